@@ -465,6 +465,134 @@ extern DECLSPEC int SDLCALL SDL_BuildAudioCVT(SDL_AudioCVT * cvt,
  */
 extern DECLSPEC int SDLCALL SDL_ConvertAudio(SDL_AudioCVT * cvt);
 
+/* SDL_AudioStream is a new audio conversion interface.
+   The benefits vs SDL_AudioCVT:
+    - it can handle resampling data in chunks without generating
+      artifacts, when it doesn't have the complete buffer available.
+    - it can handle incoming data in any variable size.
+    - You push data as you have it, and pull it when you need it
+ */
+/* this is opaque to the outside world. */
+struct _SDL_AudioStream;
+typedef struct _SDL_AudioStream SDL_AudioStream;
+
+/**
+ *  Create a new audio stream
+ *
+ *  \param src_format The format of the source audio
+ *  \param src_channels The number of channels of the source audio
+ *  \param src_rate The sampling rate of the source audio
+ *  \param dst_format The format of the desired audio output
+ *  \param dst_channels The number of channels of the desired audio output
+ *  \param dst_rate The sampling rate of the desired audio output
+ *  \return a new audio stream on success, or NULL on failure.
+ *
+ *  \sa SDL_AudioStreamPut
+ *  \sa SDL_AudioStreamPutBatch
+ *  \sa SDL_AudioStreamGet
+ *  \sa SDL_AudioStreamAvailable
+ *  \sa SDL_AudioStreamClear
+ *  \sa SDL_FreeAudioStream
+ */
+extern DECLSPEC SDL_AudioStream * SDLCALL SDL_NewAudioStream(const SDL_AudioFormat src_format,
+                                           const Uint8 src_channels,
+                                           const int src_rate,
+                                           const SDL_AudioFormat dst_format,
+                                           const Uint8 dst_channels,
+                                           const int dst_rate);
+
+/**
+ *  Add data to be converted/resampled to the stream
+ *
+ *  \param stream The stream the audio data is being added to
+ *  \param buf A pointer to the audio data to add
+ *  \param len The number of bytes to write to the stream
+ *  \return 0 on success, or -1 on error.
+ *
+ *  \sa SDL_NewAudioStream
+ *  \sa SDL_AudioStreamPutBatch
+ *  \sa SDL_AudioStreamGet
+ *  \sa SDL_AudioStreamAvailable
+ *  \sa SDL_AudioStreamClear
+ *  \sa SDL_FreeAudioStream
+ */
+extern DECLSPEC int SDLCALL SDL_AudioStreamPut(SDL_AudioStream *stream, const void *buf, const Uint32 len);
+
+/**
+ *  Add data to several independent streams at once
+ *
+ *  This is equivalent to calling SDL_AudioStreamPut(streams[i], bufs[i],
+ *  lens[i]) for every stream in the batch, but the conversions are spread
+ *  across worker threads, since each stream is converted independently.
+ *  The function returns once every stream in the batch has been converted.
+ *
+ *  A stream may only appear once in a batch, and no other thread may use
+ *  any of the streams while this call is in progress.
+ *
+ *  The number of worker threads is controlled by the
+ *  ::SDL_HINT_AUDIO_STREAM_BATCH_THREADS hint.
+ *
+ *  \param streams An array of streams the audio data is being added to
+ *  \param bufs An array of pointers to the audio data for each stream
+ *  \param lens An array with the number of bytes to write to each stream
+ *  \param num_streams The number of elements in each array
+ *  \return 0 on success, or -1 if any of the streams failed.
+ *
+ *  \sa SDL_NewAudioStream
+ *  \sa SDL_AudioStreamPut
+ *  \sa SDL_AudioStreamGet
+ */
+extern DECLSPEC int SDLCALL SDL_AudioStreamPutBatch(SDL_AudioStream **streams, const void **bufs, const Uint32 *lens, const int num_streams);
+
+/**
+ *  Get converted/resampled data from the stream
+ *
+ *  \param stream The stream the audio is being requested from
+ *  \param buf A buffer to fill with audio data
+ *  \param len The maximum number of bytes to fill
+ *  \return The number of bytes read from the stream, or -1 on error
+ *
+ *  \sa SDL_NewAudioStream
+ *  \sa SDL_AudioStreamPut
+ *  \sa SDL_AudioStreamAvailable
+ *  \sa SDL_AudioStreamClear
+ *  \sa SDL_FreeAudioStream
+ */
+extern DECLSPEC int SDLCALL SDL_AudioStreamGet(SDL_AudioStream *stream, void *buf, const Uint32 len);
+
+/**
+ *  Get the number of converted/resampled bytes available
+ *
+ *  \sa SDL_NewAudioStream
+ *  \sa SDL_AudioStreamPut
+ *  \sa SDL_AudioStreamGet
+ *  \sa SDL_AudioStreamClear
+ *  \sa SDL_FreeAudioStream
+ */
+extern DECLSPEC int SDLCALL SDL_AudioStreamAvailable(SDL_AudioStream *stream);
+
+/**
+ *  Clear any pending data in the stream without converting it
+ *
+ *  \sa SDL_NewAudioStream
+ *  \sa SDL_AudioStreamPut
+ *  \sa SDL_AudioStreamGet
+ *  \sa SDL_AudioStreamAvailable
+ *  \sa SDL_FreeAudioStream
+ */
+extern DECLSPEC void SDLCALL SDL_AudioStreamClear(SDL_AudioStream *stream);
+
+/**
+ *  Free an audio stream
+ *
+ *  \sa SDL_NewAudioStream
+ *  \sa SDL_AudioStreamPut
+ *  \sa SDL_AudioStreamGet
+ *  \sa SDL_AudioStreamAvailable
+ *  \sa SDL_AudioStreamClear
+ */
+extern DECLSPEC void SDLCALL SDL_FreeAudioStream(SDL_AudioStream *stream);
+
 #define SDL_MIX_MAXVOLUME 128
 /**
  *  This takes two audio buffers of the playing audio format and mixes
@@ -527,6 +655,88 @@ extern DECLSPEC void SDLCALL SDL_MixAudioFormat(Uint8 * dst,
  */
 extern DECLSPEC int SDLCALL SDL_QueueAudio(SDL_AudioDeviceID dev, const void *data, Uint32 len);
 
+/**
+ *  Queue audio on a non-callback device to start on a specific sample frame.
+ *
+ *  This works like SDL_QueueAudio(), but the data will not start playing
+ *  before sample frame (frame) of the queue's timeline, as reported by
+ *  SDL_GetQueuedAudioFramePosition(). If the queue reaches this buffer
+ *  early, silence is played until the requested frame; if it reaches it
+ *  late (because earlier data was still playing, or the frame has already
+ *  passed), the frames that should have played already are skipped, so the
+ *  rest of the buffer stays on schedule.
+ *
+ *  Queued data still plays in the order it was queued; schedule buffers in
+ *  increasing frame order. Frames are counted in the format the device was
+ *  opened with (the obtained spec), and only advance while it is unpaused.
+ *
+ *  \param dev The device ID to which we will queue audio.
+ *  \param data The data to queue to the device for later playback.
+ *  \param len The number of bytes (a whole number of sample frames).
+ *  \param frame The sample frame on which playback of (data) should start.
+ *  \return zero on success, -1 on error.
+ *
+ *  \sa SDL_QueueAudio
+ *  \sa SDL_QueueAudioAtCounter
+ *  \sa SDL_GetQueuedAudioFramePosition
+ */
+extern DECLSPEC int SDLCALL SDL_QueueAudioAtFrame(SDL_AudioDeviceID dev, const void *data, Uint32 len, Uint64 frame);
+
+/**
+ *  Queue audio on a non-callback device to start at a performance counter time.
+ *
+ *  The time, in SDL_GetPerformanceCounter() units, is converted to a sample
+ *  frame using the most recent position reported by
+ *  SDL_GetQueuedAudioFramePosition(), then queued with
+ *  SDL_QueueAudioAtFrame(). This is the time the audio thread renders the
+ *  frame, not when it is heard; add SDL_GetAudioDeviceLatency() if that
+ *  matters.
+ *
+ *  \param dev The device ID to which we will queue audio.
+ *  \param data The data to queue to the device for later playback.
+ *  \param len The number of bytes (a whole number of sample frames).
+ *  \param counter The performance counter value at which playback should start.
+ *  \return zero on success, -1 on error.
+ *
+ *  \sa SDL_QueueAudioAtFrame
+ *  \sa SDL_GetQueuedAudioFramePosition
+ */
+extern DECLSPEC int SDLCALL SDL_QueueAudioAtCounter(SDL_AudioDeviceID dev, const void *data, Uint32 len, Uint64 counter);
+
+/**
+ *  Get how many sample frames the queue of a non-callback device has played.
+ *
+ *  This counts every frame handed to the device from the queue since it was
+ *  opened, including silence played while the queue was empty. If (counter)
+ *  is not NULL, it is set to the SDL_GetPerformanceCounter() value at which
+ *  that position was reached.
+ *
+ *  \param dev The device ID to query.
+ *  \param counter Filled in with the time of the returned position, may be NULL.
+ *  \return The number of sample frames played, or 0 if (dev) is not a
+ *          queueing playback device.
+ *
+ *  \sa SDL_QueueAudioAtFrame
+ *  \sa SDL_QueueAudioAtCounter
+ */
+extern DECLSPEC Uint64 SDLCALL SDL_GetQueuedAudioFramePosition(SDL_AudioDeviceID dev, Uint64 *counter);
+
+/**
+ *  Get the latency of an opened audio device.
+ *
+ *  This is how many sample frames, at the device's obtained frequency, the
+ *  audio driver buffers between SDL and the speaker (or the microphone, for
+ *  capture devices). Drivers that measure it while the device runs update it,
+ *  so it may change.
+ *
+ *  \param dev The device ID to query.
+ *  \return The latency in sample frames, or 0 if the driver doesn't report it
+ *          or (dev) is invalid.
+ *
+ *  \sa SDL_QueueAudioAtCounter
+ */
+extern DECLSPEC Uint32 SDLCALL SDL_GetAudioDeviceLatency(SDL_AudioDeviceID dev);
+
 /**
  *  Dequeue more audio on non-callback devices.
  *
@@ -165,6 +165,7 @@
 #cmakedefine HAVE_NANOSLEEP 1
 #cmakedefine HAVE_SYSCONF 1
 #cmakedefine HAVE_SYSCTLBYNAME 1
+#cmakedefine HAVE_MMAP 1
 #cmakedefine HAVE_CLOCK_GETTIME 1
 #cmakedefine HAVE_GETPAGESIZE 1
 #cmakedefine HAVE_MPROTECT 1
@@ -105,6 +105,7 @@
 #define HAVE_NANOSLEEP  1
 #define HAVE_SYSCONF    1
 #define HAVE_SYSCTLBYNAME 1
+#define HAVE_MMAP 1
 #define HAVE_ATAN 1
 #define HAVE_ATAN2 1
 #define HAVE_ACOS 1
@@ -64,6 +64,23 @@ extern "C" {
  */
 #define SDL_HINT_FRAMEBUFFER_ACCELERATION   "SDL_FRAMEBUFFER_ACCELERATION"
 
+/**
+ *  \brief  A variable controlling whether window surfaces track the areas drawn into them.
+ *
+ *  When enabled, blits, fills and software renderer drawing into a window
+ *  surface add to a damaged region, and SDL_UpdateWindowSurface() presents
+ *  only that region instead of the whole window.  SDL_UpdateWindowSurfaceRects()
+ *  presents the given rectangles as well as the damaged region.  Pixels
+ *  written directly to the surface aren't tracked, so they must be passed to
+ *  SDL_UpdateWindowSurfaceRects().
+ *
+ *  This variable is checked when the window surface is created, and can be
+ *  set to the following values:
+ *    "0"       - SDL_UpdateWindowSurface() presents the whole window (default)
+ *    "1"       - SDL_UpdateWindowSurface() presents the damaged region
+ */
+#define SDL_HINT_WINDOW_SURFACE_DAMAGE   "SDL_WINDOW_SURFACE_DAMAGE"
+
 /**
  *  \brief  A variable specifying which render driver to use.
  *
@@ -123,7 +140,7 @@ extern "C" {
  *
  *  This variable can be set to the following values:
  *    "0" or "nearest" - Nearest pixel sampling
- *    "1" or "linear"  - Linear filtering (supported by OpenGL and Direct3D)
+ *    "1" or "linear"  - Linear filtering (supported by OpenGL, Direct3D and the software renderer)
  *    "2" or "best"    - Currently this is the same as "linear"
  *
  *  By default nearest pixel sampling is used
@@ -199,6 +216,26 @@ extern "C" {
  */
 #define SDL_HINT_VIDEO_X11_NET_WM_PING      "SDL_VIDEO_X11_NET_WM_PING"
 
+/**
+ *  \brief  A variable naming a file or pipe that receives the frames presented with the dummy video driver.
+ *
+ *  Every window surface update writes the whole surface, so the windows of
+ *  a headless program can be recorded or piped to another process.  Each
+ *  frame is a 32 byte header of little endian values followed by the rows
+ *  of the surface, tightly packed:
+ *    Uint32    "SDLF"
+ *    Uint32    The window ID
+ *    Uint32    The width of the frame, in pixels
+ *    Uint32    The height of the frame, in pixels
+ *    Uint32    The pixel format of the rows, an SDL_PixelFormatEnum
+ *    Uint32    The frame number, counted over all windows
+ *    Uint64    The time since the first frame was written, in nanoseconds
+ *
+ *  By default no frames are written.  The hint is checked when the first
+ *  frame is presented.
+ */
+#define SDL_HINT_VIDEO_DUMMY_OUTPUT         "SDL_VIDEO_DUMMY_OUTPUT"
+
 /**
  *  \brief  A variable controlling whether the window frame and title bar are interactive when the cursor is hidden 
  *
@@ -801,6 +838,129 @@ extern "C" {
  */
 #define SDL_HINT_AUDIO_RESAMPLING_MODE   "SDL_AUDIO_RESAMPLING_MODE"
 
+/**
+ *  \brief  A variable controlling how many threads SDL_AudioStreamPutBatch() uses.
+ *
+ *  Each stream in a batch is converted independently, so the work is split
+ *  between the calling thread and a set of short-lived worker threads.
+ *
+ *  This variable can be set to the following values:
+ *
+ *    "0"       - Use one thread per CPU core (default)
+ *    "1"       - Convert every stream on the calling thread
+ *    "N"       - Use up to N threads, including the calling thread
+ */
+#define SDL_HINT_AUDIO_STREAM_BATCH_THREADS   "SDL_AUDIO_STREAM_BATCH_THREADS"
+
+/**
+ *  \brief  A variable controlling how many threads large software blits use.
+ *
+ *  Unscaled blits and pixel format conversions that cover more than half a
+ *  megapixel are split into horizontal bands, each of at least 256K pixels,
+ *  which are blitted on the calling thread and a set of worker threads.  This
+ *  also applies to SDL_ConvertPixels() and SDL_ConvertSurface().  The worker
+ *  threads are started by the first such blit and stopped by SDL_Quit().
+ *  Blits within one surface whose source and destination overlap always run
+ *  on the calling thread.  Measure with "testbench blitthreads" before turning
+ *  this on.
+ *
+ *  This variable can be set to the following values:
+ *
+ *    "0"       - Use one thread per CPU core
+ *    "1"       - Do every blit on the calling thread (default)
+ *    "N"       - Use up to N threads, including the calling thread
+ */
+#define SDL_HINT_BLIT_THREADS   "SDL_BLIT_THREADS"
+
+/**
+ *  \brief  A variable controlling whether the software alpha blitters may use SIMD.
+ *
+ *  The SSE2 alpha blending blitters give exactly the same results as the
+ *  portable C ones; turning SIMD off (which also skips the MMX and 3DNow!
+ *  blitters) is mostly useful for comparing the two.
+ *  This is checked when a blit between two surfaces is set up, so it only
+ *  affects surfaces that are blitted for the first time after it changes.
+ *
+ *  This variable can be set to the following values:
+ *    "0"       - Use the portable C blitters
+ *    "1"       - Use SIMD blitters if the CPU supports them (default)
+ */
+#define SDL_HINT_BLIT_SIMD   "SDL_BLIT_SIMD"
+
+/**
+ *  \brief  A variable controlling whether RLE surfaces are encoded on a background thread.
+ *
+ *  Surfaces with SDL_RLEACCEL are normally encoded during their first blit,
+ *  which can take several milliseconds for large sprites.  When this is
+ *  enabled, surfaces of 65536 pixels or more (e.g. 256x256) are encoded on
+ *  a worker thread instead, and blits use the regular blitter until the
+ *  encoding is ready.  Locking the surface before then throws the encoding
+ *  away, and SDL_FillRect() waits for it, so the surface still has to be
+ *  locked to be written to.
+ *
+ *  This variable can be set to the following values:
+ *    "0"       - Encode during the first blit (default)
+ *    "1"       - Encode large surfaces on a background thread
+ */
+#define SDL_HINT_RLE_LAZY_ENCODE   "SDL_RLE_LAZY_ENCODE"
+
+/**
+ *  \brief  A variable controlling whether new surfaces get aligned pixels.
+ *
+ *  When enabled, surfaces created by SDL_CreateRGBSurface() and friends
+ *  behave as if ::SDL_SIMD_ALIGNED had been passed: the pixels start on a
+ *  64 byte boundary and the pitch is padded to a multiple of 64 bytes, so
+ *  every row starts on a cache line.
+ *
+ *  This variable can be set to the following values:
+ *    "0"       - Pixels are only aligned when asked for (default)
+ *    "1"       - Align the pixels of every new surface
+ */
+#define SDL_HINT_SURFACE_ALIGNED   "SDL_SURFACE_ALIGNED"
+
+/**
+ *  \brief  A variable setting how many bytes of freed surface pixels SDL keeps for reuse.
+ *
+ *  SDL_FreeSurface() normally releases the pixels of a surface right away.
+ *  With a pool size set, the pixel buffers of freed surfaces are kept, sorted
+ *  by size, and handed to the next surfaces of a similar size instead of
+ *  going back to the allocator.  This helps programs that create and free
+ *  temporary surfaces every frame.  Pooled buffers start on a 64 byte
+ *  boundary, but their surfaces only get ::SDL_SIMD_ALIGNED if the pitch is
+ *  a multiple of 64 as well.  Lowering the size empties the pool, and the
+ *  pool is emptied by SDL_Quit().
+ *
+ *  The default is "0", which doesn't keep any buffers.
+ */
+#define SDL_HINT_SURFACE_POOL_SIZE   "SDL_SURFACE_POOL_SIZE"
+
+/**
+ *  \brief  A variable controlling whether the PulseAudio driver renders directly into server memory.
+ *
+ *  When enabled, playback buffers come from pa_stream_begin_write(), so the
+ *  audio callback writes into memory shared with the PulseAudio server and
+ *  no copy is made when the buffer is submitted.
+ *
+ *  This variable can be set to the following values:
+ *    "0"       - Mix into SDL's own buffer and copy it to the server
+ *    "1"       - Render into server-provided memory when possible (default)
+ */
+#define SDL_HINT_PULSEAUDIO_ZERO_COPY   "SDL_PULSEAUDIO_ZERO_COPY"
+
+/**
+ *  \brief  A variable setting the target latency of PulseAudio streams, in milliseconds.
+ *
+ *  This is the amount of audio the server keeps buffered for playback. It is
+ *  never set below the size of one audio buffer. The latency the server
+ *  actually grants, and the measured latency while playing, are logged to
+ *  SDL_LOG_CATEGORY_AUDIO at debug priority.
+ *
+ *  By default, the target is twice the requested buffer size.
+ *
+ *  This hint is checked when an audio device is opened.
+ */
+#define SDL_HINT_PULSEAUDIO_TARGET_LATENCY   "SDL_PULSEAUDIO_TARGET_LATENCY"
+
 /**
  *  \brief  An enumeration of hint priorities
  */
@@ -119,6 +119,26 @@ typedef struct SDL_WindowShapeMode {
  */
 extern DECLSPEC int SDLCALL SDL_SetWindowShape(SDL_Window *window,SDL_Surface *shape,SDL_WindowShapeMode *shape_mode);
 
+/**
+ * \brief Update the part of a shaped window's shape inside a rectangle.
+ *
+ * \param window The shaped window whose shape should be updated.
+ * \param shape A surface encoding the desired shape for the window, with only the pixels inside rect changed since
+ *              the shape was last set or updated.
+ * \param rect The area of shape that changed, or NULL to update the whole shape.
+ *
+ * \return 0 on success, SDL_INVALID_SHAPE_ARGUMENT on an invalid shape argument, SDL_NONSHAPEABLE_WINDOW if the
+ *           SDL_Window* given does not reference a valid shaped window, or SDL_WINDOW_LACKS_SHAPE if the window
+ *           has not been given a shape with SDL_SetWindowShape() yet.
+ *
+ * The parameters given when the shape was set are used. Where the video driver supports it, only the part of the
+ * shape inside rect is recalculated, which is much faster than setting the whole shape again when small parts of a
+ * large shape change. Other drivers set the whole shape again.
+ *
+ * \sa SDL_SetWindowShape
+ */
+extern DECLSPEC int SDLCALL SDL_UpdateWindowShape(SDL_Window *window,SDL_Surface *shape,const SDL_Rect *rect);
+
 /**
  * \brief Get the shape parameters of a shaped window.
  *
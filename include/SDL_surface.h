@@ -53,6 +53,8 @@ extern "C" {
 #define SDL_PREALLOC        0x00000001  /**< Surface uses preallocated memory */
 #define SDL_RLEACCEL        0x00000002  /**< Surface is RLE encoded */
 #define SDL_DONTFREE        0x00000004  /**< Surface is referenced internally */
+#define SDL_SIMD_ALIGNED    0x00000008  /**< Surface uses aligned memory */
+#define SDL_TRACKDAMAGE     0x00000010  /**< Surface changes are tracked for its window */
 /* @} *//* Surface flags */
 
 /**
@@ -97,6 +99,18 @@ typedef struct SDL_Surface
 typedef int (*SDL_blit) (struct SDL_Surface * src, SDL_Rect * srcrect,
                          struct SDL_Surface * dst, SDL_Rect * dstrect);
 
+/**
+ * \brief The formula used for converting between YUV and RGB
+ */
+typedef enum
+{
+    SDL_YUV_CONVERSION_JPEG,        /**< Full range JPEG */
+    SDL_YUV_CONVERSION_BT601,       /**< BT.601 (the default) */
+    SDL_YUV_CONVERSION_BT709,       /**< BT.709 */
+    SDL_YUV_CONVERSION_AUTOMATIC,   /**< BT.601 for SD content, BT.709 for HD content */
+    SDL_YUV_CONVERSION_BT709_FULL   /**< Full range BT.709 */
+} SDL_YUV_CONVERSION_MODE;
+
 /**
  *  Allocate and free an RGB surface.
  *
@@ -106,7 +120,8 @@ typedef int (*SDL_blit) (struct SDL_Surface * src, SDL_Rect * srcrect,
  *
  *  If the function runs out of memory, it will return NULL.
  *
- *  \param flags The \c flags are obsolete and should be set to 0.
+ *  \param flags 0, or ::SDL_SIMD_ALIGNED to align the pixels and pitch to
+ *               64 bytes.  See also ::SDL_HINT_SURFACE_ALIGNED.
  *  \param width The width in pixels of the surface to create.
  *  \param height The height in pixels of the surface to create.
  *  \param depth The depth in bits of the surface to create.
@@ -185,6 +200,37 @@ extern DECLSPEC SDL_Surface *SDLCALL SDL_LoadBMP_RW(SDL_RWops * src,
  */
 #define SDL_LoadBMP(file)   SDL_LoadBMP_RW(SDL_RWFromFile(file, "rb"), 1)
 
+/**
+ *  Load a surface from a seekable SDL data stream (memory or file), in the
+ *  given pixel format.
+ *
+ *  Uncompressed images of 8 bits or more per pixel are decoded straight into
+ *  the new surface when \c format is an RGB format, reading the pixels from
+ *  memory or a memory mapped file where possible. This is faster than
+ *  SDL_LoadBMP_RW() followed by SDL_ConvertSurfaceFormat(), and gives the
+ *  same result. Other images are loaded and then converted.
+ *
+ *  If \c format is SDL_PIXELFORMAT_UNKNOWN, the surface has the format of the
+ *  file, as with SDL_LoadBMP_RW().
+ *
+ *  If \c freesrc is non-zero, the stream will be closed after being read.
+ *
+ *  The new surface should be freed with SDL_FreeSurface().
+ *
+ *  \return the new surface, or NULL if there was an error.
+ */
+extern DECLSPEC SDL_Surface *SDLCALL SDL_LoadBMPWithFormat_RW(SDL_RWops * src,
+                                                              int freesrc,
+                                                              Uint32 format);
+
+/**
+ *  Load a surface from a file, in the given pixel format.
+ *
+ *  Convenience macro.
+ */
+#define SDL_LoadBMPWithFormat(file, format) \
+    SDL_LoadBMPWithFormat_RW(SDL_RWFromFile(file, "rb"), 1, format)
+
 /**
  *  Save a surface to a seekable SDL data stream (memory or file).
  *
@@ -374,6 +420,9 @@ extern DECLSPEC SDL_Surface *SDLCALL SDL_ConvertSurfaceFormat
 /**
  * \brief Copy a block of pixels of one format to another format
  *
+ *  YUV formats can be converted to and from the packed RGB formats, using
+ *  the formula set with SDL_SetYUVConversionMode().
+ *
  *  \return 0 on success, or -1 if there was an error
  */
 extern DECLSPEC int SDLCALL SDL_ConvertPixels(int width, int height,
@@ -483,6 +532,19 @@ extern DECLSPEC int SDLCALL SDL_SoftStretch(SDL_Surface * src,
                                             SDL_Surface * dst,
                                             const SDL_Rect * dstrect);
 
+/**
+ *  \brief Perform a bilinear filtered stretch blit between two 32-bit surfaces
+ *         of the same pixel format.
+ *
+ *  Reductions to half the size or less average all the source pixels each
+ *  destination pixel covers instead.  Formats with 10-bit channels are not
+ *  supported.
+ */
+extern DECLSPEC int SDLCALL SDL_SoftStretchLinear(SDL_Surface * src,
+                                                  const SDL_Rect * srcrect,
+                                                  SDL_Surface * dst,
+                                                  const SDL_Rect * dstrect);
+
 #define SDL_BlitScaled SDL_UpperBlitScaled
 
 /**
@@ -501,6 +563,26 @@ extern DECLSPEC int SDLCALL SDL_LowerBlitScaled
     (SDL_Surface * src, SDL_Rect * srcrect,
     SDL_Surface * dst, SDL_Rect * dstrect);
 
+/**
+ *  \brief Set the YUV conversion mode
+ *
+ *  This may be called from any thread. Conversions that are already running
+ *  finish with the mode they started with.
+ */
+extern DECLSPEC void SDLCALL SDL_SetYUVConversionMode(SDL_YUV_CONVERSION_MODE mode);
+
+/**
+ *  \brief Get the YUV conversion mode
+ */
+extern DECLSPEC SDL_YUV_CONVERSION_MODE SDLCALL SDL_GetYUVConversionMode(void);
+
+/**
+ *  \brief Get the YUV conversion mode, returning the correct mode for the
+ *         resolution when the current conversion mode is
+ *         SDL_YUV_CONVERSION_AUTOMATIC
+ */
+extern DECLSPEC SDL_YUV_CONVERSION_MODE SDLCALL SDL_GetYUVConversionModeForResolution(int width, int height);
+
 
 /* Ends C function definitions when using C++ */
 #ifdef __cplusplus
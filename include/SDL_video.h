@@ -813,6 +813,44 @@ extern DECLSPEC int SDLCALL SDL_UpdateWindowSurfaceRects(SDL_Window * window,
                                                          const SDL_Rect * rects,
                                                          int numrects);
 
+/**
+ *  \brief Callback used when a window surface has been copied to the screen.
+ *
+ *  \param userdata The pointer passed to SDL_SetWindowPresentCallback().
+ *  \param window The window that was updated.
+ *  \param surface The window surface, which must not be changed or freed.
+ *  \param rects The rectangles of the surface that were copied.
+ *  \param numrects The number of rectangles.
+ *  \param timestamp The value of SDL_GetPerformanceCounter() after the copy.
+ */
+typedef void (SDLCALL *SDL_PresentCallback)(void *userdata,
+                                            SDL_Window * window,
+                                            SDL_Surface * surface,
+                                            const SDL_Rect * rects,
+                                            int numrects,
+                                            Uint64 timestamp);
+
+/**
+ *  \brief Set a callback that sees every update of the window surface.
+ *
+ *  The callback is run from SDL_UpdateWindowSurface() and
+ *  SDL_UpdateWindowSurfaceRects(), and so also from SDL_RenderPresent() with
+ *  the software renderer, once the surface has been copied to the screen.
+ *  It can be used to capture the frames of a program or to measure how often
+ *  it presents them, for example with the dummy video driver.
+ *
+ *  \param window The window to watch.
+ *  \param callback The function to call, or NULL to stop calling it.
+ *  \param userdata A pointer passed to the callback.
+ *
+ *  \return 0 on success, or -1 on error.
+ *
+ *  \sa SDL_UpdateWindowSurfaceRects()
+ */
+extern DECLSPEC int SDLCALL SDL_SetWindowPresentCallback(SDL_Window * window,
+                                                         SDL_PresentCallback callback,
+                                                         void *userdata);
+
 /**
  *  \brief Set a window's input grab mode.
  *
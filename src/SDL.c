@@ -33,6 +33,8 @@
 #include "events/SDL_events_c.h"
 #include "haptic/SDL_haptic_c.h"
 #include "joystick/SDL_joystick_c.h"
+#include "video/SDL_pixels_c.h"
+#include "video/SDL_RLEaccel_c.h"
 
 /* Initialization/Cleanup routines */
 #if !SDL_TIMERS_DISABLED
@@ -358,6 +360,11 @@ SDL_Quit(void)
 #endif
 
     SDL_ClearHints();
+    SDL_RLEEncodeQuit();
+    SDL_BlitThreadsQuit();
+    SDL_SurfacePoolQuit();
+    SDL_BlitMapCacheQuit();
+    SDL_FormatCacheQuit();
     SDL_AssertionsQuit();
     SDL_LogResetPriorities();
 
@@ -234,6 +234,12 @@ SDL_AudioWaitDevice_Default(_THIS)
 {                               /* no-op. */
 }
 
+static int
+SDL_AudioWaitDeviceTimeout_Default(_THIS, int timeoutMS)
+{
+    return -1;  /* no wait primitive, SDL_AudioPaceFrames() sleeps instead. */
+}
+
 static void
 SDL_AudioPlayDevice_Default(_THIS)
 {                               /* no-op. */
@@ -350,6 +356,7 @@ finish_audio_entry_points_init(void)
     FILL_STUB(ThreadInit);
     FILL_STUB(ThreadDeinit);
     FILL_STUB(WaitDevice);
+    FILL_STUB(WaitDeviceTimeout);
     FILL_STUB(PlayDevice);
     FILL_STUB(GetPendingBytes);
     FILL_STUB(GetDeviceBuf);
@@ -509,18 +516,84 @@ SDL_RemoveAudioDevice(const int iscapture, void *handle)
 
 /* buffer queueing support... */
 
+static void
+FreeQueueMarks(SDL_AudioDevice *device)
+{
+    SDL_AudioQueueMark *mark = device->queue_marks;
+    while (mark) {
+        SDL_AudioQueueMark *next = mark->next;
+        SDL_free(mark);
+        mark = next;
+    }
+    device->queue_marks = device->queue_marks_tail = NULL;
+}
+
+static size_t
+ReadFromBufferQueue(SDL_AudioDevice *device, Uint8 *stream, const size_t len)
+{
+    const size_t dequeued = SDL_ReadFromDataQueue(device->buffer_queue, stream, len);
+    device->queue_bytes_read += dequeued;
+    return dequeued;
+}
+
 static void SDLCALL
 SDL_BufferQueueDrainCallback(void *userdata, Uint8 *stream, int len)
 {
     /* this function always holds the mixer lock before being called. */
     SDL_AudioDevice *device = (SDL_AudioDevice *) userdata;
+    const int framesize = (SDL_AUDIO_BITSIZE(device->callbackspec.format) / 8) * device->callbackspec.channels;
+    const Uint64 start_frame = device->queue_frame_position;
+    const int origlen = len;
     size_t dequeued;
 
     SDL_assert(device != NULL);  /* this shouldn't ever happen, right?! */
     SDL_assert(!device->iscapture);  /* this shouldn't ever happen, right?! */
     SDL_assert(len >= 0);  /* this shouldn't ever happen, right?! */
 
-    dequeued = SDL_ReadFromDataQueue(device->buffer_queue, stream, len);
+    /* Queued data plays in order, but a scheduled buffer at the head of the
+       queue waits (playing silence) until its start frame comes up. If we're
+       already past that frame, skip the part that should have played by now,
+       so the rest of it still lines up with the schedule. */
+    while ((len > 0) && (device->queue_marks != NULL)) {
+        SDL_AudioQueueMark *mark = device->queue_marks;
+        const Uint64 frame = start_frame + ((origlen - len) / framesize);
+
+        if (mark->offset > device->queue_bytes_read) {
+            /* play unscheduled data that was queued before this mark. */
+            const Uint64 avail = mark->offset - device->queue_bytes_read;
+            dequeued = ReadFromBufferQueue(device, stream, (size_t) SDL_min((Uint64) len, avail));
+            if (dequeued == 0) {
+                break;  /* shouldn't happen, but don't spin forever. */
+            }
+            stream += dequeued;
+            len -= (int) dequeued;
+        } else if (frame < mark->frame) {
+            const int silence = (int) SDL_min((Uint64) len, (mark->frame - frame) * framesize);
+            SDL_memset(stream, device->callbackspec.silence, silence);
+            stream += silence;
+            len -= silence;
+        } else {
+            const Uint64 end = mark->next ? mark->next->offset : device->queue_bytes_written;
+            Uint64 late = SDL_min((frame - mark->frame) * framesize, end - device->queue_bytes_read);
+
+            /* (stream) is free scratch space until we write the real data. */
+            while (late > 0) {
+                dequeued = ReadFromBufferQueue(device, stream, (size_t) SDL_min((Uint64) len, late));
+                if (dequeued == 0) {
+                    break;
+                }
+                late -= dequeued;
+            }
+
+            device->queue_marks = mark->next;
+            if (device->queue_marks == NULL) {
+                device->queue_marks_tail = NULL;
+            }
+            SDL_free(mark);
+        }
+    }
+
+    dequeued = ReadFromBufferQueue(device, stream, len);
     stream += dequeued;
     len -= (int) dequeued;
 
@@ -528,6 +601,9 @@ SDL_BufferQueueDrainCallback(void *userdata, Uint8 *stream, int len)
         SDL_assert(SDL_CountDataQueue(device->buffer_queue) == 0);
         SDL_memset(stream, device->spec.silence, len);
     }
+
+    device->queue_frame_position = start_frame + (origlen / framesize);
+    device->queue_position_counter = SDL_GetPerformanceCounter();
 }
 
 static void SDLCALL
@@ -546,29 +622,158 @@ SDL_BufferQueueFillCallback(void *userdata, Uint8 *stream, int len)
     SDL_WriteToDataQueue(device->buffer_queue, stream, len);
 }
 
-int
-SDL_QueueAudio(SDL_AudioDeviceID devid, const void *data, Uint32 len)
+static SDL_AudioDevice *
+get_queueing_playback_device(SDL_AudioDeviceID devid)
 {
     SDL_AudioDevice *device = get_audio_device(devid);
-    int rc = 0;
 
     if (!device) {
-        return -1;  /* get_audio_device() will have set the error state */
+        return NULL;  /* get_audio_device() will have set the error state */
     } else if (device->iscapture) {
-        return SDL_SetError("This is a capture device, queueing not allowed");
+        SDL_SetError("This is a capture device, queueing not allowed");
+        return NULL;
     } else if (device->spec.callback != SDL_BufferQueueDrainCallback) {
-        return SDL_SetError("Audio device has a callback, queueing not allowed");
+        SDL_SetError("Audio device has a callback, queueing not allowed");
+        return NULL;
+    }
+    return device;
+}
+
+/* the device lock must be held. */
+static int
+QueueAudioAtFrame(SDL_AudioDevice *device, const void *data, Uint32 len, Uint64 frame)
+{
+    SDL_AudioQueueMark *mark = (SDL_AudioQueueMark *) SDL_malloc(sizeof (*mark));
+
+    if (!mark) {
+        return SDL_OutOfMemory();
+    } else if (SDL_WriteToDataQueue(device->buffer_queue, data, len) < 0) {
+        SDL_free(mark);
+        return -1;
+    }
+
+    mark->offset = device->queue_bytes_written;
+    mark->frame = frame;
+    mark->next = NULL;
+    if (device->queue_marks_tail) {
+        device->queue_marks_tail->next = mark;
+    } else {
+        device->queue_marks = mark;
+    }
+    device->queue_marks_tail = mark;
+    device->queue_bytes_written += len;
+    return 0;
+}
+
+int
+SDL_QueueAudio(SDL_AudioDeviceID devid, const void *data, Uint32 len)
+{
+    SDL_AudioDevice *device = get_queueing_playback_device(devid);
+    int rc = 0;
+
+    if (!device) {
+        return -1;
     }
 
     if (len > 0) {
         current_audio.impl.LockDevice(device);
         rc = SDL_WriteToDataQueue(device->buffer_queue, data, len);
+        if (rc == 0) {
+            device->queue_bytes_written += len;
+        }
         current_audio.impl.UnlockDevice(device);
     }
 
     return rc;
 }
 
+int
+SDL_QueueAudioAtFrame(SDL_AudioDeviceID devid, const void *data, Uint32 len, Uint64 frame)
+{
+    SDL_AudioDevice *device = get_queueing_playback_device(devid);
+    const int framesize = device ? (SDL_AUDIO_BITSIZE(device->callbackspec.format) / 8) * device->callbackspec.channels : 1;
+    int rc = 0;
+
+    if (!device) {
+        return -1;
+    } else if ((len % framesize) != 0) {
+        return SDL_SetError("Can't queue partial sample frames");
+    }
+
+    if (len > 0) {
+        current_audio.impl.LockDevice(device);
+        rc = QueueAudioAtFrame(device, data, len, frame);
+        current_audio.impl.UnlockDevice(device);
+    }
+
+    return rc;
+}
+
+int
+SDL_QueueAudioAtCounter(SDL_AudioDeviceID devid, const void *data, Uint32 len, Uint64 counter)
+{
+    SDL_AudioDevice *device = get_queueing_playback_device(devid);
+    const int framesize = device ? (SDL_AUDIO_BITSIZE(device->callbackspec.format) / 8) * device->callbackspec.channels : 1;
+    int rc = 0;
+
+    if (!device) {
+        return -1;
+    } else if ((len % framesize) != 0) {
+        return SDL_SetError("Can't queue partial sample frames");
+    }
+
+    if (len > 0) {
+        const double frames_per_tick = ((double) device->callbackspec.freq) / ((double) SDL_GetPerformanceFrequency());
+        Uint64 frame;
+
+        current_audio.impl.LockDevice(device);
+        /* project from the last time the queue fed the device. */
+        if (counter >= device->queue_position_counter) {
+            frame = device->queue_frame_position + (Uint64) ((counter - device->queue_position_counter) * frames_per_tick);
+        } else {
+            const Uint64 back = (Uint64) ((device->queue_position_counter - counter) * frames_per_tick);
+            frame = (back < device->queue_frame_position) ? device->queue_frame_position - back : 0;
+        }
+        rc = QueueAudioAtFrame(device, data, len, frame);
+        current_audio.impl.UnlockDevice(device);
+    }
+
+    return rc;
+}
+
+Uint64
+SDL_GetQueuedAudioFramePosition(SDL_AudioDeviceID devid, Uint64 *counter)
+{
+    SDL_AudioDevice *device = get_audio_device(devid);
+    Uint64 retval = 0;
+
+    if (counter) {
+        *counter = 0;
+    }
+
+    if (device && (device->spec.callback == SDL_BufferQueueDrainCallback)) {
+        current_audio.impl.LockDevice(device);
+        retval = device->queue_frame_position;
+        if (counter) {
+            *counter = device->queue_position_counter;
+        }
+        current_audio.impl.UnlockDevice(device);
+    }
+
+    return retval;
+}
+
+Uint32
+SDL_GetAudioDeviceLatency(SDL_AudioDeviceID devid)
+{
+    SDL_AudioDevice *device = get_audio_device(devid);
+
+    if (!device) {
+        return 0;
+    }
+    return (Uint32) SDL_AtomicGet(&device->latency_frames);
+}
+
 Uint32
 SDL_DequeueAudio(SDL_AudioDeviceID devid, void *data, Uint32 len)
 {
@@ -626,18 +831,77 @@ SDL_ClearQueuedAudio(SDL_AudioDeviceID devid)
 
     /* Keep up to two packets in the pool to reduce future malloc pressure. */
     SDL_ClearDataQueue(device->buffer_queue, SDL_AUDIOBUFFERQUEUE_PACKETLEN * 2);
+    device->queue_bytes_read = device->queue_bytes_written;
+    FreeQueueMarks(device);
 
     current_audio.impl.UnlockDevice(device);
 }
 
 
+void
+SDL_AudioPaceFrames(SDL_AudioDevice *device, const int frames)
+{
+    const Uint64 freq = SDL_GetPerformanceFrequency();
+    const Uint64 rate = (Uint64) device->spec.freq;
+    Uint64 now = SDL_GetPerformanceCounter();
+    Uint64 deadline;
+
+    if (frames <= 0) {
+        return;
+    }
+
+    /* Fold whole seconds into the start time, keeping the multiply small. */
+    device->pace_start += (device->pace_frames / rate) * freq;
+    device->pace_frames %= rate;
+    device->pace_frames += (Uint64) frames;
+    deadline = device->pace_start + ((device->pace_frames * freq) / rate);
+
+    if ((device->pace_start == 0) || (now >= deadline)) {
+        /* first call, or we fell a whole period behind (stall, device was
+           busy, etc): restart the clock instead of racing to catch up. */
+        device->pace_start = now;
+        device->pace_frames = (Uint64) frames;
+        deadline = now + (((Uint64) frames * freq) / rate);
+    }
+
+    /* If the backend can block on the device itself (a pollable fd, its own
+       mainloop), let the device's clock wake us instead: it isn't limited to
+       whole milliseconds and doesn't drift from the hardware. The deadline
+       still bounds the wait. */
+    if (SDL_AtomicGet(&device->enabled) && (now < deadline)) {
+        const int ms = (int) ((((deadline - now) * 1000) + freq - 1) / freq);
+        const int rc = current_audio.impl.WaitDeviceTimeout(device, ms);
+        if (rc > 0) {
+            /* the device is ready: follow its clock from here. */
+            device->pace_start = SDL_GetPerformanceCounter();
+            device->pace_frames = 0;
+            return;
+        } else if (rc == 0) {
+            return;  /* timed out, so we're at the deadline. */
+        }
+        now = SDL_GetPerformanceCounter();
+    }
+
+    /* SDL_Delay() only has millisecond resolution, so sleep whole
+       milliseconds and leave any remainder for the next period; since the
+       deadline is absolute, waking early here just makes the next wait
+       longer instead of accumulating. */
+    while (now < deadline) {
+        const Uint32 ms = (Uint32) (((deadline - now) * 1000) / freq);
+        if (ms == 0) {
+            break;
+        }
+        SDL_Delay(ms);
+        now = SDL_GetPerformanceCounter();
+    }
+}
+
 /* The general mixing thread function */
 static int SDLCALL
 SDL_RunAudio(void *devicep)
 {
     SDL_AudioDevice *device = (SDL_AudioDevice *) devicep;
     const int silence = (int) device->spec.silence;
-    const Uint32 delay = ((device->spec.samples * 1000) / device->spec.freq);
     const int data_len = device->callbackspec.size;
     Uint8 *data;
     void *udata = device->spec.userdata;
@@ -693,7 +957,7 @@ SDL_RunAudio(void *devicep)
                 SDL_assert((got < 0) || (got == device->spec.size));
 
                 if (data == NULL) {  /* device is having issues... */
-                    SDL_Delay(delay);  /* wait for as long as this buffer would have played. Maybe device recovers later? */
+                    SDL_AudioPaceFrames(device, device->spec.samples);  /* wait for as long as this buffer would have played. Maybe device recovers later? */
                 } else {
                     if (got != device->spec.size) {
                         SDL_memset(data, device->spec.silence, device->spec.size);
@@ -704,7 +968,7 @@ SDL_RunAudio(void *devicep)
             }
         } else if (data == device->work_buffer) {
             /* nothing to do; pause like we queued a buffer to play. */
-            SDL_Delay(delay);
+            SDL_AudioPaceFrames(device, device->spec.samples);
         } else {  /* writing directly to the device. */
             /* queue this buffer and wait for it to finish playing. */
             current_audio.impl.PlayDevice(device);
@@ -728,7 +992,6 @@ SDL_CaptureAudio(void *devicep)
 {
     SDL_AudioDevice *device = (SDL_AudioDevice *) devicep;
     const int silence = (int) device->spec.silence;
-    const Uint32 delay = ((device->spec.samples * 1000) / device->spec.freq);
     const int data_len = device->spec.size;
     Uint8 *data;
     void *udata = device->spec.userdata;
@@ -749,7 +1012,7 @@ SDL_CaptureAudio(void *devicep)
         Uint8 *ptr;
 
         if (SDL_AtomicGet(&device->paused)) {
-            SDL_Delay(delay);  /* just so we don't cook the CPU. */
+            SDL_AudioPaceFrames(device, device->spec.samples);  /* just so we don't cook the CPU. */
             if (device->stream) {
                 SDL_AudioStreamClear(device->stream);
             }
@@ -771,7 +1034,7 @@ SDL_CaptureAudio(void *devicep)
            But we don't process it further or call the app's callback. */
 
         if (!SDL_AtomicGet(&device->enabled)) {
-            SDL_Delay(delay);  /* try to keep callback firing at normal pace. */
+            SDL_AudioPaceFrames(device, device->spec.samples);  /* try to keep callback firing at normal pace. */
         } else {
             while (still_need > 0) {
                 const int rc = current_audio.impl.CaptureFromDevice(device, ptr, still_need);
@@ -868,8 +1131,6 @@ SDL_GetAudioDriver(int index)
     return NULL;
 }
 
-extern void SDL_ChooseAudioConverters(void);
-
 int
 SDL_AudioInit(const char *driver_name)
 {
@@ -1070,6 +1331,7 @@ close_audio_device(SDL_AudioDevice * device)
     }
 
     SDL_FreeDataQueue(device->buffer_queue);
+    FreeQueueMarks(device);
 
     SDL_free(device);
 }
@@ -1345,6 +1607,7 @@ open_audio_device(const char *devname, int iscapture,
         }
         device->spec.callback = iscapture ? SDL_BufferQueueFillCallback : SDL_BufferQueueDrainCallback;
         device->spec.userdata = device;
+        device->queue_position_counter = SDL_GetPerformanceCounter();
     }
 
     /* Allocate a scratch audio buffer */
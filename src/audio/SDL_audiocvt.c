@@ -29,6 +29,9 @@
 #include "SDL_assert.h"
 #include "../SDL_dataqueue.h"
 #include "SDL_cpuinfo.h"
+#include "SDL_atomic.h"
+#include "SDL_hints.h"
+#include "SDL_thread.h"
 
 #ifdef __SSE3__
 #define HAVE_SSE3_INTRINSICS 1
@@ -696,6 +699,9 @@ SDL_BuildAudioCVT(SDL_AudioCVT * cvt,
     /* Make sure we zero out the audio conversion before error checking */
     SDL_zerop(cvt);
 
+    /* SDL_AudioCVT and SDL_AudioStream work without SDL_Init(SDL_INIT_AUDIO). */
+    SDL_ChooseAudioConverters();
+
     /* there are no unsigned types over 16 bits, so catch this up front. */
     if ((SDL_AUDIO_BITSIZE(src_fmt) > 16) && (!SDL_AUDIO_ISSIGNED(src_fmt))) {
         return SDL_SetError("Invalid source format");
@@ -865,7 +871,7 @@ typedef int (*SDL_ResampleAudioStreamFunc)(SDL_AudioStream *stream, const void *
 typedef void (*SDL_ResetAudioStreamResamplerFunc)(SDL_AudioStream *stream);
 typedef void (*SDL_CleanupAudioStreamResamplerFunc)(SDL_AudioStream *stream);
 
-struct SDL_AudioStream
+struct _SDL_AudioStream
 {
     SDL_AudioCVT cvt_before_resampling;
     SDL_AudioCVT cvt_after_resampling;
@@ -903,15 +909,54 @@ EnsureStreamBufferSize(SDL_AudioStream *stream, const int newlen)
             SDL_OutOfMemory();
             return NULL;
         }
-        /* Make sure we're aligned to 16 bytes for SIMD code. */
         stream->work_buffer_base = ptr;
         stream->work_buffer_len = newlen;
     }
 
+    /* Make sure we're aligned to 16 bytes for SIMD code. */
     offset = ((size_t) ptr) & 15;
     return offset ? ptr + (16 - offset) : ptr;
 }
 
+#ifdef HAVE_LIBSAMPLERATE_H
+static int SDL_ResampleAudioStream_SRC(SDL_AudioStream *stream, const void *_inbuf, const int inbuflen, void *_outbuf, const int outbuflen);
+#endif
+
+/* Worst case work buffer size for a SDL_AudioStreamPut() of (buflen) bytes.
+   The work buffer must not be reallocated halfway through a conversion:
+   a realloc() can move the block to a different alignment, which would
+   shift data that one stage already left in the buffer for the next. */
+static int
+GetStreamWorkBufferSize(const SDL_AudioStream *stream, const int buflen)
+{
+    int len = buflen;
+    int maxlen = buflen;
+
+    if (stream->cvt_before_resampling.needed) {
+        len *= stream->cvt_before_resampling.len_mult;
+        maxlen = SDL_max(maxlen, len);
+    }
+
+    if (stream->dst_rate != stream->src_rate) {
+        const int resampledlen = len * ((int) SDL_ceil(stream->rate_incr));
+#ifdef HAVE_LIBSAMPLERATE_H
+        if (stream->resampler_func == SDL_ResampleAudioStream_SRC) {
+            /* libsamplerate can't work in-place, so it needs room for both. */
+            maxlen = SDL_max(maxlen, len + resampledlen);
+        }
+#endif
+        len = resampledlen;
+        maxlen = SDL_max(maxlen, len);
+    }
+
+    if (stream->cvt_after_resampling.needed) {
+        len *= stream->cvt_after_resampling.len_mult;
+        maxlen = SDL_max(maxlen, len);
+    }
+
+    return maxlen;
+}
+
 #ifdef HAVE_LIBSAMPLERATE_H
 static int
 SDL_ResampleAudioStream_SRC(SDL_AudioStream *stream, const void *_inbuf, const int inbuflen, void *_outbuf, const int outbuflen)
@@ -1184,6 +1229,11 @@ SDL_AudioStreamPut(SDL_AudioStream *stream, const void *buf, const Uint32 _bufle
         return SDL_SetError("Can't add partial sample frames");
     }
 
+    /* Grow the work buffer once, up front; every stage below reuses it. */
+    if (EnsureStreamBufferSize(stream, GetStreamWorkBufferSize(stream, buflen)) == NULL) {
+        return -1;  /* probably out of memory. */
+    }
+
     if (stream->cvt_before_resampling.needed) {
         const int workbuflen = buflen * stream->cvt_before_resampling.len_mult;  /* will be "* 1" if not needed */
         Uint8 *workbuf = EnsureStreamBufferSize(stream, workbuflen);
@@ -1238,6 +1288,93 @@ SDL_AudioStreamPut(SDL_AudioStream *stream, const void *buf, const Uint32 _bufle
     return SDL_WriteToDataQueue(stream->queue, buf, buflen);
 }
 
+typedef struct
+{
+    SDL_AudioStream **streams;
+    const void **bufs;
+    const Uint32 *lens;
+    int num_streams;
+    SDL_atomic_t next;
+    SDL_atomic_t failed;
+    char error[256];
+} SDL_AudioStreamBatch;
+
+static int SDLCALL
+SDL_AudioStreamBatchWorker(void *data)
+{
+    SDL_AudioStreamBatch *batch = (SDL_AudioStreamBatch *) data;
+    int i;
+
+    while ((i = SDL_AtomicAdd(&batch->next, 1)) < batch->num_streams) {
+        if (SDL_AudioStreamPut(batch->streams[i], batch->bufs[i], batch->lens[i]) < 0) {
+            /* error strings are per-thread; keep the first one for the caller. */
+            if (SDL_AtomicCAS(&batch->failed, -1, i)) {
+                SDL_strlcpy(batch->error, SDL_GetError(), sizeof (batch->error));
+            }
+        }
+    }
+
+    return 0;
+}
+
+int
+SDL_AudioStreamPutBatch(SDL_AudioStream **streams, const void **bufs, const Uint32 *lens, const int num_streams)
+{
+    SDL_Thread *threads[64];
+    SDL_AudioStreamBatch batch;
+    const char *hint;
+    int num_threads = 0;
+    int i;
+
+    if (!streams) {
+        return SDL_InvalidParamError("streams");
+    } else if (!bufs) {
+        return SDL_InvalidParamError("bufs");
+    } else if (!lens) {
+        return SDL_InvalidParamError("lens");
+    } else if (num_streams <= 0) {
+        return 0;  /* nothing to do. */
+    }
+
+    hint = SDL_GetHint(SDL_HINT_AUDIO_STREAM_BATCH_THREADS);
+    if (hint) {
+        num_threads = SDL_atoi(hint);
+    }
+    if (num_threads <= 0) {
+        num_threads = SDL_GetCPUCount();
+    }
+    num_threads = SDL_min(num_threads, num_streams);
+    num_threads = SDL_min(num_threads, (int) SDL_arraysize(threads) + 1);
+
+    SDL_zero(batch);
+    batch.streams = streams;
+    batch.bufs = bufs;
+    batch.lens = lens;
+    batch.num_streams = num_streams;
+    SDL_AtomicSet(&batch.next, 0);
+    SDL_AtomicSet(&batch.failed, -1);
+
+    /* the calling thread is one of the workers, so start one less. */
+    for (i = 0; i < num_threads - 1; i++) {
+        threads[i] = SDL_CreateThread(SDL_AudioStreamBatchWorker, "SDLAudioStreamBatch", &batch);
+        if (!threads[i]) {
+            break;  /* run with what we have; the remaining work still gets done. */
+        }
+    }
+    num_threads = i;
+
+    SDL_AudioStreamBatchWorker(&batch);
+
+    for (i = 0; i < num_threads; i++) {
+        SDL_WaitThread(threads[i], NULL);
+    }
+
+    if (SDL_AtomicGet(&batch.failed) != -1) {
+        return SDL_SetError("%s", batch.error);
+    }
+    return 0;
+}
+
 void
 SDL_AudioStreamClear(SDL_AudioStream *stream)
 {
@@ -24,6 +24,7 @@
 #include "SDL_audio_c.h"
 #include "SDL_cpuinfo.h"
 #include "SDL_assert.h"
+#include "SDL_atomic.h"
 
 /* !!! FIXME: write NEON code. */
 #define HAVE_NEON_INTRINSICS 0
@@ -744,11 +745,20 @@ SDL_Convert_F32_to_S32_SSE2(SDL_AudioCVT *cvt, SDL_AudioFormat format)
 #endif
 
 
+/* Streams and SDL_BuildAudioCVT() can be used from any thread without
+   SDL_Init(SDL_INIT_AUDIO), so the converters are chosen once, under a lock. */
 void SDL_ChooseAudioConverters(void)
 {
-    static SDL_bool converters_chosen = SDL_FALSE;
+    static SDL_atomic_t converters_chosen;
+    static SDL_SpinLock lock = 0;
 
-    if (converters_chosen) {
+    if (SDL_AtomicGet(&converters_chosen)) {
+        return;
+    }
+
+    SDL_AtomicLock(&lock);
+    if (SDL_AtomicGet(&converters_chosen)) {
+        SDL_AtomicUnlock(&lock);
         return;
     }
 
@@ -762,23 +772,27 @@ void SDL_ChooseAudioConverters(void)
         SDL_Convert_F32_to_U8 = SDL_Convert_F32_to_U8_##fntype; \
         SDL_Convert_F32_to_S16 = SDL_Convert_F32_to_S16_##fntype; \
         SDL_Convert_F32_to_U16 = SDL_Convert_F32_to_U16_##fntype; \
-        SDL_Convert_F32_to_S32 = SDL_Convert_F32_to_S32_##fntype; \
-        converters_chosen = SDL_TRUE
+        SDL_Convert_F32_to_S32 = SDL_Convert_F32_to_S32_##fntype
 
     #if HAVE_SSE2_INTRINSICS
     if (SDL_HasSSE2()) {
         SET_CONVERTER_FUNCS(SSE2);
-        return;
-    }
+    } else
     #endif
-
+    {
     #if NEED_SCALAR_CONVERTER_FALLBACKS
-    SET_CONVERTER_FUNCS(Scalar);
+        SET_CONVERTER_FUNCS(Scalar);
     #endif
+    }
 
     #undef SET_CONVERTER_FUNCS
 
-    SDL_assert(converters_chosen == SDL_TRUE);
+    SDL_assert(SDL_Convert_S8_to_F32 != NULL);
+
+    /* Make the pointers visible before the flag saying they're set. */
+    SDL_MemoryBarrierRelease();
+    SDL_AtomicSet(&converters_chosen, 1);
+    SDL_AtomicUnlock(&lock);
 }
 
 /* vi: set ts=4 sw=4 expandtab: */
@@ -51,6 +51,12 @@ extern void SDL_RemoveAudioDevice(const int iscapture, void *handle);
    as appropriate so SDL's list of devices is accurate. */
 extern void SDL_OpenedAudioDeviceDisconnected(SDL_AudioDevice *device);
 
+/* Audio targets without a real clock to block on (file writers, timers, etc)
+   can call this from WaitDevice() to sleep until another (frames) sample
+   frames would have played. Deadlines are absolute, measured against the
+   performance counter, so rounding never accumulates into drift. */
+extern void SDL_AudioPaceFrames(SDL_AudioDevice *device, const int frames);
+
 /* This is the size of a packet when using SDL_QueueAudio(). We allocate
    these as necessary and pool them, under the assumption that we'll
    eventually end up with a handful that keep recycling, meeting whatever
@@ -69,6 +75,7 @@ typedef struct SDL_AudioDriverImpl
     void (*ThreadInit) (_THIS); /* Called by audio thread at start */
     void (*ThreadDeinit) (_THIS); /* Called by audio thread at end */
     void (*WaitDevice) (_THIS);
+    int (*WaitDeviceTimeout) (_THIS, int timeoutMS);  /**< Block until a buffer can be played/captured: 1 if ready, 0 on timeout, -1 if unsupported */
     void (*PlayDevice) (_THIS);
     int (*GetPendingBytes) (_THIS);
     Uint8 *(*GetDeviceBuf) (_THIS);
@@ -94,6 +101,15 @@ typedef struct SDL_AudioDriverImpl
 } SDL_AudioDriverImpl;
 
 
+/* A buffer queued with SDL_QueueAudioAtFrame() starts (offset) bytes into
+   the queue's lifetime and must begin playing on sample frame (frame). */
+typedef struct SDL_AudioQueueMark
+{
+    Uint64 offset;
+    Uint64 frame;
+    struct SDL_AudioQueueMark *next;
+} SDL_AudioQueueMark;
+
 typedef struct SDL_AudioDeviceItem
 {
     void *handle;
@@ -147,6 +163,10 @@ struct SDL_AudioDevice
     SDL_atomic_t paused;
     SDL_bool iscapture;
 
+    /* Sample frames between the device and the speaker or microphone, as
+       reported by the driver; 0 if it doesn't know. */
+    SDL_atomic_t latency_frames;
+
     /* Scratch buffer used in the bridge between SDL and the user callback. */
     Uint8 *work_buffer;
 
@@ -163,6 +183,22 @@ struct SDL_AudioDevice
     /* Queued buffers (if app not using callback). */
     SDL_DataQueue *buffer_queue;
 
+    /* Scheduled start points in buffer_queue, oldest first. */
+    SDL_AudioQueueMark *queue_marks;
+    SDL_AudioQueueMark *queue_marks_tail;
+
+    /* Bytes ever written to/read from buffer_queue, to locate queue_marks. */
+    Uint64 queue_bytes_written;
+    Uint64 queue_bytes_read;
+
+    /* Sample frames the queue has fed the device, and when it last did. */
+    Uint64 queue_frame_position;
+    Uint64 queue_position_counter;
+
+    /* Clock for SDL_AudioPaceFrames(): frames paced since pace_start. */
+    Uint64 pace_start;
+    Uint64 pace_frames;
+
     /* * * */
     /* Data private to this driver */
     struct SDL_PrivateAudioData *hidden;
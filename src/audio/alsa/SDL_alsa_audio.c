@@ -247,6 +247,14 @@ ALSA_WaitDevice(_THIS)
     /* We're in blocking mode, so there's nothing to do here */
 }
 
+/* Poll the PCM's descriptors until a period can be played/captured. */
+static int
+ALSA_WaitDeviceTimeout(_THIS, int timeoutMS)
+{
+    const int status = ALSA_snd_pcm_wait(this->hidden->pcm_handle, timeoutMS);
+    return (status < 0) ? -1 : status;  /* 1 when ready, 0 on timeout. */
+}
+
 
 /* !!! FIXME: is there a channel swizzler in alsalib instead? */
 /*
@@ -1022,6 +1030,7 @@ ALSA_Init(SDL_AudioDriverImpl * impl)
     impl->DetectDevices = ALSA_DetectDevices;
     impl->OpenDevice = ALSA_OpenDevice;
     impl->WaitDevice = ALSA_WaitDevice;
+    impl->WaitDeviceTimeout = ALSA_WaitDeviceTimeout;
     impl->GetDeviceBuf = ALSA_GetDeviceBuf;
     impl->PlayDevice = ALSA_PlayDevice;
     impl->CloseDevice = ALSA_CloseDevice;
@@ -47,7 +47,11 @@
 static void
 DISKAUDIO_WaitDevice(_THIS)
 {
-    SDL_Delay(this->hidden->io_delay);
+    if (this->hidden->paced) {
+        SDL_AudioPaceFrames(this, this->spec.samples);
+    } else {
+        SDL_Delay(this->hidden->io_delay);
+    }
 }
 
 static void
@@ -78,7 +82,11 @@ DISKAUDIO_CaptureFromDevice(_THIS, void *buffer, int buflen)
     struct SDL_PrivateAudioData *h = this->hidden;
     const int origbuflen = buflen;
 
-    SDL_Delay(h->io_delay);
+    if (h->paced) {
+        SDL_AudioPaceFrames(this, this->spec.samples);
+    } else {
+        SDL_Delay(h->io_delay);
+    }
 
     if (h->io) {
         const size_t br = SDL_RWread(h->io, buffer, 1, buflen);
@@ -140,10 +148,11 @@ DISKAUDIO_OpenDevice(_THIS, void *handle, const char *devname, int iscapture)
     }
     SDL_zerop(this->hidden);
 
+    /* without an explicit delay, run in real time at the device's rate. */
     if (envr != NULL) {
         this->hidden->io_delay = SDL_atoi(envr);
     } else {
-        this->hidden->io_delay = ((this->spec.samples * 1000) / this->spec.freq);
+        this->hidden->paced = SDL_TRUE;
     }
 
     /* Open the audio device */
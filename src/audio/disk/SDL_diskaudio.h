@@ -34,6 +34,7 @@ struct SDL_PrivateAudioData
     /* The file descriptor for the audio device */
     SDL_RWops *io;
     Uint32 io_delay;
+    SDL_bool paced;
     Uint8 *mixbuf;
 };
 
@@ -37,7 +37,7 @@ static int
 DUMMYAUDIO_CaptureFromDevice(_THIS, void *buffer, int buflen)
 {
     /* Delay to make this sort of simulate real audio input. */
-    SDL_Delay((this->spec.samples * 1000) / this->spec.freq);
+    SDL_AudioPaceFrames(this, this->spec.samples);
 
     /* always return a full buffer of silence. */
     SDL_memset(buffer, this->spec.silence, buflen);
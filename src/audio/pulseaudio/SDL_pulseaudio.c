@@ -42,6 +42,8 @@
 
 #include "SDL_timer.h"
 #include "SDL_audio.h"
+#include "SDL_hints.h"
+#include "SDL_log.h"
 #include "../SDL_audio_c.h"
 #include "SDL_pulseaudio.h"
 #include "SDL_loadso.h"
@@ -72,6 +74,9 @@ static const char * (*PULSEAUDIO_pa_strerror) (int);
 static pa_mainloop * (*PULSEAUDIO_pa_mainloop_new) (void);
 static pa_mainloop_api * (*PULSEAUDIO_pa_mainloop_get_api) (pa_mainloop *);
 static int (*PULSEAUDIO_pa_mainloop_iterate) (pa_mainloop *, int, int *);
+static int (*PULSEAUDIO_pa_mainloop_prepare) (pa_mainloop *, int);
+static int (*PULSEAUDIO_pa_mainloop_poll) (pa_mainloop *);
+static int (*PULSEAUDIO_pa_mainloop_dispatch) (pa_mainloop *);
 static int (*PULSEAUDIO_pa_mainloop_run) (pa_mainloop *, int *);
 static void (*PULSEAUDIO_pa_mainloop_quit) (pa_mainloop *, int);
 static void (*PULSEAUDIO_pa_mainloop_free) (pa_mainloop *);
@@ -106,6 +111,10 @@ static size_t (*PULSEAUDIO_pa_stream_writable_size) (pa_stream *);
 static size_t (*PULSEAUDIO_pa_stream_readable_size) (pa_stream *);
 static int (*PULSEAUDIO_pa_stream_write) (pa_stream *, const void *, size_t,
     pa_free_cb_t, int64_t, pa_seek_mode_t);
+static int (*PULSEAUDIO_pa_stream_begin_write) (pa_stream *, void **, size_t *);
+static int (*PULSEAUDIO_pa_stream_cancel_write) (pa_stream *);
+static int (*PULSEAUDIO_pa_stream_get_latency) (pa_stream *, pa_usec_t *, int *);
+static const pa_buffer_attr * (*PULSEAUDIO_pa_stream_get_buffer_attr) (pa_stream *);
 static pa_operation * (*PULSEAUDIO_pa_stream_drain) (pa_stream *,
     pa_stream_success_cb_t, void *);
 static int (*PULSEAUDIO_pa_stream_peek) (pa_stream *, const void **, size_t *);
@@ -193,6 +202,9 @@ load_pulseaudio_syms(void)
     SDL_PULSEAUDIO_SYM(pa_mainloop_new);
     SDL_PULSEAUDIO_SYM(pa_mainloop_get_api);
     SDL_PULSEAUDIO_SYM(pa_mainloop_iterate);
+    SDL_PULSEAUDIO_SYM(pa_mainloop_prepare);
+    SDL_PULSEAUDIO_SYM(pa_mainloop_poll);
+    SDL_PULSEAUDIO_SYM(pa_mainloop_dispatch);
     SDL_PULSEAUDIO_SYM(pa_mainloop_run);
     SDL_PULSEAUDIO_SYM(pa_mainloop_quit);
     SDL_PULSEAUDIO_SYM(pa_mainloop_free);
@@ -217,6 +229,10 @@ load_pulseaudio_syms(void)
     SDL_PULSEAUDIO_SYM(pa_stream_writable_size);
     SDL_PULSEAUDIO_SYM(pa_stream_readable_size);
     SDL_PULSEAUDIO_SYM(pa_stream_write);
+    SDL_PULSEAUDIO_SYM(pa_stream_begin_write);
+    SDL_PULSEAUDIO_SYM(pa_stream_cancel_write);
+    SDL_PULSEAUDIO_SYM(pa_stream_get_latency);
+    SDL_PULSEAUDIO_SYM(pa_stream_get_buffer_attr);
     SDL_PULSEAUDIO_SYM(pa_stream_drain);
     SDL_PULSEAUDIO_SYM(pa_stream_disconnect);
     SDL_PULSEAUDIO_SYM(pa_stream_peek);
@@ -337,6 +353,34 @@ ConnectToPulseServer(pa_mainloop **_mainloop, pa_context **_context)
 }
 
 
+static int
+BytesToMilliseconds(_THIS, const Uint32 bytes)
+{
+    const Uint32 framesize = (SDL_AUDIO_BITSIZE(this->spec.format) / 8) * this->spec.channels;
+    return (int) ((((Uint64) bytes) * 1000) / (((Uint64) framesize) * this->spec.freq));
+}
+
+/* Log the latency the server is actually giving us, about once a second. */
+static void
+ReportLatency(_THIS)
+{
+    struct SDL_PrivateAudioData *h = this->hidden;
+    const Uint32 now = SDL_GetTicks();
+    pa_usec_t usec = 0;
+    int negative = 0;
+
+    if (!SDL_TICKS_PASSED(now, h->latency_report_ticks)) {
+        return;
+    }
+    h->latency_report_ticks = now + 1000;
+
+    if (PULSEAUDIO_pa_stream_get_latency(h->stream, &usec, &negative) == 0) {
+        SDL_LogDebug(SDL_LOG_CATEGORY_AUDIO, "PulseAudio: playback latency is %s%d ms",
+                     negative ? "-" : "", (int) (usec / 1000));
+        SDL_AtomicSet(&this->latency_frames, negative ? 0 : (int) ((usec * this->spec.freq) / 1000000));
+    }
+}
+
 /* This function waits until it is possible to write a full sound buffer */
 static void
 PULSEAUDIO_WaitDevice(_THIS)
@@ -351,27 +395,81 @@ PULSEAUDIO_WaitDevice(_THIS)
             return;
         }
         if (PULSEAUDIO_pa_stream_writable_size(h->stream) >= h->mixlen) {
+            ReportLatency(this);
             return;
         }
     }
 }
 
+/* Like WaitDevice, but for SDL_AudioPaceFrames(): gives up after timeoutMS. */
+static int
+PULSEAUDIO_WaitDeviceTimeout(_THIS, int timeoutMS)
+{
+    struct SDL_PrivateAudioData *h = this->hidden;
+    const Uint32 end = SDL_GetTicks() + (Uint32) timeoutMS;
+
+    for (;;) {
+        const size_t avail = this->iscapture ?
+                                PULSEAUDIO_pa_stream_readable_size(h->stream) :
+                                PULSEAUDIO_pa_stream_writable_size(h->stream);
+        const Uint32 now = SDL_GetTicks();
+
+        if (avail == (size_t) -1) {
+            return -1;
+        } else if (avail >= h->mixlen) {
+            return 1;
+        } else if (SDL_TICKS_PASSED(now, end)) {
+            return 0;
+        }
+
+        if (PULSEAUDIO_pa_mainloop_prepare(h->mainloop, (int) ((end - now) * 1000)) < 0 ||
+            PULSEAUDIO_pa_mainloop_poll(h->mainloop) < 0 ||
+            PULSEAUDIO_pa_mainloop_dispatch(h->mainloop) < 0) {
+            return -1;
+        }
+    }
+}
+
 static void
 PULSEAUDIO_PlayDevice(_THIS)
 {
     /* Write the audio data */
     struct SDL_PrivateAudioData *h = this->hidden;
-    if (SDL_AtomicGet(&this->enabled)) {
-        if (PULSEAUDIO_pa_stream_write(h->stream, h->mixbuf, h->mixlen, NULL, 0LL, PA_SEEK_RELATIVE) < 0) {
-            SDL_OpenedAudioDeviceDisconnected(this);
+    Uint8 *buf = h->writebuf ? h->writebuf : h->mixbuf;
+
+    h->writebuf = NULL;
+
+    if (!SDL_AtomicGet(&this->enabled)) {
+        if (buf != h->mixbuf) {
+            PULSEAUDIO_pa_stream_cancel_write(h->stream);
         }
+    } else if (PULSEAUDIO_pa_stream_write(h->stream, buf, h->mixlen, NULL, 0LL, PA_SEEK_RELATIVE) < 0) {
+        /* (buf) came from pa_stream_begin_write(), this write is zero-copy. */
+        SDL_OpenedAudioDeviceDisconnected(this);
     }
 }
 
 static Uint8 *
 PULSEAUDIO_GetDeviceBuf(_THIS)
 {
-    return (this->hidden->mixbuf);
+    struct SDL_PrivateAudioData *h = this->hidden;
+
+    /* Try to render straight into the server's memory block, so
+       pa_stream_write() doesn't have to copy our mix buffer. Pulse may hand
+       back a smaller block than we asked for; then we use our own buffer. */
+    if (h->zerocopy && (h->writebuf == NULL)) {
+        void *data = NULL;
+        size_t nbytes = (size_t) h->mixlen;
+        if (PULSEAUDIO_pa_stream_begin_write(h->stream, &data, &nbytes) == 0) {
+            if ((data != NULL) && (nbytes >= (size_t) h->mixlen)) {
+                h->writebuf = (Uint8 *) data;
+            } else {
+                PULSEAUDIO_pa_stream_cancel_write(h->stream);
+            }
+        }
+    }
+
+    return h->writebuf ? h->writebuf : h->mixbuf;
 }
 
 
@@ -444,6 +542,9 @@ PULSEAUDIO_CloseDevice(_THIS)
         if (this->hidden->capturebuf != NULL) {
             PULSEAUDIO_pa_stream_drop(this->hidden->stream);
         }
+        if (this->hidden->writebuf != NULL) {
+            PULSEAUDIO_pa_stream_cancel_write(this->hidden->stream);
+        }
         PULSEAUDIO_pa_stream_disconnect(this->hidden->stream);
         PULSEAUDIO_pa_stream_unref(this->hidden->stream);
     }
@@ -503,6 +604,11 @@ PULSEAUDIO_OpenDevice(_THIS, void *handle, const char *devname, int iscapture)
     pa_buffer_attr paattr;
     pa_channel_map pacmap;
     pa_stream_flags_t flags = 0;
+    const pa_buffer_attr *actual_attr = NULL;
+    const char *hint = NULL;
+    Uint32 framesize = 0;
+    Uint32 target = 0;
+    int latency_ms = 0;
     int state = 0;
     int rc = 0;
 
@@ -564,8 +670,8 @@ PULSEAUDIO_OpenDevice(_THIS, void *handle, const char *devname, int iscapture)
     SDL_CalculateAudioSpec(&this->spec);
 
     /* Allocate mixing buffer */
+    h->mixlen = this->spec.size;
     if (!iscapture) {
-        h->mixlen = this->spec.size;
         h->mixbuf = (Uint8 *) SDL_malloc(h->mixlen);
         if (h->mixbuf == NULL) {
             return SDL_OutOfMemory();
@@ -576,20 +682,35 @@ PULSEAUDIO_OpenDevice(_THIS, void *handle, const char *devname, int iscapture)
     paspec.channels = this->spec.channels;
     paspec.rate = this->spec.freq;
 
+    framesize = (SDL_AUDIO_BITSIZE(this->spec.format) / 8) * this->spec.channels;
+    hint = SDL_GetHint(SDL_HINT_PULSEAUDIO_TARGET_LATENCY);
+    if (hint) {
+        latency_ms = SDL_atoi(hint);
+    }
+
+    /* never ask for less than one mix buffer, or we'd underrun constantly. */
+    if (latency_ms > 0) {
+        target = (Uint32) ((((Uint64) latency_ms) * this->spec.freq) / 1000) * framesize;
+        target = SDL_max(target, (Uint32) h->mixlen);
+    }
+
     /* Reduced prebuffering compared to the defaults. */
 #ifdef PA_STREAM_ADJUST_LATENCY
-    /* 2x original requested bufsize */
-    paattr.tlength = h->mixlen * 4;
+    /* 2x original requested bufsize, unless a latency was asked for */
+    paattr.tlength = target ? target : h->mixlen * 4;
     paattr.prebuf = -1;
     paattr.maxlength = -1;
     /* -1 can lead to pa_stream_writable_size() >= mixlen never being true */
     paattr.minreq = h->mixlen;
+    /* capture hands us one mix buffer at a time */
+    paattr.fragsize = iscapture ? h->mixlen : -1;
     flags = PA_STREAM_ADJUST_LATENCY;
 #else
-    paattr.tlength = h->mixlen*2;
-    paattr.prebuf = h->mixlen*2;
-    paattr.maxlength = h->mixlen*2;
+    paattr.tlength = target ? target : h->mixlen*2;
+    paattr.prebuf = paattr.tlength;
+    paattr.maxlength = paattr.tlength;
     paattr.minreq = h->mixlen;
+    paattr.fragsize = iscapture ? h->mixlen : -1;
 #endif
 
     if (ConnectToPulseServer(&h->mainloop, &h->context) < 0) {
@@ -622,6 +743,9 @@ PULSEAUDIO_OpenDevice(_THIS, void *handle, const char *devname, int iscapture)
         flags |= PA_STREAM_DONT_MOVE;
     }
 
+    /* keep timing info current, so pa_stream_get_latency() doesn't block. */
+    flags |= PA_STREAM_INTERPOLATE_TIMING | PA_STREAM_AUTO_TIMING_UPDATE;
+
     if (iscapture) {
         rc = PULSEAUDIO_pa_stream_connect_record(h->stream, h->device_name, &paattr, flags);
     } else {
@@ -642,6 +766,23 @@ PULSEAUDIO_OpenDevice(_THIS, void *handle, const char *devname, int iscapture)
         }
     } while (state != PA_STREAM_READY);
 
+    /* The server is free to change what we asked for; report what we got. */
+    actual_attr = PULSEAUDIO_pa_stream_get_buffer_attr(h->stream);
+    if (actual_attr) {
+        SDL_LogDebug(SDL_LOG_CATEGORY_AUDIO,
+                     "PulseAudio: requested %d ms buffer, server granted tlength=%d ms, minreq=%d ms, prebuf=%d ms",
+                     BytesToMilliseconds(this, paattr.tlength),
+                     BytesToMilliseconds(this, actual_attr->tlength),
+                     BytesToMilliseconds(this, actual_attr->minreq),
+                     BytesToMilliseconds(this, actual_attr->prebuf));
+        SDL_AtomicSet(&this->latency_frames,
+                      (int) ((iscapture ? actual_attr->fragsize : actual_attr->tlength) / framesize));
+    }
+
+    if (!iscapture) {
+        h->zerocopy = SDL_GetHintBoolean(SDL_HINT_PULSEAUDIO_ZERO_COPY, SDL_TRUE);
+    }
+
     /* We're ready to rock and roll. :-) */
     return 0;
 }
@@ -752,6 +893,7 @@ PULSEAUDIO_Init(SDL_AudioDriverImpl * impl)
     impl->OpenDevice = PULSEAUDIO_OpenDevice;
     impl->PlayDevice = PULSEAUDIO_PlayDevice;
     impl->WaitDevice = PULSEAUDIO_WaitDevice;
+    impl->WaitDeviceTimeout = PULSEAUDIO_WaitDeviceTimeout;
     impl->GetDeviceBuf = PULSEAUDIO_GetDeviceBuf;
     impl->CloseDevice = PULSEAUDIO_CloseDevice;
     impl->Deinitialize = PULSEAUDIO_Deinitialize;
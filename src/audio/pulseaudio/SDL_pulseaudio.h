@@ -43,6 +43,13 @@ struct SDL_PrivateAudioData
     Uint8 *mixbuf;
     int mixlen;
 
+    /* Server memory from pa_stream_begin_write(), if zero-copy is on */
+    SDL_bool zerocopy;
+    Uint8 *writebuf;
+
+    /* When to log the server's latency next */
+    Uint32 latency_report_ticks;
+
     const Uint8 *capturebuf;
     int capturelen;
 };
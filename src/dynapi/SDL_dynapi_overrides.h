@@ -624,3 +624,21 @@
 #define SDL_MemoryBarrierReleaseFunction SDL_MemoryBarrierReleaseFunction_REAL
 #define SDL_MemoryBarrierAcquireFunction SDL_MemoryBarrierAcquireFunction_REAL
 #define SDL_JoystickGetDeviceInstanceID SDL_JoystickGetDeviceInstanceID_REAL
+#define SDL_NewAudioStream SDL_NewAudioStream_REAL
+#define SDL_AudioStreamPut SDL_AudioStreamPut_REAL
+#define SDL_AudioStreamPutBatch SDL_AudioStreamPutBatch_REAL
+#define SDL_AudioStreamGet SDL_AudioStreamGet_REAL
+#define SDL_AudioStreamAvailable SDL_AudioStreamAvailable_REAL
+#define SDL_AudioStreamClear SDL_AudioStreamClear_REAL
+#define SDL_FreeAudioStream SDL_FreeAudioStream_REAL
+#define SDL_QueueAudioAtFrame SDL_QueueAudioAtFrame_REAL
+#define SDL_QueueAudioAtCounter SDL_QueueAudioAtCounter_REAL
+#define SDL_GetQueuedAudioFramePosition SDL_GetQueuedAudioFramePosition_REAL
+#define SDL_SoftStretchLinear SDL_SoftStretchLinear_REAL
+#define SDL_SetYUVConversionMode SDL_SetYUVConversionMode_REAL
+#define SDL_GetYUVConversionMode SDL_GetYUVConversionMode_REAL
+#define SDL_GetYUVConversionModeForResolution SDL_GetYUVConversionModeForResolution_REAL
+#define SDL_LoadBMPWithFormat_RW SDL_LoadBMPWithFormat_RW_REAL
+#define SDL_SetWindowPresentCallback SDL_SetWindowPresentCallback_REAL
+#define SDL_UpdateWindowShape SDL_UpdateWindowShape_REAL
+#define SDL_GetAudioDeviceLatency SDL_GetAudioDeviceLatency_REAL
@@ -656,3 +656,21 @@ SDL_DYNAPI_PROC(SDL_JoystickType,SDL_JoystickGetType,(SDL_Joystick *a),(a),retur
 SDL_DYNAPI_PROC(void,SDL_MemoryBarrierReleaseFunction,(void),(),)
 SDL_DYNAPI_PROC(void,SDL_MemoryBarrierAcquireFunction,(void),(),)
 SDL_DYNAPI_PROC(SDL_JoystickID,SDL_JoystickGetDeviceInstanceID,(int a),(a),return)
+SDL_DYNAPI_PROC(SDL_AudioStream*,SDL_NewAudioStream,(const SDL_AudioFormat a, const Uint8 b, const int c, const SDL_AudioFormat d, const Uint8 e, const int f),(a,b,c,d,e,f),return)
+SDL_DYNAPI_PROC(int,SDL_AudioStreamPut,(SDL_AudioStream *a, const void *b, const Uint32 c),(a,b,c),return)
+SDL_DYNAPI_PROC(int,SDL_AudioStreamPutBatch,(SDL_AudioStream **a, const void **b, const Uint32 *c, const int d),(a,b,c,d),return)
+SDL_DYNAPI_PROC(int,SDL_AudioStreamGet,(SDL_AudioStream *a, void *b, const Uint32 c),(a,b,c),return)
+SDL_DYNAPI_PROC(int,SDL_AudioStreamAvailable,(SDL_AudioStream *a),(a),return)
+SDL_DYNAPI_PROC(void,SDL_AudioStreamClear,(SDL_AudioStream *a),(a),)
+SDL_DYNAPI_PROC(void,SDL_FreeAudioStream,(SDL_AudioStream *a),(a),)
+SDL_DYNAPI_PROC(int,SDL_QueueAudioAtFrame,(SDL_AudioDeviceID a, const void *b, Uint32 c, Uint64 d),(a,b,c,d),return)
+SDL_DYNAPI_PROC(int,SDL_QueueAudioAtCounter,(SDL_AudioDeviceID a, const void *b, Uint32 c, Uint64 d),(a,b,c,d),return)
+SDL_DYNAPI_PROC(Uint64,SDL_GetQueuedAudioFramePosition,(SDL_AudioDeviceID a, Uint64 *b),(a,b),return)
+SDL_DYNAPI_PROC(int,SDL_SoftStretchLinear,(SDL_Surface *a, const SDL_Rect *b, SDL_Surface *c, const SDL_Rect *d),(a,b,c,d),return)
+SDL_DYNAPI_PROC(void,SDL_SetYUVConversionMode,(SDL_YUV_CONVERSION_MODE a),(a),)
+SDL_DYNAPI_PROC(SDL_YUV_CONVERSION_MODE,SDL_GetYUVConversionMode,(void),(),return)
+SDL_DYNAPI_PROC(SDL_YUV_CONVERSION_MODE,SDL_GetYUVConversionModeForResolution,(int a, int b),(a,b),return)
+SDL_DYNAPI_PROC(SDL_Surface*,SDL_LoadBMPWithFormat_RW,(SDL_RWops *a, int b, Uint32 c),(a,b,c),return)
+SDL_DYNAPI_PROC(int,SDL_SetWindowPresentCallback,(SDL_Window *a, SDL_PresentCallback b, void *c),(a,b,c),return)
+SDL_DYNAPI_PROC(int,SDL_UpdateWindowShape,(SDL_Window *a, SDL_Surface *b, const SDL_Rect *c),(a,b,c),return)
+SDL_DYNAPI_PROC(Uint32,SDL_GetAudioDeviceLatency,(SDL_AudioDeviceID a),(a),return)
@@ -187,6 +187,9 @@ SDL_SendWindowEvent(SDL_Window * window, Uint8 windowevent, int data1,
         window->flags &= ~SDL_WINDOW_INPUT_FOCUS;
         SDL_OnWindowFocusLost(window);
         break;
+    case SDL_WINDOWEVENT_EXPOSED:
+        SDL_OnWindowExposed(window);
+        break;
     }
 
     /* Post the event, if desired */
@@ -33,6 +33,14 @@
 
 #include "SDL_endian.h"
 #include "SDL_rwops.h"
+#include "SDL_rwops_c.h"
+
+#if defined(HAVE_STDIO_H) && defined(HAVE_MMAP)
+#include <sys/types.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
 
 #ifdef __APPLE__
 #include "cocoa/SDL_rwopsbundlesupport.h"
@@ -653,6 +661,75 @@ SDL_FreeRW(SDL_RWops * area)
     SDL_free(area);
 }
 
+const void *
+SDL_RWmap(SDL_RWops * context, Sint64 offset, size_t size, SDL_RWmapping * mapping)
+{
+    mapping->base = NULL;
+    mapping->length = 0;
+
+    if (!context || offset < 0) {
+        return NULL;
+    }
+
+    switch (context->type) {
+    case SDL_RWOPS_MEMORY:
+    case SDL_RWOPS_MEMORY_RO:
+        if ((Uint64) offset + size > (Uint64) (context->hidden.mem.stop - context->hidden.mem.base)) {
+            return NULL;
+        }
+        return context->hidden.mem.base + offset;
+
+#if defined(HAVE_STDIO_H) && defined(HAVE_MMAP)
+    case SDL_RWOPS_STDFILE:
+        {
+            const int fd = fileno(context->hidden.stdio.fp);
+            const Sint64 page = (Sint64) sysconf(_SC_PAGESIZE);
+            const Sint64 start = offset - (offset % page);
+            struct stat info;
+            int flags = MAP_PRIVATE;
+            void *base;
+
+            /* Pages past the end of the file can't be read */
+            if (fd < 0 || page <= 0 || fstat(fd, &info) < 0 ||
+                !S_ISREG(info.st_mode) ||
+                (Uint64) offset + size > (Uint64) info.st_size) {
+                return NULL;
+            }
+            if (size == 0 || (Uint64) (offset - start) + size > (size_t) -1) {
+                return NULL;
+            }
+#ifdef MAP_POPULATE
+            /* The caller is about to read all of it */
+            flags |= MAP_POPULATE;
+#endif
+            base = mmap(NULL, (size_t) (offset - start) + size, PROT_READ,
+                        flags, fd, (off_t) start);
+            if (base == MAP_FAILED) {
+                return NULL;
+            }
+            mapping->base = base;
+            mapping->length = (size_t) (offset - start) + size;
+            return (const Uint8 *) base + (offset - start);
+        }
+#endif
+
+    default:
+        return NULL;
+    }
+}
+
+void
+SDL_RWunmap(SDL_RWmapping * mapping)
+{
+#if defined(HAVE_STDIO_H) && defined(HAVE_MMAP)
+    if (mapping->base) {
+        munmap(mapping->base, mapping->length);
+    }
+#endif
+    mapping->base = NULL;
+    mapping->length = 0;
+}
+
 /* Functions for dynamically reading and writing endian-specific values */
 
 Uint8
@@ -0,0 +1,45 @@
+/*
+  Simple DirectMedia Layer
+  Copyright (C) 1997-2017 Sam Lantinga <slouken@libsdl.org>
+
+  This software is provided 'as-is', without any express or implied
+  warranty.  In no event will the authors be held liable for any damages
+  arising from the use of this software.
+
+  Permission is granted to anyone to use this software for any purpose,
+  including commercial applications, and to alter it and redistribute it
+  freely, subject to the following restrictions:
+
+  1. The origin of this software must not be misrepresented; you must not
+     claim that you wrote the original software. If you use this software
+     in a product, an acknowledgment in the product documentation would be
+     appreciated but is not required.
+  2. Altered source versions must be plainly marked as such, and must not be
+     misrepresented as being the original software.
+  3. This notice may not be removed or altered from any source distribution.
+*/
+#include "../SDL_internal.h"
+
+#ifndef SDL_rwops_c_h_
+#define SDL_rwops_c_h_
+
+#include "SDL_rwops.h"
+
+/* A read-only view of part of a data stream */
+typedef struct SDL_RWmapping
+{
+    void *base;         /* the start of the mapped pages, if any */
+    size_t length;
+} SDL_RWmapping;
+
+/* Returns a pointer to size bytes at offset in the stream, without copying
+   them, or NULL if the stream can't provide one. Memory streams are used
+   directly and stdio files are memory mapped where mmap() is available.
+   The view stays valid until SDL_RWunmap(), and the stream position is
+   not changed. */
+extern const void *SDL_RWmap(SDL_RWops * context, Sint64 offset, size_t size, SDL_RWmapping * mapping);
+extern void SDL_RWunmap(SDL_RWmapping * mapping);
+
+#endif /* SDL_rwops_c_h_ */
+
+/* vi: set ts=4 sw=4 expandtab: */
@@ -86,6 +86,7 @@
 #include "SDL_video.h"
 #include "SDL_cpuinfo.h"
 #include "SDL_yuv_sw_c.h"
+#include "../video/SDL_yuv_c.h"
 
 
 /* The colorspace conversion functions */
@@ -1028,6 +1029,8 @@ SDL_SW_SetupYUVDisplay(SDL_SW_YUVTexture * swdata, Uint32 target_format)
 
     SDL_FreeSurface(swdata->display);
     swdata->display = NULL;
+    SDL_FreeSurface(swdata->stretch);
+    swdata->stretch = NULL;
     return 0;
 }
 
@@ -1041,6 +1044,7 @@ SDL_SW_CreateYUVTexture(Uint32 format, int w, int h)
     int *Cb_b_tab;
     int i;
     int CR, CB;
+    size_t size;
 
     switch (format) {
     case SDL_PIXELFORMAT_YV12:
@@ -1048,6 +1052,12 @@ SDL_SW_CreateYUVTexture(Uint32 format, int w, int h)
     case SDL_PIXELFORMAT_YUY2:
     case SDL_PIXELFORMAT_UYVY:
     case SDL_PIXELFORMAT_YVYU:
+        size = w * h * 2;
+        break;
+    case SDL_PIXELFORMAT_NV12:
+    case SDL_PIXELFORMAT_NV21:
+        /* Odd sizes are padded out to whole chroma samples */
+        size = ((w + 1) & ~1) * (h + (h + 1) / 2);
         break;
     default:
         SDL_SetError("Unsupported YUV format");
@@ -1064,7 +1074,7 @@ SDL_SW_CreateYUVTexture(Uint32 format, int w, int h)
     swdata->target_format = SDL_PIXELFORMAT_UNKNOWN;
     swdata->w = w;
     swdata->h = h;
-    swdata->pixels = (Uint8 *) SDL_malloc(w * h * 2);
+    swdata->pixels = (Uint8 *) SDL_malloc(size);
     swdata->colortab = (int *) SDL_malloc(4 * 256 * sizeof(int));
     swdata->rgb_2_pix = (Uint32 *) SDL_malloc(3 * 768 * sizeof(Uint32));
     if (!swdata->pixels || !swdata->colortab || !swdata->rgb_2_pix) {
@@ -1100,6 +1110,13 @@ SDL_SW_CreateYUVTexture(Uint32 format, int w, int h)
         swdata->planes[1] = swdata->planes[0] + swdata->pitches[0] * h;
         swdata->planes[2] = swdata->planes[1] + swdata->pitches[1] * h / 2;
         break;
+    case SDL_PIXELFORMAT_NV12:
+    case SDL_PIXELFORMAT_NV21:
+        swdata->pitches[0] = (w + 1) & ~1;
+        swdata->pitches[1] = swdata->pitches[0];
+        swdata->planes[0] = swdata->pixels;
+        swdata->planes[1] = swdata->planes[0] + swdata->pitches[0] * h;
+        break;
     case SDL_PIXELFORMAT_YUY2:
     case SDL_PIXELFORMAT_UYVY:
     case SDL_PIXELFORMAT_YVYU:
@@ -1194,6 +1211,34 @@ SDL_SW_UpdateYUVTexture(SDL_SW_YUVTexture * swdata, const SDL_Rect * rect,
             }
         }
         break;
+    case SDL_PIXELFORMAT_NV12:
+    case SDL_PIXELFORMAT_NV21:
+        {
+            Uint8 *src, *dst;
+            int row;
+            size_t length;
+
+            /* Copy the Y plane */
+            src = (Uint8 *) pixels;
+            dst = swdata->planes[0] + rect->y * swdata->pitches[0] + rect->x;
+            length = rect->w;
+            for (row = 0; row < rect->h; ++row) {
+                SDL_memcpy(dst, src, length);
+                src += pitch;
+                dst += swdata->pitches[0];
+            }
+
+            /* Copy the interleaved UV plane */
+            src = (Uint8 *) pixels + rect->h * pitch;
+            dst = swdata->planes[1] + rect->y/2 * swdata->pitches[1] + (rect->x & ~1);
+            length = (rect->w + 1) & ~1;
+            for (row = 0; row < (rect->h + 1)/2; ++row) {
+                SDL_memcpy(dst, src, length);
+                src += pitch;
+                dst += swdata->pitches[1];
+            }
+        }
+        break;
     }
     return 0;
 }
@@ -1260,11 +1305,13 @@ SDL_SW_LockYUVTexture(SDL_SW_YUVTexture * swdata, const SDL_Rect * rect,
     switch (swdata->format) {
     case SDL_PIXELFORMAT_YV12:
     case SDL_PIXELFORMAT_IYUV:
+    case SDL_PIXELFORMAT_NV12:
+    case SDL_PIXELFORMAT_NV21:
         if (rect
             && (rect->x != 0 || rect->y != 0 || rect->w != swdata->w
                 || rect->h != swdata->h)) {
             return SDL_SetError
-                ("YV12 and IYUV textures only support full surface locks");
+                ("Planar YUV textures only support full surface locks");
         }
         break;
     }
@@ -1289,6 +1336,9 @@ SDL_SW_CopyYUVToRGB(SDL_SW_YUVTexture * swdata, const SDL_Rect * srcrect,
                     int pitch)
 {
     const int targetbpp = SDL_BYTESPERPIXEL(target_format);
+    const SDL_bool semiplanar = (swdata->format == SDL_PIXELFORMAT_NV12 ||
+                                 swdata->format == SDL_PIXELFORMAT_NV21);
+    SDL_bool direct;
     int stretch;
     int scale_2x;
     Uint8 *lum, *Cr, *Cb;
@@ -1322,6 +1372,16 @@ SDL_SW_CopyYUVToRGB(SDL_SW_YUVTexture * swdata, const SDL_Rect * srcrect,
             stretch = 1;
         }
     }
+
+    /* 32-bit targets with 8-bit channels are converted by the SIMD code in
+       SDL_yuv.c, which also handles NV12 and NV21 for any target at 1x.
+       The lookup table routines below cover the rest. */
+    direct = SDL_IsYUVDirectFormat(target_format) &&
+             (semiplanar || (!(swdata->w & 1) && !(swdata->h & 1)));
+    if (scale_2x && semiplanar && !direct) {
+        scale_2x = 0;
+        stretch = 1;
+    }
     if (stretch) {
         int bpp;
         Uint32 Rmask, Gmask, Bmask, Amask;
@@ -1356,6 +1416,27 @@ SDL_SW_CopyYUVToRGB(SDL_SW_YUVTexture * swdata, const SDL_Rect * srcrect,
         pixels = swdata->stretch->pixels;
         pitch = swdata->stretch->pitch;
     }
+    if (direct || semiplanar) {
+        int retval;
+        if (scale_2x) {
+            retval = SDL_ConvertPixels_YUV_to_RGB2X(swdata->w, swdata->h, swdata->format,
+                                                    swdata->planes[0], swdata->pitches[0],
+                                                    target_format, pixels, pitch);
+        } else {
+            retval = SDL_ConvertPixels(swdata->w, swdata->h, swdata->format,
+                                       swdata->planes[0], swdata->pitches[0],
+                                       target_format, pixels, pitch);
+        }
+        if (retval < 0) {
+            return -1;
+        }
+        if (stretch) {
+            SDL_Rect rect = *srcrect;
+            SDL_SoftStretch(swdata->stretch, &rect, swdata->display, NULL);
+        }
+        return 0;
+    }
+
     switch (swdata->format) {
     case SDL_PIXELFORMAT_YV12:
         lum = swdata->planes[0];
@@ -23,6 +23,7 @@
 #if !SDL_RENDER_DISABLED
 
 #include "SDL_draw.h"
+#include "../../video/SDL_rect_c.h"
 #include "SDL_blendfillrect.h"
 
 
@@ -263,8 +264,8 @@ int
 SDL_BlendFillRects(SDL_Surface * dst, const SDL_Rect * rects, int count,
                    SDL_BlendMode blendMode, Uint8 r, Uint8 g, Uint8 b, Uint8 a)
 {
-    SDL_Rect rect;
-    int i;
+    SDL_Rect clipped[64];
+    int i, j, numclipped;
     int (*func)(SDL_Surface * dst, const SDL_Rect * rect,
                 SDL_BlendMode blendMode, Uint8 r, Uint8 g, Uint8 b, Uint8 a) = NULL;
     int status = 0;
@@ -321,12 +322,13 @@ SDL_BlendFillRects(SDL_Surface * dst, const SDL_Rect * rects, int count,
         }
     }
 
-    for (i = 0; i < count; ++i) {
+    for (i = 0; i < count; i += SDL_arraysize(clipped)) {
         /* Perform clipping */
-        if (!SDL_IntersectRect(&rects[i], &dst->clip_rect, &rect)) {
-            continue;
+        numclipped = SDL_ClipRects(&dst->clip_rect, &rects[i],
+                                   SDL_min(count - i, (int) SDL_arraysize(clipped)), clipped);
+        for (j = 0; j < numclipped; ++j) {
+            status = func(dst, &clipped[j], blendMode, r, g, b, a);
         }
-        status = func(dst, &rect, blendMode, r, g, b, a);
     }
     return status;
 }
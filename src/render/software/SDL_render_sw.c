@@ -24,6 +24,7 @@
 
 #include "../SDL_sysrender.h"
 #include "SDL_render_sw_c.h"
+#include "../../video/SDL_sysvideo.h"
 #include "SDL_hints.h"
 
 #include "SDL_draw.h"
@@ -401,6 +402,37 @@ SW_RenderClear(SDL_Renderer * renderer)
     return 0;
 }
 
+/* Adds the pixels of points, or of the lines joining them, to the damage of
+   a window surface */
+static void
+SW_AddPointsDamage(SDL_Surface * surface, const SDL_Point * points, int count,
+                   SDL_bool lines)
+{
+    SDL_Rect rect;
+    int i;
+
+    if (!(surface->flags & SDL_TRACKDAMAGE)) {
+        return;
+    }
+    if (lines && count > 1) {
+        for (i = 1; i < count; ++i) {
+            rect.x = SDL_min(points[i - 1].x, points[i].x);
+            rect.y = SDL_min(points[i - 1].y, points[i].y);
+            rect.w = SDL_max(points[i - 1].x, points[i].x) - rect.x + 1;
+            rect.h = SDL_max(points[i - 1].y, points[i].y) - rect.y + 1;
+            SDL_AddWindowSurfaceDamage(surface, &rect);
+        }
+    } else {
+        rect.w = 1;
+        rect.h = 1;
+        for (i = 0; i < count; ++i) {
+            rect.x = points[i].x;
+            rect.y = points[i].y;
+            SDL_AddWindowSurfaceDamage(surface, &rect);
+        }
+    }
+}
+
 static int
 SW_RenderDrawPoints(SDL_Renderer * renderer, const SDL_FPoint * points,
                     int count)
@@ -432,6 +464,8 @@ SW_RenderDrawPoints(SDL_Renderer * renderer, const SDL_FPoint * points,
         }
     }
 
+    SW_AddPointsDamage(surface, final_points, count, SDL_FALSE);
+
     /* Draw the points! */
     if (renderer->blendMode == SDL_BLENDMODE_NONE) {
         Uint32 color = SDL_MapRGBA(surface->format,
@@ -481,6 +515,8 @@ SW_RenderDrawLines(SDL_Renderer * renderer, const SDL_FPoint * points,
         }
     }
 
+    SW_AddPointsDamage(surface, final_points, count, SDL_TRUE);
+
     /* Draw the lines! */
     if (renderer->blendMode == SDL_BLENDMODE_NONE) {
         Uint32 color = SDL_MapRGBA(surface->format,
@@ -539,6 +575,12 @@ SW_RenderFillRects(SDL_Renderer * renderer, const SDL_FRect * rects, int count)
                                    renderer->a);
         status = SDL_FillRects(surface, final_rects, count, color);
     } else {
+        /* SDL_FillRects() tracks damage itself, but blending doesn't */
+        if (surface->flags & SDL_TRACKDAMAGE) {
+            for (i = 0; i < count; ++i) {
+                SDL_AddWindowSurfaceDamage(surface, &final_rects[i]);
+            }
+        }
         status = SDL_BlendFillRects(surface, final_rects, count,
                                     renderer->blendMode,
                                     renderer->r, renderer->g, renderer->b,
@@ -549,6 +591,18 @@ SW_RenderFillRects(SDL_Renderer * renderer, const SDL_FRect * rects, int count)
     return status;
 }
 
+static int
+GetScaleQuality(void)
+{
+    const char *hint = SDL_GetHint(SDL_HINT_RENDER_SCALE_QUALITY);
+
+    if (!hint || *hint == '0' || SDL_strcasecmp(hint, "nearest") == 0) {
+        return 0;
+    } else {
+        return 1;
+    }
+}
+
 static int
 SW_RenderCopy(SDL_Renderer * renderer, SDL_Texture * texture,
               const SDL_Rect * srcrect, const SDL_FRect * dstrect)
@@ -578,19 +632,8 @@ SW_RenderCopy(SDL_Renderer * renderer, SDL_Texture * texture,
          * to avoid potentially frequent RLE encoding/decoding.
          */
         SDL_SetSurfaceRLE(surface, 0);
-        return SDL_BlitScaled(src, srcrect, surface, &final_rect);
-    }
-}
-
-static int
-GetScaleQuality(void)
-{
-    const char *hint = SDL_GetHint(SDL_HINT_RENDER_SCALE_QUALITY);
-
-    if (!hint || *hint == '0' || SDL_strcasecmp(hint, "nearest") == 0) {
-        return 0;
-    } else {
-        return 1;
+        return SDL_PrivateUpperBlitScaled(src, srcrect, surface, &final_rect,
+                                          GetScaleQuality() ? SDL_TRUE : SDL_FALSE);
     }
 }
 
@@ -700,7 +743,8 @@ SW_RenderCopyEx(SDL_Renderer * renderer, SDL_Texture * texture,
             retval = -1;
         } else {
             SDL_SetSurfaceBlendMode(src_clone, SDL_BLENDMODE_NONE);
-            retval = SDL_BlitScaled(src_clone, srcrect, src_scaled, &scale_rect);
+            retval = SDL_PrivateUpperBlitScaled(src_clone, srcrect, src_scaled, &scale_rect,
+                                                GetScaleQuality() ? SDL_TRUE : SDL_FALSE);
             SDL_FreeSurface(src_clone);
             src_clone = src_scaled;
             src_scaled = NULL;
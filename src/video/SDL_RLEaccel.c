@@ -85,9 +85,13 @@
  *   beginning of an opaque line.
  */
 
+#include "SDL_atomic.h"
+#include "SDL_hints.h"
+#include "SDL_thread.h"
 #include "SDL_video.h"
 #include "SDL_sysvideo.h"
 #include "SDL_blit.h"
+#include "SDL_pixels_c.h"
 #include "SDL_RLEaccel_c.h"
 
 #ifndef MIN
@@ -129,6 +133,52 @@
         }                                                   \
     } while (0)
 
+#ifdef __SSE2__
+/*
+ * With SSE2, four 32bpp pixels are blended at a time as
+ * d + (s - d) * alpha / 256 per component, where alo and ahi are the
+ * alpha values for the two pixels in each half of the register.
+ */
+static SDL_INLINE __m128i
+BlendPixelsSSE2(__m128i s, __m128i d, __m128i alo, __m128i ahi)
+{
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i full = _mm_set1_epi16(256);
+    __m128i lo, hi;
+
+    lo = _mm_add_epi16(_mm_mullo_epi16(_mm_unpacklo_epi8(s, zero), alo),
+                       _mm_mullo_epi16(_mm_unpacklo_epi8(d, zero),
+                                       _mm_sub_epi16(full, alo)));
+    hi = _mm_add_epi16(_mm_mullo_epi16(_mm_unpackhi_epi8(s, zero), ahi),
+                       _mm_mullo_epi16(_mm_unpackhi_epi8(d, zero),
+                                       _mm_sub_epi16(full, ahi)));
+    return _mm_packus_epi16(_mm_srli_epi16(lo, 8), _mm_srli_epi16(hi, 8));
+}
+
+static void
+BlitAlpha32SSE2(Uint32 * to, Uint32 * from, int length, unsigned alpha)
+{
+    const __m128i a = _mm_set1_epi16((short) alpha);
+    const __m128i rgb = _mm_set1_epi32(0x00ffffff);
+    int x;
+
+    for (x = 0; x + 4 <= length; x += 4) {
+        const __m128i s = _mm_loadu_si128((const __m128i *) (from + x));
+        const __m128i d = _mm_loadu_si128((const __m128i *) (to + x));
+        _mm_storeu_si128((__m128i *) (to + x),
+                         _mm_and_si128(BlendPixelsSSE2(s, d, a, a), rgb));
+    }
+    if (x < length) {
+        ALPHA_BLIT32_888(to + x, from + x, length - x, 4, alpha);
+    }
+}
+
+#define ALPHA_BLIT32_888_SSE2(to, from, length, bpp, alpha)     \
+    BlitAlpha32SSE2((Uint32 *)(to), (Uint32 *)(from), length, alpha)
+#else
+#define ALPHA_BLIT32_888_SSE2 ALPHA_BLIT32_888
+#endif /* __SSE2__ */
+
 /*
  * For 16bpp pixels we can go a step further: put the middle component
  * in the high 16 bits of a 32 bit word, and process all three RGB
@@ -360,6 +410,8 @@
                     || fmt->Bmask == 0xff00)) {                 \
                     if (alpha == 128) {                         \
                         blitter(4, Uint16, ALPHA_BLIT32_888_50); \
+                    } else if (simd) {                          \
+                        blitter(4, Uint16, ALPHA_BLIT32_888_SSE2); \
                     } else {                                    \
                         blitter(4, Uint16, ALPHA_BLIT32_888);   \
                     }                                           \
@@ -388,7 +440,7 @@
  */
 static void
 RLEClipBlit(int w, Uint8 * srcbuf, SDL_Surface * surf_dst,
-            Uint8 * dstbuf, SDL_Rect * srcrect, unsigned alpha)
+            Uint8 * dstbuf, SDL_Rect * srcrect, unsigned alpha, SDL_bool simd)
 {
     SDL_PixelFormat *fmt = surf_dst->format;
 
@@ -454,6 +506,7 @@ SDL_RLEBlit(SDL_Surface * surf_src, SDL_Rect * srcrect,
     int x, y;
     int w = surf_src->w;
     unsigned alpha;
+    const SDL_bool simd = surf_src->map->rle_simd;
 
     /* Lock the destination if necessary */
     if (SDL_MUSTLOCK(surf_dst)) {
@@ -516,7 +569,7 @@ SDL_RLEBlit(SDL_Surface * surf_src, SDL_Rect * srcrect,
     alpha = surf_src->map->info.a;
     /* if left or right edge clipping needed, call clip blit */
     if (srcrect->x || srcrect->w != surf_src->w) {
-        RLEClipBlit(w, srcbuf, surf_dst, dstbuf, srcrect, alpha);
+        RLEClipBlit(w, srcbuf, surf_dst, dstbuf, srcrect, alpha, simd);
     } else {
         SDL_PixelFormat *fmt = surf_src->format;
 
@@ -610,6 +663,50 @@ SDL_RLEBlit(SDL_Surface * surf_src, SDL_Rect * srcrect,
     dst = (Uint16)(d | d >> 16);            \
     } while(0)
 
+/* blend a run of translucent pixels */
+#define BLIT_TRANSL_RUN(do_blend, to, from, length)     \
+    do {                                                \
+        int i;                                          \
+        for (i = 0; i < (int)(length); i++)             \
+            do_blend((from)[i], (to)[i]);               \
+    } while(0)
+
+#define BLIT_TRANSL_RUN_888(to, from, length)           \
+    BLIT_TRANSL_RUN(BLIT_TRANSL_888, to, from, length)
+
+#define BLIT_TRANSL_RUN_565(to, from, length)           \
+    BLIT_TRANSL_RUN(BLIT_TRANSL_565, to, from, length)
+
+#define BLIT_TRANSL_RUN_555(to, from, length)           \
+    BLIT_TRANSL_RUN(BLIT_TRANSL_555, to, from, length)
+
+#ifdef __SSE2__
+static void
+BlitTransl32SSE2(Uint32 * to, Uint32 * from, int length)
+{
+    const __m128i opaque = _mm_set1_epi32(0xff000000);
+    int i;
+
+    for (i = 0; i + 4 <= length; i += 4) {
+        const __m128i s = _mm_loadu_si128((const __m128i *) (from + i));
+        const __m128i d = _mm_loadu_si128((const __m128i *) (to + i));
+        __m128i a = _mm_srli_epi32(s, 24);
+
+        a = _mm_or_si128(a, _mm_slli_epi32(a, 16));
+        _mm_storeu_si128((__m128i *) (to + i),
+                         _mm_or_si128(BlendPixelsSSE2(s, d, _mm_unpacklo_epi32(a, a),
+                                                      _mm_unpackhi_epi32(a, a)),
+                                      opaque));
+    }
+    for (; i < length; i++) {
+        BLIT_TRANSL_888(from[i], to[i]);
+    }
+}
+
+#define BLIT_TRANSL_RUN_888_SSE2(to, from, length)      \
+    BlitTransl32SSE2(to, from, length)
+#endif /* __SSE2__ */
+
 /* used to save the destination format in the encoding. Designed to be
    macro-compatible with SDL_PixelFormat but without the unneeded fields */
 typedef struct
@@ -633,15 +730,15 @@ typedef struct
 /* blit a pixel-alpha RLE surface clipped at the right and/or left edges */
 static void
 RLEAlphaClipBlit(int w, Uint8 * srcbuf, SDL_Surface * surf_dst,
-                 Uint8 * dstbuf, SDL_Rect * srcrect)
+                 Uint8 * dstbuf, SDL_Rect * srcrect, SDL_bool simd)
 {
     SDL_PixelFormat *df = surf_dst->format;
     /*
      * clipped blitter: Ptype is the destination pixel type,
-     * Ctype the translucent count type, and do_blend the macro
-     * to blend one pixel.
+     * Ctype the translucent count type, and do_blend_run the macro
+     * to blend a run of pixels.
      */
-#define RLEALPHACLIPBLIT(Ptype, Ctype, do_blend)              \
+#define RLEALPHACLIPBLIT(Ptype, Ctype, do_blend_run)          \
     do {                                  \
     int linecount = srcrect->h;                   \
     int left = srcrect->x;                        \
@@ -694,13 +791,9 @@ RLEAlphaClipBlit(int w, Uint8 * srcbuf, SDL_Surface * surf_dst,
             }                             \
             if(crun > right - cofs)               \
             crun = right - cofs;                  \
-            if(crun > 0) {                    \
-            Ptype *dst = (Ptype *)dstbuf + cofs;          \
-            Uint32 *src = (Uint32 *)srcbuf + (cofs - ofs);    \
-            int i;                        \
-            for(i = 0; i < crun; i++)             \
-                do_blend(src[i], dst[i]);             \
-            }                             \
+            if(crun > 0)                      \
+            do_blend_run((Ptype *)dstbuf + cofs,          \
+                     (Uint32 *)srcbuf + (cofs - ofs), crun);  \
             srcbuf += run * 4;                    \
             ofs += run;                       \
         }                             \
@@ -712,12 +805,18 @@ RLEAlphaClipBlit(int w, Uint8 * srcbuf, SDL_Surface * surf_dst,
     switch (df->BytesPerPixel) {
     case 2:
         if (df->Gmask == 0x07e0 || df->Rmask == 0x07e0 || df->Bmask == 0x07e0)
-            RLEALPHACLIPBLIT(Uint16, Uint8, BLIT_TRANSL_565);
+            RLEALPHACLIPBLIT(Uint16, Uint8, BLIT_TRANSL_RUN_565);
         else
-            RLEALPHACLIPBLIT(Uint16, Uint8, BLIT_TRANSL_555);
+            RLEALPHACLIPBLIT(Uint16, Uint8, BLIT_TRANSL_RUN_555);
         break;
     case 4:
-        RLEALPHACLIPBLIT(Uint32, Uint16, BLIT_TRANSL_888);
+#ifdef __SSE2__
+        if (simd) {
+            RLEALPHACLIPBLIT(Uint32, Uint16, BLIT_TRANSL_RUN_888_SSE2);
+            break;
+        }
+#endif
+        RLEALPHACLIPBLIT(Uint32, Uint16, BLIT_TRANSL_RUN_888);
         break;
     }
 }
@@ -802,15 +901,15 @@ SDL_RLEAlphaBlit(SDL_Surface * surf_src, SDL_Rect * srcrect,
 
     /* if left or right edge clipping needed, call clip blit */
     if (srcrect->x || srcrect->w != surf_src->w) {
-        RLEAlphaClipBlit(w, srcbuf, surf_dst, dstbuf, srcrect);
+        RLEAlphaClipBlit(w, srcbuf, surf_dst, dstbuf, srcrect, surf_src->map->rle_simd);
     } else {
 
         /*
          * non-clipped blitter. Ptype is the destination pixel type,
-         * Ctype the translucent count type, and do_blend the
-         * macro to blend one pixel.
+         * Ctype the translucent count type, and do_blend_run the
+         * macro to blend a run of pixels.
          */
-#define RLEALPHABLIT(Ptype, Ctype, do_blend)                 \
+#define RLEALPHABLIT(Ptype, Ctype, do_blend_run)             \
     do {                                 \
         int linecount = srcrect->h;                  \
         do {                             \
@@ -840,14 +939,9 @@ SDL_RLEAlphaBlit(SDL_Surface * surf_src, SDL_Rect * srcrect,
             run = ((Uint16 *)srcbuf)[1];             \
             srcbuf += 4;                     \
             if(run) {                        \
-            Ptype *dst = (Ptype *)dstbuf + ofs;      \
-            unsigned i;                  \
-            for(i = 0; i < run; i++) {           \
-                Uint32 src = *(Uint32 *)srcbuf;      \
-                do_blend(src, *dst);             \
-                srcbuf += 4;                 \
-                dst++;                   \
-            }                        \
+            do_blend_run((Ptype *)dstbuf + ofs,      \
+                     (Uint32 *)srcbuf, run);         \
+            srcbuf += run * 4;               \
             ofs += run;                  \
             }                            \
         } while(ofs < w);                    \
@@ -859,12 +953,18 @@ SDL_RLEAlphaBlit(SDL_Surface * surf_src, SDL_Rect * srcrect,
         case 2:
             if (df->Gmask == 0x07e0 || df->Rmask == 0x07e0
                 || df->Bmask == 0x07e0)
-                RLEALPHABLIT(Uint16, Uint8, BLIT_TRANSL_565);
+                RLEALPHABLIT(Uint16, Uint8, BLIT_TRANSL_RUN_565);
             else
-                RLEALPHABLIT(Uint16, Uint8, BLIT_TRANSL_555);
+                RLEALPHABLIT(Uint16, Uint8, BLIT_TRANSL_RUN_555);
             break;
         case 4:
-            RLEALPHABLIT(Uint32, Uint16, BLIT_TRANSL_888);
+#ifdef __SSE2__
+            if (surf_src->map->rle_simd) {
+                RLEALPHABLIT(Uint32, Uint16, BLIT_TRANSL_RUN_888_SSE2);
+                break;
+            }
+#endif
+            RLEALPHABLIT(Uint32, Uint16, BLIT_TRANSL_RUN_888);
             break;
         }
     }
@@ -1021,32 +1121,16 @@ uncopy_32(Uint32 * dst, void *src, int n,
 #define ISTRANSL(pixel, fmt)    \
     ((unsigned)((((pixel) & fmt->Amask) >> fmt->Ashift) - 1U) < 254U)
 
-/* convert surface to be quickly alpha-blittable onto dest, if possible */
+typedef int (*copy_func) (void *, Uint32 *, int,
+                          SDL_PixelFormat *, SDL_PixelFormat *);
+
+/* pick the encoding functions for a destination format, if we support it */
 static int
-RLEAlphaSurface(SDL_Surface * surface)
+RLEAlphaCopyFuncs(SDL_PixelFormat * df, copy_func * copy_opaque,
+                  copy_func * copy_transl)
 {
-    SDL_Surface *dest;
-    SDL_PixelFormat *df;
-    int maxsize = 0;
-    int max_opaque_run;
-    int max_transl_run = 65535;
-    unsigned masksum;
-    Uint8 *rlebuf, *dst;
-    int (*copy_opaque) (void *, Uint32 *, int,
-                        SDL_PixelFormat *, SDL_PixelFormat *);
-    int (*copy_transl) (void *, Uint32 *, int,
-                        SDL_PixelFormat *, SDL_PixelFormat *);
-
-    dest = surface->map->dst;
-    if (!dest)
-        return -1;
-    df = dest->format;
-    if (surface->format->BitsPerPixel != 32)
-        return -1;              /* only 32bpp source supported */
+    unsigned masksum = df->Rmask | df->Gmask | df->Bmask;
 
-    /* find out whether the destination is one we support,
-       and determine the max size of the encoded result */
-    masksum = df->Rmask | df->Gmask | df->Bmask;
     switch (df->BytesPerPixel) {
     case 2:
         /* 16bpp: only support 565 and 555 formats */
@@ -1054,47 +1138,289 @@ RLEAlphaSurface(SDL_Surface * surface)
         case 0xffff:
             if (df->Gmask == 0x07e0
                 || df->Rmask == 0x07e0 || df->Bmask == 0x07e0) {
-                copy_opaque = copy_opaque_16;
-                copy_transl = copy_transl_565;
-            } else
-                return -1;
+                *copy_opaque = copy_opaque_16;
+                *copy_transl = copy_transl_565;
+                return 0;
+            }
             break;
         case 0x7fff:
             if (df->Gmask == 0x03e0
                 || df->Rmask == 0x03e0 || df->Bmask == 0x03e0) {
-                copy_opaque = copy_opaque_16;
-                copy_transl = copy_transl_555;
-            } else
-                return -1;
+                *copy_opaque = copy_opaque_16;
+                *copy_transl = copy_transl_555;
+                return 0;
+            }
             break;
-        default:
-            return -1;
         }
+        break;
+    case 4:
+        if (masksum == 0x00ffffff) {   /* requires unused high byte */
+            *copy_opaque = copy_32;
+            *copy_transl = copy_32;
+            return 0;
+        }
+        break;
+    }
+    return -1;              /* anything else unsupported right now */
+}
+
+#ifdef __SSE2__
+/*
+ * SSE2 version of the encoding functions, for sources with 8-bit channels.
+ * A whole scan line is converted to both the opaque and the translucent
+ * encoding at once, and runs are then copied out of the converted lines.
+ */
+typedef struct
+{
+    __m128i right[3];       /* shift the source channel down to its lost bits */
+    __m128i mask[3];        /* keep the bits the destination has room for */
+    __m128i left[3];        /* shift them up to the destination channel */
+    __m128i alpha_shift;
+    __m128i amask;
+    __m128i middle;         /* the 16bpp middle component */
+    __m128i keep;           /* and the other two */
+} RLEConvertSSE2;
+
+static SDL_bool
+InitConvertSSE2(RLEConvertSSE2 * k, SDL_PixelFormat * sf, SDL_PixelFormat * df)
+{
+    const int sshift[3] = { sf->Rshift, sf->Gshift, sf->Bshift };
+    const int dloss[3] = { df->Rloss, df->Gloss, df->Bloss };
+    const int dshift[3] = { df->Rshift, df->Gshift, df->Bshift };
+    Uint32 middle;
+    int i;
+
+    if (sf->Rloss || sf->Gloss || sf->Bloss || sf->Aloss) {
+        return SDL_FALSE;
+    }
+    for (i = 0; i < 3; i++) {
+        k->right[i] = _mm_cvtsi32_si128(sshift[i] + dloss[i]);
+        k->mask[i] = _mm_set1_epi32(0xff >> dloss[i]);
+        k->left[i] = _mm_cvtsi32_si128(dshift[i]);
+    }
+    k->alpha_shift = _mm_cvtsi32_si128(sf->Ashift);
+
+    /* PIXEL_FROM_RGB adds the alpha mask in the 16bpp encodings */
+    k->amask = _mm_set1_epi32(df->BytesPerPixel == 2 ? (int) df->Amask : 0);
+    middle = ((df->Rmask | df->Gmask | df->Bmask) == 0xffff) ? 0x07e0 : 0x03e0;
+    k->middle = _mm_set1_epi32(middle);
+    k->keep = _mm_set1_epi32(0xffff & ~middle);
+    return SDL_TRUE;
+}
+
+/* encode a scan line; opaque and transl are the same buffer for 32bpp */
+static void
+ConvertLineSSE2(const RLEConvertSSE2 * k, Uint32 * src, int w,
+                Uint8 * opaque, Uint32 * transl,
+                SDL_PixelFormat * sf, SDL_PixelFormat * df,
+                copy_func copy_opaque, copy_func copy_transl)
+{
+    const __m128i ff = _mm_set1_epi32(0xff);
+    const __m128i bias32 = _mm_set1_epi32(0x8000);
+    const __m128i bias16 = _mm_set1_epi16((short) 0x8000);
+    int x;
+
+    for (x = 0; x + 4 <= w; x += 4) {
+        const __m128i v = _mm_loadu_si128((const __m128i *) (src + x));
+        const __m128i a = _mm_and_si128(_mm_srl_epi32(v, k->alpha_shift), ff);
+        __m128i r, g, b, pix;
+
+        r = _mm_sll_epi32(_mm_and_si128(_mm_srl_epi32(v, k->right[0]), k->mask[0]), k->left[0]);
+        g = _mm_sll_epi32(_mm_and_si128(_mm_srl_epi32(v, k->right[1]), k->mask[1]), k->left[1]);
+        b = _mm_sll_epi32(_mm_and_si128(_mm_srl_epi32(v, k->right[2]), k->mask[2]), k->left[2]);
+        pix = _mm_or_si128(_mm_or_si128(r, g), b);
+
+        if (df->BytesPerPixel == 2) {
+            __m128i t;
+
+            pix = _mm_or_si128(pix, k->amask);
+
+            /* no unsigned 32 to 16 bit pack in SSE2, go through signed */
+            t = _mm_packs_epi32(_mm_sub_epi32(pix, bias32), _mm_sub_epi32(pix, bias32));
+            _mm_storel_epi64((__m128i *) (opaque + x * 2), _mm_add_epi16(t, bias16));
+
+            t = _mm_or_si128(_mm_slli_epi32(_mm_and_si128(pix, k->middle), 16),
+                             _mm_and_si128(pix, k->keep));
+            t = _mm_or_si128(t, _mm_and_si128(_mm_slli_epi32(a, 2), k->middle));
+            _mm_storeu_si128((__m128i *) (transl + x), t);
+        } else {
+            pix = _mm_or_si128(pix, _mm_slli_epi32(a, 24));
+            _mm_storeu_si128((__m128i *) (transl + x), pix);
+        }
+    }
+    if (x < w) {
+        copy_opaque(opaque + x * df->BytesPerPixel, src + x, w - x, sf, df);
+        if (df->BytesPerPixel == 2) {
+            copy_transl(transl + x, src + x, w - x, sf, df);
+        }
+    }
+}
+#endif /* __SSE2__ */
+
+/*
+ * Run detection: these return the first pixel from x on that is not part
+ * of the run, which is made of pixels that are (or are not, if want is
+ * SDL_FALSE) opaque, translucent or the colorkey. With SSE2, whole blocks
+ * of 16 bytes are skipped at a time.
+ */
+static int
+ScanAlpha(Uint32 * src, int x, int w, SDL_PixelFormat * sf,
+          SDL_bool transl, SDL_bool want, SDL_bool simd)
+{
+#ifdef __SSE2__
+    if (simd) {
+        const __m128i ff = _mm_set1_epi32(0xff);
+        const __m128i zero = _mm_setzero_si128();
+        const __m128i shift = _mm_cvtsi32_si128(sf->Ashift);
+        const int match = want ? 0xffff : 0;
+
+        for (; x + 4 <= w; x += 4) {
+            const __m128i v = _mm_loadu_si128((const __m128i *) (src + x));
+            const __m128i a = _mm_and_si128(_mm_srl_epi32(v, shift), ff);
+            __m128i is = _mm_cmpeq_epi32(a, ff);
+
+            if (transl) {
+                /* translucent is neither transparent nor opaque */
+                is = _mm_andnot_si128(_mm_or_si128(is, _mm_cmpeq_epi32(a, zero)),
+                                      _mm_cmpeq_epi32(zero, zero));
+            }
+            if (_mm_movemask_epi8(is) != match) {
+                break;
+            }
+        }
+    }
+#endif
+    if (transl) {
+        while (x < w && (ISTRANSL(src[x], sf) != 0) == want)
+            x++;
+    } else {
+        while (x < w && (ISOPAQUE(src[x], sf) != 0) == want)
+            x++;
+    }
+    return x;
+}
+
+static int
+ScanColorkey(Uint8 * srcbuf, int x, int w, int bpp, Uint32 ckey,
+             Uint32 rgbmask, SDL_bool want, SDL_bool simd)
+{
+#ifdef __SSE2__
+    if (simd && bpp != 3) {
+        const int match = want ? 0xffff : 0;
+        const int block = 16 / bpp;
+        __m128i key, mask;
+
+        if (bpp == 1) {
+            key = _mm_set1_epi8((char) ckey);
+            mask = _mm_set1_epi8((char) rgbmask);
+        } else if (bpp == 2) {
+            key = _mm_set1_epi16((short) ckey);
+            mask = _mm_set1_epi16((short) rgbmask);
+        } else {
+            key = _mm_set1_epi32((int) ckey);
+            mask = _mm_set1_epi32((int) rgbmask);
+        }
+        for (; x + block <= w; x += block) {
+            __m128i v = _mm_loadu_si128((const __m128i *) (srcbuf + x * bpp));
+            v = _mm_and_si128(v, mask);
+            if (bpp == 1) {
+                v = _mm_cmpeq_epi8(v, key);
+            } else if (bpp == 2) {
+                v = _mm_cmpeq_epi16(v, key);
+            } else {
+                v = _mm_cmpeq_epi32(v, key);
+            }
+            if (_mm_movemask_epi8(v) != match) {
+                break;
+            }
+        }
+    }
+#endif
+    switch (bpp) {
+    case 1:
+        while (x < w && ((srcbuf[x] & rgbmask) == ckey) == want)
+            x++;
+        break;
+    case 2:
+        while (x < w && ((((Uint16 *) srcbuf)[x] & rgbmask) == ckey) == want)
+            x++;
+        break;
+    case 3:
+        while (x < w) {
+            Uint8 *p = srcbuf + x * 3;
+#if SDL_BYTEORDER == SDL_LIL_ENDIAN
+            Uint32 pix = p[0] + (p[1] << 8) + (p[2] << 16);
+#else
+            Uint32 pix = (p[0] << 16) + (p[1] << 8) + p[2];
+#endif
+            if (((pix & rgbmask) == ckey) != want)
+                break;
+            x++;
+        }
+        break;
+    case 4:
+        while (x < w && ((((Uint32 *) srcbuf)[x] & rgbmask) == ckey) == want)
+            x++;
+        break;
+    }
+    return x;
+}
+
+/* encode a 32bpp surface to be quickly alpha-blittable onto df */
+static Uint8 *
+RLEAlphaEncode(SDL_Surface * surface, SDL_PixelFormat * df, SDL_bool use_simd)
+{
+    int maxsize = 0;
+    int max_opaque_run;
+    int max_transl_run = 65535;
+    Uint8 *rlebuf, *dst;
+    Uint8 *line = NULL;     /* the converted scan line, when there is one */
+    Uint32 *transl_line = NULL;
+    SDL_bool simd = SDL_FALSE;
+    copy_func copy_opaque, copy_transl;
+#ifdef __SSE2__
+    RLEConvertSSE2 convert;
+#endif
+
+    if (RLEAlphaCopyFuncs(df, &copy_opaque, &copy_transl) < 0) {
+        return NULL;
+    }
+
+    /* determine the max size of the encoded result */
+    if (df->BytesPerPixel == 2) {
         max_opaque_run = 255;   /* runs stored as bytes */
 
         /* worst case is alternating opaque and translucent pixels,
            with room for alignment padding between lines */
         maxsize = surface->h * (2 + (4 + 2) * (surface->w + 1)) + 2;
-        break;
-    case 4:
-        if (masksum != 0x00ffffff)
-            return -1;          /* requires unused high byte */
-        copy_opaque = copy_32;
-        copy_transl = copy_32;
+    } else {
         max_opaque_run = 255;   /* runs stored as short ints */
 
         /* worst case is alternating opaque and translucent pixels */
         maxsize = surface->h * 2 * 4 * (surface->w + 1) + 4;
-        break;
-    default:
-        return -1;              /* anything else unsupported right now */
     }
 
     maxsize += sizeof(RLEDestFormat);
     rlebuf = (Uint8 *) SDL_malloc(maxsize);
     if (!rlebuf) {
-        return SDL_OutOfMemory();
+        SDL_OutOfMemory();
+        return NULL;
     }
+
+#ifdef __SSE2__
+    if (use_simd) {
+        simd = SDL_TRUE;
+        if (InitConvertSSE2(&convert, surface->format, df)) {
+            /* the 16bpp opaque line is followed by the translucent one,
+               32bpp uses the same line for both */
+            const int opaque_size = (df->BytesPerPixel == 2) ? ((surface->w * 2 + 3) & ~3) : 0;
+            line = (Uint8 *) SDL_malloc(opaque_size + surface->w * 4);
+            if (line) {
+                transl_line = (Uint32 *) (line + opaque_size);
+            }
+        }
+    }
+#endif
     {
         /* save the destination format so we can undo the encoding later */
         RLEDestFormat *r = (RLEDestFormat *) rlebuf;
@@ -1121,6 +1447,7 @@ RLEAlphaSurface(SDL_Surface * surface)
         SDL_PixelFormat *sf = surface->format;
         Uint32 *src = (Uint32 *) surface->pixels;
         Uint8 *lastline = dst;  /* end of last non-blank line */
+        const int opaque_bpp = df->BytesPerPixel;
 
         /* opaque counts are 8 or 16 bits, depending on target depth */
 #define ADD_OPAQUE_COUNTS(n, m)         \
@@ -1138,19 +1465,38 @@ RLEAlphaSurface(SDL_Surface * surface)
 #define ADD_TRANSL_COUNTS(n, m)     \
     (((Uint16 *)dst)[0] = n, ((Uint16 *)dst)[1] = m, dst += 4)
 
+        /* copy from the converted line if we have one */
+#define COPY_OPAQUE(start, len)                                         \
+    if(line) {                                                          \
+        SDL_memcpy(dst, line + (start) * opaque_bpp, (len) * opaque_bpp); \
+        dst += (len) * opaque_bpp;                                      \
+    } else                                                              \
+        dst += copy_opaque(dst, src + (start), len, sf, df)
+
+#define COPY_TRANSL(start, len)                                         \
+    if(line) {                                                          \
+        SDL_memcpy(dst, transl_line + (start), (len) * 4);              \
+        dst += (len) * 4;                                               \
+    } else                                                              \
+        dst += copy_transl(dst, src + (start), len, sf, df)
+
         for (y = 0; y < h; y++) {
             int runstart, skipstart;
             int blankline = 0;
+#ifdef __SSE2__
+            if (line) {
+                ConvertLineSSE2(&convert, src, w, line, transl_line,
+                                sf, df, copy_opaque, copy_transl);
+            }
+#endif
             /* First encode all opaque pixels of a scan line */
             x = 0;
             do {
                 int run, skip, len;
                 skipstart = x;
-                while (x < w && !ISOPAQUE(src[x], sf))
-                    x++;
+                x = ScanAlpha(src, x, w, sf, SDL_FALSE, SDL_FALSE, simd);
                 runstart = x;
-                while (x < w && ISOPAQUE(src[x], sf))
-                    x++;
+                x = ScanAlpha(src, x, w, sf, SDL_FALSE, SDL_TRUE, simd);
                 skip = runstart - skipstart;
                 if (skip == w)
                     blankline = 1;
@@ -1161,13 +1507,13 @@ RLEAlphaSurface(SDL_Surface * surface)
                 }
                 len = MIN(run, max_opaque_run);
                 ADD_OPAQUE_COUNTS(skip, len);
-                dst += copy_opaque(dst, src + runstart, len, sf, df);
+                COPY_OPAQUE(runstart, len);
                 runstart += len;
                 run -= len;
                 while (run) {
                     len = MIN(run, max_opaque_run);
                     ADD_OPAQUE_COUNTS(0, len);
-                    dst += copy_opaque(dst, src + runstart, len, sf, df);
+                    COPY_OPAQUE(runstart, len);
                     runstart += len;
                     run -= len;
                 }
@@ -1181,11 +1527,9 @@ RLEAlphaSurface(SDL_Surface * surface)
             do {
                 int run, skip, len;
                 skipstart = x;
-                while (x < w && !ISTRANSL(src[x], sf))
-                    x++;
+                x = ScanAlpha(src, x, w, sf, SDL_TRUE, SDL_FALSE, simd);
                 runstart = x;
-                while (x < w && ISTRANSL(src[x], sf))
-                    x++;
+                x = ScanAlpha(src, x, w, sf, SDL_TRUE, SDL_TRUE, simd);
                 skip = runstart - skipstart;
                 blankline &= (skip == w);
                 run = x - runstart;
@@ -1195,13 +1539,13 @@ RLEAlphaSurface(SDL_Surface * surface)
                 }
                 len = MIN(run, max_transl_run);
                 ADD_TRANSL_COUNTS(skip, len);
-                dst += copy_transl(dst, src + runstart, len, sf, df);
+                COPY_TRANSL(runstart, len);
                 runstart += len;
                 run -= len;
                 while (run) {
                     len = MIN(run, max_transl_run);
                     ADD_TRANSL_COUNTS(0, len);
-                    dst += copy_transl(dst, src + runstart, len, sf, df);
+                    COPY_TRANSL(runstart, len);
                     runstart += len;
                     run -= len;
                 }
@@ -1217,60 +1561,22 @@ RLEAlphaSurface(SDL_Surface * surface)
 
 #undef ADD_OPAQUE_COUNTS
 #undef ADD_TRANSL_COUNTS
+#undef COPY_OPAQUE
+#undef COPY_TRANSL
 
-    /* Now that we have it encoded, release the original pixels */
-    if (!(surface->flags & SDL_PREALLOC)) {
-        SDL_free(surface->pixels);
-        surface->pixels = NULL;
-    }
+    SDL_free(line);
 
     /* realloc the buffer to release unused memory */
     {
         Uint8 *p = SDL_realloc(rlebuf, dst - rlebuf);
         if (!p)
             p = rlebuf;
-        surface->map->data = p;
+        return p;
     }
-
-    return 0;
-}
-
-static Uint32
-getpix_8(Uint8 * srcbuf)
-{
-    return *srcbuf;
 }
 
-static Uint32
-getpix_16(Uint8 * srcbuf)
-{
-    return *(Uint16 *) srcbuf;
-}
-
-static Uint32
-getpix_24(Uint8 * srcbuf)
-{
-#if SDL_BYTEORDER == SDL_LIL_ENDIAN
-    return srcbuf[0] + (srcbuf[1] << 8) + (srcbuf[2] << 16);
-#else
-    return (srcbuf[0] << 16) + (srcbuf[1] << 8) + srcbuf[2];
-#endif
-}
-
-static Uint32
-getpix_32(Uint8 * srcbuf)
-{
-    return *(Uint32 *) srcbuf;
-}
-
-typedef Uint32(*getpix_func) (Uint8 *);
-
-static const getpix_func getpixes[4] = {
-    getpix_8, getpix_16, getpix_24, getpix_32
-};
-
-static int
-RLEColorkeySurface(SDL_Surface * surface)
+static Uint8 *
+RLEColorkeyEncode(SDL_Surface * surface, Uint32 colorkey, SDL_bool use_simd)
 {
     Uint8 *rlebuf, *dst;
     int maxn;
@@ -1278,7 +1584,7 @@ RLEColorkeySurface(SDL_Surface * surface)
     Uint8 *srcbuf, *lastline;
     int maxsize = 0;
     const int bpp = surface->format->BytesPerPixel;
-    getpix_func getpix;
+    SDL_bool simd = SDL_FALSE;
     Uint32 ckey, rgbmask;
     int w, h;
 
@@ -1302,12 +1608,13 @@ RLEColorkeySurface(SDL_Surface * surface)
         break;
 
     default:
-        return -1;
+        return NULL;
     }
 
     rlebuf = (Uint8 *) SDL_malloc(maxsize);
     if (rlebuf == NULL) {
-        return SDL_OutOfMemory();
+        SDL_OutOfMemory();
+        return NULL;
     }
 
     /* Set up the conversion */
@@ -1315,11 +1622,13 @@ RLEColorkeySurface(SDL_Surface * surface)
     maxn = bpp == 4 ? 65535 : 255;
     dst = rlebuf;
     rgbmask = ~surface->format->Amask;
-    ckey = surface->map->info.colorkey & rgbmask;
+    ckey = colorkey & rgbmask;
     lastline = dst;
-    getpix = getpixes[bpp - 1];
     w = surface->w;
     h = surface->h;
+#ifdef __SSE2__
+    simd = use_simd;
+#endif
 
 #define ADD_COUNTS(n, m)            \
     if(bpp == 4) {              \
@@ -1341,11 +1650,9 @@ RLEColorkeySurface(SDL_Surface * surface)
             int skipstart = x;
 
             /* find run of transparent, then opaque pixels */
-            while (x < w && (getpix(srcbuf + x * bpp) & rgbmask) == ckey)
-                x++;
+            x = ScanColorkey(srcbuf, x, w, bpp, ckey, rgbmask, SDL_TRUE, simd);
             runstart = x;
-            while (x < w && (getpix(srcbuf + x * bpp) & rgbmask) != ckey)
-                x++;
+            x = ScanColorkey(srcbuf, x, w, bpp, ckey, rgbmask, SDL_FALSE, simd);
             skip = runstart - skipstart;
             if (skip == w)
                 blankline = 1;
@@ -1381,28 +1688,299 @@ RLEColorkeySurface(SDL_Surface * surface)
 
 #undef ADD_COUNTS
 
-    /* Now that we have it encoded, release the original pixels */
-    if (!(surface->flags & SDL_PREALLOC)) {
-        SDL_free(surface->pixels);
-        surface->pixels = NULL;
-    }
-
     /* realloc the buffer to release unused memory */
     {
         /* If realloc returns NULL, the original block is left intact */
         Uint8 *p = SDL_realloc(rlebuf, dst - rlebuf);
         if (!p)
             p = rlebuf;
-        surface->map->data = p;
+        return p;
+    }
+}
+
+/* replace the pixels of a surface with its encoding and set up the blit */
+static void
+RLEInstall(SDL_Surface * surface, Uint8 * data, SDL_bool alpha)
+{
+    /* Now that we have it encoded, release the original pixels */
+    SDL_FreeSurfacePixels(surface);
+    surface->map->data = data;
+
+    if (alpha) {
+        surface->map->blit = SDL_RLEAlphaBlit;
+        surface->map->info.flags |= SDL_COPY_RLE_ALPHAKEY;
+    } else {
+        surface->map->blit = SDL_RLEBlit;
+        surface->map->info.flags |= SDL_COPY_RLE_COLORKEY;
+    }
+
+    /* The surface is now accelerated */
+    surface->flags |= SDL_RLEACCEL;
+}
+
+/*
+ * Background encoding (SDL_HINT_RLE_LAZY_ENCODE):
+ * The surface keeps its pixels and is blitted with the regular blitter
+ * while a worker thread encodes it. The first blit after the worker is done
+ * puts the encoding in place. Anything that would un-RLE the surface, like
+ * locking it, waits for the worker and throws its encoding away instead.
+ * There is a single worker, started when it's first needed, which takes the
+ * surfaces from a queue in turn.
+ */
+
+/* Smaller surfaces encode faster than they can be handed to the worker */
+#define RLE_LAZY_MIN_PIXELS (256 * 256)
+
+typedef struct SDL_RLEEncoding
+{
+    SDL_Surface *surface;
+    SDL_PixelFormat dst_format;
+    Uint32 colorkey;
+    SDL_bool alpha;
+    SDL_bool simd;
+    Uint8 *data;
+    SDL_atomic_t done;
+    struct SDL_RLEEncoding *next;
+} SDL_RLEEncoding;
+
+static SDL_SpinLock rle_init_lock;
+static SDL_mutex *rle_lock;
+static SDL_cond *rle_cond;          /* a surface was queued or encoded */
+static SDL_Thread *rle_thread;
+static SDL_bool rle_quit;
+static SDL_RLEEncoding *rle_queue;
+static SDL_RLEEncoding *rle_queue_tail;
+static SDL_RLEEncoding *rle_current;
+
+static void
+RLEEncode(SDL_RLEEncoding * encoding)
+{
+    if (encoding->alpha) {
+        encoding->data = RLEAlphaEncode(encoding->surface, &encoding->dst_format, encoding->simd);
+    } else {
+        encoding->data = RLEColorkeyEncode(encoding->surface, encoding->colorkey, encoding->simd);
+    }
+}
+
+static int SDLCALL
+RLEEncodeThread(void *unused)
+{
+    SDL_LockMutex(rle_lock);
+    for (;;) {
+        SDL_RLEEncoding *encoding = rle_queue;
+
+        if (!encoding) {
+            /* when quitting, empty the queue first so nobody waits forever */
+            if (rle_quit) {
+                break;
+            }
+            SDL_CondWait(rle_cond, rle_lock);
+            continue;
+        }
+        rle_queue = encoding->next;
+        if (!rle_queue) {
+            rle_queue_tail = NULL;
+        }
+        rle_current = encoding;
+        SDL_UnlockMutex(rle_lock);
+
+        RLEEncode(encoding);
+
+        SDL_LockMutex(rle_lock);
+        rle_current = NULL;
+        SDL_AtomicSet(&encoding->done, 1);
+        SDL_CondBroadcast(rle_cond);
+    }
+    SDL_UnlockMutex(rle_lock);
+    return 0;
+}
+
+/* hand an encoding to the worker, starting it if needed */
+static int
+RLEQueueEncoding(SDL_RLEEncoding * encoding)
+{
+    int retval = 0;
+
+    SDL_AtomicLock(&rle_init_lock);
+    if (!rle_lock) {
+        rle_lock = SDL_CreateMutex();
+        rle_cond = SDL_CreateCond();
+        if (!rle_lock || !rle_cond) {
+            SDL_DestroyMutex(rle_lock);
+            SDL_DestroyCond(rle_cond);
+            rle_lock = NULL;
+            rle_cond = NULL;
+        }
+    }
+    SDL_AtomicUnlock(&rle_init_lock);
+    if (!rle_lock) {
+        return -1;
+    }
+
+    SDL_LockMutex(rle_lock);
+    if (!rle_thread) {
+        rle_thread = SDL_CreateThread(RLEEncodeThread, "SDLRLEEncode", NULL);
+    }
+    if (rle_thread) {
+        if (rle_queue_tail) {
+            rle_queue_tail->next = encoding;
+        } else {
+            rle_queue = encoding;
+        }
+        rle_queue_tail = encoding;
+        SDL_CondBroadcast(rle_cond);
+    } else {
+        retval = -1;
     }
+    SDL_UnlockMutex(rle_lock);
+    return retval;
+}
+
+/* wait for the worker, then install its encoding or throw it away.
+   An encoding the worker hasn't started is done here if it's wanted. */
+static void
+RLEFinishEncoding(SDL_Surface * surface, SDL_bool install)
+{
+    SDL_RLEEncoding *encoding = surface->map->rle_encoding;
+    SDL_bool queued = SDL_FALSE;
+
+    SDL_LockMutex(rle_lock);
+    if (encoding == rle_current) {
+        while (!SDL_AtomicGet(&encoding->done)) {
+            SDL_CondWait(rle_cond, rle_lock);
+        }
+    } else if (!SDL_AtomicGet(&encoding->done)) {
+        /* the worker hasn't got to it yet, take it off the queue */
+        SDL_RLEEncoding *prev = NULL;
+        SDL_RLEEncoding *i;
+
+        for (i = rle_queue; i != encoding; i = i->next) {
+            prev = i;
+        }
+        if (prev) {
+            prev->next = encoding->next;
+        } else {
+            rle_queue = encoding->next;
+        }
+        if (rle_queue_tail == encoding) {
+            rle_queue_tail = prev;
+        }
+        queued = SDL_TRUE;
+    }
+    SDL_UnlockMutex(rle_lock);
+
+    if (queued && install) {
+        RLEEncode(encoding);
+    }
+
+    surface->map->rle_encoding = NULL;
+    surface->map->blit = SDL_SoftBlit;
+    surface->flags &= ~SDL_RLEACCEL;
+
+    if (install && encoding->data) {
+        RLEInstall(surface, encoding->data, encoding->alpha);
+    } else {
+        SDL_free(encoding->data);
+    }
+    SDL_free(encoding);
+}
 
+/* Install a background encoding before the surface is written to, so that
+   it can't replace the new pixels later.  Writes then need the surface to be
+   locked, as with any other RLE surface. */
+void
+SDL_RLEFinishEncoding(SDL_Surface * surface)
+{
+    if (surface->map->rle_encoding) {
+        RLEFinishEncoding(surface, SDL_TRUE);
+    }
+}
+
+static int
+RLELazyBlit(SDL_Surface * surf_src, SDL_Rect * srcrect,
+            SDL_Surface * surf_dst, SDL_Rect * dstrect)
+{
+    int retval;
+
+    if (SDL_AtomicGet(&surf_src->map->rle_encoding->done)) {
+        RLEFinishEncoding(surf_src, SDL_TRUE);
+        return surf_src->map->blit(surf_src, srcrect, surf_dst, dstrect);
+    }
+
+    /* The pixels are all there, blit them without the lock
+       that would throw the encoding away */
+    surf_src->flags &= ~SDL_RLEACCEL;
+    retval = SDL_SoftBlit(surf_src, srcrect, surf_dst, dstrect);
+    surf_src->flags |= SDL_RLEACCEL;
+    return retval;
+}
+
+static int
+RLEStartEncoding(SDL_Surface * surface, SDL_bool alpha)
+{
+    SDL_BlitMap *map = surface->map;
+    SDL_RLEEncoding *encoding;
+    SDL_BlitFunc blit;
+
+    /* blit with the regular blitter until the encoding is done */
+    blit = SDL_ChooseSoftBlit(surface);
+    if (!blit) {
+        return -1;
+    }
+
+    encoding = (SDL_RLEEncoding *) SDL_calloc(1, sizeof(*encoding));
+    if (!encoding) {
+        return SDL_OutOfMemory();
+    }
+    encoding->surface = surface;
+    encoding->dst_format = *map->dst->format;
+    encoding->colorkey = map->info.colorkey;
+    encoding->alpha = alpha;
+    encoding->simd = map->rle_simd;
+    if (RLEQueueEncoding(encoding) < 0) {
+        SDL_free(encoding);
+        return -1;
+    }
+
+    map->data = blit;
+    map->blit = RLELazyBlit;
+    map->rle_encoding = encoding;
+    surface->flags |= SDL_RLEACCEL;
     return 0;
 }
 
+/* Stop the worker once it has encoded everything queued */
+void
+SDL_RLEEncodeQuit(void)
+{
+    SDL_Thread *thread;
+
+    if (!rle_lock) {
+        return;
+    }
+
+    SDL_LockMutex(rle_lock);
+    rle_quit = SDL_TRUE;
+    thread = rle_thread;
+    SDL_CondBroadcast(rle_cond);
+    SDL_UnlockMutex(rle_lock);
+
+    SDL_WaitThread(thread, NULL);
+
+    rle_thread = NULL;
+    rle_quit = SDL_FALSE;
+    SDL_DestroyCond(rle_cond);
+    SDL_DestroyMutex(rle_lock);
+    rle_cond = NULL;
+    rle_lock = NULL;
+}
+
 int
 SDL_RLESurface(SDL_Surface * surface)
 {
     int flags;
+    SDL_bool alpha;
+    Uint8 *data;
 
     /* Clear any previous RLE conversion */
     if ((surface->flags & SDL_RLEACCEL) == SDL_RLEACCEL) {
@@ -1433,26 +2011,42 @@ SDL_RLESurface(SDL_Surface * surface)
         return -1;
     }
 
-    /* Encode and set up the blit */
     if (!surface->format->Amask || !(flags & SDL_COPY_BLEND)) {
         if (!surface->map->identity) {
             return -1;
         }
-        if (RLEColorkeySurface(surface) < 0) {
-            return -1;
-        }
-        surface->map->blit = SDL_RLEBlit;
-        surface->map->info.flags |= SDL_COPY_RLE_COLORKEY;
+        alpha = SDL_FALSE;
     } else {
-        if (RLEAlphaSurface(surface) < 0) {
+        copy_func copy_opaque, copy_transl;
+
+        /* only 32bpp source supported */
+        if (!surface->map->dst || surface->format->BitsPerPixel != 32 ||
+            RLEAlphaCopyFuncs(surface->map->dst->format,
+                              &copy_opaque, &copy_transl) < 0) {
             return -1;
         }
-        surface->map->blit = SDL_RLEAlphaBlit;
-        surface->map->info.flags |= SDL_COPY_RLE_ALPHAKEY;
+        alpha = SDL_TRUE;
     }
 
-    /* The surface is now accelerated */
-    surface->flags |= SDL_RLEACCEL;
+    surface->map->rle_simd = SDL_BlitUseSIMD() && SDL_HasSSE2();
+
+    /* Encode large surfaces in the background if we're asked to */
+    if (surface->w * surface->h >= RLE_LAZY_MIN_PIXELS && surface->map->dst &&
+        SDL_GetHintBoolean(SDL_HINT_RLE_LAZY_ENCODE, SDL_FALSE) &&
+        RLEStartEncoding(surface, alpha) == 0) {
+        return 0;
+    }
+
+    /* Encode and set up the blit */
+    if (alpha) {
+        data = RLEAlphaEncode(surface, surface->map->dst->format, surface->map->rle_simd);
+    } else {
+        data = RLEColorkeyEncode(surface, surface->map->info.colorkey, surface->map->rle_simd);
+    }
+    if (!data) {
+        return -1;
+    }
+    RLEInstall(surface, data, alpha);
 
     return (0);
 }
@@ -1484,7 +2078,7 @@ UnRLEAlpha(SDL_Surface * surface)
         uncopy_opaque = uncopy_transl = uncopy_32;
     }
 
-    surface->pixels = SDL_malloc(surface->h * surface->pitch);
+    surface->pixels = SDL_AllocSurfacePixels(surface);
     if (!surface->pixels) {
         return (SDL_FALSE);
     }
@@ -1539,15 +2133,22 @@ UnRLEAlpha(SDL_Surface * surface)
 void
 SDL_UnRLESurface(SDL_Surface * surface, int recode)
 {
+    if (surface->map->rle_encoding) {
+        /* Not encoded yet, the pixels are still there */
+        RLEFinishEncoding(surface, SDL_FALSE);
+        return;
+    }
+
     if (surface->flags & SDL_RLEACCEL) {
         surface->flags &= ~SDL_RLEACCEL;
 
         if (recode && !(surface->flags & SDL_PREALLOC)) {
             if (surface->map->info.flags & SDL_COPY_RLE_COLORKEY) {
                 SDL_Rect full;
+                Uint8 alpha;
 
                 /* re-create the original surface */
-                surface->pixels = SDL_malloc(surface->h * surface->pitch);
+                surface->pixels = SDL_AllocSurfacePixels(surface);
                 if (!surface->pixels) {
                     /* Oh crap... */
                     surface->flags |= SDL_RLEACCEL;
@@ -1561,7 +2162,10 @@ SDL_UnRLESurface(SDL_Surface * surface, int recode)
                 full.x = full.y = 0;
                 full.w = surface->w;
                 full.h = surface->h;
+                alpha = surface->map->info.a;
+                surface->map->info.a = 255; /* copy, don't blend */
                 SDL_RLEBlit(surface, &full, surface, &full);
+                surface->map->info.a = alpha;
             } else {
                 if (!UnRLEAlpha(surface)) {
                     /* Oh crap... */
@@ -20,7 +20,11 @@
 */
 #include "../SDL_internal.h"
 
+#include "SDL_atomic.h"
 #include "SDL_video.h"
+#include "SDL_hints.h"
+#include "SDL_log.h"
+#include "SDL_thread.h"
 #include "SDL_sysvideo.h"
 #include "SDL_blit.h"
 #include "SDL_blit_auto.h"
@@ -29,8 +33,211 @@
 #include "SDL_RLEaccel_c.h"
 #include "SDL_pixels_c.h"
 
+/* Large blits are split into horizontal bands that run on worker threads.
+   A band must cover at least this many pixels to be worth handing to a thread. */
+#define SDL_BLIT_BAND_PIXELS    (256 * 1024)
+#define SDL_BLIT_MAX_BANDS      64
+
+typedef struct
+{
+    SDL_BlitFunc blit;
+    SDL_BlitInfo info;
+} SDL_BlitBand;
+
+/* Worker threads are started on the first banded blit and kept until
+   SDL_Quit().  One banded blit runs at a time, others use the caller. */
+static SDL_SpinLock blit_init_lock;
+static SDL_mutex *blit_lock;
+static SDL_cond *blit_cond;         /* bands were queued or quitting */
+static SDL_cond *blit_done_cond;    /* the last band of a blit finished */
+static SDL_Thread *blit_threads[SDL_BLIT_MAX_BANDS - 1];
+static int blit_num_threads;
+static SDL_bool blit_quit;
+static SDL_BlitBand *blit_bands;
+static int blit_next_band;
+static int blit_num_bands;
+static int blit_pending_bands;
+
+/* run queued bands until there are none left, called with blit_lock held */
+static void
+SDL_RunBlitBands(void)
+{
+    while (blit_bands && blit_next_band < blit_num_bands) {
+        SDL_BlitBand *band = &blit_bands[blit_next_band++];
+
+        SDL_UnlockMutex(blit_lock);
+        band->blit(&band->info);
+        SDL_LockMutex(blit_lock);
+
+        if (--blit_pending_bands == 0) {
+            SDL_CondBroadcast(blit_done_cond);
+        }
+    }
+}
+
+static int SDLCALL
+SDL_BlitBandThread(void *unused)
+{
+    SDL_LockMutex(blit_lock);
+    while (!blit_quit) {
+        SDL_RunBlitBands();
+        if (!blit_quit) {
+            SDL_CondWait(blit_cond, blit_lock);
+        }
+    }
+    SDL_UnlockMutex(blit_lock);
+    return 0;
+}
+
+static SDL_bool
+SDL_InitBlitThreads(void)
+{
+    SDL_AtomicLock(&blit_init_lock);
+    if (!blit_lock) {
+        blit_lock = SDL_CreateMutex();
+        blit_cond = SDL_CreateCond();
+        blit_done_cond = SDL_CreateCond();
+        if (!blit_lock || !blit_cond || !blit_done_cond) {
+            SDL_DestroyMutex(blit_lock);
+            SDL_DestroyCond(blit_cond);
+            SDL_DestroyCond(blit_done_cond);
+            blit_lock = NULL;
+            blit_cond = NULL;
+            blit_done_cond = NULL;
+        }
+    }
+    SDL_AtomicUnlock(&blit_init_lock);
+    return blit_lock ? SDL_TRUE : SDL_FALSE;
+}
+
+/* start more workers if needed, called with blit_lock held */
+static void
+SDL_StartBlitThreads(int num_threads)
+{
+    while (blit_num_threads < num_threads) {
+        SDL_Thread *thread = SDL_CreateThread(SDL_BlitBandThread, "SDLBlit", NULL);
+        if (!thread) {
+            break;  /* the calling thread picks up the slack */
+        }
+        blit_threads[blit_num_threads++] = thread;
+    }
+}
+
+static void
+SDL_RunBlit(SDL_BlitFunc RunBlit, SDL_BlitInfo * info)
+{
+    SDL_BlitBand bands[SDL_BLIT_MAX_BANDS];
+    const int pixels = info->dst_w * info->dst_h;
+    const Uint8 *src_end;
+    const Uint8 *dst_end;
+    const char *hint;
+    int num_bands;
+    int i, y;
+
+    /* Scaled blits step through the source relative to the whole rectangle */
+    if ((info->flags & SDL_COPY_NEAREST) || pixels < 2 * SDL_BLIT_BAND_PIXELS) {
+        RunBlit(info);
+        return;
+    }
+
+    /* Overlapping blits within a surface depend on the order rows are
+       copied in, so they can't be split up. */
+    src_end = info->src + (info->src_h - 1) * info->src_pitch +
+              info->src_w * info->src_fmt->BytesPerPixel;
+    dst_end = info->dst + (info->dst_h - 1) * info->dst_pitch +
+              info->dst_w * info->dst_fmt->BytesPerPixel;
+    if (info->src < dst_end && info->dst < src_end) {
+        RunBlit(info);
+        return;
+    }
+
+    /* threads are only used when asked for, see SDL_HINT_BLIT_THREADS */
+    hint = SDL_GetHint(SDL_HINT_BLIT_THREADS);
+    num_bands = hint ? SDL_atoi(hint) : 1;
+    if (num_bands <= 0) {
+        num_bands = SDL_GetCPUCount();
+    }
+    num_bands = SDL_min(num_bands, pixels / SDL_BLIT_BAND_PIXELS);
+    num_bands = SDL_min(num_bands, info->dst_h);
+    num_bands = SDL_min(num_bands, SDL_BLIT_MAX_BANDS);
+    if (num_bands <= 1) {
+        RunBlit(info);
+        return;
+    }
+
+    for (i = 0, y = 0; i < num_bands; ++i) {
+        const int rows = (info->dst_h * (i + 1)) / num_bands - y;
+
+        bands[i].blit = RunBlit;
+        bands[i].info = *info;
+        bands[i].info.src = info->src + y * info->src_pitch;
+        bands[i].info.dst = info->dst + y * info->dst_pitch;
+        bands[i].info.src_h = rows;
+        bands[i].info.dst_h = rows;
+        y += rows;
+    }
+
+    if (!SDL_InitBlitThreads()) {
+        RunBlit(info);
+        return;
+    }
+    SDL_LockMutex(blit_lock);
+
+    /* another thread is running a banded blit, don't wait for it */
+    if (blit_bands) {
+        SDL_UnlockMutex(blit_lock);
+        RunBlit(info);
+        return;
+    }
+
+    SDL_StartBlitThreads(num_bands - 1);
+    blit_bands = bands;
+    blit_next_band = 0;
+    blit_num_bands = num_bands;
+    blit_pending_bands = num_bands;
+    SDL_CondBroadcast(blit_cond);
+
+    /* the calling thread works on bands too, then waits for the rest */
+    SDL_RunBlitBands();
+    while (blit_pending_bands > 0) {
+        SDL_CondWait(blit_done_cond, blit_lock);
+    }
+    blit_bands = NULL;
+    SDL_UnlockMutex(blit_lock);
+}
+
+/* Stop the blit worker threads */
+void
+SDL_BlitThreadsQuit(void)
+{
+    int i;
+
+    if (!blit_lock) {
+        return;
+    }
+
+    SDL_LockMutex(blit_lock);
+    blit_quit = SDL_TRUE;
+    SDL_CondBroadcast(blit_cond);
+    SDL_UnlockMutex(blit_lock);
+
+    for (i = 0; i < blit_num_threads; ++i) {
+        SDL_WaitThread(blit_threads[i], NULL);
+        blit_threads[i] = NULL;
+    }
+    blit_num_threads = 0;
+
+    blit_quit = SDL_FALSE;
+    SDL_DestroyCond(blit_done_cond);
+    SDL_DestroyCond(blit_cond);
+    SDL_DestroyMutex(blit_lock);
+    blit_done_cond = NULL;
+    blit_cond = NULL;
+    blit_lock = NULL;
+}
+
 /* The general purpose software blit routine */
-static int
+int
 SDL_SoftBlit(SDL_Surface * src, SDL_Rect * srcrect,
              SDL_Surface * dst, SDL_Rect * dstrect)
 {
@@ -85,7 +292,7 @@ SDL_SoftBlit(SDL_Surface * src, SDL_Rect * srcrect,
         RunBlit = (SDL_BlitFunc) src->map->data;
 
         /* Run the actual software blit */
-        RunBlit(info);
+        SDL_RunBlit(RunBlit, info);
     }
 
     /* We need to unlock the surfaces if they're locked */
@@ -211,38 +418,37 @@ SDL_ChooseBlitFunc(Uint32 src_format, Uint32 dst_format, int flags,
     return NULL;
 }
 
-/* Figure out which of many blit routines to set up on a surface */
-int
-SDL_CalculateBlit(SDL_Surface * surface)
+/* Say which blits still fall back to the generic per-pixel blitter */
+static void
+LogSlowBlit(SDL_Surface * surface, SDL_BlitFunc blit)
+{
+    if (blit == SDL_Blit_Slow) {
+        SDL_LogDebug(SDL_LOG_CATEGORY_VIDEO,
+                     "Using slow blit from %s to %s, flags 0x%.8x",
+                     SDL_GetPixelFormatName(surface->format->format),
+                     SDL_GetPixelFormatName(surface->map->dst->format->format),
+                     surface->map->info.flags);
+    }
+}
+
+/* Choose the regular, non-RLE blit function for a surface */
+SDL_BlitFunc
+SDL_ChooseSoftBlit(SDL_Surface * surface)
 {
     SDL_BlitFunc blit = NULL;
     SDL_BlitMap *map = surface->map;
     SDL_Surface *dst = map->dst;
-
-    /* We don't currently support blitting to < 8 bpp surfaces */
-    if (dst->format->BitsPerPixel < 8) {
-        SDL_InvalidateMap(map);
-        return SDL_SetError("Blit combination not supported");
-    }
-
-    /* Clean everything out to start */
-    if ((surface->flags & SDL_RLEACCEL) == SDL_RLEACCEL) {
-        SDL_UnRLESurface(surface, 1);
-    }
-    map->blit = SDL_SoftBlit;
-    map->info.src_fmt = surface->format;
-    map->info.src_pitch = surface->pitch;
-    map->info.dst_fmt = dst->format;
-    map->info.dst_pitch = dst->pitch;
-
-    /* See if we can do RLE acceleration */
-    if (map->info.flags & SDL_COPY_RLE_DESIRED) {
-        if (SDL_RLESurface(surface) == 0) {
-            return 0;
+    const int simd = SDL_BlitUseSIMD() ? 1 : 0;
+
+    /* Another map between the same formats may have chosen already */
+    if (map->shared) {
+        blit = (SDL_BlitFunc) SDL_AtomicGetPtr(&map->shared->blit[simd]);
+        if (blit) {
+            LogSlowBlit(surface, blit);
+            return blit;
         }
     }
 
-    /* Choose a standard blit function */
     if (map->identity && !(map->info.flags & ~SDL_COPY_RLE_DESIRED)) {
         blit = SDL_BlitCopy;
     } else if (surface->format->BitsPerPixel < 8 &&
@@ -278,6 +484,53 @@ SDL_CalculateBlit(SDL_Surface * surface)
             blit = SDL_Blit_Slow;
         }
     }
+    if (map->shared && blit) {
+        SDL_AtomicSetPtr(&map->shared->blit[simd], (void *) blit);
+    }
+    LogSlowBlit(surface, blit);
+    return blit;
+}
+
+/* Whether the alpha blitters may pick their SIMD versions */
+SDL_bool
+SDL_BlitUseSIMD(void)
+{
+    return SDL_GetHintBoolean(SDL_HINT_BLIT_SIMD, SDL_TRUE);
+}
+
+/* Figure out which of many blit routines to set up on a surface */
+int
+SDL_CalculateBlit(SDL_Surface * surface)
+{
+    SDL_BlitFunc blit = NULL;
+    SDL_BlitMap *map = surface->map;
+    SDL_Surface *dst = map->dst;
+
+    /* We don't currently support blitting to < 8 bpp surfaces */
+    if (dst->format->BitsPerPixel < 8) {
+        SDL_InvalidateMap(map);
+        return SDL_SetError("Blit combination not supported");
+    }
+
+    /* Clean everything out to start */
+    if ((surface->flags & SDL_RLEACCEL) == SDL_RLEACCEL) {
+        SDL_UnRLESurface(surface, 1);
+    }
+    map->blit = SDL_SoftBlit;
+    map->info.src_fmt = surface->format;
+    map->info.src_pitch = surface->pitch;
+    map->info.dst_fmt = dst->format;
+    map->info.dst_pitch = dst->pitch;
+
+    /* See if we can do RLE acceleration */
+    if (map->info.flags & SDL_COPY_RLE_DESIRED) {
+        if (SDL_RLESurface(surface) == 0) {
+            return 0;
+        }
+    }
+
+    /* Choose a standard blit function */
+    blit = SDL_ChooseSoftBlit(surface);
     map->data = blit;
 
     /* Make sure we have a blit function */
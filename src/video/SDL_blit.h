@@ -82,6 +82,31 @@ typedef struct
 } SDL_BlitFuncEntry;
 
 /* Blit mapping definition */
+/* Mapping data shared by all blit maps between the same formats and
+   palettes with the same flags, see SDL_pixels.c */
+typedef struct SDL_BlitMapEntry
+{
+    Uint32 src_format;
+    Uint32 dst_format;
+    SDL_Palette *src_palette;
+    SDL_Palette *dst_palette;
+    Uint32 src_palette_version;
+    Uint32 dst_palette_version;
+    Uint32 flags;
+    Uint8 r, g, b, a;
+    SDL_bool same_format;
+
+    int identity;
+    Uint8 *table;
+    void *blit[2];              /* the regular blit function, if known,
+                                   without and with SIMD blitters allowed */
+
+    int refcount;
+    Uint32 last_used;
+    SDL_bool stale;             /* one of the palettes was freed */
+    struct SDL_BlitMapEntry *next;
+} SDL_BlitMapEntry;
+
 typedef struct SDL_BlitMap
 {
     SDL_Surface *dst;
@@ -89,6 +114,11 @@ typedef struct SDL_BlitMap
     SDL_blit blit;
     void *data;
     SDL_BlitInfo info;
+    SDL_BlitMapEntry *shared;
+
+    /* RLE encoding in progress on a background thread, see SDL_RLEaccel.c */
+    struct SDL_RLEEncoding *rle_encoding;
+    SDL_bool rle_simd;          /* the RLE encoding and blits may use SSE2 */
 
     /* the version count matches the destination; mismatch indicates
        an invalid mapping */
@@ -98,13 +128,23 @@ typedef struct SDL_BlitMap
 
 /* Functions found in SDL_blit.c */
 extern int SDL_CalculateBlit(SDL_Surface * surface);
+extern SDL_BlitFunc SDL_ChooseSoftBlit(SDL_Surface * surface);
+extern int SDL_SoftBlit(SDL_Surface * src, SDL_Rect * srcrect,
+                        SDL_Surface * dst, SDL_Rect * dstrect);
+extern void SDL_BlitThreadsQuit(void);
 
 /* Functions found in SDL_blit_*.c */
+extern SDL_bool SDL_BlitUseSIMD(void);
 extern SDL_BlitFunc SDL_CalculateBlit0(SDL_Surface * surface);
 extern SDL_BlitFunc SDL_CalculateBlit1(SDL_Surface * surface);
 extern SDL_BlitFunc SDL_CalculateBlitN(SDL_Surface * surface);
 extern SDL_BlitFunc SDL_CalculateBlitA(SDL_Surface * surface);
 
+/* Functions found in SDL_surface.c */
+extern int SDL_PrivateUpperBlitScaled(SDL_Surface * src, const SDL_Rect * srcrect,
+                                      SDL_Surface * dst, SDL_Rect * dstrect,
+                                      SDL_bool linear);
+
 /*
  * Useful macros for blitting routines
  */
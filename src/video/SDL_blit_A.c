@@ -389,6 +389,181 @@ BlitRGBtoRGBPixelAlphaMMX(SDL_BlitInfo * info)
 
 #endif /* __MMX__ */
 
+#ifdef __SSE2__
+
+/* Blends the RGB of 4 ARGB pixels like BlitRGBtoRGBSurfaceAlpha() does,
+   with (alpha) holding each pixel's alpha in its 32-bit lane. The C version
+   blends red and blue packed in one word, but each result stays in 0-255,
+   so nothing carries between channels and 16-bit lanes give the same
+   answer. The alpha channel of the result is left zero. */
+static SDL_INLINE __m128i
+BlendRGBx4SSE2(const __m128i s, const __m128i d, __m128i alpha)
+{
+    const __m128i mm_zero = _mm_setzero_si128();
+    const __m128i mm_lobyte = _mm_set1_epi16(0x00ff);
+    __m128i alo, ahi, slo, shi, dlo, dhi;
+
+    alpha = _mm_or_si128(alpha, _mm_slli_epi32(alpha, 16));
+    alo = _mm_unpacklo_epi32(alpha, alpha);     /* 0A0A0A0A for pixels 0,1 */
+    ahi = _mm_unpackhi_epi32(alpha, alpha);     /* 0A0A0A0A for pixels 2,3 */
+    slo = _mm_unpacklo_epi8(s, mm_zero);
+    shi = _mm_unpackhi_epi8(s, mm_zero);
+    dlo = _mm_unpacklo_epi8(d, mm_zero);
+    dhi = _mm_unpackhi_epi8(d, mm_zero);
+
+    /* d + ((s - d) * alpha >> 8), keeping the low byte */
+    dlo = _mm_add_epi16(dlo, _mm_srli_epi16(_mm_mullo_epi16(_mm_sub_epi16(slo, dlo), alo), 8));
+    dhi = _mm_add_epi16(dhi, _mm_srli_epi16(_mm_mullo_epi16(_mm_sub_epi16(shi, dhi), ahi), 8));
+    dlo = _mm_and_si128(dlo, mm_lobyte);
+    dhi = _mm_and_si128(dhi, mm_lobyte);
+    return _mm_and_si128(_mm_packus_epi16(dlo, dhi), _mm_set1_epi32(0x00ffffff));
+}
+
+/* fast RGB888->(A)RGB888 blending with surface alpha=128 special case */
+static void
+BlitRGBtoRGBSurfaceAlpha128SSE2(SDL_BlitInfo * info)
+{
+    int width = info->dst_w;
+    int height = info->dst_h;
+    Uint32 *srcp = (Uint32 *) info->src;
+    int srcskip = info->src_skip >> 2;
+    Uint32 *dstp = (Uint32 *) info->dst;
+    int dstskip = info->dst_skip >> 2;
+    const __m128i lsb = _mm_set1_epi32(0x00010101);
+    const __m128i dsta = _mm_set1_epi32(0xff000000);
+
+    while (height--) {
+        int n = width;
+        for (; n >= 4; n -= 4) {
+            const __m128i s = _mm_loadu_si128((const __m128i *) srcp);
+            const __m128i d = _mm_loadu_si128((const __m128i *) dstp);
+            /* _mm_avg_epu8 rounds up, the C version rounds down. */
+            __m128i avg = _mm_avg_epu8(s, d);
+            avg = _mm_sub_epi8(avg, _mm_and_si128(_mm_xor_si128(s, d), lsb));
+            _mm_storeu_si128((__m128i *) dstp, _mm_or_si128(avg, dsta));
+            srcp += 4;
+            dstp += 4;
+        }
+        while (n--) {
+            Uint32 s = *srcp++;
+            Uint32 d = *dstp;
+            *dstp++ = ((((s & 0x00fefefe) + (d & 0x00fefefe)) >> 1)
+                       + (s & d & 0x00010101)) | 0xff000000;
+        }
+        srcp += srcskip;
+        dstp += dstskip;
+    }
+}
+
+/* fast RGB888->(A)RGB888 blending with surface alpha */
+static void
+BlitRGBtoRGBSurfaceAlphaSSE2(SDL_BlitInfo * info)
+{
+    unsigned alpha = info->a;
+    if (alpha == 128) {
+        BlitRGBtoRGBSurfaceAlpha128SSE2(info);
+    } else {
+        int width = info->dst_w;
+        int height = info->dst_h;
+        Uint32 *srcp = (Uint32 *) info->src;
+        int srcskip = info->src_skip >> 2;
+        Uint32 *dstp = (Uint32 *) info->dst;
+        int dstskip = info->dst_skip >> 2;
+        const __m128i mm_alpha = _mm_set1_epi32(alpha);
+        const __m128i dsta = _mm_set1_epi32(0xff000000);
+
+        while (height--) {
+            int n = width;
+            for (; n >= 4; n -= 4) {
+                const __m128i s = _mm_loadu_si128((const __m128i *) srcp);
+                const __m128i d = _mm_loadu_si128((const __m128i *) dstp);
+                const __m128i rgb = BlendRGBx4SSE2(s, d, mm_alpha);
+                _mm_storeu_si128((__m128i *) dstp, _mm_or_si128(rgb, dsta));
+                srcp += 4;
+                dstp += 4;
+            }
+            while (n--) {
+                Uint32 s = *srcp;
+                Uint32 d = *dstp;
+                Uint32 s1 = s & 0xff00ff;
+                Uint32 d1 = d & 0xff00ff;
+                d1 = (d1 + ((s1 - d1) * alpha >> 8)) & 0xff00ff;
+                s &= 0xff00;
+                d &= 0xff00;
+                d = (d + ((s - d) * alpha >> 8)) & 0xff00;
+                *dstp = d1 | d | 0xff000000;
+                ++srcp;
+                ++dstp;
+            }
+            srcp += srcskip;
+            dstp += dstskip;
+        }
+    }
+}
+
+/* fast ARGB888->(A)RGB888 blending with pixel alpha */
+static void
+BlitRGBtoRGBPixelAlphaSSE2(SDL_BlitInfo * info)
+{
+    int width = info->dst_w;
+    int height = info->dst_h;
+    Uint32 *srcp = (Uint32 *) info->src;
+    int srcskip = info->src_skip >> 2;
+    Uint32 *dstp = (Uint32 *) info->dst;
+    int dstskip = info->dst_skip >> 2;
+    const __m128i mm_zero = _mm_setzero_si128();
+    const __m128i mm_opaque = _mm_set1_epi32(SDL_ALPHA_OPAQUE);
+
+    while (height--) {
+        int n = width;
+        for (; n >= 4; n -= 4) {
+            const __m128i s = _mm_loadu_si128((const __m128i *) srcp);
+            const __m128i d = _mm_loadu_si128((const __m128i *) dstp);
+            const __m128i alpha = _mm_srli_epi32(s, 24);
+            const __m128i opaque = _mm_cmpeq_epi32(alpha, mm_opaque);
+            const __m128i clear = _mm_cmpeq_epi32(alpha, mm_zero);
+            __m128i dalpha = _mm_srli_epi32(d, 24);
+            __m128i res;
+
+            /* dalpha * (255 - alpha) fits in 16 bits. */
+            dalpha = _mm_mullo_epi16(dalpha, _mm_xor_si128(alpha, mm_opaque));
+            dalpha = _mm_add_epi32(alpha, _mm_srli_epi32(dalpha, 8));
+            res = _mm_or_si128(BlendRGBx4SSE2(s, d, alpha), _mm_slli_epi32(dalpha, 24));
+
+            /* opaque pixels are copied and clear ones leave dst alone. */
+            res = _mm_or_si128(_mm_and_si128(opaque, s), _mm_andnot_si128(opaque, res));
+            res = _mm_or_si128(_mm_and_si128(clear, d), _mm_andnot_si128(clear, res));
+            _mm_storeu_si128((__m128i *) dstp, res);
+            srcp += 4;
+            dstp += 4;
+        }
+        while (n--) {
+            Uint32 s = *srcp;
+            Uint32 alpha = s >> 24;
+            if (alpha == SDL_ALPHA_OPAQUE) {
+                *dstp = s;
+            } else if (alpha) {
+                Uint32 d = *dstp;
+                Uint32 dalpha = d >> 24;
+                Uint32 s1 = s & 0xff00ff;
+                Uint32 d1 = d & 0xff00ff;
+                d1 = (d1 + ((s1 - d1) * alpha >> 8)) & 0xff00ff;
+                s &= 0xff00;
+                d &= 0xff00;
+                d = (d + ((s - d) * alpha >> 8)) & 0xff00;
+                dalpha = alpha + (dalpha * (alpha ^ 0xFF) >> 8);
+                *dstp = d1 | d | (dalpha << 24);
+            }
+            ++srcp;
+            ++dstp;
+        }
+        srcp += srcskip;
+        dstp += dstskip;
+    }
+}
+
+#endif /* __SSE2__ */
+
 /* fast RGB888->(A)RGB888 blending with surface alpha=128 special case */
 static void
 BlitRGBtoRGBSurfaceAlpha128(SDL_BlitInfo * info)
@@ -971,6 +1146,119 @@ Blit555to555SurfaceAlphaMMX(SDL_BlitInfo * info)
 
 #endif /* __MMX__ */
 
+#ifdef __SSE2__
+
+/* 16bpp blending of 8 pixels at 50%, same math as BLEND16_50 */
+static void
+Blit16to16SurfaceAlpha128SSE2(SDL_BlitInfo * info, Uint16 mask)
+{
+    int width = info->dst_w;
+    int height = info->dst_h;
+    Uint16 *srcp = (Uint16 *) info->src;
+    int srcskip = info->src_skip >> 1;
+    Uint16 *dstp = (Uint16 *) info->dst;
+    int dstskip = info->dst_skip >> 1;
+    const __m128i mm_mask = _mm_set1_epi16((short) mask);
+
+    while (height--) {
+        int n = width;
+        for (; n >= 8; n -= 8) {
+            const __m128i s = _mm_loadu_si128((const __m128i *) srcp);
+            const __m128i d = _mm_loadu_si128((const __m128i *) dstp);
+            /* mask clears each channel's low bit, so halving first can't lose anything. */
+            __m128i res = _mm_add_epi16(_mm_srli_epi16(_mm_and_si128(s, mm_mask), 1),
+                                        _mm_srli_epi16(_mm_and_si128(d, mm_mask), 1));
+            res = _mm_add_epi16(res, _mm_andnot_si128(mm_mask, _mm_and_si128(s, d)));
+            _mm_storeu_si128((__m128i *) dstp, res);
+            srcp += 8;
+            dstp += 8;
+        }
+        while (n--) {
+            Uint16 d = *dstp, s = *srcp++;
+            *dstp++ = BLEND16_50(d, s, mask);
+        }
+        srcp += srcskip;
+        dstp += dstskip;
+    }
+}
+
+/* Blends 8 16bpp pixels one channel at a time. The C version packs all
+   three channels into one 32-bit word, but each blended channel stays
+   within its original range, so nothing carries between them and the
+   results come out the same. */
+static void
+Blit16to16SurfaceAlphaSSE2(SDL_BlitInfo * info, Uint32 mask, int rshift, Uint16 gmask)
+{
+    int width = info->dst_w;
+    int height = info->dst_h;
+    Uint16 *srcp = (Uint16 *) info->src;
+    int srcskip = info->src_skip >> 1;
+    Uint16 *dstp = (Uint16 *) info->dst;
+    int dstskip = info->dst_skip >> 1;
+    unsigned alpha = info->a >> 3;      /* downscale alpha to 5 bits */
+    const __m128i mm_alpha = _mm_set1_epi16((short) alpha);
+    const __m128i mm_5bits = _mm_set1_epi16(0x1f);
+    const __m128i mm_gmask = _mm_set1_epi16((short) gmask);
+
+    while (height--) {
+        int n = width;
+        for (; n >= 8; n -= 8) {
+            const __m128i s = _mm_loadu_si128((const __m128i *) srcp);
+            const __m128i d = _mm_loadu_si128((const __m128i *) dstp);
+            __m128i dB = _mm_and_si128(d, mm_5bits);
+            __m128i dG = _mm_and_si128(_mm_srli_epi16(d, 5), mm_gmask);
+            __m128i dR = _mm_and_si128(_mm_srli_epi16(d, rshift), mm_5bits);
+            const __m128i sB = _mm_and_si128(s, mm_5bits);
+            const __m128i sG = _mm_and_si128(_mm_srli_epi16(s, 5), mm_gmask);
+            const __m128i sR = _mm_and_si128(_mm_srli_epi16(s, rshift), mm_5bits);
+
+            /* d + ((s - d) * alpha >> 5), with an arithmetic shift */
+            dB = _mm_add_epi16(dB, _mm_srai_epi16(_mm_mullo_epi16(_mm_sub_epi16(sB, dB), mm_alpha), 5));
+            dG = _mm_add_epi16(dG, _mm_srai_epi16(_mm_mullo_epi16(_mm_sub_epi16(sG, dG), mm_alpha), 5));
+            dR = _mm_add_epi16(dR, _mm_srai_epi16(_mm_mullo_epi16(_mm_sub_epi16(sR, dR), mm_alpha), 5));
+            dB = _mm_or_si128(dB, _mm_slli_epi16(dG, 5));
+            _mm_storeu_si128((__m128i *) dstp, _mm_or_si128(dB, _mm_slli_epi16(dR, rshift)));
+            srcp += 8;
+            dstp += 8;
+        }
+        while (n--) {
+            Uint32 s = *srcp++;
+            Uint32 d = *dstp;
+            s = (s | s << 16) & mask;
+            d = (d | d << 16) & mask;
+            d += (s - d) * alpha >> 5;
+            d &= mask;
+            *dstp++ = (Uint16)(d | d >> 16);
+        }
+        srcp += srcskip;
+        dstp += dstskip;
+    }
+}
+
+/* fast RGB565->RGB565 blending with surface alpha */
+static void
+Blit565to565SurfaceAlphaSSE2(SDL_BlitInfo * info)
+{
+    if (info->a == 128) {
+        Blit16to16SurfaceAlpha128SSE2(info, 0xf7de);
+    } else {
+        Blit16to16SurfaceAlphaSSE2(info, 0x07e0f81f, 11, 0x3f);
+    }
+}
+
+/* fast RGB555->RGB555 blending with surface alpha */
+static void
+Blit555to555SurfaceAlphaSSE2(SDL_BlitInfo * info)
+{
+    if (info->a == 128) {
+        Blit16to16SurfaceAlpha128SSE2(info, 0xfbde);
+    } else {
+        Blit16to16SurfaceAlphaSSE2(info, 0x03e07c1f, 10, 0x1f);
+    }
+}
+
+#endif /* __SSE2__ */
+
 /* fast RGB565->RGB565 blending with surface alpha */
 static void
 Blit565to565SurfaceAlpha(SDL_BlitInfo * info)
@@ -1265,6 +1553,11 @@ BlitNtoNPixelAlpha(SDL_BlitInfo * info)
 }
 
 
+/* The SIMD blitters can be turned off with SDL_HINT_BLIT_SIMD */
+#define HAVE_SSE2_BLIT()    (SDL_BlitUseSIMD() && SDL_HasSSE2())
+#define HAVE_MMX_BLIT()     (SDL_BlitUseSIMD() && SDL_HasMMX())
+#define HAVE_3DNOW_BLIT()   (SDL_BlitUseSIMD() && SDL_Has3DNow())
+
 SDL_BlitFunc
 SDL_CalculateBlitA(SDL_Surface * surface)
 {
@@ -1294,17 +1587,21 @@ SDL_CalculateBlitA(SDL_Surface * surface)
             if (sf->Rmask == df->Rmask
                 && sf->Gmask == df->Gmask
                 && sf->Bmask == df->Bmask && sf->BytesPerPixel == 4) {
+#ifdef __SSE2__
+                if (sf->Amask == 0xff000000 && HAVE_SSE2_BLIT())
+                    return BlitRGBtoRGBPixelAlphaSSE2;
+#endif
 #if defined(__MMX__) || defined(__3dNOW__)
                 if (sf->Rshift % 8 == 0
                     && sf->Gshift % 8 == 0
                     && sf->Bshift % 8 == 0
                     && sf->Ashift % 8 == 0 && sf->Aloss == 0) {
 #ifdef __3dNOW__
-                    if (SDL_Has3DNow())
+                    if (HAVE_3DNOW_BLIT())
                         return BlitRGBtoRGBPixelAlphaMMX3DNOW;
 #endif
 #ifdef __MMX__
-                    if (SDL_HasMMX())
+                    if (HAVE_MMX_BLIT())
                         return BlitRGBtoRGBPixelAlphaMMX;
 #endif
                 }
@@ -1331,15 +1628,23 @@ SDL_CalculateBlitA(SDL_Surface * surface)
             case 2:
                 if (surface->map->identity) {
                     if (df->Gmask == 0x7e0) {
+#ifdef __SSE2__
+                        if (HAVE_SSE2_BLIT())
+                            return Blit565to565SurfaceAlphaSSE2;
+#endif
 #ifdef __MMX__
-                        if (SDL_HasMMX())
+                        if (HAVE_MMX_BLIT())
                             return Blit565to565SurfaceAlphaMMX;
                         else
 #endif
                             return Blit565to565SurfaceAlpha;
                     } else if (df->Gmask == 0x3e0) {
+#ifdef __SSE2__
+                        if (HAVE_SSE2_BLIT())
+                            return Blit555to555SurfaceAlphaSSE2;
+#endif
 #ifdef __MMX__
-                        if (SDL_HasMMX())
+                        if (HAVE_MMX_BLIT())
                             return Blit555to555SurfaceAlphaMMX;
                         else
 #endif
@@ -1352,10 +1657,15 @@ SDL_CalculateBlitA(SDL_Surface * surface)
                 if (sf->Rmask == df->Rmask
                     && sf->Gmask == df->Gmask
                     && sf->Bmask == df->Bmask && sf->BytesPerPixel == 4) {
+#ifdef __SSE2__
+                    if ((sf->Rmask | sf->Gmask | sf->Bmask) == 0xffffff
+                        && HAVE_SSE2_BLIT())
+                        return BlitRGBtoRGBSurfaceAlphaSSE2;
+#endif
 #ifdef __MMX__
                     if (sf->Rshift % 8 == 0
                         && sf->Gshift % 8 == 0
-                        && sf->Bshift % 8 == 0 && SDL_HasMMX())
+                        && sf->Bshift % 8 == 0 && HAVE_MMX_BLIT())
                         return BlitRGBtoRGBSurfaceAlphaMMX;
 #endif
                     if ((sf->Rmask | sf->Gmask | sf->Bmask) == 0xffffff) {
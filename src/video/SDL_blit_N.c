@@ -2462,6 +2462,163 @@ BlitNto2101010(SDL_BlitInfo * info)
     }
 }
 
+#ifdef __SSE2__
+/* Reorders 24 and 32-bit pixels with 8-bit channels, four pixels at a time.
+   Every channel moves with one shift and mask, and channels that move by the
+   same amount share them, so most conversions take two or three steps. */
+typedef struct
+{
+    int count;
+    int shift[4];   /* in bits, negative values shift right */
+    Uint32 mask[4];
+    Uint32 alpha;   /* constant bits of every destination pixel */
+} SwizzleSSE2;
+
+static SDL_bool
+IsByteAlignedRGB(const SDL_PixelFormat * fmt)
+{
+    return (fmt->BytesPerPixel == 3 || fmt->BytesPerPixel == 4) &&
+           !fmt->Rloss && !fmt->Gloss && !fmt->Bloss &&
+           !(fmt->Rshift & 7) && !(fmt->Gshift & 7) && !(fmt->Bshift & 7);
+}
+
+static SDL_bool
+IsByteAlignedAlpha(const SDL_PixelFormat * fmt)
+{
+    return fmt->Amask && !fmt->Aloss && !(fmt->Ashift & 7);
+}
+
+static void
+AddSwizzleChannel(SwizzleSSE2 * swizzle, int srcshift, int dstshift, Uint32 dstmask)
+{
+    const int shift = dstshift - srcshift;
+    int i;
+
+    for (i = 0; i < swizzle->count; ++i) {
+        if (swizzle->shift[i] == shift) {
+            break;
+        }
+    }
+    if (i == swizzle->count) {
+        swizzle->shift[i] = shift;
+        swizzle->mask[i] = 0;
+        ++swizzle->count;
+    }
+    swizzle->mask[i] |= dstmask;
+}
+
+static SDL_INLINE Uint32
+SwizzlePixel(const SwizzleSSE2 * swizzle, Uint32 pixel)
+{
+    Uint32 result = swizzle->alpha;
+    int i;
+
+    for (i = 0; i < swizzle->count; ++i) {
+        const int shift = swizzle->shift[i];
+        result |= ((shift >= 0) ? (pixel << shift) : (pixel >> -shift)) & swizzle->mask[i];
+    }
+    return result;
+}
+
+static void
+BlitNtoNSwizzleSSE2(SDL_BlitInfo * info)
+{
+    int height = info->dst_h;
+    Uint8 *src = info->src;
+    int srcskip = info->src_skip;
+    Uint8 *dst = info->dst;
+    int dstskip = info->dst_skip;
+    SDL_PixelFormat *srcfmt = info->src_fmt;
+    SDL_PixelFormat *dstfmt = info->dst_fmt;
+    const int srcbpp = srcfmt->BytesPerPixel;
+    const int dstbpp = dstfmt->BytesPerPixel;
+    SwizzleSSE2 swizzle;
+    __m128i count[4], mask[4], alpha;
+    int i;
+
+    swizzle.count = 0;
+    AddSwizzleChannel(&swizzle, srcfmt->Rshift, dstfmt->Rshift, dstfmt->Rmask);
+    AddSwizzleChannel(&swizzle, srcfmt->Gshift, dstfmt->Gshift, dstfmt->Gmask);
+    AddSwizzleChannel(&swizzle, srcfmt->Bshift, dstfmt->Bshift, dstfmt->Bmask);
+    if (srcfmt->Amask && dstfmt->Amask) {
+        AddSwizzleChannel(&swizzle, srcfmt->Ashift, dstfmt->Ashift, dstfmt->Amask);
+        swizzle.alpha = 0;
+    } else if (dstfmt->Amask) {
+        swizzle.alpha = ((info->a >> dstfmt->Aloss) << dstfmt->Ashift) & dstfmt->Amask;
+    } else {
+        swizzle.alpha = 0;
+    }
+    for (i = 0; i < swizzle.count; ++i) {
+        count[i] = _mm_cvtsi32_si128(SDL_abs(swizzle.shift[i]));
+        mask[i] = _mm_set1_epi32(swizzle.mask[i]);
+    }
+    alpha = _mm_set1_epi32(swizzle.alpha);
+
+    while (height--) {
+        int n = info->dst_w;
+
+        for (; n >= 4; n -= 4) {
+            __m128i s, d;
+
+            if (srcbpp == 4) {
+                s = _mm_loadu_si128((const __m128i *)src);
+            } else {
+                /* spread the 12 bytes out to one pixel per 32-bit lane */
+                const __m128i lo = _mm_loadl_epi64((const __m128i *)src);
+                const __m128i p = _mm_unpacklo_epi64(lo, _mm_cvtsi32_si128(*(Uint32 *)(src + 8)));
+                s = _mm_unpacklo_epi64(
+                        _mm_unpacklo_epi32(p, _mm_srli_si128(p, 3)),
+                        _mm_unpacklo_epi32(_mm_srli_si128(p, 6), _mm_srli_si128(p, 9)));
+            }
+
+            d = alpha;
+            for (i = 0; i < swizzle.count; ++i) {
+                const __m128i moved = (swizzle.shift[i] >= 0) ?
+                    _mm_sll_epi32(s, count[i]) : _mm_srl_epi32(s, count[i]);
+                d = _mm_or_si128(d, _mm_and_si128(moved, mask[i]));
+            }
+
+            if (dstbpp == 4) {
+                _mm_storeu_si128((__m128i *)dst, d);
+            } else {
+                /* pack the low 3 bytes of each lane back together */
+                const __m128i lane = _mm_setr_epi32(0x00FFFFFF, 0, 0, 0);
+                d = _mm_or_si128(
+                        _mm_or_si128(_mm_and_si128(d, lane),
+                                     _mm_srli_si128(_mm_and_si128(d, _mm_slli_si128(lane, 4)), 1)),
+                        _mm_or_si128(_mm_srli_si128(_mm_and_si128(d, _mm_slli_si128(lane, 8)), 2),
+                                     _mm_srli_si128(_mm_and_si128(d, _mm_slli_si128(lane, 12)), 3)));
+                _mm_storel_epi64((__m128i *)dst, d);
+                *(Uint32 *)(dst + 8) = (Uint32)_mm_cvtsi128_si32(_mm_srli_si128(d, 8));
+            }
+            src += 4 * srcbpp;
+            dst += 4 * dstbpp;
+        }
+        while (n--) {
+            Uint32 Pixel;
+
+            if (srcbpp == 4) {
+                Pixel = *(Uint32 *)src;
+            } else {
+                Pixel = src[0] | ((Uint32)src[1] << 8) | ((Uint32)src[2] << 16);
+            }
+            Pixel = SwizzlePixel(&swizzle, Pixel);
+            if (dstbpp == 4) {
+                *(Uint32 *)dst = Pixel;
+            } else {
+                dst[0] = (Uint8)Pixel;
+                dst[1] = (Uint8)(Pixel >> 8);
+                dst[2] = (Uint8)(Pixel >> 16);
+            }
+            src += srcbpp;
+            dst += dstbpp;
+        }
+        src += srcskip;
+        dst += dstskip;
+    }
+}
+#endif /* __SSE2__ */
+
 /* Normal N to N optimized blitters */
 #define NO_ALPHA   1
 #define SET_ALPHA  2
@@ -2610,6 +2767,14 @@ SDL_CalculateBlitN(SDL_Surface * surface)
                         /* Fastpath C fallback: 32bit RGB<->RGBA blit with matching RGB */
                         blitfun = Blit4to4MaskAlpha;
                     }
+#ifdef __SSE2__
+                } else if (IsByteAlignedRGB(srcfmt) &&
+                           IsByteAlignedRGB(dstfmt) &&
+                           (a_need != COPY_ALPHA ||
+                            (IsByteAlignedAlpha(srcfmt) && IsByteAlignedAlpha(dstfmt))) &&
+                           SDL_HasSSE2()) {
+                    blitfun = BlitNtoNSwizzleSSE2;
+#endif
                 } else if (a_need == COPY_ALPHA) {
                     blitfun = BlitNtoNCopyAlpha;
                 }
@@ -37,6 +37,7 @@
 #include "SDL_assert.h"
 #include "SDL_endian.h"
 #include "SDL_pixels_c.h"
+#include "../file/SDL_rwops_c.h"
 
 #define SAVE_32BIT_BMP
 
@@ -83,8 +84,114 @@ static void CorrectAlphaChannel(SDL_Surface *surface)
     }
 }
 
+/* Decodes the rows of an uncompressed image straight into a new surface of
+   the given format. The file pixels are read through a memory mapping when
+   the stream allows it, or with a single read otherwise. The image surface
+   has the format and palette of the file, and no pixels of its own. */
+static SDL_Surface *
+LoadBMPPixels(SDL_RWops * src, Sint64 offset, SDL_Surface * image,
+              SDL_bool topDown, SDL_bool correctAlpha, Uint32 format)
+{
+    /* Rows are padded to 4 bytes in the file */
+    const int bmpPitch = (image->w * image->format->BytesPerPixel + 3) & ~3;
+    const size_t size = (size_t) bmpPitch * image->h;
+    SDL_RWmapping mapping;
+    SDL_Surface *surface = NULL;
+    SDL_Surface *view = NULL;
+    SDL_Rect srcrect, dstrect;
+    Uint8 *buffer = NULL;
+    const Uint8 *data;
+    int x, y;
+
+    data = (const Uint8 *) SDL_RWmap(src, offset, size, &mapping);
+    if (!data) {
+        buffer = (Uint8 *) SDL_malloc(size ? size : 1);
+        if (!buffer) {
+            SDL_OutOfMemory();
+            return NULL;
+        }
+        if (SDL_RWseek(src, offset, RW_SEEK_SET) < 0) {
+            SDL_Error(SDL_EFSEEK);
+            goto done;
+        }
+        if (SDL_RWread(src, buffer, 1, size) != size) {
+            SDL_Error(SDL_EFREAD);
+            goto done;
+        }
+        data = buffer;
+    }
+
+    /* Without any alpha data, 32-bit images are opaque */
+    view = image;
+    if (correctAlpha) {
+        SDL_bool hasAlpha = SDL_FALSE;
+        for (y = 0; y < image->h && !hasAlpha; ++y) {
+            const Uint8 *alpha = data + y * bmpPitch + 3;
+            for (x = 0; x < image->w; ++x, alpha += 4) {
+                if (*alpha) {
+                    hasAlpha = SDL_TRUE;
+                    break;
+                }
+            }
+        }
+        if (!hasAlpha) {
+            view = SDL_CreateRGBSurfaceWithFormatFrom(NULL, image->w, image->h,
+                                                      32, 0, SDL_PIXELFORMAT_RGB888);
+            if (!view) {
+                goto done;
+            }
+        }
+    }
+
+    surface = SDL_CreateRGBSurfaceWithFormat(0, image->w, image->h, 0, format);
+    if (!surface) {
+        goto done;
+    }
+
+    view->pixels = (void *) data;
+    view->pitch = bmpPitch;
+    SDL_SetSurfaceBlendMode(view, SDL_BLENDMODE_NONE);
+    srcrect.x = dstrect.x = 0;
+    srcrect.y = dstrect.y = 0;
+    srcrect.w = dstrect.w = image->w;
+    if (topDown) {
+        srcrect.h = dstrect.h = image->h;
+        if (SDL_LowerBlit(view, &srcrect, surface, &dstrect) < 0) {
+            SDL_FreeSurface(surface);
+            surface = NULL;
+        }
+    } else {
+        /* The rows are stored bottom up */
+        srcrect.h = dstrect.h = 1;
+        for (y = 0; y < image->h; ++y) {
+            srcrect.y = image->h - 1 - y;
+            dstrect.y = y;
+            if (SDL_LowerBlit(view, &srcrect, surface, &dstrect) < 0) {
+                SDL_FreeSurface(surface);
+                surface = NULL;
+                break;
+            }
+        }
+    }
+    view->pixels = NULL;
+
+  done:
+    if (view && view != image) {
+        SDL_FreeSurface(view);
+    }
+    SDL_RWunmap(&mapping);
+    SDL_free(buffer);
+    return surface;
+}
+
 SDL_Surface *
 SDL_LoadBMP_RW(SDL_RWops * src, int freesrc)
+{
+    return SDL_LoadBMPWithFormat_RW(src, freesrc, SDL_PIXELFORMAT_UNKNOWN);
+}
+
+SDL_Surface *
+SDL_LoadBMPWithFormat_RW(SDL_RWops * src, int freesrc, Uint32 format)
 {
     SDL_bool was_error;
     Sint64 fp_offset = 0;
@@ -103,6 +210,7 @@ SDL_LoadBMP_RW(SDL_RWops * src, int freesrc)
     SDL_bool haveRGBMasks = SDL_FALSE;
     SDL_bool haveAlphaMask = SDL_FALSE;
     SDL_bool correctAlpha = SDL_FALSE;
+    SDL_bool direct = SDL_FALSE;
 
     /* The Win32 BMP file header (14 bytes) */
     char magic[2];
@@ -298,10 +406,27 @@ SDL_LoadBMP_RW(SDL_RWops * src, int freesrc)
         goto done;
     }
 
+#if SDL_BYTEORDER == SDL_LIL_ENDIAN
+    /* Decode straight into RGB formats when the file layout is known */
+    if (format != SDL_PIXELFORMAT_UNKNOWN && !ExpandBMP &&
+        !SDL_ISPIXELFORMAT_INDEXED(format) &&
+        !SDL_ISPIXELFORMAT_FOURCC(format)) {
+        direct = (biBitCount == 8 ||
+                  SDL_MasksToPixelFormatEnum(biBitCount, Rmask, Gmask, Bmask,
+                                             Amask) != SDL_PIXELFORMAT_UNKNOWN);
+    }
+#endif
+
     /* Create a compatible surface, note that the colors are RGB ordered */
-    surface =
-        SDL_CreateRGBSurface(0, biWidth, biHeight, biBitCount, Rmask, Gmask,
-                             Bmask, Amask);
+    if (direct) {
+        surface =
+            SDL_CreateRGBSurfaceFrom(NULL, biWidth, biHeight, biBitCount, 0,
+                                     Rmask, Gmask, Bmask, Amask);
+    } else {
+        surface =
+            SDL_CreateRGBSurface(0, biWidth, biHeight, biBitCount, Rmask,
+                                 Gmask, Bmask, Amask);
+    }
     if (surface == NULL) {
         was_error = SDL_TRUE;
         goto done;
@@ -354,6 +479,19 @@ SDL_LoadBMP_RW(SDL_RWops * src, int freesrc)
         }
     }
 
+    if (direct) {
+        SDL_Surface *converted = LoadBMPPixels(src, fp_offset + bfOffBits,
+                                               surface, topDown, correctAlpha,
+                                               format);
+        if (converted == NULL) {
+            was_error = SDL_TRUE;
+            goto done;
+        }
+        SDL_FreeSurface(surface);
+        surface = converted;
+        goto done;
+    }
+
     /* Read the surface pixels.  Note that the bmp image is upside down */
     if (SDL_RWseek(src, fp_offset + bfOffBits, RW_SEEK_SET) < 0) {
         SDL_Error(SDL_EFSEEK);
@@ -372,7 +510,9 @@ SDL_LoadBMP_RW(SDL_RWops * src, int freesrc)
         pad = (((bmpPitch) % 4) ? (4 - ((bmpPitch) % 4)) : 0);
         break;
     default:
-        pad = ((surface->pitch % 4) ? (4 - (surface->pitch % 4)) : 0);
+        /* The surface rows may be padded further than the file rows */
+        bmpPitch = (surface->w * surface->format->BytesPerPixel + 3) & ~3;
+        pad = 0;
         break;
     }
     if (topDown) {
@@ -401,8 +541,7 @@ SDL_LoadBMP_RW(SDL_RWops * src, int freesrc)
             break;
 
         default:
-            if (SDL_RWread(src, bits, 1, surface->pitch)
-                != surface->pitch) {
+            if (SDL_RWread(src, bits, 1, bmpPitch) != bmpPitch) {
                 SDL_Error(SDL_EFREAD);
                 was_error = SDL_TRUE;
                 goto done;
@@ -445,6 +584,15 @@ SDL_LoadBMP_RW(SDL_RWops * src, int freesrc)
     if (correctAlpha) {
         CorrectAlphaChannel(surface);
     }
+    if (format != SDL_PIXELFORMAT_UNKNOWN && format != surface->format->format) {
+        SDL_Surface *converted = SDL_ConvertSurfaceFormat(surface, format, 0);
+        if (converted == NULL) {
+            was_error = SDL_TRUE;
+            goto done;
+        }
+        SDL_FreeSurface(surface);
+        surface = converted;
+    }
   done:
     if (was_error) {
         if (src) {
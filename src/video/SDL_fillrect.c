@@ -21,7 +21,19 @@
 #include "../SDL_internal.h"
 
 #include "SDL_video.h"
+#include "SDL_sysvideo.h"
 #include "SDL_blit.h"
+#include "SDL_RLEaccel_c.h"
+
+#ifdef __AVX__
+#include <immintrin.h>
+#endif
+
+/* Fills covering at least this many bytes use non-temporal stores, which
+   write around the cache instead of evicting everything else from it for
+   pixels that won't be read until the next frame. Smaller fills use
+   regular stores, since they are usually drawn over or read back soon. */
+#define SDL_FILLRECT_STREAM_BYTES   (1024 * 1024)
 
 
 #ifdef __SSE__
@@ -46,19 +58,33 @@
 #endif
 
 #define SSE_WORK \
-    for (i = n / 64; i--;) { \
-        _mm_stream_ps((float *)(p+0), c128); \
-        _mm_stream_ps((float *)(p+16), c128); \
-        _mm_stream_ps((float *)(p+32), c128); \
-        _mm_stream_ps((float *)(p+48), c128); \
-        p += 64; \
+    if (stream) { \
+        for (i = n / 64; i--;) { \
+            _mm_stream_ps((float *)(p+0), c128); \
+            _mm_stream_ps((float *)(p+16), c128); \
+            _mm_stream_ps((float *)(p+32), c128); \
+            _mm_stream_ps((float *)(p+48), c128); \
+            p += 64; \
+        } \
+    } else { \
+        for (i = n / 64; i--;) { \
+            _mm_store_ps((float *)(p+0), c128); \
+            _mm_store_ps((float *)(p+16), c128); \
+            _mm_store_ps((float *)(p+32), c128); \
+            _mm_store_ps((float *)(p+48), c128); \
+            p += 64; \
+        } \
     }
 
-#define SSE_END
+/* Non-temporal stores aren't ordered with other stores until a fence */
+#define SSE_END \
+    if (stream) { \
+        _mm_sfence(); \
+    }
 
 #define DEFINE_SSE_FILLRECT(bpp, type) \
 static void \
-SDL_FillRect##bpp##SSE(Uint8 *pixels, int pitch, Uint32 color, int w, int h) \
+SDL_FillRect##bpp##SSE(Uint8 *pixels, int pitch, Uint32 color, int w, int h, SDL_bool stream) \
 { \
     int i, n; \
     Uint8 *p = NULL; \
@@ -96,7 +122,7 @@ SDL_FillRect##bpp##SSE(Uint8 *pixels, int pitch, Uint32 color, int w, int h) \
 }
 
 static void
-SDL_FillRect1SSE(Uint8 *pixels, int pitch, Uint32 color, int w, int h)
+SDL_FillRect1SSE(Uint8 *pixels, int pitch, Uint32 color, int w, int h, SDL_bool stream)
 {
     int i, n;
 
@@ -107,7 +133,7 @@ SDL_FillRect1SSE(Uint8 *pixels, int pitch, Uint32 color, int w, int h)
 
         if (n > 63) {
             int adjust = 16 - ((uintptr_t)p & 15);
-            if (adjust) {
+            if (adjust < 16) {
                 n -= adjust;
                 SDL_memset(p, color, adjust);
                 p += adjust;
@@ -127,9 +153,145 @@ SDL_FillRect1SSE(Uint8 *pixels, int pitch, Uint32 color, int w, int h)
 DEFINE_SSE_FILLRECT(2, Uint16)
 DEFINE_SSE_FILLRECT(4, Uint32)
 
+/* 24-bit pixels repeat every 48 bytes, three vectors of the color */
+static void
+SDL_FillRect3SSE(Uint8 *pixels, int pitch, Uint32 color, int w, int h, SDL_bool stream)
+{
+    Uint8 b1 = (Uint8) (color & 0xFF);
+    Uint8 b2 = (Uint8) ((color >> 8) & 0xFF);
+    Uint8 b3 = (Uint8) ((color >> 16) & 0xFF);
+    Uint8 pattern[48];
+    __m128 c0, c1, c2;
+    int i, n;
+
+    for (i = 0; i < 48; i += 3) {
+        pattern[i + 0] = b1;
+        pattern[i + 1] = b2;
+        pattern[i + 2] = b3;
+    }
+    c0 = _mm_loadu_ps((const float *)(pattern+0));
+    c1 = _mm_loadu_ps((const float *)(pattern+16));
+    c2 = _mm_loadu_ps((const float *)(pattern+32));
+
+    while (h--) {
+        Uint8 *p = pixels;
+        n = w;
+
+        if (n >= 32) {
+            /* 3 and 16 have no common factors, so this takes at most 15 pixels */
+            while ((uintptr_t)p & 15) {
+                *p++ = b1;
+                *p++ = b2;
+                *p++ = b3;
+                --n;
+            }
+            if (stream) {
+                for (i = n / 16; i--;) {
+                    _mm_stream_ps((float *)(p+0), c0);
+                    _mm_stream_ps((float *)(p+16), c1);
+                    _mm_stream_ps((float *)(p+32), c2);
+                    p += 48;
+                }
+            } else {
+                for (i = n / 16; i--;) {
+                    _mm_store_ps((float *)(p+0), c0);
+                    _mm_store_ps((float *)(p+16), c1);
+                    _mm_store_ps((float *)(p+32), c2);
+                    p += 48;
+                }
+            }
+            n &= 15;
+        }
+        while (n--) {
+            *p++ = b1;
+            *p++ = b2;
+            *p++ = b3;
+        }
+        pixels += pitch;
+    }
+
+    SSE_END;
+}
+
 /* *INDENT-ON* */
 #endif /* __SSE__ */
 
+#ifdef __AVX__
+/* *INDENT-OFF* */
+
+#define AVX_BEGIN \
+    const __m256 c256 = _mm256_castsi256_ps(_mm256_set1_epi32((int)color));
+
+#define AVX_WORK \
+    if (stream) { \
+        for (i = n / 128; i--;) { \
+            _mm256_stream_ps((float *)(p+0), c256); \
+            _mm256_stream_ps((float *)(p+32), c256); \
+            _mm256_stream_ps((float *)(p+64), c256); \
+            _mm256_stream_ps((float *)(p+96), c256); \
+            p += 128; \
+        } \
+    } else { \
+        for (i = n / 128; i--;) { \
+            _mm256_store_ps((float *)(p+0), c256); \
+            _mm256_store_ps((float *)(p+32), c256); \
+            _mm256_store_ps((float *)(p+64), c256); \
+            _mm256_store_ps((float *)(p+96), c256); \
+            p += 128; \
+        } \
+    }
+
+#define AVX_END \
+    if (stream) { \
+        _mm_sfence(); \
+    }
+
+#define DEFINE_AVX_FILLRECT(bpp, type) \
+static void \
+SDL_FillRect##bpp##AVX(Uint8 *pixels, int pitch, Uint32 color, int w, int h, SDL_bool stream) \
+{ \
+    int i, n; \
+    Uint8 *p = NULL; \
+ \
+    AVX_BEGIN; \
+ \
+    while (h--) { \
+        n = w * bpp; \
+        p = pixels; \
+ \
+        if (n > 127) { \
+            int adjust = 32 - ((uintptr_t)p & 31); \
+            if (adjust < 32) { \
+                n -= adjust; \
+                adjust /= bpp; \
+                while (adjust--) { \
+                    *((type *)p) = (type)color; \
+                    p += bpp; \
+                } \
+            } \
+            AVX_WORK; \
+        } \
+        if (n & 127) { \
+            int remainder = (n & 127); \
+            remainder /= bpp; \
+            while (remainder--) { \
+                *((type *)p) = (type)color; \
+                p += bpp; \
+            } \
+        } \
+        pixels += pitch; \
+    } \
+ \
+    AVX_END; \
+}
+
+DEFINE_AVX_FILLRECT(1, Uint8)
+DEFINE_AVX_FILLRECT(2, Uint16)
+DEFINE_AVX_FILLRECT(4, Uint32)
+
+/* *INDENT-ON* */
+#endif /* __AVX__ */
+
 static void
 SDL_FillRect1(Uint8 * pixels, int pitch, Uint32 color, int w, int h)
 {
@@ -230,55 +392,30 @@ SDL_FillRect4(Uint8 * pixels, int pitch, Uint32 color, int w, int h)
     }
 }
 
-/* 
- * This function performs a fast fill of the given rectangle with 'color'
- */
-int
-SDL_FillRect(SDL_Surface * dst, const SDL_Rect * rect, Uint32 color)
+/* Fills a rectangle that is already clipped to the surface */
+static void
+SDL_FillClippedRect(SDL_Surface * dst, const SDL_Rect * rect, Uint32 color)
 {
-    SDL_Rect clipped;
+    const int bpp = dst->format->BytesPerPixel;
+    const SDL_bool stream = ((size_t) rect->w * rect->h * bpp >= SDL_FILLRECT_STREAM_BYTES);
     Uint8 *pixels;
 
-    if (!dst) {
-        return SDL_SetError("Passed NULL destination surface");
-    }
-
-    /* This function doesn't work on surfaces < 8 bpp */
-    if (dst->format->BitsPerPixel < 8) {
-        return SDL_SetError("SDL_FillRect(): Unsupported surface format");
-    }
-
-    /* If 'rect' == NULL, then fill the whole surface */
-    if (rect) {
-        /* Perform clipping */
-        if (!SDL_IntersectRect(rect, &dst->clip_rect, &clipped)) {
-            return 0;
-        }
-        rect = &clipped;
-    } else {
-        rect = &dst->clip_rect;
-        /* Don't attempt to fill if the surface's clip_rect is empty */
-        if (SDL_RectEmpty(rect)) {
-            return 0;
-        }
-    }
-
-    /* Perform software fill */
-    if (!dst->pixels) {
-        return SDL_SetError("SDL_FillRect(): You must lock the surface");
-    }
-
-    pixels = (Uint8 *) dst->pixels + rect->y * dst->pitch +
-                                     rect->x * dst->format->BytesPerPixel;
+    pixels = (Uint8 *) dst->pixels + rect->y * dst->pitch + rect->x * bpp;
 
-    switch (dst->format->BytesPerPixel) {
+    switch (bpp) {
     case 1:
         {
             color |= (color << 8);
             color |= (color << 16);
+#ifdef __AVX__
+            if (SDL_HasAVX()) {
+                SDL_FillRect1AVX(pixels, dst->pitch, color, rect->w, rect->h, stream);
+                break;
+            }
+#endif
 #ifdef __SSE__
             if (SDL_HasSSE()) {
-                SDL_FillRect1SSE(pixels, dst->pitch, color, rect->w, rect->h);
+                SDL_FillRect1SSE(pixels, dst->pitch, color, rect->w, rect->h, stream);
                 break;
             }
 #endif
@@ -289,9 +426,15 @@ SDL_FillRect(SDL_Surface * dst, const SDL_Rect * rect, Uint32 color)
     case 2:
         {
             color |= (color << 16);
+#ifdef __AVX__
+            if (SDL_HasAVX()) {
+                SDL_FillRect2AVX(pixels, dst->pitch, color, rect->w, rect->h, stream);
+                break;
+            }
+#endif
 #ifdef __SSE__
             if (SDL_HasSSE()) {
-                SDL_FillRect2SSE(pixels, dst->pitch, color, rect->w, rect->h);
+                SDL_FillRect2SSE(pixels, dst->pitch, color, rect->w, rect->h, stream);
                 break;
             }
 #endif
@@ -300,17 +443,28 @@ SDL_FillRect(SDL_Surface * dst, const SDL_Rect * rect, Uint32 color)
         }
 
     case 3:
-        /* 24-bit RGB is a slow path, at least for now. */
         {
+#ifdef __SSE__
+            if (SDL_HasSSE()) {
+                SDL_FillRect3SSE(pixels, dst->pitch, color, rect->w, rect->h, stream);
+                break;
+            }
+#endif
             SDL_FillRect3(pixels, dst->pitch, color, rect->w, rect->h);
             break;
         }
 
     case 4:
         {
+#ifdef __AVX__
+            if (SDL_HasAVX()) {
+                SDL_FillRect4AVX(pixels, dst->pitch, color, rect->w, rect->h, stream);
+                break;
+            }
+#endif
 #ifdef __SSE__
             if (SDL_HasSSE()) {
-                SDL_FillRect4SSE(pixels, dst->pitch, color, rect->w, rect->h);
+                SDL_FillRect4SSE(pixels, dst->pitch, color, rect->w, rect->h, stream);
                 break;
             }
 #endif
@@ -318,26 +472,138 @@ SDL_FillRect(SDL_Surface * dst, const SDL_Rect * rect, Uint32 color)
             break;
         }
     }
+}
 
-    /* We're done! */
-    return 0;
+/*
+ * If the union of two rectangles is a rectangle, grow the first one to
+ * cover it and return SDL_TRUE.
+ */
+static SDL_bool
+SDL_MergeFillRect(SDL_Rect * a, const SDL_Rect * b)
+{
+    if (b->x >= a->x && b->x + b->w <= a->x + a->w &&
+        b->y >= a->y && b->y + b->h <= a->y + a->h) {
+        /* b is inside a */
+        return SDL_TRUE;
+    }
+    if (a->x >= b->x && a->x + a->w <= b->x + b->w &&
+        a->y >= b->y && a->y + a->h <= b->y + b->h) {
+        /* a is inside b */
+        *a = *b;
+        return SDL_TRUE;
+    }
+    if (a->x == b->x && a->w == b->w &&
+        b->y <= a->y + a->h && a->y <= b->y + b->h) {
+        /* Same columns, touching or overlapping rows */
+        const int bottom = SDL_max(a->y + a->h, b->y + b->h);
+        a->y = SDL_min(a->y, b->y);
+        a->h = bottom - a->y;
+        return SDL_TRUE;
+    }
+    if (a->y == b->y && a->h == b->h &&
+        b->x <= a->x + a->w && a->x <= b->x + b->w) {
+        /* Same rows, touching or overlapping columns */
+        const int right = SDL_max(a->x + a->w, b->x + b->w);
+        a->x = SDL_min(a->x, b->x);
+        a->w = right - a->x;
+        return SDL_TRUE;
+    }
+    return SDL_FALSE;
 }
 
+/* 
+ * This function performs a fast fill of the given rectangle with 'color'
+ */
+int
+SDL_FillRect(SDL_Surface * dst, const SDL_Rect * rect, Uint32 color)
+{
+    if (!dst) {
+        return SDL_SetError("Passed NULL destination surface");
+    }
+
+    /* If 'rect' == NULL, then fill the whole surface */
+    if (!rect) {
+        rect = &dst->clip_rect;
+        /* Don't attempt to fill if the surface's clip_rect is empty */
+        if (SDL_RectEmpty(rect)) {
+            return 0;
+        }
+    }
+
+    return SDL_FillRects(dst, rect, 1, color);
+}
+
+/*
+ * Rectangles that touch or overlap in a way that makes a larger rectangle,
+ * like the spans of a shape or the tiles of a grid in order, are combined
+ * and filled together. Two rectangles are kept pending so that a row of
+ * tiles can also combine with the row above it.
+ */
 int
 SDL_FillRects(SDL_Surface * dst, const SDL_Rect * rects, int count,
               Uint32 color)
 {
-    int i;
-    int status = 0;
+    SDL_Rect clipped[64], pending[2];
+    int num_pending = 0;
+    int i, j, numclipped;
+
+    if (!dst) {
+        return SDL_SetError("Passed NULL destination surface");
+    }
+
+    /* This function doesn't work on surfaces < 8 bpp */
+    if (dst->format->BitsPerPixel < 8) {
+        return SDL_SetError("SDL_FillRect(): Unsupported surface format");
+    }
 
     if (!rects) {
         return SDL_SetError("SDL_FillRects() passed NULL rects");
     }
 
-    for (i = 0; i < count; ++i) {
-        status += SDL_FillRect(dst, &rects[i], color);
+    SDL_RLEFinishEncoding(dst);
+
+    for (i = 0; i < count; i += SDL_arraysize(clipped)) {
+        /* Perform clipping */
+        numclipped = SDL_ClipRects(&dst->clip_rect, &rects[i],
+                                   SDL_min(count - i, (int) SDL_arraysize(clipped)), clipped);
+        for (j = 0; j < numclipped; ++j) {
+            if (dst->flags & SDL_TRACKDAMAGE) {
+                SDL_AddWindowSurfaceDamage(dst, &clipped[j]);
+            }
+            if (num_pending == 0) {
+                /* Perform software fill */
+                if (!dst->pixels) {
+                    return SDL_SetError("SDL_FillRect(): You must lock the surface");
+                }
+                pending[num_pending++] = clipped[j];
+                continue;
+            }
+            if (SDL_MergeFillRect(&pending[num_pending - 1], &clipped[j])) {
+                continue;
+            }
+            if (num_pending == 2) {
+                /* The latest one is complete, see if it extends the older one */
+                if (SDL_MergeFillRect(&pending[0], &pending[1])) {
+                    pending[1] = clipped[j];
+                    continue;
+                }
+                SDL_FillClippedRect(dst, &pending[0], color);
+                pending[0] = pending[1];
+            }
+            pending[1] = clipped[j];
+            num_pending = 2;
+        }
+    }
+
+    if (num_pending == 2 && SDL_MergeFillRect(&pending[0], &pending[1])) {
+        num_pending = 1;
+    }
+    for (i = 0; i < num_pending; ++i) {
+        SDL_FillClippedRect(dst, &pending[i], color);
     }
-    return status;
+
+    /* We're done! */
+    return 0;
 }
 
 /* vi: set ts=4 sw=4 expandtab: */
@@ -22,7 +22,9 @@
 
 /* General (mostly internal) pixel/color manipulation routines for SDL */
 
+#include "SDL_atomic.h"
 #include "SDL_endian.h"
+#include "SDL_log.h"
 #include "SDL_video.h"
 #include "SDL_sysvideo.h"
 #include "SDL_blit.h"
@@ -482,20 +484,48 @@ SDL_MasksToPixelFormatEnum(int bpp, Uint32 Rmask, Uint32 Gmask, Uint32 Bmask,
     return SDL_PIXELFORMAT_UNKNOWN;
 }
 
-static SDL_PixelFormat *formats;
+/*
+ * RGB formats are shared, through a hash table indexed by the format enum.
+ * The table holds a reference on each format, so formats stay in it until
+ * SDL_Quit() and lookups never see a format being freed. Lookups walk the
+ * chains without locking, and new formats are pushed on a chain with a
+ * compare-and-swap. The refcount is an int in the public structure, which
+ * has the same layout as SDL_atomic_t.
+ */
+#define FORMAT_CACHE_BUCKETS    64
 
-SDL_PixelFormat *
-SDL_AllocFormat(Uint32 pixel_format)
-{
-    SDL_PixelFormat *format;
+static void *formats[FORMAT_CACHE_BUCKETS];
+
+#define FORMAT_BUCKET(pixel_format) \
+    (((Uint32) (pixel_format) * 0x9E3779B1u) >> 26)
 
-    /* Look it up in our list of previously allocated formats */
-    for (format = formats; format; format = format->next) {
-        if (pixel_format == format->format) {
-            ++format->refcount;
+#define FORMAT_REFCOUNT(format) ((SDL_atomic_t *) &(format)->refcount)
+
+static SDL_PixelFormat *
+SDL_FindFormat(SDL_PixelFormat * format, Uint32 pixel_format)
+{
+    for (; format; format = format->next) {
+        if (format->format == pixel_format) {
+            SDL_AtomicIncRef(FORMAT_REFCOUNT(format));
             return format;
         }
     }
+    return NULL;
+}
+
+SDL_PixelFormat *
+SDL_AllocFormat(Uint32 pixel_format)
+{
+    void **head = &formats[FORMAT_BUCKET(pixel_format)];
+    SDL_PixelFormat *first, *format;
+
+    /* Look it up in our table of previously allocated formats */
+    first = (SDL_PixelFormat *) *head;
+    SDL_MemoryBarrierAcquire();
+    format = SDL_FindFormat(first, pixel_format);
+    if (format) {
+        return format;
+    }
 
     /* Allocate an empty pixel format structure, and initialize it */
     format = SDL_malloc(sizeof(*format));
@@ -510,9 +540,19 @@ SDL_AllocFormat(Uint32 pixel_format)
     }
 
     if (!SDL_ISPIXELFORMAT_INDEXED(pixel_format)) {
-        /* Cache the RGB formats */
-        format->next = formats;
-        formats = format;
+        /* Cache the RGB formats, unless another thread just did */
+        format->refcount = 2;
+        format->next = first;
+        while (!SDL_AtomicCASPtr(head, format->next, format)) {
+            SDL_PixelFormat *other;
+
+            format->next = (SDL_PixelFormat *) SDL_AtomicGetPtr(head);
+            other = SDL_FindFormat(format->next, pixel_format);
+            if (other) {
+                SDL_free(format);
+                return other;
+            }
+        }
     }
     return format;
 }
@@ -585,34 +625,40 @@ SDL_InitFormat(SDL_PixelFormat * format, Uint32 pixel_format)
 void
 SDL_FreeFormat(SDL_PixelFormat *format)
 {
-    SDL_PixelFormat *prev;
-
     if (!format) {
         SDL_InvalidParamError("format");
         return;
     }
-    if (--format->refcount > 0) {
+    if (!SDL_AtomicDecRef(FORMAT_REFCOUNT(format))) {
         return;
     }
 
-    /* Remove this format from our list */
-    if (format == formats) {
-        formats = format->next;
-    } else if (formats) {
-        for (prev = formats; prev->next; prev = prev->next) {
-            if (prev->next == format) {
-                prev->next = format->next;
-                break;
-            }
-        }
-    }
-
     if (format->palette) {
         SDL_FreePalette(format->palette);
     }
     SDL_free(format);
 }
 
+void
+SDL_FormatCacheQuit(void)
+{
+    SDL_PixelFormat *format, *next;
+    int i;
+
+    /* Formats still in use are freed with their last reference */
+    for (i = 0; i < FORMAT_CACHE_BUCKETS; ++i) {
+        format = (SDL_PixelFormat *) SDL_AtomicGetPtr(&formats[i]);
+        while (format && !SDL_AtomicCASPtr(&formats[i], format, NULL)) {
+            format = (SDL_PixelFormat *) SDL_AtomicGetPtr(&formats[i]);
+        }
+        for (; format; format = next) {
+            next = format->next;
+            format->next = NULL;
+            SDL_FreeFormat(format);
+        }
+    }
+}
+
 SDL_Palette *
 SDL_AllocPalette(int ncolors)
 {
@@ -699,6 +745,236 @@ SDL_SetPaletteColors(SDL_Palette * palette, const SDL_Color * colors,
     return status;
 }
 
+/*
+ * Inverse color maps
+ *
+ * When all the colors of a palette have the same alpha, the nearest color
+ * only depends on red, green and blue. The RGB cube is then split into
+ * 8x8x8 cells, and each cell gets the list of palette entries that can be
+ * the nearest one to some color in it. An entry is left out when even the
+ * closest point of the cell is further from it than the furthest point of
+ * the cell is from some other entry. Lookups only search that list, in
+ * palette order, so they give the same answer as the full search.
+ *
+ * The maps are kept per palette and rebuilt when the palette version
+ * changes, so palette colors must be changed with SDL_SetPaletteColors().
+ * Building a cell costs about two full searches, so a cell is only built
+ * the second time a color falls into it.
+ *
+ * Each map has its own lock, so lookups in different palettes don't wait
+ * for each other. The lock of the table only covers finding the map. A map
+ * goes away with its palette, and SDL_VideoQuit() drops the ones left.
+ */
+#define COLORMAP_SHIFT      5
+#define COLORMAP_CELLS      (1 << (3 * (8 - COLORMAP_SHIFT)))
+#define COLORMAP_MIN_COLORS 16
+#define COLORMAP_BUCKETS    64
+
+typedef struct SDL_InverseColorMap
+{
+    SDL_SpinLock lock;
+    SDL_Palette *palette;
+    Uint32 version;
+    int ncolors;
+    SDL_bool usable;            /* all colors have the same alpha */
+    Uint8 seen[COLORMAP_CELLS];
+    Uint32 cells[COLORMAP_CELLS];       /* offset << 9 | count, 0 if not built */
+    Uint8 *candidates;
+    int used, size;
+    struct SDL_InverseColorMap *next;
+} SDL_InverseColorMap;
+
+static SDL_SpinLock colormap_lock;
+static SDL_InverseColorMap *colormaps[COLORMAP_BUCKETS];
+
+#define COLORMAP_BUCKET(palette) \
+    ((((uintptr_t) (palette)) >> 4) % COLORMAP_BUCKETS)
+
+/* Find or add the map of a palette, it stays until the palette is freed */
+static SDL_InverseColorMap *
+SDL_GetInverseColorMap(SDL_Palette * palette)
+{
+    SDL_InverseColorMap **head = &colormaps[COLORMAP_BUCKET(palette)];
+    SDL_InverseColorMap *map;
+
+    SDL_AtomicLock(&colormap_lock);
+    for (map = *head; map; map = map->next) {
+        if (map->palette == palette) {
+            break;
+        }
+    }
+    if (!map) {
+        /* no colors yet, it will be set up by the first lookup */
+        map = (SDL_InverseColorMap *) SDL_calloc(1, sizeof(*map));
+        if (map) {
+            map->palette = palette;
+            map->next = *head;
+            *head = map;
+        }
+    }
+    SDL_AtomicUnlock(&colormap_lock);
+    return map;
+}
+
+/* These must be called with the map locked */
+static void
+SDL_UpdateInverseColorMap(SDL_InverseColorMap * map)
+{
+    const SDL_Palette *palette = map->palette;
+    int i;
+
+    if (map->version == palette->version &&
+        map->ncolors == palette->ncolors) {
+        return;
+    }
+
+    /* Start over for the current colors */
+    map->version = palette->version;
+    map->ncolors = palette->ncolors;
+    map->usable = SDL_TRUE;
+    for (i = 1; i < palette->ncolors; ++i) {
+        if (palette->colors[i].a != palette->colors[0].a) {
+            map->usable = SDL_FALSE;
+            break;
+        }
+    }
+    SDL_zero(map->seen);
+    SDL_zero(map->cells);
+    map->used = 0;
+}
+
+static SDL_bool
+SDL_BuildColorCell(SDL_InverseColorMap * map, int cell)
+{
+    const SDL_Color *colors = map->palette->colors;
+    const int r0 = (cell >> (2 * (8 - COLORMAP_SHIFT))) << COLORMAP_SHIFT;
+    const int g0 = ((cell >> (8 - COLORMAP_SHIFT)) & ((1 << (8 - COLORMAP_SHIFT)) - 1)) << COLORMAP_SHIFT;
+    const int b0 = (cell & ((1 << (8 - COLORMAP_SHIFT)) - 1)) << COLORMAP_SHIFT;
+    const int last = (1 << COLORMAP_SHIFT) - 1;
+    unsigned int limit = ~0u;
+    int i, count = 0;
+
+    if (map->used + map->ncolors > map->size) {
+        int size = SDL_max(map->size * 2, map->used + map->ncolors);
+        Uint8 *candidates = (Uint8 *) SDL_realloc(map->candidates, size);
+        if (!candidates) {
+            return SDL_FALSE;
+        }
+        map->candidates = candidates;
+        map->size = size;
+    }
+
+#define FAR_DIST(c, c0)     SDL_max(((c) - (c0)) * ((c) - (c0)), ((c) - (c0) - last) * ((c) - (c0) - last))
+#define NEAR_DIST(c, c0)    (((c) < (c0)) ? ((c0) - (c)) * ((c0) - (c)) : \
+                             ((c) > (c0) + last) ? ((c) - (c0) - last) * ((c) - (c0) - last) : 0)
+
+    for (i = 0; i < map->ncolors; ++i) {
+        const unsigned int distance = FAR_DIST(colors[i].r, r0) +
+            FAR_DIST(colors[i].g, g0) + FAR_DIST(colors[i].b, b0);
+        if (distance < limit) {
+            limit = distance;
+        }
+    }
+    for (i = 0; i < map->ncolors; ++i) {
+        const unsigned int distance = NEAR_DIST(colors[i].r, r0) +
+            NEAR_DIST(colors[i].g, g0) + NEAR_DIST(colors[i].b, b0);
+        if (distance <= limit) {
+            map->candidates[map->used + count++] = (Uint8) i;
+        }
+    }
+
+#undef FAR_DIST
+#undef NEAR_DIST
+
+    map->cells[cell] = ((Uint32) map->used << 9) | count;
+    map->used += count;
+    return SDL_TRUE;
+}
+
+/* Returns the nearest color, or -1 if the palette needs a full search */
+static int
+SDL_FindColorInMap(SDL_InverseColorMap * map, Uint8 r, Uint8 g, Uint8 b)
+{
+    const SDL_Palette *pal = map->palette;
+    const Uint8 *candidates;
+    unsigned int smallest = ~0u;
+    int cell, count, pixel = 0;
+
+    SDL_UpdateInverseColorMap(map);
+    if (!map->usable) {
+        return -1;
+    }
+    cell = ((r >> COLORMAP_SHIFT) << (2 * (8 - COLORMAP_SHIFT))) |
+           ((g >> COLORMAP_SHIFT) << (8 - COLORMAP_SHIFT)) |
+           (b >> COLORMAP_SHIFT);
+    if (!map->cells[cell]) {
+        if (!map->seen[cell]) {
+            map->seen[cell] = 1;
+            return -1;
+        }
+        if (!SDL_BuildColorCell(map, cell)) {
+            return -1;
+        }
+    }
+
+    candidates = map->candidates + (map->cells[cell] >> 9);
+    count = map->cells[cell] & 0x1FF;
+    while (count--) {
+        const SDL_Color *color = &pal->colors[*candidates];
+        const int rd = color->r - r;
+        const int gd = color->g - g;
+        const int bd = color->b - b;
+        const unsigned int distance = (rd * rd) + (gd * gd) + (bd * bd);
+        if (distance < smallest) {
+            pixel = *candidates;
+            if (distance == 0) {
+                break;
+            }
+            smallest = distance;
+        }
+        ++candidates;
+    }
+    return pixel;
+}
+
+static void
+SDL_ForgetInverseColorMap(SDL_Palette * palette)
+{
+    SDL_InverseColorMap **prev, *map = NULL;
+
+    SDL_AtomicLock(&colormap_lock);
+    for (prev = &colormaps[COLORMAP_BUCKET(palette)]; *prev; prev = &(*prev)->next) {
+        if ((*prev)->palette == palette) {
+            map = *prev;
+            *prev = map->next;
+            break;
+        }
+    }
+    SDL_AtomicUnlock(&colormap_lock);
+
+    if (map) {
+        SDL_free(map->candidates);
+        SDL_free(map);
+    }
+}
+
+void
+SDL_InverseColorMapQuit(void)
+{
+    int i;
+
+    SDL_AtomicLock(&colormap_lock);
+    for (i = 0; i < COLORMAP_BUCKETS; ++i) {
+        while (colormaps[i]) {
+            SDL_InverseColorMap *map = colormaps[i];
+            colormaps[i] = map->next;
+            SDL_free(map->candidates);
+            SDL_free(map);
+        }
+    }
+    SDL_AtomicUnlock(&colormap_lock);
+}
+
 void
 SDL_FreePalette(SDL_Palette * palette)
 {
@@ -709,6 +985,8 @@ SDL_FreePalette(SDL_Palette * palette)
     if (--palette->refcount > 0) {
         return;
     }
+    SDL_ForgetBlitMapPalette(palette);
+    SDL_ForgetInverseColorMap(palette);
     SDL_free(palette->colors);
     SDL_free(palette);
 }
@@ -778,6 +1056,20 @@ SDL_FindColor(SDL_Palette * pal, Uint8 r, Uint8 g, Uint8 b, Uint8 a)
     int i;
     Uint8 pixel = 0;
 
+    if (pal->ncolors > COLORMAP_MIN_COLORS && pal->ncolors <= 256) {
+        SDL_InverseColorMap *map = SDL_GetInverseColorMap(pal);
+        if (map) {
+            int found;
+
+            SDL_AtomicLock(&map->lock);
+            found = SDL_FindColorInMap(map, r, g, b);
+            SDL_AtomicUnlock(&map->lock);
+            if (found >= 0) {
+                return (Uint8) found;
+            }
+        }
+    }
+
     smallest = ~0;
     for (i = 0; i < pal->ncolors; ++i) {
         rd = pal->colors[i].r - r;
@@ -950,6 +1242,269 @@ MapNto1(SDL_PixelFormat * src, SDL_PixelFormat * dst, int *identical)
     return (Map1to1(&dithered, pal, identical));
 }
 
+/*
+ * The blit map cache
+ *
+ * The translation table and blit function of a mapping only depend on the
+ * formats, palettes and flags involved, so they are shared between blit
+ * maps, and kept after the maps are invalidated. Blitting one surface to
+ * several destinations in turn then doesn't rebuild the tables every time.
+ */
+#define BLITMAP_CACHE_BUCKETS   64
+#define BLITMAP_CACHE_SIZE      256
+
+static SDL_SpinLock blitmap_cache_lock;
+static SDL_BlitMapEntry *blitmap_cache[BLITMAP_CACHE_BUCKETS];
+static int blitmap_cache_entries;
+static Uint32 blitmap_cache_clock;
+static Uint32 blitmap_cache_hits;
+static Uint32 blitmap_cache_misses;
+
+static void
+SDL_InitBlitMapKey(SDL_BlitMapEntry * key, SDL_Surface * src, SDL_Surface * dst)
+{
+    SDL_PixelFormat *srcfmt = src->format;
+    SDL_PixelFormat *dstfmt = dst->format;
+
+    SDL_zerop(key);
+    key->src_format = srcfmt->format;
+    key->dst_format = dstfmt->format;
+    if (srcfmt->palette) {
+        key->src_palette = srcfmt->palette;
+        key->src_palette_version = srcfmt->palette->version;
+    }
+    if (dstfmt->palette) {
+        key->dst_palette = dstfmt->palette;
+        key->dst_palette_version = dstfmt->palette->version;
+    }
+    key->flags = src->map->info.flags;
+    if (SDL_ISPIXELFORMAT_INDEXED(srcfmt->format) &&
+        !SDL_ISPIXELFORMAT_INDEXED(dstfmt->format)) {
+        /* The color and alpha modulation are part of the table */
+        key->r = src->map->info.r;
+        key->g = src->map->info.g;
+        key->b = src->map->info.b;
+        key->a = src->map->info.a;
+    }
+    key->same_format = (srcfmt == dstfmt);
+}
+
+static Uint32
+SDL_HashBlitMapKey(const SDL_BlitMapEntry * key)
+{
+    Uint32 hash = key->src_format;
+
+    hash = hash * 31 + key->dst_format;
+    hash = hash * 31 + (Uint32) (uintptr_t) key->src_palette;
+    hash = hash * 31 + (Uint32) (uintptr_t) key->dst_palette;
+    hash = hash * 31 + key->src_palette_version;
+    hash = hash * 31 + key->dst_palette_version;
+    hash = hash * 31 + key->flags;
+    hash = hash * 31 + ((key->r << 24) | (key->g << 16) | (key->b << 8) | key->a);
+    return (hash ^ (hash >> 16)) % BLITMAP_CACHE_BUCKETS;
+}
+
+static SDL_bool
+SDL_BlitMapKeysEqual(const SDL_BlitMapEntry * a, const SDL_BlitMapEntry * b)
+{
+    return (a->src_format == b->src_format &&
+            a->dst_format == b->dst_format &&
+            a->src_palette == b->src_palette &&
+            a->dst_palette == b->dst_palette &&
+            a->src_palette_version == b->src_palette_version &&
+            a->dst_palette_version == b->dst_palette_version &&
+            a->flags == b->flags &&
+            a->r == b->r && a->g == b->g && a->b == b->b && a->a == b->a &&
+            a->same_format == b->same_format);
+}
+
+/* Build the translation table for an entry from its key */
+static int
+SDL_BuildBlitMapTable(SDL_BlitMapEntry * entry, SDL_PixelFormat * srcfmt,
+                      SDL_PixelFormat * dstfmt)
+{
+    entry->identity = 0;
+    entry->table = NULL;
+    if (SDL_ISPIXELFORMAT_INDEXED(srcfmt->format)) {
+        if (SDL_ISPIXELFORMAT_INDEXED(dstfmt->format)) {
+            /* Palette --> Palette */
+            entry->table =
+                Map1to1(srcfmt->palette, dstfmt->palette, &entry->identity);
+            if (!entry->identity) {
+                if (entry->table == NULL) {
+                    return (-1);
+                }
+            }
+            if (srcfmt->BitsPerPixel != dstfmt->BitsPerPixel)
+                entry->identity = 0;
+        } else {
+            /* Palette --> BitField */
+            entry->table =
+                Map1toN(srcfmt, entry->r, entry->g, entry->b, entry->a, dstfmt);
+            if (entry->table == NULL) {
+                return (-1);
+            }
+        }
+    } else {
+        if (SDL_ISPIXELFORMAT_INDEXED(dstfmt->format)) {
+            /* BitField --> Palette */
+            entry->table = MapNto1(srcfmt, dstfmt, &entry->identity);
+            if (!entry->identity) {
+                if (entry->table == NULL) {
+                    return (-1);
+                }
+            }
+            entry->identity = 0;        /* Don't optimize to copy */
+        } else {
+            /* BitField --> BitField */
+            entry->identity = entry->same_format;
+        }
+    }
+    return (0);
+}
+
+/* These must be called with the cache locked */
+static void
+SDL_RemoveBlitMapEntry(SDL_BlitMapEntry * entry)
+{
+    SDL_BlitMapEntry **prev = &blitmap_cache[SDL_HashBlitMapKey(entry)];
+
+    while (*prev != entry) {
+        prev = &(*prev)->next;
+    }
+    *prev = entry->next;
+    --blitmap_cache_entries;
+
+    SDL_free(entry->table);
+    SDL_free(entry);
+}
+
+static void
+SDL_EvictBlitMapEntry(void)
+{
+    SDL_BlitMapEntry *entry, *oldest = NULL;
+    int i;
+
+    for (i = 0; i < BLITMAP_CACHE_BUCKETS; ++i) {
+        for (entry = blitmap_cache[i]; entry; entry = entry->next) {
+            if (entry->refcount == 0 &&
+                (!oldest || (Uint32) (blitmap_cache_clock - entry->last_used) >
+                            (Uint32) (blitmap_cache_clock - oldest->last_used))) {
+                oldest = entry;
+            }
+        }
+    }
+    if (oldest) {
+        SDL_RemoveBlitMapEntry(oldest);
+    }
+}
+
+static SDL_BlitMapEntry *
+SDL_AcquireBlitMapEntry(SDL_Surface * src, SDL_Surface * dst)
+{
+    SDL_BlitMapEntry key, *entry;
+    Uint32 bucket;
+
+    SDL_InitBlitMapKey(&key, src, dst);
+    bucket = SDL_HashBlitMapKey(&key);
+
+    SDL_AtomicLock(&blitmap_cache_lock);
+    for (entry = blitmap_cache[bucket]; entry; entry = entry->next) {
+        if (!entry->stale && SDL_BlitMapKeysEqual(entry, &key)) {
+            ++entry->refcount;
+            entry->last_used = ++blitmap_cache_clock;
+            ++blitmap_cache_hits;
+            break;
+        }
+    }
+    SDL_AtomicUnlock(&blitmap_cache_lock);
+    if (entry) {
+        return entry;
+    }
+
+    /* Building the table can take a while, don't hold the lock for it */
+    entry = (SDL_BlitMapEntry *) SDL_malloc(sizeof(*entry));
+    if (entry == NULL) {
+        SDL_OutOfMemory();
+        return (NULL);
+    }
+    *entry = key;
+    if (SDL_BuildBlitMapTable(entry, src->format, dst->format) < 0) {
+        SDL_free(entry);
+        return (NULL);
+    }
+    entry->refcount = 1;
+
+    SDL_AtomicLock(&blitmap_cache_lock);
+    ++blitmap_cache_misses;
+    if (blitmap_cache_entries >= BLITMAP_CACHE_SIZE) {
+        SDL_EvictBlitMapEntry();
+    }
+    entry->last_used = ++blitmap_cache_clock;
+    entry->next = blitmap_cache[bucket];
+    blitmap_cache[bucket] = entry;
+    ++blitmap_cache_entries;
+    SDL_AtomicUnlock(&blitmap_cache_lock);
+
+    return entry;
+}
+
+static void
+SDL_ReleaseBlitMapEntry(SDL_BlitMapEntry * entry)
+{
+    SDL_AtomicLock(&blitmap_cache_lock);
+    if (--entry->refcount == 0 && entry->stale) {
+        SDL_RemoveBlitMapEntry(entry);
+    }
+    SDL_AtomicUnlock(&blitmap_cache_lock);
+}
+
+/* A palette is going away, make sure a new one at the same address
+   doesn't pick up its mappings */
+void
+SDL_ForgetBlitMapPalette(SDL_Palette * palette)
+{
+    SDL_BlitMapEntry *entry, *next;
+    int i;
+
+    SDL_AtomicLock(&blitmap_cache_lock);
+    for (i = 0; i < BLITMAP_CACHE_BUCKETS; ++i) {
+        for (entry = blitmap_cache[i]; entry; entry = next) {
+            next = entry->next;
+            if (entry->src_palette == palette || entry->dst_palette == palette) {
+                if (entry->refcount == 0) {
+                    SDL_RemoveBlitMapEntry(entry);
+                } else {
+                    entry->stale = SDL_TRUE;
+                }
+            }
+        }
+    }
+    SDL_AtomicUnlock(&blitmap_cache_lock);
+}
+
+void
+SDL_BlitMapCacheQuit(void)
+{
+    SDL_BlitMapEntry *entry, *next;
+    int i;
+
+    SDL_AtomicLock(&blitmap_cache_lock);
+    SDL_LogDebug(SDL_LOG_CATEGORY_VIDEO, "Blit map cache: %u hits, %u misses, %d entries",
+                 blitmap_cache_hits, blitmap_cache_misses, blitmap_cache_entries);
+    for (i = 0; i < BLITMAP_CACHE_BUCKETS; ++i) {
+        for (entry = blitmap_cache[i]; entry; entry = next) {
+            next = entry->next;
+            if (entry->refcount == 0) {
+                SDL_RemoveBlitMapEntry(entry);
+            }
+        }
+    }
+    blitmap_cache_hits = 0;
+    blitmap_cache_misses = 0;
+    SDL_AtomicUnlock(&blitmap_cache_lock);
+}
+
 SDL_BlitMap *
 SDL_AllocBlitMap(void)
 {
@@ -985,7 +1540,10 @@ SDL_InvalidateMap(SDL_BlitMap * map)
     map->dst = NULL;
     map->src_palette_version = 0;
     map->dst_palette_version = 0;
-    SDL_free(map->info.table);
+    if (map->shared) {
+        SDL_ReleaseBlitMapEntry(map->shared);
+        map->shared = NULL;
+    }
     map->info.table = NULL;
 }
 
@@ -1004,47 +1562,15 @@ SDL_MapSurface(SDL_Surface * src, SDL_Surface * dst)
     SDL_InvalidateMap(map);
 
     /* Figure out what kind of mapping we're doing */
-    map->identity = 0;
     srcfmt = src->format;
     dstfmt = dst->format;
-    if (SDL_ISPIXELFORMAT_INDEXED(srcfmt->format)) {
-        if (SDL_ISPIXELFORMAT_INDEXED(dstfmt->format)) {
-            /* Palette --> Palette */
-            map->info.table =
-                Map1to1(srcfmt->palette, dstfmt->palette, &map->identity);
-            if (!map->identity) {
-                if (map->info.table == NULL) {
-                    return (-1);
-                }
-            }
-            if (srcfmt->BitsPerPixel != dstfmt->BitsPerPixel)
-                map->identity = 0;
-        } else {
-            /* Palette --> BitField */
-            map->info.table =
-                Map1toN(srcfmt, src->map->info.r, src->map->info.g,
-                        src->map->info.b, src->map->info.a, dstfmt);
-            if (map->info.table == NULL) {
-                return (-1);
-            }
-        }
-    } else {
-        if (SDL_ISPIXELFORMAT_INDEXED(dstfmt->format)) {
-            /* BitField --> Palette */
-            map->info.table = MapNto1(srcfmt, dstfmt, &map->identity);
-            if (!map->identity) {
-                if (map->info.table == NULL) {
-                    return (-1);
-                }
-            }
-            map->identity = 0;  /* Don't optimize to copy */
-        } else {
-            /* BitField --> BitField */
-            if (srcfmt == dstfmt) {
-                map->identity = 1;
-            }
-        }
+    map->shared = SDL_AcquireBlitMapEntry(src, dst);
+    if (!map->shared) {
+        map->identity = 0;
+        return (-1);
     }
+    map->identity = map->shared->identity;
+    map->info.table = map->shared->table;
 
     map->dst = dst;
 
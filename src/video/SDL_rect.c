@@ -23,6 +23,7 @@
 #include "SDL_rect.h"
 #include "SDL_rect_c.h"
 #include "SDL_assert.h"
+#include "SDL_cpuinfo.h"
 
 SDL_bool
 SDL_HasIntersection(const SDL_Rect * A, const SDL_Rect * B)
@@ -528,4 +529,839 @@ SDL_GetSpanEnclosingRect(int width, int height,
     return SDL_FALSE;
 }
 
+/* Presenting a rectangle costs about as much as copying this many pixels */
+#define DAMAGE_RECT_COST    4096
+
+/* Limits on the work done for one new rectangle, after which the region
+   is replaced by its bounding box */
+#define DAMAGE_MAX_PENDING  64
+#define DAMAGE_MAX_STEPS    256
+
+static Sint64
+RectArea(const SDL_Rect * rect)
+{
+    return (Sint64) rect->w * rect->h;
+}
+
+/* Splits the part of A outside B, which must intersect A, into at most four
+   rectangles: full width bands above and below B, then the parts to the
+   left and right of it. */
+static int
+SubtractRect(const SDL_Rect * A, const SDL_Rect * B, SDL_Rect * pieces)
+{
+    const int Ax2 = A->x + A->w;
+    const int Bx2 = B->x + B->w;
+    const int By2 = B->y + B->h;
+    int top = A->y;
+    int bottom = A->y + A->h;
+    int count = 0;
+
+    if (B->y > top) {
+        pieces[count].x = A->x;
+        pieces[count].y = top;
+        pieces[count].w = A->w;
+        pieces[count].h = B->y - top;
+        ++count;
+        top = B->y;
+    }
+    if (By2 < bottom) {
+        pieces[count].x = A->x;
+        pieces[count].y = By2;
+        pieces[count].w = A->w;
+        pieces[count].h = bottom - By2;
+        ++count;
+        bottom = By2;
+    }
+    if (B->x > A->x) {
+        pieces[count].x = A->x;
+        pieces[count].y = top;
+        pieces[count].w = B->x - A->x;
+        pieces[count].h = bottom - top;
+        ++count;
+    }
+    if (Bx2 < Ax2) {
+        pieces[count].x = Bx2;
+        pieces[count].y = top;
+        pieces[count].w = Ax2 - Bx2;
+        pieces[count].h = bottom - top;
+        ++count;
+    }
+    return count;
+}
+
+static void
+RemoveDamage(SDL_DamageRegion * damage, int index)
+{
+    damage->rects[index] = damage->rects[--damage->numrects];
+}
+
+/*
+ * Every rectangle of the region costs its area plus DAMAGE_RECT_COST. A new
+ * rectangle is merged with the existing one where replacing both with their
+ * bounding box saves the most, if it saves anything. Otherwise it is split
+ * around the rectangles it overlaps, so that the region stays disjoint and
+ * no pixel is presented twice.
+ */
+void
+SDL_AddDamage(SDL_DamageRegion * damage, const SDL_Rect * rect)
+{
+    SDL_Rect pending[DAMAGE_MAX_PENDING];
+    int numpending = 0;
+    int steps = 0;
+    int i;
+
+    if (SDL_RectEmpty(rect)) {
+        return;
+    }
+    pending[numpending++] = *rect;
+
+    while (numpending > 0) {
+        SDL_Rect r = pending[--numpending];
+        SDL_Rect bounds, overlap, pieces[4];
+        Sint64 cost, best_cost = -1;
+        int best = -1, split = -1;
+
+        if (++steps > DAMAGE_MAX_STEPS ||
+            numpending + SDL_arraysize(pieces) > SDL_arraysize(pending)) {
+            /* Too fragmented, present everything in one rectangle */
+            for (i = 0; i < damage->numrects; ++i) {
+                SDL_UnionRect(&r, &damage->rects[i], &r);
+            }
+            for (i = 0; i < numpending; ++i) {
+                SDL_UnionRect(&r, &pending[i], &r);
+            }
+            damage->rects[0] = r;
+            damage->numrects = 1;
+            return;
+        }
+
+        for (i = 0; i < damage->numrects; ++i) {
+            const SDL_Rect *existing = &damage->rects[i];
+
+            /* The saving of merging, which is zero if r is already covered */
+            SDL_UnionRect(existing, &r, &bounds);
+            cost = RectArea(existing) + RectArea(&r) - RectArea(&bounds);
+            if (SDL_IntersectRect(existing, &r, &overlap)) {
+                cost += DAMAGE_RECT_COST * SubtractRect(&r, existing, pieces);
+                cost -= RectArea(&overlap);
+                split = i;
+            } else {
+                cost += DAMAGE_RECT_COST;
+            }
+            if (cost > best_cost) {
+                best_cost = cost;
+                best = i;
+            }
+        }
+
+        if (best >= 0) {
+            SDL_UnionRect(&damage->rects[best], &r, &pending[numpending++]);
+            RemoveDamage(damage, best);
+        } else if (split >= 0) {
+            numpending += SubtractRect(&r, &damage->rects[split], &pending[numpending]);
+        } else if (damage->numrects < SDL_MAX_DAMAGE_RECTS) {
+            damage->rects[damage->numrects++] = r;
+        } else {
+            /* No room left, merge with the rectangle that grows the least */
+            for (i = 0; i < damage->numrects; ++i) {
+                SDL_UnionRect(&damage->rects[i], &r, &bounds);
+                cost = RectArea(&bounds) - RectArea(&damage->rects[i]);
+                if (best < 0 || cost < best_cost) {
+                    best_cost = cost;
+                    best = i;
+                }
+            }
+            SDL_UnionRect(&damage->rects[best], &r, &pending[numpending++]);
+            RemoveDamage(damage, best);
+        }
+    }
+}
+
+#ifdef __SSE2__
+static SDL_INLINE __m128i
+MaxEpi32(__m128i a, __m128i b)
+{
+    const __m128i greater = _mm_cmpgt_epi32(a, b);
+    return _mm_or_si128(_mm_and_si128(greater, a), _mm_andnot_si128(greater, b));
+}
+
+static SDL_INLINE __m128i
+MinEpi32(__m128i a, __m128i b)
+{
+    const __m128i greater = _mm_cmpgt_epi32(a, b);
+    return _mm_or_si128(_mm_and_si128(greater, b), _mm_andnot_si128(greater, a));
+}
+
+/* Clips four rects at a time, with their x, y, w and h in separate vectors */
+static int
+SDL_ClipRects_SSE2(const SDL_Rect * clip, const SDL_Rect * rects, int count,
+                   SDL_Rect * result, int *numrects)
+{
+    const __m128i clip_x1 = _mm_set1_epi32(clip->x);
+    const __m128i clip_y1 = _mm_set1_epi32(clip->y);
+    const __m128i clip_x2 = _mm_set1_epi32(clip->x + clip->w);
+    const __m128i clip_y2 = _mm_set1_epi32(clip->y + clip->h);
+    const __m128i zero = _mm_setzero_si128();
+    int i, n = *numrects;
+
+    for (i = 0; i + 4 <= count; i += 4) {
+        const __m128i r0 = _mm_loadu_si128((const __m128i *) &rects[i + 0]);
+        const __m128i r1 = _mm_loadu_si128((const __m128i *) &rects[i + 1]);
+        const __m128i r2 = _mm_loadu_si128((const __m128i *) &rects[i + 2]);
+        const __m128i r3 = _mm_loadu_si128((const __m128i *) &rects[i + 3]);
+        __m128i t0 = _mm_unpacklo_epi32(r0, r1);
+        __m128i t1 = _mm_unpacklo_epi32(r2, r3);
+        __m128i t2 = _mm_unpackhi_epi32(r0, r1);
+        __m128i t3 = _mm_unpackhi_epi32(r2, r3);
+        __m128i x1 = _mm_unpacklo_epi64(t0, t1);
+        __m128i y1 = _mm_unpackhi_epi64(t0, t1);
+        __m128i x2 = _mm_add_epi32(x1, _mm_unpacklo_epi64(t2, t3));
+        __m128i y2 = _mm_add_epi32(y1, _mm_unpackhi_epi64(t2, t3));
+        __m128i w, h;
+        int visible, j;
+
+        x1 = MaxEpi32(x1, clip_x1);
+        y1 = MaxEpi32(y1, clip_y1);
+        x2 = MinEpi32(x2, clip_x2);
+        y2 = MinEpi32(y2, clip_y2);
+        w = _mm_sub_epi32(x2, x1);
+        h = _mm_sub_epi32(y2, y1);
+        visible = _mm_movemask_ps(_mm_castsi128_ps(
+                      _mm_and_si128(_mm_cmpgt_epi32(w, zero), _mm_cmpgt_epi32(h, zero))));
+        if (!visible) {
+            continue;
+        }
+
+        /* Back to x, y, w and h for each rect. All four were loaded before
+           any is stored, so the results can be stored over them. */
+        t0 = _mm_unpacklo_epi32(x1, y1);
+        t1 = _mm_unpackhi_epi32(x1, y1);
+        t2 = _mm_unpacklo_epi32(w, h);
+        t3 = _mm_unpackhi_epi32(w, h);
+        if (visible == 0xF) {
+            _mm_storeu_si128((__m128i *) &result[n + 0], _mm_unpacklo_epi64(t0, t2));
+            _mm_storeu_si128((__m128i *) &result[n + 1], _mm_unpackhi_epi64(t0, t2));
+            _mm_storeu_si128((__m128i *) &result[n + 2], _mm_unpacklo_epi64(t1, t3));
+            _mm_storeu_si128((__m128i *) &result[n + 3], _mm_unpackhi_epi64(t1, t3));
+            n += 4;
+        } else {
+            __m128i clipped[4];
+
+            clipped[0] = _mm_unpacklo_epi64(t0, t2);
+            clipped[1] = _mm_unpackhi_epi64(t0, t2);
+            clipped[2] = _mm_unpacklo_epi64(t1, t3);
+            clipped[3] = _mm_unpackhi_epi64(t1, t3);
+            for (j = 0; j < 4; ++j) {
+                if (visible & (1 << j)) {
+                    _mm_storeu_si128((__m128i *) &result[n++], clipped[j]);
+                }
+            }
+        }
+    }
+    *numrects = n;
+    return i;
+}
+#endif /* __SSE2__ */
+
+int
+SDL_ClipRects(const SDL_Rect * clip, const SDL_Rect * rects, int count,
+              SDL_Rect * result)
+{
+    int i = 0, numrects = 0;
+
+#ifdef __SSE2__
+    if (count >= 4 && SDL_HasSSE2()) {
+        i = SDL_ClipRects_SSE2(clip, rects, count, result, &numrects);
+    }
+#endif
+    for (; i < count; ++i) {
+        if (SDL_IntersectRect(&rects[i], clip, &result[numrects])) {
+            ++numrects;
+        }
+    }
+    return numrects;
+}
+
+/* Region operations walk both regions a band at a time, and combine the
+   spans of the bands that are there at each height. */
+typedef enum
+{
+    REGION_UNION,
+    REGION_INTERSECT,
+    REGION_SUBTRACT
+} SDL_RegionOp;
+
+/* Small regions fit in this many rects on the stack */
+#define REGION_STACK_RECTS  16
+
+void
+SDL_InitRegion(SDL_Region * region)
+{
+    SDL_zerop(region);
+}
+
+void
+SDL_InitRegionWithBuffer(SDL_Region * region, SDL_Rect * buffer, int maxrects)
+{
+    SDL_zerop(region);
+    region->rects = buffer;
+    region->maxrects = maxrects;
+    region->buffer = buffer;
+}
+
+void
+SDL_FreeRegion(SDL_Region * region)
+{
+    if (region->rects != region->buffer) {
+        SDL_free(region->rects);
+    }
+    SDL_zerop(region);
+}
+
+void
+SDL_ClearRegion(SDL_Region * region)
+{
+    region->numrects = 0;
+    SDL_zero(region->bounds);
+}
+
+static int
+ReserveRegion(SDL_Region * region, int numrects)
+{
+    if (numrects > region->maxrects) {
+        int maxrects = region->maxrects ? region->maxrects : 16;
+        SDL_Rect *rects;
+
+        while (maxrects < numrects) {
+            maxrects *= 2;
+        }
+        if (region->rects && region->rects != region->buffer) {
+            rects = (SDL_Rect *) SDL_realloc(region->rects, maxrects * sizeof(*rects));
+        } else {
+            /* leave the buffer the region started with */
+            rects = (SDL_Rect *) SDL_malloc(maxrects * sizeof(*rects));
+            if (rects && region->numrects > 0) {
+                SDL_memcpy(rects, region->rects, region->numrects * sizeof(*rects));
+            }
+        }
+        if (!rects) {
+            return SDL_OutOfMemory();
+        }
+        region->rects = rects;
+        region->maxrects = maxrects;
+    }
+    return 0;
+}
+
+/* A region of one rect, or none if it's empty, that can only be read */
+static void
+RectRegion(SDL_Region * region, const SDL_Rect * rect)
+{
+    region->numrects = SDL_RectEmpty(rect) ? 0 : 1;
+    region->maxrects = 0;
+    region->rects = (SDL_Rect *) rect;
+    region->bounds = *rect;
+    region->buffer = NULL;
+}
+
+/* Hands the rects of src, which must be on the heap, over to dst */
+static void
+MoveRegion(SDL_Region * dst, SDL_Region * src)
+{
+    if (dst->rects != dst->buffer) {
+        SDL_free(dst->rects);
+    }
+    dst->numrects = src->numrects;
+    dst->maxrects = src->maxrects;
+    dst->rects = src->rects;
+    dst->bounds = src->bounds;
+    SDL_zerop(src);
+}
+
+static void
+UpdateRegionBounds(SDL_Region * region)
+{
+    const SDL_Rect *rects = region->rects;
+    const int numrects = region->numrects;
+    int x1, x2, i;
+
+    if (numrects == 0) {
+        SDL_zero(region->bounds);
+        return;
+    }
+    x1 = rects[0].x;
+    x2 = rects[0].x + rects[0].w;
+    for (i = 1; i < numrects; ++i) {
+        x1 = SDL_min(x1, rects[i].x);
+        x2 = SDL_max(x2, rects[i].x + rects[i].w);
+    }
+    region->bounds.x = x1;
+    region->bounds.y = rects[0].y;
+    region->bounds.w = x2 - x1;
+    region->bounds.h = rects[numrects - 1].y + rects[numrects - 1].h - rects[0].y;
+}
+
+static int
+BandEnd(const SDL_Rect * rects, int start, int numrects)
+{
+    int end = start + 1;
+
+    while (end < numrects && rects[end].y == rects[start].y) {
+        ++end;
+    }
+    return end;
+}
+
+/* Merges the band starting at band with the one before it, starting at
+   *last_band, if it continues it with the same spans. Returns the number
+   of rects the region has after that. */
+static int
+CoalesceBand(SDL_Rect * rects, int *last_band, int band, int numrects)
+{
+    const int previous = *last_band;
+    int i;
+
+    if (band == numrects) {
+        return numrects;
+    }
+    if (previous >= 0 && band - previous == numrects - band &&
+        rects[previous].y + rects[previous].h == rects[band].y) {
+        for (i = 0; i < numrects - band; ++i) {
+            if (rects[previous + i].x != rects[band + i].x ||
+                rects[previous + i].w != rects[band + i].w) {
+                break;
+            }
+        }
+        if (i == numrects - band) {
+            for (i = previous; i < band; ++i) {
+                rects[i].h += rects[band].h;
+            }
+            return band;
+        }
+    }
+    *last_band = band;
+    return numrects;
+}
+
+static SDL_INLINE void
+AddSpan(SDL_Rect * rects, int *numrects, int x1, int x2, int y, int h)
+{
+    SDL_Rect *rect = &rects[(*numrects)++];
+
+    rect->x = x1;
+    rect->y = y;
+    rect->w = x2 - x1;
+    rect->h = h;
+}
+
+/* Adds the spans of A and B from y to y + h, or of only one of them if the
+   other is NULL */
+static void
+AddBand(SDL_Region * result, SDL_RegionOp op, const SDL_Rect * A, int numA,
+        const SDL_Rect * B, int numB, int y, int h)
+{
+    SDL_Rect *rects = result->rects;
+    int n = result->numrects;
+    int i = 0, j = 0;
+
+    if (!B) {
+        for (i = 0; i < numA; ++i) {
+            AddSpan(rects, &n, A[i].x, A[i].x + A[i].w, y, h);
+        }
+    } else if (!A) {
+        for (j = 0; j < numB; ++j) {
+            AddSpan(rects, &n, B[j].x, B[j].x + B[j].w, y, h);
+        }
+    } else if (op == REGION_UNION) {
+        int x1 = 0, x2 = 0;
+        SDL_bool open = SDL_FALSE;
+
+        while (i < numA || j < numB) {
+            const SDL_Rect *next;
+
+            if (j == numB || (i < numA && A[i].x <= B[j].x)) {
+                next = &A[i++];
+            } else {
+                next = &B[j++];
+            }
+            if (open && next->x <= x2) {
+                x2 = SDL_max(x2, next->x + next->w);
+            } else {
+                if (open) {
+                    AddSpan(rects, &n, x1, x2, y, h);
+                }
+                x1 = next->x;
+                x2 = next->x + next->w;
+                open = SDL_TRUE;
+            }
+        }
+        if (open) {
+            AddSpan(rects, &n, x1, x2, y, h);
+        }
+    } else if (op == REGION_INTERSECT) {
+        while (i < numA && j < numB) {
+            const int Ax2 = A[i].x + A[i].w;
+            const int Bx2 = B[j].x + B[j].w;
+            const int x1 = SDL_max(A[i].x, B[j].x);
+            const int x2 = SDL_min(Ax2, Bx2);
+
+            if (x1 < x2) {
+                AddSpan(rects, &n, x1, x2, y, h);
+            }
+            if (Ax2 <= Bx2) {
+                ++i;
+            } else {
+                ++j;
+            }
+        }
+    } else {
+        for (i = 0; i < numA; ++i) {
+            const int Ax2 = A[i].x + A[i].w;
+            int x = A[i].x, k;
+
+            while (j < numB && B[j].x + B[j].w <= x) {
+                ++j;
+            }
+            for (k = j; k < numB && B[k].x < Ax2; ++k) {
+                if (B[k].x > x) {
+                    AddSpan(rects, &n, x, B[k].x, y, h);
+                }
+                x = SDL_max(x, B[k].x + B[k].w);
+            }
+            if (x < Ax2) {
+                AddSpan(rects, &n, x, Ax2, y, h);
+            }
+        }
+    }
+    result->numrects = n;
+}
+
+/* Combines A and B into result, which mustn't be either of them */
+static int
+RegionOp(SDL_Region * result, const SDL_Region * A, const SDL_Region * B,
+         SDL_RegionOp op)
+{
+    const SDL_Rect *a = A->rects;
+    const SDL_Rect *b = B->rects;
+    const int numA = A->numrects;
+    const int numB = B->numrects;
+    int ia = 0, ib = 0;
+    int y = (-0x7FFFFFFF - 1);
+    int last_band = -1;
+
+    result->numrects = 0;
+    while (ia < numA || ib < numB) {
+        const int endA = (ia < numA) ? BandEnd(a, ia, numA) : ia;
+        const int endB = (ib < numB) ? BandEnd(b, ib, numB) : ib;
+        SDL_bool onA = SDL_FALSE, onB = SDL_FALSE;
+        int top = 0x7FFFFFFF, bottom = 0x7FFFFFFF;
+        int band;
+
+        if (ia < numA) {
+            top = SDL_max(a[ia].y, y);
+        }
+        if (ib < numB) {
+            top = SDL_min(top, SDL_max(b[ib].y, y));
+        }
+        if (ia < numA) {
+            onA = (a[ia].y <= top);
+            bottom = onA ? (a[ia].y + a[ia].h) : a[ia].y;
+        }
+        if (ib < numB) {
+            onB = (b[ib].y <= top);
+            bottom = SDL_min(bottom, onB ? (b[ib].y + b[ib].h) : b[ib].y);
+        }
+
+        if ((onA && onB) || (onA && op != REGION_INTERSECT) || (onB && op == REGION_UNION)) {
+            if (ReserveRegion(result, result->numrects + (endA - ia) + (endB - ib)) < 0) {
+                return -1;
+            }
+            band = result->numrects;
+            AddBand(result, op, onA ? &a[ia] : NULL, endA - ia,
+                    onB ? &b[ib] : NULL, endB - ib, top, bottom - top);
+            result->numrects = CoalesceBand(result->rects, &last_band, band, result->numrects);
+        }
+
+        if (onA && a[ia].y + a[ia].h == bottom) {
+            ia = endA;
+        }
+        if (onB && b[ib].y + b[ib].h == bottom) {
+            ib = endB;
+        }
+        y = bottom;
+
+        /* Nothing more can come out of the rest */
+        if ((ia == numA && op != REGION_UNION) || (ib == numB && op == REGION_INTERSECT)) {
+            break;
+        }
+    }
+    UpdateRegionBounds(result);
+    return 0;
+}
+
+static int
+SDL_CopyRegion(SDL_Region * dst, const SDL_Region * src)
+{
+    if (dst == src) {
+        return 0;
+    }
+    if (ReserveRegion(dst, src->numrects) < 0) {
+        return -1;
+    }
+    if (src->numrects) {
+        SDL_memcpy(dst->rects, src->rects, src->numrects * sizeof(*src->rects));
+    }
+    dst->numrects = src->numrects;
+    dst->bounds = src->bounds;
+    return 0;
+}
+
+/* Runs an operation that may have the result as an input */
+static int
+SDL_CombineRegions(SDL_Region * result, const SDL_Region * A,
+                   const SDL_Region * B, SDL_RegionOp op)
+{
+    SDL_Rect buffer[REGION_STACK_RECTS];
+    SDL_Region combined;
+    int status;
+
+    if (result != A && result != B) {
+        return RegionOp(result, A, B, op);
+    }
+    SDL_InitRegionWithBuffer(&combined, buffer, SDL_arraysize(buffer));
+    status = RegionOp(&combined, A, B, op);
+    if (status == 0) {
+        if (combined.rects == combined.buffer) {
+            status = SDL_CopyRegion(result, &combined);
+        } else {
+            MoveRegion(result, &combined);
+        }
+    }
+    SDL_FreeRegion(&combined);
+    return status;
+}
+
+static int SDLCALL
+CompareRectTops(const void *A, const void *B)
+{
+    const SDL_Rect *a = (const SDL_Rect *) A;
+    const SDL_Rect *b = (const SDL_Rect *) B;
+
+    return (a->y < b->y) ? -1 : (a->y > b->y);
+}
+
+/* Sweeps down through the tops and bottoms of the rects, keeping the ones
+   crossing the current band sorted by x, and adds the union of their spans
+   as each band. */
+static int
+BuildRegion(SDL_Region * region, const SDL_Rect * rects, int numrects)
+{
+    SDL_Rect buffer[2 * REGION_STACK_RECTS];
+    SDL_Rect *sorted, *active;
+    int numsorted = 0, numactive = 0, next = 0;
+    int last_band = -1;
+    int y, bottom, band, x1, x2, i, j;
+
+    if (numrects <= REGION_STACK_RECTS) {
+        sorted = buffer;
+    } else {
+        sorted = (SDL_Rect *) SDL_malloc(2 * numrects * sizeof(*sorted));
+        if (!sorted) {
+            return SDL_OutOfMemory();
+        }
+    }
+    active = sorted + numrects;
+    for (i = 0; i < numrects; ++i) {
+        if (!SDL_RectEmpty(&rects[i])) {
+            sorted[numsorted++] = rects[i];
+        }
+    }
+    SDL_qsort(sorted, numsorted, sizeof(*sorted), CompareRectTops);
+
+    y = numsorted ? sorted[0].y : 0;
+    while (next < numsorted || numactive > 0) {
+        /* Start the rects beginning at this height */
+        for (; next < numsorted && sorted[next].y == y; ++next) {
+            int lo = 0, hi = numactive;
+
+            while (lo < hi) {
+                const int mid = (lo + hi) / 2;
+                if (active[mid].x <= sorted[next].x) {
+                    lo = mid + 1;
+                } else {
+                    hi = mid;
+                }
+            }
+            SDL_memmove(&active[lo + 1], &active[lo], (numactive - lo) * sizeof(*active));
+            active[lo] = sorted[next];
+            ++numactive;
+        }
+
+        bottom = (next < numsorted) ? sorted[next].y : 0x7FFFFFFF;
+        for (i = 0; i < numactive; ++i) {
+            bottom = SDL_min(bottom, active[i].y + active[i].h);
+        }
+
+        if (ReserveRegion(region, region->numrects + numactive) < 0) {
+            if (sorted != buffer) {
+                SDL_free(sorted);
+            }
+            return -1;
+        }
+        band = region->numrects;
+        x1 = active[0].x;
+        x2 = active[0].x + active[0].w;
+        for (i = 1; i < numactive; ++i) {
+            if (active[i].x <= x2) {
+                x2 = SDL_max(x2, active[i].x + active[i].w);
+            } else {
+                AddSpan(region->rects, &region->numrects, x1, x2, y, bottom - y);
+                x1 = active[i].x;
+                x2 = active[i].x + active[i].w;
+            }
+        }
+        AddSpan(region->rects, &region->numrects, x1, x2, y, bottom - y);
+        region->numrects = CoalesceBand(region->rects, &last_band, band, region->numrects);
+
+        /* Finish the rects ending at the bottom of the band */
+        for (i = 0, j = 0; i < numactive; ++i) {
+            if (active[i].y + active[i].h != bottom) {
+                active[j++] = active[i];
+            }
+        }
+        numactive = j;
+        y = (numactive == 0 && next < numsorted) ? sorted[next].y : bottom;
+    }
+    if (sorted != buffer) {
+        SDL_free(sorted);
+    }
+    UpdateRegionBounds(region);
+    return 0;
+}
+
+int
+SDL_SetRegionRects(SDL_Region * region, const SDL_Rect * rects, int numrects)
+{
+    SDL_Region rect;
+
+    SDL_ClearRegion(region);
+    if (numrects <= 0) {
+        return 0;
+    }
+    if (numrects == 1) {
+        RectRegion(&rect, &rects[0]);
+        return SDL_CopyRegion(region, &rect);
+    }
+    return BuildRegion(region, rects, numrects);
+}
+
+int
+SDL_UnionRegion(SDL_Region * result, const SDL_Region * A, const SDL_Region * B)
+{
+    if (B->numrects == 0) {
+        return SDL_CopyRegion(result, A);
+    }
+    if (A->numrects == 0) {
+        return SDL_CopyRegion(result, B);
+    }
+    return SDL_CombineRegions(result, A, B, REGION_UNION);
+}
+
+int
+SDL_IntersectRegion(SDL_Region * result, const SDL_Region * A, const SDL_Region * B)
+{
+    if (!SDL_HasIntersection(&A->bounds, &B->bounds) ||
+        A->numrects == 0 || B->numrects == 0) {
+        SDL_ClearRegion(result);
+        return 0;
+    }
+    return SDL_CombineRegions(result, A, B, REGION_INTERSECT);
+}
+
+int
+SDL_SubtractRegion(SDL_Region * result, const SDL_Region * A, const SDL_Region * B)
+{
+    if (!SDL_HasIntersection(&A->bounds, &B->bounds) ||
+        A->numrects == 0 || B->numrects == 0) {
+        return SDL_CopyRegion(result, A);
+    }
+    return SDL_CombineRegions(result, A, B, REGION_SUBTRACT);
+}
+
+int
+SDL_UnionRegionRect(SDL_Region * region, const SDL_Rect * rect)
+{
+    SDL_Region B;
+
+    if (SDL_RectEmpty(rect)) {
+        return 0;
+    }
+
+    /* Rects added from the top down become new bands at the end */
+    if (region->numrects > 0 && rect->y >= region->bounds.y + region->bounds.h) {
+        int last_band = region->numrects - 1;
+        int band;
+
+        while (last_band > 0 && region->rects[last_band - 1].y == region->rects[last_band].y) {
+            --last_band;
+        }
+        if (ReserveRegion(region, region->numrects + 1) < 0) {
+            return -1;
+        }
+        band = region->numrects;
+        region->rects[region->numrects++] = *rect;
+        region->numrects = CoalesceBand(region->rects, &last_band, band, region->numrects);
+        SDL_UnionRect(&region->bounds, rect, &region->bounds);
+        return 0;
+    }
+
+    RectRegion(&B, rect);
+    return SDL_UnionRegion(region, region, &B);
+}
+
+int
+SDL_IntersectRegionRect(SDL_Region * region, const SDL_Rect * rect)
+{
+    int numrects, last_band = -1, band, end, i;
+
+    /* Clipping keeps the bands in order, but may leave some to merge */
+    numrects = SDL_ClipRects(rect, region->rects, region->numrects, region->rects);
+    region->numrects = 0;
+    for (band = 0; band < numrects; band = end) {
+        const int start = region->numrects;
+
+        end = BandEnd(region->rects, band, numrects);
+        for (i = band; i < end; ++i) {
+            region->rects[region->numrects++] = region->rects[i];
+        }
+        region->numrects = CoalesceBand(region->rects, &last_band, start, region->numrects);
+    }
+    UpdateRegionBounds(region);
+    return 0;
+}
+
+int
+SDL_SubtractRegionRect(SDL_Region * region, const SDL_Rect * rect)
+{
+    SDL_Region B;
+
+    RectRegion(&B, rect);
+    return SDL_SubtractRegion(region, region, &B);
+}
+
+void
+SDL_TranslateRegion(SDL_Region * region, int dx, int dy)
+{
+    int i;
+
+    for (i = 0; i < region->numrects; ++i) {
+        region->rects[i].x += dx;
+        region->rects[i].y += dy;
+    }
+    if (region->numrects > 0) {
+        region->bounds.x += dx;
+        region->bounds.y += dy;
+    }
+}
+
 /* vi: set ts=4 sw=4 expandtab: */
@@ -20,6 +20,59 @@
 */
 #include "../SDL_internal.h"
 
+#ifndef SDL_rect_c_h_
+#define SDL_rect_c_h_
+
 extern SDL_bool SDL_GetSpanEnclosingRect(int width, int height, int numrects, const SDL_Rect * rects, SDL_Rect *span);
 
+/* The most rectangles a damaged region is kept in */
+#define SDL_MAX_DAMAGE_RECTS    16
+
+/* A set of disjoint rectangles covering the areas that need to be presented */
+typedef struct SDL_DamageRegion
+{
+    int numrects;
+    SDL_Rect rects[SDL_MAX_DAMAGE_RECTS];
+} SDL_DamageRegion;
+
+extern void SDL_AddDamage(SDL_DamageRegion * damage, const SDL_Rect * rect);
+
+/* Clips rects to clip, storing the non-empty results in order, and returns
+   how many there are. The results may be stored over the rects. */
+extern int SDL_ClipRects(const SDL_Rect * clip, const SDL_Rect * rects, int count, SDL_Rect * result);
+
+/* A set of pixels, kept as disjoint rectangles grouped into bands. The
+   rectangles of a band have the same y and h, are sorted by x and don't
+   touch. Bands are sorted by y, and bands that touch don't have the same
+   rectangles, so every set of pixels has exactly one representation.
+
+   Regions start zeroed or with SDL_InitRegion(), and their rects can be
+   read in order. SDL_InitRegionWithBuffer() lets a region use the caller's
+   storage, often on the stack, until it needs more rects than that. The
+   functions returning int return 0, or -1 when out of memory. The result
+   of an operation may be one of its inputs. */
+typedef struct SDL_Region
+{
+    int numrects;
+    int maxrects;
+    SDL_Rect *rects;
+    SDL_Rect bounds;
+    SDL_Rect *buffer;           /* storage from the caller, never freed */
+} SDL_Region;
+
+extern void SDL_InitRegion(SDL_Region * region);
+extern void SDL_InitRegionWithBuffer(SDL_Region * region, SDL_Rect * buffer, int maxrects);
+extern void SDL_FreeRegion(SDL_Region * region);
+extern void SDL_ClearRegion(SDL_Region * region);
+extern int SDL_SetRegionRects(SDL_Region * region, const SDL_Rect * rects, int numrects);
+extern int SDL_UnionRegion(SDL_Region * result, const SDL_Region * A, const SDL_Region * B);
+extern int SDL_IntersectRegion(SDL_Region * result, const SDL_Region * A, const SDL_Region * B);
+extern int SDL_SubtractRegion(SDL_Region * result, const SDL_Region * A, const SDL_Region * B);
+extern int SDL_UnionRegionRect(SDL_Region * region, const SDL_Rect * rect);
+extern int SDL_IntersectRegionRect(SDL_Region * region, const SDL_Rect * rect);
+extern int SDL_SubtractRegionRect(SDL_Region * region, const SDL_Rect * rect);
+extern void SDL_TranslateRegion(SDL_Region * region, int dx, int dy);
+
+#endif /* SDL_rect_c_h_ */
+
 /* vi: set ts=4 sw=4 expandtab: */
@@ -27,12 +27,17 @@
 #include "SDL_pixels.h"
 #include "SDL_surface.h"
 #include "SDL_shape.h"
+#include "SDL_cpuinfo.h"
 #include "SDL_shape_internals.h"
 
 SDL_Window*
 SDL_CreateShapedWindow(const char *title,unsigned int x,unsigned int y,unsigned int w,unsigned int h,Uint32 flags)
 {
     SDL_Window *result = NULL;
+    if(SDL_GetVideoDevice() == NULL || SDL_GetVideoDevice()->shape_driver.CreateShaper == NULL) {
+        SDL_Unsupported();
+        return NULL;
+    }
     result = SDL_CreateWindow(title,-1000,-1000,w,h,(flags | SDL_WINDOW_BORDERLESS) & (~SDL_WINDOW_FULLSCREEN) & (~SDL_WINDOW_RESIZABLE) /* & (~SDL_WINDOW_SHOWN) */);
     if(result != NULL) {
         result->shaper = SDL_GetVideoDevice()->shape_driver.CreateShaper(result);
@@ -62,163 +67,479 @@ SDL_IsShapedWindow(const SDL_Window *window)
         return (SDL_bool)(window->shaper != NULL);
 }
 
-/* REQUIRES that bitmap point to a w-by-h bitmap with ppb pixels-per-byte. */
-void
-SDL_CalculateShapeBitmap(SDL_WindowShapeMode mode,SDL_Surface *shape,Uint8* bitmap,Uint8 ppb)
+/* How the pixels of a shape are tested for opacity: 32-bit pixels with an
+   8-bit alpha channel or 8-bit color channels are tested directly, others
+   are converted with SDL_GetRGBA(). */
+typedef enum { ShapeTestPixel,ShapeTestAlpha32,ShapeTestKey32 } SDL_ShapeTestKind;
+
+typedef struct {
+    SDL_ShapeTestKind kind;
+    SDL_WindowShapeMode mode;
+    SDL_PixelFormat *format;
+    /* Pixels with an alpha between lo and hi are opaque */
+    int lo,hi;
+    /* The alpha, or the color masked, of 32-bit pixels */
+    Uint32 mask;
+    int shift;
+    Uint32 key;
+    SDL_bool sse2;
+} SDL_ShapeTest;
+
+static void
+SDL_InitShapeTest(SDL_ShapeTest *test,SDL_WindowShapeMode mode,SDL_PixelFormat *format)
+{
+    SDL_PixelFormat *pf = format;
+
+    test->kind = ShapeTestPixel;
+    test->mode = mode;
+    test->format = format;
+    test->lo = 1;
+    test->hi = 255;
+    if(mode.mode == ShapeModeBinarizeAlpha)
+        test->lo = mode.parameters.binarizationCutoff;
+    else if(mode.mode == ShapeModeReverseBinarizeAlpha) {
+        test->lo = 0;
+        test->hi = mode.parameters.binarizationCutoff;
+    }
+    test->mask = 0;
+    test->shift = 0;
+    test->key = 0;
+    if(pf->BytesPerPixel == 4) {
+        if(SDL_SHAPEMODEALPHA(mode.mode) && pf->Amask == ((Uint32)0xFF << pf->Ashift)) {
+            test->kind = ShapeTestAlpha32;
+            test->mask = 0xFF;
+            test->shift = pf->Ashift;
+        }
+        else if(mode.mode == ShapeModeColorKey && pf->Rloss == 0 && pf->Gloss == 0 && pf->Bloss == 0) {
+            test->kind = ShapeTestKey32;
+            test->mask = pf->Rmask | pf->Gmask | pf->Bmask;
+            test->key = SDL_MapRGB(pf,mode.parameters.colorKey.r,mode.parameters.colorKey.g,mode.parameters.colorKey.b) & test->mask;
+        }
+    }
+    test->sse2 = SDL_HasSSE2();
+}
+
+static Uint8
+SDL_IsShapePixelOpaque(const SDL_ShapeTest *test,Uint32 pixel_value)
 {
-    int x = 0;
-    int y = 0;
     Uint8 r = 0,g = 0,b = 0,alpha = 0;
-    Uint8* pixel = NULL;
-    Uint32 bitmap_pixel,pixel_value = 0,mask_value = 0;
     SDL_Color key;
-    if(SDL_MUSTLOCK(shape))
-        SDL_LockSurface(shape);
-    for(y = 0;y<shape->h;y++) {
-        for(x=0;x<shape->w;x++) {
-            alpha = 0;
-            pixel_value = 0;
-            pixel = (Uint8 *)(shape->pixels) + (y*shape->pitch) + (x*shape->format->BytesPerPixel);
-            switch(shape->format->BytesPerPixel) {
-                case(1):
-                    pixel_value = *(Uint8*)pixel;
-                    break;
-                case(2):
-                    pixel_value = *(Uint16*)pixel;
-                    break;
-                case(3):
-                    pixel_value = *(Uint32*)pixel & (~shape->format->Amask);
-                    break;
-                case(4):
-                    pixel_value = *(Uint32*)pixel;
-                    break;
-            }
-            SDL_GetRGBA(pixel_value,shape->format,&r,&g,&b,&alpha);
-            bitmap_pixel = y*shape->w + x;
-            switch(mode.mode) {
-                case(ShapeModeDefault):
-                    mask_value = (alpha >= 1 ? 1 : 0);
-                    break;
-                case(ShapeModeBinarizeAlpha):
-                    mask_value = (alpha >= mode.parameters.binarizationCutoff ? 1 : 0);
-                    break;
-                case(ShapeModeReverseBinarizeAlpha):
-                    mask_value = (alpha <= mode.parameters.binarizationCutoff ? 1 : 0);
-                    break;
-                case(ShapeModeColorKey):
-                    key = mode.parameters.colorKey;
-                    mask_value = ((key.r != r || key.g != g || key.b != b) ? 1 : 0);
-                    break;
+
+    SDL_GetRGBA(pixel_value,test->format,&r,&g,&b,&alpha);
+    if(test->mode.mode == ShapeModeColorKey) {
+        key = test->mode.parameters.colorKey;
+        return ((key.r != r || key.g != g || key.b != b) ? 1 : 0);
+    }
+    return ((alpha >= test->lo && alpha <= test->hi) ? 1 : 0);
+}
+
+#ifdef __SSE2__
+/* Tests 16 pixels at a time, returning how many were tested */
+static int
+SDL_TestShapeRowSSE2(const SDL_ShapeTest *test,const Uint32 *row,int w,Uint8 *opaque)
+{
+    const __m128i mask = _mm_set1_epi32((int)test->mask);
+    const __m128i key = _mm_set1_epi32((int)test->key);
+    const __m128i lo = _mm_set1_epi32(test->lo);
+    const __m128i hi = _mm_set1_epi32(test->hi);
+    const __m128i shift = _mm_cvtsi32_si128(test->shift);
+    const __m128i one = _mm_set1_epi8(1);
+    __m128i clear[4];
+    int x,i;
+
+    for(x = 0;x + 16 <= w;x += 16) {
+        for(i = 0;i < 4;i++) {
+            const __m128i pixels = _mm_loadu_si128((const __m128i *)(row + x + i * 4));
+            if(test->kind == ShapeTestAlpha32) {
+                const __m128i alpha = _mm_and_si128(_mm_srl_epi32(pixels,shift),mask);
+                clear[i] = _mm_or_si128(_mm_cmpgt_epi32(lo,alpha),_mm_cmpgt_epi32(alpha,hi));
             }
-            bitmap[bitmap_pixel / ppb] |= mask_value << (7 - ((ppb - 1) - (bitmap_pixel % ppb)));
+            else
+                clear[i] = _mm_cmpeq_epi32(_mm_and_si128(pixels,mask),key);
         }
+        clear[0] = _mm_packs_epi16(_mm_packs_epi32(clear[0],clear[1]),_mm_packs_epi32(clear[2],clear[3]));
+        _mm_storeu_si128((__m128i *)(opaque + x),_mm_andnot_si128(clear[0],one));
+    }
+    return x;
+}
+#endif /* __SSE2__ */
+
+/* Sets opaque[i] to 1 if the i-th of the w pixels is opaque, or to 0 */
+static void
+SDL_TestShapeRow(const SDL_ShapeTest *test,const Uint8 *pixels,int w,Uint8 *opaque)
+{
+    const Uint32 *row = (const Uint32 *)pixels;
+    const int bpp = test->format->BytesPerPixel;
+    Uint32 pixel_value;
+    int x = 0;
+
+#ifdef __SSE2__
+    if(test->kind != ShapeTestPixel && test->sse2)
+        x = SDL_TestShapeRowSSE2(test,row,w,opaque);
+#endif
+    switch(test->kind) {
+        case(ShapeTestAlpha32):
+            for(;x<w;x++) {
+                const int alpha = (int)((row[x] >> test->shift) & test->mask);
+                opaque[x] = ((alpha >= test->lo && alpha <= test->hi) ? 1 : 0);
+            }
+            break;
+        case(ShapeTestKey32):
+            for(;x<w;x++)
+                opaque[x] = (((row[x] & test->mask) != test->key) ? 1 : 0);
+            break;
+        default:
+            for(;x<w;x++,pixels+=bpp) {
+                pixel_value = 0;
+                switch(bpp) {
+                    case(1):
+                        pixel_value = *(Uint8*)pixels;
+                        break;
+                    case(2):
+                        pixel_value = *(Uint16*)pixels;
+                        break;
+                    case(3):
+#if SDL_BYTEORDER == SDL_LIL_ENDIAN
+                        pixel_value = pixels[0] | (pixels[1] << 8) | (pixels[2] << 16);
+#else
+                        pixel_value = (pixels[0] << 16) | (pixels[1] << 8) | pixels[2];
+#endif
+                        break;
+                    case(4):
+                        pixel_value = *(Uint32*)pixels;
+                        break;
+                }
+                opaque[x] = SDL_IsShapePixelOpaque(test,pixel_value);
+            }
+            break;
     }
+}
+
+/* Clips rect, or takes the whole shape if it's NULL, and allocates a row of
+   opacity tests for it. Returns 1 if there's nothing to test, or -1 if out
+   of memory. */
+static int
+SDL_BeginShapeRows(SDL_Surface *shape,const SDL_Rect *rect,SDL_Rect *area,Uint8 **opaque)
+{
+    SDL_Rect bounds;
+
+    bounds.x = 0;
+    bounds.y = 0;
+    bounds.w = shape->w;
+    bounds.h = shape->h;
+    if(rect == NULL)
+        *area = bounds;
+    else if(!SDL_IntersectRect(rect,&bounds,area))
+        return 1;
+    if(SDL_RectEmpty(area))
+        return 1;
+    *opaque = (Uint8*)SDL_malloc(area->w);
+    if(*opaque == NULL)
+        return SDL_OutOfMemory();
+    if(SDL_MUSTLOCK(shape))
+        SDL_LockSurface(shape);
+    return 0;
+}
+
+static void
+SDL_EndShapeRows(SDL_Surface *shape,Uint8 *opaque)
+{
     if(SDL_MUSTLOCK(shape))
         SDL_UnlockSurface(shape);
+    SDL_free(opaque);
 }
 
-static SDL_ShapeTree*
-RecursivelyCalculateShapeTree(SDL_WindowShapeMode mode,SDL_Surface* mask,SDL_Rect dimensions) {
-    int x = 0,y = 0;
-    Uint8* pixel = NULL;
-    Uint32 pixel_value = 0;
-    Uint8 r = 0,g = 0,b = 0,a = 0;
-    SDL_bool pixel_opaque = SDL_FALSE;
-    int last_opaque = -1;
-    SDL_Color key;
-    SDL_ShapeTree* result = (SDL_ShapeTree*)SDL_malloc(sizeof(SDL_ShapeTree));
-    SDL_Rect next = {0,0,0,0};
-
-    for(y=dimensions.y;y<dimensions.y + dimensions.h;y++) {
-        for(x=dimensions.x;x<dimensions.x + dimensions.w;x++) {
-            pixel_value = 0;
-            pixel = (Uint8 *)(mask->pixels) + (y*mask->pitch) + (x*mask->format->BytesPerPixel);
-            switch(mask->format->BytesPerPixel) {
-                case(1):
-                    pixel_value = *(Uint8*)pixel;
-                    break;
-                case(2):
-                    pixel_value = *(Uint16*)pixel;
-                    break;
-                case(3):
-                    pixel_value = *(Uint32*)pixel & (~mask->format->Amask);
-                    break;
-                case(4):
-                    pixel_value = *(Uint32*)pixel;
-                    break;
+/* REQUIRES that bitmap point to a w-by-h bitmap with ppb pixels-per-byte, each row starting at a new byte. */
+int
+SDL_CalculateShapeBitmap(SDL_WindowShapeMode mode,SDL_Surface *shape,Uint8* bitmap,Uint8 ppb)
+{
+    const int bitmap_pitch = (shape->w + ppb - 1) / ppb;
+    SDL_ShapeTest test;
+    SDL_Rect area;
+    int result;
+    Uint8 *opaque = NULL,*bits,*o;
+    int x,y,end,shift;
+
+    result = SDL_BeginShapeRows(shape,NULL,&area,&opaque);
+    if(result != 0)
+        return (result < 0) ? -1 : 0;
+    SDL_InitShapeTest(&test,mode,shape->format);
+    end = area.x + area.w;
+    for(y = area.y;y < area.y + area.h;y++) {
+        SDL_TestShapeRow(&test,(Uint8*)shape->pixels + y * shape->pitch + area.x * shape->format->BytesPerPixel,area.w,opaque);
+        bits = bitmap + y * bitmap_pitch;
+        o = opaque;
+        x = area.x;
+        if(ppb == 8) {
+            /* Set whole bytes at once between the partial ones at the ends */
+            for(;x < end && (x % 8) != 0;x++,o++)
+                bits[x / 8] = (bits[x / 8] & ~(1 << (x % 8))) | (*o << (x % 8));
+            for(;x + 8 <= end;x += 8,o += 8)
+                bits[x / 8] = o[0] | (o[1] << 1) | (o[2] << 2) | (o[3] << 3) | (o[4] << 4) | (o[5] << 5) | (o[6] << 6) | (o[7] << 7);
+        }
+        for(;x < end;x++,o++) {
+            shift = 7 - ((ppb - 1) - (x % ppb));
+            bits[x / ppb] = (bits[x / ppb] & ~(1 << shift)) | (*o << shift);
+        }
+    }
+    SDL_EndShapeRows(shape,opaque);
+    return 0;
+}
+
+int
+SDL_CalculateShapeRegion(SDL_WindowShapeMode mode,SDL_Surface *shape,const SDL_Rect *rect,SDL_Region *region)
+{
+    SDL_ShapeTest test;
+    SDL_Region changed;
+    SDL_Rect area,*spans = NULL,*more;
+    int numspans = 0,maxspans = 0,last = 0,numlast = 0;
+    Uint8 *opaque = NULL;
+    int x,y,i,start,result;
+
+    result = SDL_BeginShapeRows(shape,rect,&area,&opaque);
+    if(result < 0)
+        return -1;
+    if(result > 0) {
+        if(rect == NULL)
+            SDL_ClearRegion(region);
+        return 0;
+    }
+    SDL_InitShapeTest(&test,mode,shape->format);
+    for(y = area.y;y < area.y + area.h;y++) {
+        SDL_TestShapeRow(&test,(Uint8*)shape->pixels + y * shape->pitch + area.x * shape->format->BytesPerPixel,area.w,opaque);
+        start = numspans;
+        for(x = 0;x < area.w;) {
+            while(x < area.w && !opaque[x])
+                x++;
+            if(x == area.w)
+                break;
+            if(numspans == maxspans) {
+                maxspans = maxspans ? maxspans * 2 : 64;
+                more = (SDL_Rect*)SDL_realloc(spans,maxspans * sizeof(SDL_Rect));
+                if(more == NULL) {
+                    SDL_EndShapeRows(shape,opaque);
+                    SDL_free(spans);
+                    return SDL_OutOfMemory();
+                }
+                spans = more;
             }
-            SDL_GetRGBA(pixel_value,mask->format,&r,&g,&b,&a);
-            switch(mode.mode) {
-                case(ShapeModeDefault):
-                    pixel_opaque = (a >= 1 ? SDL_TRUE : SDL_FALSE);
-                    break;
-                case(ShapeModeBinarizeAlpha):
-                    pixel_opaque = (a >= mode.parameters.binarizationCutoff ? SDL_TRUE : SDL_FALSE);
-                    break;
-                case(ShapeModeReverseBinarizeAlpha):
-                    pixel_opaque = (a <= mode.parameters.binarizationCutoff ? SDL_TRUE : SDL_FALSE);
-                    break;
-                case(ShapeModeColorKey):
-                    key = mode.parameters.colorKey;
-                    pixel_opaque = ((key.r != r || key.g != g || key.b != b) ? SDL_TRUE : SDL_FALSE);
+            spans[numspans].x = x;
+            spans[numspans].y = y - area.y;
+            spans[numspans].h = 1;
+            while(x < area.w && opaque[x])
+                x++;
+            spans[numspans].w = x - spans[numspans].x;
+            numspans++;
+        }
+        /* Rows with the same spans as the one above extend its spans down */
+        if(numspans - start == numlast && numlast > 0 && spans[last].y + spans[last].h == y - area.y) {
+            for(i = 0;i < numlast;i++) {
+                if(spans[last + i].x != spans[start + i].x || spans[last + i].w != spans[start + i].w)
                     break;
             }
-            if(last_opaque == -1)
-                last_opaque = pixel_opaque;
-            if(last_opaque != pixel_opaque) {
-                const int halfwidth = dimensions.w / 2;
-                const int halfheight = dimensions.h / 2;
-
-                result->kind = QuadShape;
-
-                next.x = dimensions.x;
-                next.y = dimensions.y;
-                next.w = halfwidth;
-                next.h = halfheight;
-                result->data.children.upleft = (struct SDL_ShapeTree *)RecursivelyCalculateShapeTree(mode,mask,next);
-
-                next.x = dimensions.x + halfwidth;
-                next.w = dimensions.w - halfwidth;
-                result->data.children.upright = (struct SDL_ShapeTree *)RecursivelyCalculateShapeTree(mode,mask,next);
-
-                next.x = dimensions.x;
-                next.w = halfwidth;
-                next.y = dimensions.y + halfheight;
-                next.h = dimensions.h - halfheight;
-                result->data.children.downleft = (struct SDL_ShapeTree *)RecursivelyCalculateShapeTree(mode,mask,next);
-
-                next.x = dimensions.x + halfwidth;
-                next.w = dimensions.w - halfwidth;
-                result->data.children.downright = (struct SDL_ShapeTree *)RecursivelyCalculateShapeTree(mode,mask,next);
-
-                return result;
+            if(i == numlast) {
+                for(i = 0;i < numlast;i++)
+                    spans[last + i].h++;
+                numspans = start;
+                continue;
             }
         }
+        last = start;
+        numlast = numspans - start;
+    }
+    SDL_EndShapeRows(shape,opaque);
+
+    /* The spans are relative to the area, like the opaque flags */
+    if(rect == NULL) {
+        result = SDL_SetRegionRects(region,spans,numspans);
+        if(result == 0)
+            SDL_TranslateRegion(region,area.x,area.y);
+    } else {
+        SDL_InitRegion(&changed);
+        result = SDL_SetRegionRects(&changed,spans,numspans);
+        if(result == 0) {
+            SDL_TranslateRegion(&changed,area.x,area.y);
+            result = SDL_SubtractRegionRect(region,&area);
+        }
+        if(result == 0)
+            result = SDL_UnionRegion(region,region,&changed);
+        SDL_FreeRegion(&changed);
+    }
+    SDL_free(spans);
+    return result;
+}
+
+/* Returns whether region covers all of rect, none of it, or only a part */
+static SDL_ShapeKind
+SDL_GetShapeRegionKind(const SDL_Region *region,const SDL_Rect *rect)
+{
+    const SDL_Rect *rects = region->rects;
+    const int right = rect->x + rect->w,bottom = rect->y + rect->h;
+    int covered = rect->y,lo = 0,hi = region->numrects,i;
+    SDL_bool some = SDL_FALSE,all = SDL_TRUE,band_all;
+
+    if(!SDL_HasIntersection(&region->bounds,rect))
+        return TransparentShape;
+
+    /* Find the first band reaching below the top of rect */
+    while(lo < hi) {
+        const int mid = (lo + hi) / 2;
+        if(rects[mid].y + rects[mid].h <= rect->y)
+            lo = mid + 1;
+        else
+            hi = mid;
+    }
+    for(i = lo;i < region->numrects && rects[i].y < bottom;) {
+        const int band_y = rects[i].y;
+        if(band_y > covered)
+            all = SDL_FALSE;
+        band_all = SDL_FALSE;
+        for(;i < region->numrects && rects[i].y == band_y;i++) {
+            if(rects[i].x + rects[i].w <= rect->x || rects[i].x >= right)
+                continue;
+            some = SDL_TRUE;
+            if(rects[i].x <= rect->x && rects[i].x + rects[i].w >= right)
+                band_all = SDL_TRUE;
+        }
+        if(!band_all)
+            all = SDL_FALSE;
+        if(some && !all)
+            return QuadShape;
+        covered = rects[i - 1].y + rects[i - 1].h;
     }
+    if(covered < bottom)
+        all = SDL_FALSE;
+    if(all)
+        return OpaqueShape;
+    return some ? QuadShape : TransparentShape;
+}
 
+/* Makes node the tree of region inside dimensions, splitting it in quadrants
+   until each is all transparent or all opaque. */
+static int
+SDL_BuildShapeTree(SDL_ShapeTree *node,const SDL_Region *region,SDL_Rect dimensions)
+{
+    const int halfwidth = dimensions.w / 2;
+    const int halfheight = dimensions.h / 2;
+    SDL_ShapeTree *children[4];
+    SDL_Rect next[4];
+    int i,result = 0;
 
-    /* If we never recursed, all the pixels in this quadrant have the same "value". */
-    result->kind = (last_opaque == SDL_TRUE ? OpaqueShape : TransparentShape);
-    result->data.shape = dimensions;
+    node->kind = SDL_GetShapeRegionKind(region,&dimensions);
+    if(node->kind != QuadShape) {
+        node->data.shape = dimensions;
+        return 0;
+    }
+
+    for(i = 0;i < 4;i++) {
+        next[i].x = dimensions.x + ((i & 1) ? halfwidth : 0);
+        next[i].y = dimensions.y + ((i & 2) ? halfheight : 0);
+        next[i].w = (i & 1) ? dimensions.w - halfwidth : halfwidth;
+        next[i].h = (i & 2) ? dimensions.h - halfheight : halfheight;
+        children[i] = (SDL_ShapeTree*)SDL_malloc(sizeof(SDL_ShapeTree));
+        if(children[i] == NULL) {
+            while(i--)
+                SDL_free(children[i]);
+            node->kind = OpaqueShape;
+            node->data.shape = dimensions;
+            return SDL_OutOfMemory();
+        }
+    }
+    for(i = 0;i < 4;i++) {
+        if(SDL_BuildShapeTree(children[i],region,next[i]) < 0)
+            result = -1;
+    }
+    node->data.children.upleft = (struct SDL_ShapeTree *)children[0];
+    node->data.children.upright = (struct SDL_ShapeTree *)children[1];
+    node->data.children.downleft = (struct SDL_ShapeTree *)children[2];
+    node->data.children.downright = (struct SDL_ShapeTree *)children[3];
     return result;
 }
 
-SDL_ShapeTree*
-SDL_CalculateShapeTree(SDL_WindowShapeMode mode,SDL_Surface* shape)
+/* Rebuilds the parts of node inside dimensions that rect touches */
+static int
+SDL_UpdateShapeNode(SDL_ShapeTree *node,const SDL_Region *region,SDL_Rect dimensions,const SDL_Rect *rect)
+{
+    const int halfwidth = dimensions.w / 2;
+    const int halfheight = dimensions.h / 2;
+    SDL_ShapeKind kind;
+    SDL_Rect next;
+    int result = 0;
+
+    if(!SDL_HasIntersection(&dimensions,rect))
+        return 0;
+    if(node->kind != QuadShape)
+        return SDL_BuildShapeTree(node,region,dimensions);
+
+    kind = SDL_GetShapeRegionKind(region,&dimensions);
+    if(kind != QuadShape) {
+        SDL_FreeShapeTree((SDL_ShapeTree **)(char*)&node->data.children.upleft);
+        SDL_FreeShapeTree((SDL_ShapeTree **)(char*)&node->data.children.upright);
+        SDL_FreeShapeTree((SDL_ShapeTree **)(char*)&node->data.children.downleft);
+        SDL_FreeShapeTree((SDL_ShapeTree **)(char*)&node->data.children.downright);
+        node->kind = kind;
+        node->data.shape = dimensions;
+        return 0;
+    }
+
+    next.x = dimensions.x;
+    next.y = dimensions.y;
+    next.w = halfwidth;
+    next.h = halfheight;
+    if(SDL_UpdateShapeNode((SDL_ShapeTree *)node->data.children.upleft,region,next,rect) < 0)
+        result = -1;
+
+    next.x = dimensions.x + halfwidth;
+    next.w = dimensions.w - halfwidth;
+    if(SDL_UpdateShapeNode((SDL_ShapeTree *)node->data.children.upright,region,next,rect) < 0)
+        result = -1;
+
+    next.x = dimensions.x;
+    next.w = halfwidth;
+    next.y = dimensions.y + halfheight;
+    next.h = dimensions.h - halfheight;
+    if(SDL_UpdateShapeNode((SDL_ShapeTree *)node->data.children.downleft,region,next,rect) < 0)
+        result = -1;
+
+    next.x = dimensions.x + halfwidth;
+    next.w = dimensions.w - halfwidth;
+    if(SDL_UpdateShapeNode((SDL_ShapeTree *)node->data.children.downright,region,next,rect) < 0)
+        result = -1;
+
+    return result;
+}
+
+int
+SDL_UpdateShapeTree(SDL_ShapeTree **shape_tree,const SDL_Region *region,int w,int h,const SDL_Rect *rect)
 {
     SDL_Rect dimensions;
-    SDL_ShapeTree* result = NULL;
 
     dimensions.x = 0;
     dimensions.y = 0;
-    dimensions.w = shape->w;
-    dimensions.h = shape->h;
+    dimensions.w = w;
+    dimensions.h = h;
 
-    if(SDL_MUSTLOCK(shape))
-        SDL_LockSurface(shape);
-    result = RecursivelyCalculateShapeTree(mode,shape,dimensions);
-    if(SDL_MUSTLOCK(shape))
-        SDL_UnlockSurface(shape);
+    if(*shape_tree != NULL && rect != NULL)
+        return SDL_UpdateShapeNode(*shape_tree,region,dimensions,rect);
+
+    if(*shape_tree != NULL)
+        SDL_FreeShapeTree(shape_tree);
+    *shape_tree = (SDL_ShapeTree*)SDL_malloc(sizeof(SDL_ShapeTree));
+    if(*shape_tree == NULL)
+        return SDL_OutOfMemory();
+    return SDL_BuildShapeTree(*shape_tree,region,dimensions);
+}
+
+SDL_ShapeTree*
+SDL_CalculateShapeTree(SDL_WindowShapeMode mode,SDL_Surface* shape)
+{
+    SDL_Region region;
+    SDL_ShapeTree* result = NULL;
+
+    SDL_InitRegion(&region);
+    if(SDL_CalculateShapeRegion(mode,shape,NULL,&region) == 0)
+        SDL_UpdateShapeTree(&result,&region,shape->w,shape->h,NULL);
+    SDL_FreeRegion(&region);
     return result;
 }
 
@@ -249,9 +570,18 @@ SDL_FreeShapeTree(SDL_ShapeTree** shape_tree)
     *shape_tree = NULL;
 }
 
+/* Presents leave out what the shape hides, so what it shows may be new */
+static void
+SDL_DamageShapedWindow(SDL_Window *window,const SDL_Rect *area)
+{
+    if(window->surface_valid && (window->surface->flags & SDL_TRACKDAMAGE))
+        SDL_AddDamage(&window->damage,area);
+}
+
 int
 SDL_SetWindowShape(SDL_Window *window,SDL_Surface *shape,SDL_WindowShapeMode *shape_mode)
 {
+    SDL_Rect area;
     int result;
     if(window == NULL || !SDL_IsShapedWindow(window))
         /* The window given was not a shapeable window. */
@@ -264,6 +594,13 @@ SDL_SetWindowShape(SDL_Window *window,SDL_Surface *shape,SDL_WindowShapeMode *sh
         window->shaper->mode = *shape_mode;
     result = SDL_GetVideoDevice()->shape_driver.SetWindowShape(window->shaper,shape,shape_mode);
     window->shaper->hasshape = SDL_TRUE;
+    if(result == 0) {
+        area.x = 0;
+        area.y = 0;
+        area.w = window->w;
+        area.h = window->h;
+        SDL_DamageShapedWindow(window,&area);
+    }
     if(window->shaper->userx != 0 && window->shaper->usery != 0) {
         SDL_SetWindowPosition(window,window->shaper->userx,window->shaper->usery);
         window->shaper->userx = 0;
@@ -280,6 +617,40 @@ SDL_WindowHasAShape(SDL_Window *window)
     return window->shaper->hasshape;
 }
 
+int
+SDL_UpdateWindowShape(SDL_Window *window,SDL_Surface *shape,const SDL_Rect *rect)
+{
+    SDL_VideoDevice *_this = SDL_GetVideoDevice();
+    SDL_Rect bounds,area;
+    int result;
+
+    if(window == NULL || !SDL_IsShapedWindow(window))
+        /* The window given was not a shapeable window. */
+        return SDL_NONSHAPEABLE_WINDOW;
+    if(shape == NULL)
+        /* Invalid shape argument. */
+        return SDL_INVALID_SHAPE_ARGUMENT;
+    if(!SDL_WindowHasAShape(window))
+        /* There's no shape to update yet. */
+        return SDL_WINDOW_LACKS_SHAPE;
+
+    bounds.x = 0;
+    bounds.y = 0;
+    bounds.w = shape->w;
+    bounds.h = shape->h;
+    if(rect == NULL)
+        area = bounds;
+    else if(!SDL_IntersectRect(rect,&bounds,&area))
+        return 0;
+    if(_this->shape_driver.UpdateWindowShape == NULL)
+        result = _this->shape_driver.SetWindowShape(window->shaper,shape,&window->shaper->mode);
+    else
+        result = _this->shape_driver.UpdateWindowShape(window->shaper,shape,&area);
+    if(result == 0)
+        SDL_DamageShapedWindow(window,&area);
+    return result;
+}
+
 int
 SDL_GetShapedWindowMode(SDL_Window *window,SDL_WindowShapeMode *shape_mode)
 {
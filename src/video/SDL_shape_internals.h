@@ -26,6 +26,7 @@
 #include "SDL_rect.h"
 #include "SDL_shape.h"
 #include "SDL_surface.h"
+#include "SDL_rect_c.h"
 
 #include "begin_code.h"
 /* Set up for C function definitions, even when using C++ */
@@ -53,8 +54,12 @@ typedef struct {
 	
 typedef void(*SDL_TraversalFunction)(SDL_ShapeTree*,void*);
 
-extern void SDL_CalculateShapeBitmap(SDL_WindowShapeMode mode,SDL_Surface *shape,Uint8* bitmap,Uint8 ppb);
+extern int SDL_CalculateShapeBitmap(SDL_WindowShapeMode mode,SDL_Surface *shape,Uint8* bitmap,Uint8 ppb);
+/* Sets region to the opaque pixels of shape, or with a rect, recalculates only the part of it inside rect. */
+extern int SDL_CalculateShapeRegion(SDL_WindowShapeMode mode,SDL_Surface *shape,const SDL_Rect *rect,SDL_Region *region);
 extern SDL_ShapeTree* SDL_CalculateShapeTree(SDL_WindowShapeMode mode,SDL_Surface* shape);
+/* Rebuilds the nodes of a w-by-h shape tree touching rect from region, or the whole tree if rect or the tree is NULL. */
+extern int SDL_UpdateShapeTree(SDL_ShapeTree** shape_tree,const SDL_Region *region,int w,int h,const SDL_Rect *rect);
 extern void SDL_TraverseShapeTree(SDL_ShapeTree *tree,SDL_TraversalFunction function,void* closure);
 extern void SDL_FreeShapeTree(SDL_ShapeTree** shape_tree);
 
@@ -27,6 +27,7 @@
 */
 
 #include "SDL_video.h"
+#include "SDL_sysvideo.h"
 #include "SDL_blit.h"
 
 /* This isn't ready for general consumption yet - it should be folded
@@ -251,6 +252,9 @@ SDL_SoftStretch(SDL_Surface * src, const SDL_Rect * srcrect,
         full_dst.h = dst->h;
         dstrect = &full_dst;
     }
+    if (dst->flags & SDL_TRACKDAMAGE) {
+        SDL_AddWindowSurfaceDamage(dst, dstrect);
+    }
 
     /* Lock the destination if it's in hardware */
     dst_locked = 0;
@@ -350,4 +354,368 @@ SDL_SoftStretch(SDL_Surface * src, const SDL_Rect * srcrect,
     return (0);
 }
 
+/* Linear filtering keeps 7 bits of fraction per pass, so a horizontally
+   filtered channel fits in 15 bits and the vertical pass can use SSE2's
+   signed 16-bit multiply-add. */
+#define LINEAR_BITS 7
+#define LINEAR_ONE  (1 << LINEAR_BITS)
+
+/* How one destination pixel (or row) is made from the source */
+typedef struct
+{
+    int src;        /* first source pixel */
+    int count;      /* number of source pixels averaged, 0 for linear steps */
+    Uint32 weight;  /* linear: weight of src + 1, box: LINEAR_ONE * 65536 / count */
+} SDL_StretchStep;
+
+/* Reductions of 2x or more average every source pixel they cover, since
+   sampling just two of them would skip the rest. */
+static void
+SDL_CalculateStretchSteps(SDL_StretchStep * steps, int src_n, int dst_n)
+{
+    const SDL_bool box = (src_n == 1 || src_n >= 2 * dst_n);
+    int i;
+
+    for (i = 0; i < dst_n; ++i) {
+        if (box) {
+            int first = (int) (((Sint64) i * src_n) / dst_n);
+            int last = (int) (((Sint64) (i + 1) * src_n) / dst_n);
+            first = SDL_min(first, src_n - 1);
+            last = SDL_max(last, first + 1);
+            steps[i].src = first;
+            steps[i].count = last - first;
+            steps[i].weight = (LINEAR_ONE << 16) / steps[i].count;
+        } else {
+            /* sample at pixel centers, in 16.16 fixed point */
+            Sint64 pos = ((Sint64) (2 * i + 1) * src_n << 16) / (2 * dst_n) - 0x8000;
+            if (pos < 0) {
+                pos = 0;
+            }
+            steps[i].src = (int) (pos >> 16);
+            steps[i].count = 0;
+            /* rounded, so this can be LINEAR_ONE */
+            steps[i].weight = (Uint32) (((pos & 0xFFFF) + (1 << (15 - LINEAR_BITS))) >> (16 - LINEAR_BITS));
+            if (steps[i].src >= src_n - 1) {
+                steps[i].src = src_n - 2;
+                steps[i].weight = LINEAR_ONE;
+            }
+        }
+    }
+}
+
+/* Filters one source row to dst_w pixels of four 15-bit channels */
+static void
+SDL_StretchRowLinear(const Uint8 * src, Uint16 * dst, const SDL_StretchStep * steps,
+                     int dst_w, SDL_bool use_sse2)
+{
+    int i, j, c;
+
+    if (steps[0].count) {
+        for (i = 0; i < dst_w; ++i, dst += 4) {
+            const Uint8 *p = src + steps[i].src * 4;
+            const Uint32 weight = steps[i].weight;
+#ifdef __SSE2__
+            /* the 16-bit sums can't overflow below 258 pixels */
+            if (use_sse2 && steps[i].count < 258) {
+                const __m128i zero = _mm_setzero_si128();
+                __m128i sum = zero;
+                for (j = steps[i].count; j >= 2; j -= 2, p += 8) {
+                    sum = _mm_add_epi16(sum, _mm_unpacklo_epi8(_mm_loadl_epi64((const __m128i *) p), zero));
+                }
+                if (j) {
+                    sum = _mm_add_epi16(sum, _mm_unpacklo_epi8(_mm_cvtsi32_si128(*(const Uint32 *) p), zero));
+                }
+                sum = _mm_add_epi16(sum, _mm_srli_si128(sum, 8));
+                /* sum * weight >> 16, with the weight split into 16-bit halves */
+                sum = _mm_add_epi16(_mm_mullo_epi16(sum, _mm_set1_epi16((short) (weight >> 16))),
+                                    _mm_mulhi_epu16(sum, _mm_set1_epi16((short) (weight & 0xFFFF))));
+                _mm_storel_epi64((__m128i *) dst, sum);
+                continue;
+            }
+#endif
+            {
+                Uint32 sum[4] = { 0, 0, 0, 0 };
+                for (j = steps[i].count; j; --j, p += 4) {
+                    sum[0] += p[0];
+                    sum[1] += p[1];
+                    sum[2] += p[2];
+                    sum[3] += p[3];
+                }
+                for (c = 0; c < 4; ++c) {
+                    dst[c] = (Uint16) ((sum[c] * weight) >> 16);
+                }
+            }
+        }
+        return;
+    }
+
+#ifdef __SSE2__
+    if (use_sse2) {
+        const __m128i zero = _mm_setzero_si128();
+        for (i = 0; i < dst_w; ++i, dst += 4) {
+            const int w = (int) steps[i].weight;
+            /* both source pixels, and their weights, side by side */
+            const __m128i pixels = _mm_unpacklo_epi8(_mm_loadl_epi64((const __m128i *) (src + steps[i].src * 4)), zero);
+            const __m128i weights = _mm_unpacklo_epi64(_mm_set1_epi16((short) (LINEAR_ONE - w)), _mm_set1_epi16((short) w));
+            __m128i result = _mm_mullo_epi16(pixels, weights);
+            result = _mm_add_epi16(result, _mm_srli_si128(result, 8));
+            _mm_storel_epi64((__m128i *) dst, result);
+        }
+        return;
+    }
+#endif
+
+    for (i = 0; i < dst_w; ++i, dst += 4) {
+        const Uint8 *p = src + steps[i].src * 4;
+        const int w = (int) steps[i].weight;
+        for (c = 0; c < 4; ++c) {
+            dst[c] = (Uint16) (p[c] * (LINEAR_ONE - w) + p[c + 4] * w);
+        }
+    }
+}
+
+/* Blends two filtered rows back down to 8-bit channels */
+static void
+SDL_StretchColumnLinear(const Uint16 * row0, const Uint16 * row1, int w,
+                        Uint8 * dst, int n, SDL_bool use_sse2)
+{
+    int i = 0;
+
+#ifdef __SSE2__
+    if (use_sse2) {
+        const __m128i weights = _mm_set1_epi32(((LINEAR_ONE - w) & 0xFFFF) | (w << 16));
+        const __m128i round = _mm_set1_epi32(1 << (2 * LINEAR_BITS - 1));
+        for (; i + 16 <= n; i += 16) {
+            const __m128i a0 = _mm_loadu_si128((const __m128i *) (row0 + i));
+            const __m128i a1 = _mm_loadu_si128((const __m128i *) (row1 + i));
+            const __m128i b0 = _mm_loadu_si128((const __m128i *) (row0 + i + 8));
+            const __m128i b1 = _mm_loadu_si128((const __m128i *) (row1 + i + 8));
+            __m128i r0 = _mm_madd_epi16(_mm_unpacklo_epi16(a0, a1), weights);
+            __m128i r1 = _mm_madd_epi16(_mm_unpackhi_epi16(a0, a1), weights);
+            __m128i r2 = _mm_madd_epi16(_mm_unpacklo_epi16(b0, b1), weights);
+            __m128i r3 = _mm_madd_epi16(_mm_unpackhi_epi16(b0, b1), weights);
+            r0 = _mm_srai_epi32(_mm_add_epi32(r0, round), 2 * LINEAR_BITS);
+            r1 = _mm_srai_epi32(_mm_add_epi32(r1, round), 2 * LINEAR_BITS);
+            r2 = _mm_srai_epi32(_mm_add_epi32(r2, round), 2 * LINEAR_BITS);
+            r3 = _mm_srai_epi32(_mm_add_epi32(r3, round), 2 * LINEAR_BITS);
+            _mm_storeu_si128((__m128i *) (dst + i),
+                             _mm_packus_epi16(_mm_packs_epi32(r0, r1), _mm_packs_epi32(r2, r3)));
+        }
+    }
+#endif
+
+    for (; i < n; ++i) {
+        dst[i] = (Uint8) ((row0[i] * (LINEAR_ONE - w) + row1[i] * w + (1 << (2 * LINEAR_BITS - 1))) >> (2 * LINEAR_BITS));
+    }
+}
+
+/* Adds a filtered row to the running sums of a box filtered row */
+static void
+SDL_StretchAccumulate(Uint32 * sums, const Uint16 * row, int n, SDL_bool use_sse2)
+{
+    int i = 0;
+
+#ifdef __SSE2__
+    if (use_sse2) {
+        const __m128i zero = _mm_setzero_si128();
+        for (; i + 8 <= n; i += 8) {
+            const __m128i v = _mm_loadu_si128((const __m128i *) (row + i));
+            __m128i *s = (__m128i *) (sums + i);
+            _mm_storeu_si128(s, _mm_add_epi32(_mm_loadu_si128(s), _mm_unpacklo_epi16(v, zero)));
+            _mm_storeu_si128(s + 1, _mm_add_epi32(_mm_loadu_si128(s + 1), _mm_unpackhi_epi16(v, zero)));
+        }
+    }
+#endif
+
+    for (; i < n; ++i) {
+        sums[i] += row[i];
+    }
+}
+
+/* Divides the sums of a box filtered row back down to 8-bit channels.
+   (weight) is 65536 / count, so the sums don't overflow 32 bits. */
+static void
+SDL_StretchAverage(const Uint32 * sums, Uint32 weight, Uint8 * dst, int n, SDL_bool use_sse2)
+{
+    const Uint32 round = 1 << (16 + LINEAR_BITS - 1);
+    int i = 0;
+
+#ifdef __SSE2__
+    if (use_sse2) {
+        const __m128i w = _mm_set1_epi32(weight);
+        const __m128i r = _mm_set_epi32(0, round, 0, round);
+        __m128i v[4];
+        int j;
+
+        for (; i + 16 <= n; i += 16) {
+            for (j = 0; j < 4; ++j) {
+                const __m128i s = _mm_loadu_si128((const __m128i *) (sums + i + j * 4));
+                /* 32x32 bit multiplies of the even and odd lanes */
+                const __m128i even = _mm_srli_epi64(_mm_add_epi64(_mm_mul_epu32(s, w), r), 16 + LINEAR_BITS);
+                const __m128i odd = _mm_srli_epi64(_mm_add_epi64(_mm_mul_epu32(_mm_srli_epi64(s, 32), w), r), 16 + LINEAR_BITS);
+                v[j] = _mm_or_si128(even, _mm_slli_epi64(odd, 32));
+            }
+            _mm_storeu_si128((__m128i *) (dst + i),
+                             _mm_packus_epi16(_mm_packs_epi32(v[0], v[1]), _mm_packs_epi32(v[2], v[3])));
+        }
+    }
+#endif
+
+    for (; i < n; ++i) {
+        dst[i] = (Uint8) ((sums[i] * weight + round) >> (16 + LINEAR_BITS));
+    }
+}
+
+/* Perform a bilinear filtered stretch blit between two 32-bit surfaces of the
+   same format.  Reductions of 2x or more are box filtered instead.
+*/
+int
+SDL_SoftStretchLinear(SDL_Surface * src, const SDL_Rect * srcrect,
+                      SDL_Surface * dst, const SDL_Rect * dstrect)
+{
+    SDL_Rect full_src;
+    SDL_Rect full_dst;
+    SDL_StretchStep *xsteps, *ysteps;
+    Uint16 *rowbuf;
+    Uint16 *rows[2];
+    int rowy[2] = { -1, -1 };
+    Uint32 *sums = NULL;
+    SDL_bool use_sse2 = SDL_FALSE;
+    int src_locked = 0;
+    int dst_locked = 0;
+    int retval = 0;
+    int x, y;
+
+    if (src->format->format != dst->format->format) {
+        return SDL_SetError("Only works with same format surfaces");
+    }
+    if (src->format->BytesPerPixel != 4 ||
+        src->format->format == SDL_PIXELFORMAT_ARGB2101010) {
+        return SDL_SetError("Only works with 32-bit surfaces with 8-bit channels");
+    }
+
+    /* Verify the blit rectangles */
+    if (srcrect) {
+        if ((srcrect->x < 0) || (srcrect->y < 0) ||
+            ((srcrect->x + srcrect->w) > src->w) ||
+            ((srcrect->y + srcrect->h) > src->h)) {
+            return SDL_SetError("Invalid source blit rectangle");
+        }
+    } else {
+        full_src.x = 0;
+        full_src.y = 0;
+        full_src.w = src->w;
+        full_src.h = src->h;
+        srcrect = &full_src;
+    }
+    if (dstrect) {
+        if ((dstrect->x < 0) || (dstrect->y < 0) ||
+            ((dstrect->x + dstrect->w) > dst->w) ||
+            ((dstrect->y + dstrect->h) > dst->h)) {
+            return SDL_SetError("Invalid destination blit rectangle");
+        }
+    } else {
+        full_dst.x = 0;
+        full_dst.y = 0;
+        full_dst.w = dst->w;
+        full_dst.h = dst->h;
+        dstrect = &full_dst;
+    }
+    if (dst->flags & SDL_TRACKDAMAGE) {
+        SDL_AddWindowSurfaceDamage(dst, dstrect);
+    }
+    if (srcrect->w <= 0 || srcrect->h <= 0 || dstrect->w <= 0 || dstrect->h <= 0) {
+        return 0;
+    }
+
+    xsteps = (SDL_StretchStep *) SDL_malloc((dstrect->w + dstrect->h) * sizeof (SDL_StretchStep));
+    rowbuf = (Uint16 *) SDL_malloc(2 * dstrect->w * 4 * sizeof (Uint16));
+    if (!xsteps || !rowbuf) {
+        SDL_free(xsteps);
+        SDL_free(rowbuf);
+        return SDL_OutOfMemory();
+    }
+    ysteps = xsteps + dstrect->w;
+    rows[0] = rowbuf;
+    rows[1] = rowbuf + dstrect->w * 4;
+    SDL_CalculateStretchSteps(xsteps, srcrect->w, dstrect->w);
+    SDL_CalculateStretchSteps(ysteps, srcrect->h, dstrect->h);
+    if (ysteps[0].count) {
+        sums = (Uint32 *) SDL_malloc(dstrect->w * 4 * sizeof (Uint32));
+        if (!sums) {
+            SDL_free(rowbuf);
+            SDL_free(xsteps);
+            return SDL_OutOfMemory();
+        }
+    }
+#ifdef __SSE2__
+    use_sse2 = SDL_HasSSE2();
+#endif
+
+    /* Lock the destination if it's in hardware */
+    if (SDL_MUSTLOCK(dst)) {
+        if (SDL_LockSurface(dst) < 0) {
+            retval = SDL_SetError("Unable to lock destination surface");
+            goto done;
+        }
+        dst_locked = 1;
+    }
+    /* Lock the source if it's in hardware */
+    if (SDL_MUSTLOCK(src)) {
+        if (SDL_LockSurface(src) < 0) {
+            retval = SDL_SetError("Unable to lock source surface");
+            goto done;
+        }
+        src_locked = 1;
+    }
+
+    for (y = 0; y < dstrect->h; ++y) {
+        const SDL_StretchStep *step = &ysteps[y];
+        const Uint8 *srcp = (const Uint8 *) src->pixels + (srcrect->y + step->src) * src->pitch + srcrect->x * 4;
+        Uint8 *dstp = (Uint8 *) dst->pixels + (dstrect->y + y) * dst->pitch + dstrect->x * 4;
+
+        if (step->count) {
+            SDL_memset(sums, 0, dstrect->w * 4 * sizeof (Uint32));
+            for (x = 0; x < step->count; ++x, srcp += src->pitch) {
+                SDL_StretchRowLinear(srcp, rows[0], xsteps, dstrect->w, use_sse2);
+                SDL_StretchAccumulate(sums, rows[0], dstrect->w * 4, use_sse2);
+            }
+            rowy[0] = -1;
+            SDL_StretchAverage(sums, step->weight >> LINEAR_BITS, dstp, dstrect->w * 4, use_sse2);
+            continue;
+        }
+
+        /* Consecutive rows usually share source rows, so keep the last two */
+        if (rowy[0] != step->src) {
+            if (rowy[1] == step->src) {
+                Uint16 *tmp = rows[0];
+                rows[0] = rows[1];
+                rows[1] = tmp;
+                rowy[1] = -1;
+            } else {
+                SDL_StretchRowLinear(srcp, rows[0], xsteps, dstrect->w, use_sse2);
+            }
+            rowy[0] = step->src;
+        }
+        if (rowy[1] != step->src + 1) {
+            SDL_StretchRowLinear(srcp + src->pitch, rows[1], xsteps, dstrect->w, use_sse2);
+            rowy[1] = step->src + 1;
+        }
+        SDL_StretchColumnLinear(rows[0], rows[1], (int) step->weight, dstp, dstrect->w * 4, use_sse2);
+    }
+
+done:
+    /* We need to unlock the surfaces if they're locked */
+    if (dst_locked) {
+        SDL_UnlockSurface(dst);
+    }
+    if (src_locked) {
+        SDL_UnlockSurface(src);
+    }
+    SDL_free(sums);
+    SDL_free(rowbuf);
+    SDL_free(xsteps);
+    return retval;
+}
+
 /* vi: set ts=4 sw=4 expandtab: */
@@ -20,11 +20,237 @@
 */
 #include "../SDL_internal.h"
 
+#include "SDL_atomic.h"
+#include "SDL_bits.h"
+#include "SDL_hints.h"
 #include "SDL_video.h"
 #include "SDL_sysvideo.h"
 #include "SDL_blit.h"
 #include "SDL_RLEaccel_c.h"
 #include "SDL_pixels_c.h"
+#include "SDL_yuv_c.h"
+
+/* Aligned pixels start on a cache line, which suits every SIMD blitter */
+#define SURFACE_ALIGNMENT   64
+
+/* Pooled buffers are sorted into size classes, four per power of two */
+#define SURFACE_POOL_CLASSES    96
+
+/* Internal surface flag, kept clear of the public ones: the pixels came
+   from the pool and go back to it */
+#define SDL_POOLED_PIXELS   0x80000000
+
+typedef struct SDL_PooledPixels
+{
+    struct SDL_PooledPixels *next;
+} SDL_PooledPixels;
+
+static SDL_SpinLock surface_pool_lock;
+static SDL_PooledPixels *surface_pool[SURFACE_POOL_CLASSES];
+static size_t surface_pool_bytes;
+
+/* SDL_HINT_SURFACE_POOL_SIZE and SDL_HINT_SURFACE_ALIGNED, kept up to date
+   by hint callbacks */
+static SDL_SpinLock surface_hints_lock;
+static SDL_bool surface_hints_watched;
+static size_t surface_pool_limit;
+static SDL_bool surface_aligned;
+
+/* The allocation and its usable size are stored just before the pixels */
+static void *
+SDL_AllocAligned(size_t size)
+{
+    const size_t header = 2 * sizeof(void *);
+    Uint8 *mem, *ptr;
+
+    mem = (Uint8 *) SDL_malloc(size + header + SURFACE_ALIGNMENT - 1);
+    if (!mem) {
+        return NULL;
+    }
+    ptr = (Uint8 *) (((uintptr_t) mem + header + SURFACE_ALIGNMENT - 1) &
+                     ~(uintptr_t) (SURFACE_ALIGNMENT - 1));
+    ((void **) ptr)[-1] = mem;
+    ((size_t *) ptr)[-2] = size;
+    return ptr;
+}
+
+static void
+SDL_FreeAligned(void *ptr)
+{
+    if (ptr) {
+        SDL_free(((void **) ptr)[-1]);
+    }
+}
+
+/* Round a size up to its pool class, returns the class or -1 */
+static int
+SDL_GetPoolClass(size_t * size)
+{
+    size_t step;
+    int bits, index;
+
+    if (*size <= 256) {
+        *size = 256;
+        return 0;
+    }
+    if ((Uint64) *size > 0x80000000) {
+        return -1;
+    }
+    bits = SDL_MostSignificantBitIndex32((Uint32) (*size - 1));
+    step = (size_t) 1 << (bits - 2);
+    *size = (*size + step - 1) & ~(step - 1);
+    index = (bits - 8) * 4 + (int) (*size >> (bits - 2)) - 4;
+    return (index < SURFACE_POOL_CLASSES) ? index : -1;
+}
+
+/* Must be called with the pool locked */
+static void
+SDL_EmptySurfacePool(void)
+{
+    int i;
+
+    for (i = 0; i < SURFACE_POOL_CLASSES; ++i) {
+        while (surface_pool[i]) {
+            SDL_PooledPixels *pixels = surface_pool[i];
+            surface_pool[i] = pixels->next;
+            SDL_FreeAligned(pixels);
+        }
+    }
+    surface_pool_bytes = 0;
+}
+
+static void SDLCALL
+SDL_SurfacePoolSizeChanged(void *userdata, const char *name, const char *oldValue, const char *hint)
+{
+    SDL_AtomicLock(&surface_pool_lock);
+    surface_pool_limit = hint ? (size_t) SDL_strtoul(hint, NULL, 0) : 0;
+    if (surface_pool_bytes > surface_pool_limit) {
+        SDL_EmptySurfacePool();
+    }
+    SDL_AtomicUnlock(&surface_pool_lock);
+}
+
+static void SDLCALL
+SDL_SurfaceAlignedChanged(void *userdata, const char *name, const char *oldValue, const char *hint)
+{
+    if (hint && *hint != '0' && SDL_strcasecmp(hint, "false") != 0) {
+        surface_aligned = SDL_TRUE;
+    } else {
+        surface_aligned = SDL_FALSE;
+    }
+}
+
+static void
+SDL_WatchSurfaceHints(void)
+{
+    SDL_AtomicLock(&surface_hints_lock);
+    if (!surface_hints_watched) {
+        SDL_AddHintCallback(SDL_HINT_SURFACE_POOL_SIZE, SDL_SurfacePoolSizeChanged, NULL);
+        SDL_AddHintCallback(SDL_HINT_SURFACE_ALIGNED, SDL_SurfaceAlignedChanged, NULL);
+        surface_hints_watched = SDL_TRUE;
+    }
+    SDL_AtomicUnlock(&surface_hints_lock);
+}
+
+/*
+ * Allocate surface->h * surface->pitch bytes for the pixels of a surface,
+ * aligned if the surface has SDL_SIMD_ALIGNED. With a pool size set the
+ * buffer comes from the pool if possible. Pooled buffers are aligned too,
+ * so the surface gets SDL_SIMD_ALIGNED if its pitch already is.
+ */
+void *
+SDL_AllocSurfacePixels(SDL_Surface * surface)
+{
+    size_t size = (size_t) surface->h * surface->pitch;
+    void *pixels = NULL;
+
+    SDL_WatchSurfaceHints();
+    if (surface_pool_limit > 0) {
+        const int index = SDL_GetPoolClass(&size);
+        if (index >= 0) {
+            SDL_AtomicLock(&surface_pool_lock);
+            if (surface_pool[index]) {
+                pixels = surface_pool[index];
+                surface_pool[index] = surface_pool[index]->next;
+                surface_pool_bytes -= size;
+            }
+            SDL_AtomicUnlock(&surface_pool_lock);
+            if (!pixels) {
+                pixels = SDL_AllocAligned(size);
+            }
+            if (pixels) {
+                surface->flags |= SDL_POOLED_PIXELS;
+                if ((surface->pitch % SURFACE_ALIGNMENT) == 0) {
+                    surface->flags |= SDL_SIMD_ALIGNED;
+                }
+                return pixels;
+            }
+        }
+    }
+
+    if (!pixels) {
+        if (surface->flags & SDL_SIMD_ALIGNED) {
+            pixels = SDL_AllocAligned(size);
+        } else {
+            pixels = SDL_malloc(size);
+        }
+    }
+    if (!pixels) {
+        SDL_OutOfMemory();
+    }
+    return pixels;
+}
+
+/*
+ * Release the pixels of a surface unless they belong to the application,
+ * keeping them in the pool if there's room.
+ */
+void
+SDL_FreeSurfacePixels(SDL_Surface * surface)
+{
+    void *pixels = surface->pixels;
+
+    if (surface->flags & SDL_PREALLOC) {
+        return;
+    }
+    surface->pixels = NULL;
+
+    if (surface->flags & SDL_POOLED_PIXELS) {
+        /* the size was rounded up to its class when allocated */
+        size_t size = ((size_t *) pixels)[-2];
+        const int index = SDL_GetPoolClass(&size);
+
+        surface->flags &= ~SDL_POOLED_PIXELS;
+        SDL_AtomicLock(&surface_pool_lock);
+        if (surface_pool_bytes + size <= surface_pool_limit) {
+            ((SDL_PooledPixels *) pixels)->next = surface_pool[index];
+            surface_pool[index] = (SDL_PooledPixels *) pixels;
+            surface_pool_bytes += size;
+            pixels = NULL;
+        }
+        SDL_AtomicUnlock(&surface_pool_lock);
+        SDL_FreeAligned(pixels);
+    } else if (surface->flags & SDL_SIMD_ALIGNED) {
+        SDL_FreeAligned(pixels);
+    } else {
+        SDL_free(pixels);
+    }
+}
+
+void
+SDL_SurfacePoolQuit(void)
+{
+    /* SDL_ClearHints() has already dropped the hint callbacks */
+    SDL_AtomicLock(&surface_hints_lock);
+    surface_hints_watched = SDL_FALSE;
+    SDL_AtomicUnlock(&surface_hints_lock);
+
+    SDL_AtomicLock(&surface_pool_lock);
+    surface_pool_limit = 0;
+    SDL_EmptySurfacePool();
+    SDL_AtomicUnlock(&surface_pool_lock);
+    surface_aligned = SDL_FALSE;
+}
 
 /* Public routines */
 
@@ -38,9 +264,6 @@ SDL_CreateRGBSurfaceWithFormat(Uint32 flags, int width, int height, int depth,
 {
     SDL_Surface *surface;
 
-    /* The flags are no longer used, make the compiler happy */
-    (void)flags;
-
     /* Allocate the surface */
     surface = (SDL_Surface *) SDL_calloc(1, sizeof(*surface));
     if (surface == NULL) {
@@ -80,10 +303,16 @@ SDL_CreateRGBSurfaceWithFormat(Uint32 flags, int width, int height, int depth,
 
     /* Get the pixels */
     if (surface->w && surface->h) {
-        surface->pixels = SDL_malloc(surface->h * surface->pitch);
+        /* Apart from alignment, the flags are no longer used */
+        SDL_WatchSurfaceHints();
+        if ((flags & SDL_SIMD_ALIGNED) || surface_aligned) {
+            surface->flags |= SDL_SIMD_ALIGNED;
+            surface->pitch = (surface->pitch + SURFACE_ALIGNMENT - 1) &
+                             ~(SURFACE_ALIGNMENT - 1);
+        }
+        surface->pixels = SDL_AllocSurfacePixels(surface);
         if (!surface->pixels) {
             SDL_FreeSurface(surface);
-            SDL_OutOfMemory();
             return NULL;
         }
         /* This is important for bitmaps */
@@ -550,6 +779,15 @@ SDL_LowerBlit(SDL_Surface * src, SDL_Rect * srcrect,
 /*              src, dst->flags, src->map->info.flags, dst, dst->flags, */
 /*              dst->map->info.flags, src->map->blit); */
     }
+    if (dst->flags & SDL_TRACKDAMAGE) {
+        SDL_Rect damaged = *dstrect;
+        /* Unscaled blits cover the size of the source rect */
+        if (!(src->map->info.flags & SDL_COPY_NEAREST)) {
+            damaged.w = srcrect->w;
+            damaged.h = srcrect->h;
+        }
+        SDL_AddWindowSurfaceDamage(dst, &damaged);
+    }
     return (src->map->blit(src, srcrect, dst, dstrect));
 }
 
@@ -653,9 +891,21 @@ SDL_UpperBlit(SDL_Surface * src, const SDL_Rect * srcrect,
     return 0;
 }
 
+static int SDL_PrivateLowerBlitScaled(SDL_Surface * src, SDL_Rect * srcrect,
+                                      SDL_Surface * dst, SDL_Rect * dstrect,
+                                      SDL_bool linear);
+
 int
 SDL_UpperBlitScaled(SDL_Surface * src, const SDL_Rect * srcrect,
               SDL_Surface * dst, SDL_Rect * dstrect)
+{
+    return SDL_PrivateUpperBlitScaled(src, srcrect, dst, dstrect, SDL_FALSE);
+}
+
+int
+SDL_PrivateUpperBlitScaled(SDL_Surface * src, const SDL_Rect * srcrect,
+                           SDL_Surface * dst, SDL_Rect * dstrect,
+                           SDL_bool linear)
 {
     double src_x0, src_y0, src_x1, src_y1;
     double dst_x0, dst_y0, dst_x1, dst_y1;
@@ -800,16 +1050,78 @@ SDL_UpperBlitScaled(SDL_Surface * src, const SDL_Rect * srcrect,
         return 0;
     }
 
-    return SDL_LowerBlitScaled(src, &final_src, dst, &final_dst);
+    return SDL_PrivateLowerBlitScaled(src, &final_src, dst, &final_dst, linear);
 }
 
-/**
- *  This is a semi-private blit function and it performs low-level surface
- *  scaled blitting only.
- */
-int
-SDL_LowerBlitScaled(SDL_Surface * src, SDL_Rect * srcrect,
-                SDL_Surface * dst, SDL_Rect * dstrect)
+/* Filters the source into a temporary 32-bit surface of the destination
+   size, then blits that with the source's blend mode and modulation. */
+static int
+SDL_LowerBlitScaledLinear(SDL_Surface * src, SDL_Rect * srcrect,
+                          SDL_Surface * dst, SDL_Rect * dstrect)
+{
+    SDL_Surface *tmp1 = NULL;
+    SDL_Surface *tmp2;
+    SDL_Rect tmprect;
+    SDL_BlendMode blendMode;
+    Uint8 r, g, b, alpha;
+    Uint32 format = src->format->format;
+    int retval;
+
+    if (format == SDL_PIXELFORMAT_ARGB2101010 || src->format->BytesPerPixel != 4) {
+        /* convert to a format SDL_SoftStretchLinear() can filter */
+        format = SDL_PIXELFORMAT_ARGB8888;
+        tmp1 = SDL_CreateRGBSurfaceWithFormat(0, srcrect->w, srcrect->h, 32, format);
+        if (!tmp1) {
+            return -1;
+        }
+        if (SDL_LockSurface(src) < 0) {
+            SDL_FreeSurface(tmp1);
+            return -1;
+        }
+        retval = SDL_ConvertPixels(srcrect->w, srcrect->h, src->format->format,
+                                   (Uint8 *) src->pixels + srcrect->y * src->pitch + srcrect->x * src->format->BytesPerPixel,
+                                   src->pitch, format, tmp1->pixels, tmp1->pitch);
+        SDL_UnlockSurface(src);
+        if (retval < 0) {
+            SDL_FreeSurface(tmp1);
+            return -1;
+        }
+    }
+
+    tmp2 = SDL_CreateRGBSurfaceWithFormat(0, dstrect->w, dstrect->h, 32, format);
+    if (!tmp2) {
+        SDL_FreeSurface(tmp1);
+        return -1;
+    }
+    if (tmp1) {
+        retval = SDL_SoftStretchLinear(tmp1, NULL, tmp2, NULL);
+        SDL_FreeSurface(tmp1);
+    } else {
+        retval = SDL_SoftStretchLinear(src, srcrect, tmp2, NULL);
+    }
+
+    if (retval == 0) {
+        SDL_GetSurfaceBlendMode(src, &blendMode);
+        SDL_GetSurfaceColorMod(src, &r, &g, &b);
+        SDL_GetSurfaceAlphaMod(src, &alpha);
+        SDL_SetSurfaceBlendMode(tmp2, blendMode);
+        SDL_SetSurfaceColorMod(tmp2, r, g, b);
+        SDL_SetSurfaceAlphaMod(tmp2, alpha);
+
+        tmprect.x = 0;
+        tmprect.y = 0;
+        tmprect.w = dstrect->w;
+        tmprect.h = dstrect->h;
+        retval = SDL_LowerBlit(tmp2, &tmprect, dst, dstrect);
+    }
+    SDL_FreeSurface(tmp2);
+    return retval;
+}
+
+static int
+SDL_PrivateLowerBlitScaled(SDL_Surface * src, SDL_Rect * srcrect,
+                           SDL_Surface * dst, SDL_Rect * dstrect,
+                           SDL_bool linear)
 {
     static const Uint32 complex_copy_flags = (
         SDL_COPY_MODULATE_COLOR | SDL_COPY_MODULATE_ALPHA |
@@ -822,6 +1134,18 @@ SDL_LowerBlitScaled(SDL_Surface * src, SDL_Rect * srcrect,
         SDL_InvalidateMap(src->map);
     }
 
+    /* Linear filtering doesn't make sense for color keys or palettes */
+    if (linear && !(src->map->info.flags & SDL_COPY_COLORKEY) &&
+        !SDL_ISPIXELFORMAT_INDEXED(src->format->format)) {
+        if ( !(src->map->info.flags & complex_copy_flags) &&
+             src->format->format == dst->format->format &&
+             src->format->BytesPerPixel == 4 &&
+             src->format->format != SDL_PIXELFORMAT_ARGB2101010 ) {
+            return SDL_SoftStretchLinear( src, srcrect, dst, dstrect );
+        }
+        return SDL_LowerBlitScaledLinear( src, srcrect, dst, dstrect );
+    }
+
     if ( !(src->map->info.flags & complex_copy_flags) &&
          src->format->format == dst->format->format &&
          !SDL_ISPIXELFORMAT_INDEXED(src->format->format) ) {
@@ -831,6 +1155,17 @@ SDL_LowerBlitScaled(SDL_Surface * src, SDL_Rect * srcrect,
     }
 }
 
+/**
+ *  This is a semi-private blit function and it performs low-level surface
+ *  scaled blitting only.
+ */
+int
+SDL_LowerBlitScaled(SDL_Surface * src, SDL_Rect * srcrect,
+                SDL_Surface * dst, SDL_Rect * dstrect)
+{
+    return SDL_PrivateLowerBlitScaled(src, srcrect, dst, dstrect, SDL_FALSE);
+}
+
 /*
  * Lock a surface to directly access the pixels
  */
@@ -1126,6 +1461,14 @@ int SDL_ConvertPixels(int width, int height,
         return 0;
     }
 
+    if (SDL_ISPIXELFORMAT_FOURCC(src_format) && SDL_ISPIXELFORMAT_FOURCC(dst_format)) {
+        return SDL_ConvertPixels_YUV_to_YUV(width, height, src_format, src, src_pitch, dst_format, dst, dst_pitch);
+    } else if (SDL_ISPIXELFORMAT_FOURCC(src_format)) {
+        return SDL_ConvertPixels_YUV_to_RGB(width, height, src_format, src, src_pitch, dst_format, dst, dst_pitch);
+    } else if (SDL_ISPIXELFORMAT_FOURCC(dst_format)) {
+        return SDL_ConvertPixels_RGB_to_YUV(width, height, src_format, src, src_pitch, dst_format, dst, dst_pitch);
+    }
+
     if (!SDL_CreateSurfaceOnStack(width, height, src_format, nonconst_src,
                                   src_pitch,
                                   &src_surface, &src_fmt, &src_blitmap)) {
@@ -1174,9 +1517,7 @@ SDL_FreeSurface(SDL_Surface * surface)
         SDL_FreeBlitMap(surface->map);
         surface->map = NULL;
     }
-    if (!(surface->flags & SDL_PREALLOC)) {
-        SDL_free(surface->pixels);
-    }
+    SDL_FreeSurfacePixels(surface);
     SDL_free(surface);
 }
 
@@ -26,6 +26,7 @@
 #include "SDL_messagebox.h"
 #include "SDL_shape.h"
 #include "SDL_thread.h"
+#include "SDL_rect_c.h"
 
 /* The SDL video driver */
 
@@ -49,6 +50,9 @@ struct SDL_WindowShaper
     /* Has this window been assigned a shape? */
     SDL_bool hasshape;
 
+    /* The opaque pixels of the shape, if the driver keeps them, or NULL */
+    const SDL_Region *region;
+
     void *driverdata;
 };
 
@@ -57,6 +61,7 @@ struct SDL_ShapeDriver
 {
     SDL_WindowShaper *(*CreateShaper)(SDL_Window * window);
     int (*SetWindowShape)(SDL_WindowShaper *shaper,SDL_Surface *shape,SDL_WindowShapeMode *shape_mode);
+    int (*UpdateWindowShape)(SDL_WindowShaper *shaper,SDL_Surface *shape,const SDL_Rect *rect);
     int (*ResizeWindowShape)(SDL_Window *window);
 };
 
@@ -94,6 +99,7 @@ struct SDL_Window
 
     SDL_Surface *surface;
     SDL_bool surface_valid;
+    SDL_DamageRegion damage;    /* Changes to the surface not presented yet */
 
     SDL_bool is_hiding;
     SDL_bool is_destroying;
@@ -104,6 +110,9 @@ struct SDL_Window
     SDL_HitTest hit_test;
     void *hit_test_data;
 
+    SDL_PresentCallback present_callback;
+    void *present_callback_data;
+
     SDL_WindowUserData *data;
 
     void *driverdata;
@@ -412,8 +421,10 @@ extern void SDL_OnWindowEnter(SDL_Window * window);
 extern void SDL_OnWindowLeave(SDL_Window * window);
 extern void SDL_OnWindowFocusGained(SDL_Window * window);
 extern void SDL_OnWindowFocusLost(SDL_Window * window);
+extern void SDL_OnWindowExposed(SDL_Window * window);
 extern void SDL_UpdateWindowGrab(SDL_Window * window);
 extern SDL_Window * SDL_GetFocusWindow(void);
+extern void SDL_AddWindowSurfaceDamage(SDL_Surface * surface, const SDL_Rect * rect);
 
 extern SDL_bool SDL_ShouldAllowTopmost(void);
 
@@ -369,23 +369,35 @@ static int
 SDL_UpdateWindowTexture(SDL_VideoDevice *unused, SDL_Window * window, const SDL_Rect * rects, int numrects)
 {
     SDL_WindowTextureData *data;
-    SDL_Rect rect;
+    SDL_Rect bounds, rect;
+    SDL_bool updated = SDL_FALSE;
     void *src;
+    int i;
 
     data = SDL_GetWindowData(window, SDL_WINDOWTEXTUREDATA);
     if (!data || !data->texture) {
         return SDL_SetError("No window texture data");
     }
 
-    /* Update a single rect that contains subrects for best DMA performance */
-    if (SDL_GetSpanEnclosingRect(window->w, window->h, numrects, rects, &rect)) {
+    /* The rects are already coalesced, so upload each of them on its own */
+    bounds.x = 0;
+    bounds.y = 0;
+    bounds.w = window->w;
+    bounds.h = window->h;
+    for (i = 0; i < numrects; ++i) {
+        if (!SDL_IntersectRect(&rects[i], &bounds, &rect)) {
+            continue;
+        }
         src = (void *)((Uint8 *)data->pixels +
                         rect.y * data->pitch +
                         rect.x * data->bytes_per_pixel);
         if (SDL_UpdateTexture(data->texture, &rect, src, data->pitch) < 0) {
             return -1;
         }
+        updated = SDL_TRUE;
+    }
 
+    if (updated) {
         if (SDL_RenderCopy(data->renderer, data->texture, NULL, NULL) < 0) {
             return -1;
         }
@@ -2189,6 +2201,16 @@ SDL_CreateWindowFramebuffer(SDL_Window * window)
     return SDL_CreateRGBSurfaceFrom(pixels, window->w, window->h, bpp, pitch, Rmask, Gmask, Bmask, Amask);
 }
 
+static void
+SDL_DamageWholeWindow(SDL_Window * window)
+{
+    window->damage.rects[0].x = 0;
+    window->damage.rects[0].y = 0;
+    window->damage.rects[0].w = window->surface->w;
+    window->damage.rects[0].h = window->surface->h;
+    window->damage.numrects = 1;
+}
+
 SDL_Surface *
 SDL_GetWindowSurface(SDL_Window * window)
 {
@@ -2203,6 +2225,10 @@ SDL_GetWindowSurface(SDL_Window * window)
         if (window->surface) {
             window->surface_valid = SDL_TRUE;
             window->surface->flags |= SDL_DONTFREE;
+            if (SDL_GetHintBoolean(SDL_HINT_WINDOW_SURFACE_DAMAGE, SDL_FALSE)) {
+                window->surface->flags |= SDL_TRACKDAMAGE;
+            }
+            SDL_DamageWholeWindow(window);
         }
     }
     return window->surface;
@@ -2215,6 +2241,10 @@ SDL_UpdateWindowSurface(SDL_Window * window)
 
     CHECK_WINDOW_MAGIC(window, -1);
 
+    if (window->surface_valid && (window->surface->flags & SDL_TRACKDAMAGE)) {
+        return SDL_UpdateWindowSurfaceRects(window, NULL, 0);
+    }
+
     full_rect.x = 0;
     full_rect.y = 0;
     full_rect.w = window->w;
@@ -2226,13 +2256,95 @@ int
 SDL_UpdateWindowSurfaceRects(SDL_Window * window, const SDL_Rect * rects,
                              int numrects)
 {
+    SDL_Rect region_rects[64];
+    SDL_Region region;
+    SDL_DamageRegion coarse;
+    const SDL_Rect *present_rects;
+    SDL_Rect bounds;
+    SDL_bool tracked;
+    int i, num_present_rects, status;
+
     CHECK_WINDOW_MAGIC(window, -1);
 
     if (!window->surface_valid) {
         return SDL_SetError("Window surface is invalid, please call SDL_GetWindowSurface() to get a new surface");
     }
+    if (numrects > 0 && !rects) {
+        return SDL_InvalidParamError("rects");
+    }
 
-    return _this->UpdateWindowFramebuffer(_this, window, rects, numrects);
+    /* The pixels of the rects and any damage in the window, each once.
+       Most presents fit on the stack. */
+    SDL_InitRegionWithBuffer(&region, region_rects, SDL_arraysize(region_rects));
+    if (SDL_SetRegionRects(&region, rects, numrects) < 0) {
+        SDL_FreeRegion(&region);
+        return -1;
+    }
+    tracked = (window->surface->flags & SDL_TRACKDAMAGE) ? SDL_TRUE : SDL_FALSE;
+    if (tracked) {
+        for (i = 0; i < window->damage.numrects; ++i) {
+            if (SDL_UnionRegionRect(&region, &window->damage.rects[i]) < 0) {
+                SDL_FreeRegion(&region);
+                return -1;
+            }
+        }
+    }
+    bounds.x = 0;
+    bounds.y = 0;
+    bounds.w = window->w;
+    bounds.h = window->h;
+    if (SDL_IntersectRegionRect(&region, &bounds) < 0) {
+        SDL_FreeRegion(&region);
+        return -1;
+    }
+    /* Nothing outside the shape of a shaped window is seen */
+    if (window->shaper && window->shaper->hasshape && window->shaper->region &&
+        SDL_IntersectRegion(&region, &region, window->shaper->region) < 0) {
+        SDL_FreeRegion(&region);
+        return -1;
+    }
+    if (region.numrects == 0) {
+        SDL_FreeRegion(&region);
+        return 0;
+    }
+
+    /* Presenting many small rects costs more than a few larger ones */
+    present_rects = region.rects;
+    num_present_rects = region.numrects;
+    if (num_present_rects > SDL_MAX_DAMAGE_RECTS) {
+        coarse.numrects = 0;
+        for (i = 0; i < region.numrects; ++i) {
+            SDL_AddDamage(&coarse, &region.rects[i]);
+        }
+        present_rects = coarse.rects;
+        num_present_rects = coarse.numrects;
+    }
+
+    status = _this->UpdateWindowFramebuffer(_this, window, present_rects, num_present_rects);
+    if (status == 0) {
+        if (tracked) {
+            window->damage.numrects = 0;
+        }
+        if (window->present_callback) {
+            window->present_callback(window->present_callback_data, window,
+                                     window->surface, present_rects, num_present_rects,
+                                     SDL_GetPerformanceCounter());
+        }
+    }
+    SDL_FreeRegion(&region);
+    return status;
+}
+
+int
+SDL_SetWindowPresentCallback(SDL_Window * window, SDL_PresentCallback callback,
+                             void *userdata)
+{
+    CHECK_WINDOW_MAGIC(window, -1);
+
+    window->present_callback = callback;
+    window->present_callback_data = userdata;
+
+    return 0;
 }
 
 int
@@ -2565,6 +2677,15 @@ SDL_OnWindowFocusLost(SDL_Window * window)
     }
 }
 
+void
+SDL_OnWindowExposed(SDL_Window * window)
+{
+    /* The window contents are gone, present all of the surface next time */
+    if (window->surface_valid) {
+        SDL_DamageWholeWindow(window);
+    }
+}
+
 /* !!! FIXME: is this different than SDL_GetKeyboardFocus()?
    !!! FIXME:  Also, SDL_GetKeyboardFocus() is O(1), this isn't. */
 SDL_Window *
@@ -2583,6 +2704,24 @@ SDL_GetFocusWindow(void)
     return NULL;
 }
 
+/* Called for surfaces with SDL_TRACKDAMAGE after drawing into them */
+void
+SDL_AddWindowSurfaceDamage(SDL_Surface * surface, const SDL_Rect * rect)
+{
+    SDL_Window *window;
+    SDL_Rect clipped;
+
+    if (!_this || !SDL_IntersectRect(rect, &surface->clip_rect, &clipped)) {
+        return;
+    }
+    for (window = _this->windows; window; window = window->next) {
+        if (window->surface == surface) {
+            SDL_AddDamage(&window->damage, &clipped);
+            return;
+        }
+    }
+}
+
 void
 SDL_DestroyWindow(SDL_Window * window)
 {
@@ -2744,6 +2883,8 @@ SDL_VideoQuit(void)
     _this->clipboard_text = NULL;
     _this->free(_this);
     _this = NULL;
+
+    SDL_InverseColorMapQuit();
 }
 
 int
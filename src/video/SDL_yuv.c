@@ -0,0 +1,673 @@
+/*
+  Simple DirectMedia Layer
+  Copyright (C) 1997-2017 Sam Lantinga <slouken@libsdl.org>
+
+  This software is provided 'as-is', without any express or implied
+  warranty.  In no event will the authors be held liable for any damages
+  arising from the use of this software.
+
+  Permission is granted to anyone to use this software for any purpose,
+  including commercial applications, and to alter it and redistribute it
+  freely, subject to the following restrictions:
+
+  1. The origin of this software must not be misrepresented; you must not
+     claim that you wrote the original software. If you use this software
+     in a product, an acknowledgment in the product documentation would be
+     appreciated but is not required.
+  2. Altered source versions must be plainly marked as such, and must not be
+     misrepresented as being the original software.
+  3. This notice may not be removed or altered from any source distribution.
+*/
+#include "../SDL_internal.h"
+
+#include "SDL_atomic.h"
+#include "SDL_cpuinfo.h"
+#include "SDL_video.h"
+#include "SDL_yuv_c.h"
+
+
+/* Set from any thread, each conversion reads it once when it starts */
+static SDL_atomic_t SDL_YUV_ConversionMode = { SDL_YUV_CONVERSION_BT601 };
+
+void SDL_SetYUVConversionMode(SDL_YUV_CONVERSION_MODE mode)
+{
+    SDL_AtomicSet(&SDL_YUV_ConversionMode, (int) mode);
+}
+
+SDL_YUV_CONVERSION_MODE SDL_GetYUVConversionMode(void)
+{
+    return (SDL_YUV_CONVERSION_MODE) SDL_AtomicGet(&SDL_YUV_ConversionMode);
+}
+
+SDL_YUV_CONVERSION_MODE SDL_GetYUVConversionModeForResolution(int width, int height)
+{
+    SDL_YUV_CONVERSION_MODE mode = SDL_GetYUVConversionMode();
+    if (mode == SDL_YUV_CONVERSION_AUTOMATIC) {
+        if (height <= 576) {
+            mode = SDL_YUV_CONVERSION_BT601;
+        } else {
+            mode = SDL_YUV_CONVERSION_BT709;
+        }
+    }
+    return mode;
+}
+
+
+/* The RGB to YUV coefficients are 13-bit fixed point. The YUV to RGB ones
+   are only 6-bit, so SSE2 can work on 16-bit values for 8 pixels at a time;
+   luma gets its own 16-bit gain on top of that, see YUVRowToRGB(). */
+#define YUV_DECODE_BITS 6
+#define YUV_BITS        13
+#define YUV_ROUND       (1 << (YUV_BITS - 1))
+
+typedef struct
+{
+    int y_offset;
+    /* YUV to RGB, 6-bit: luma is scaled by y_gain / 65536 after widening
+       it to 16 bits, and the bias includes the luma offset and rounding */
+    Uint16 y_gain;
+    Sint16 bias, r_v, g_u, g_v, b_u;
+    /* RGB to YUV, 13-bit */
+    Sint16 y_r, y_g, y_b, u_r, u_g, u_b, v_r, v_g, v_b;
+} SDL_YUVCoefficients;
+
+static const SDL_YUVCoefficients SDL_YUV_JPEG = {
+    0, 16320, 32, 90, 22, 46, 113,
+    2449, 4809, 934, -1382, -2714, 4096, 4096, -3430, -666
+};
+static const SDL_YUVCoefficients SDL_YUV_BT601 = {
+    16, 19003, -1160, 102, 25, 52, 129,
+    2104, 4130, 802, -1214, -2384, 3598, 3598, -3013, -585
+};
+static const SDL_YUVCoefficients SDL_YUV_BT709 = {
+    16, 19003, -1160, 115, 14, 34, 135,
+    1496, 5032, 508, -824, -2774, 3598, 3598, -3268, -330
+};
+static const SDL_YUVCoefficients SDL_YUV_BT709_FULL = {
+    0, 16320, 32, 101, 12, 30, 119,
+    1742, 5859, 591, -939, -3157, 4096, 4096, -3720, -376
+};
+
+static const SDL_YUVCoefficients *
+GetYUVCoefficients(int width, int height)
+{
+    switch (SDL_GetYUVConversionModeForResolution(width, height)) {
+    case SDL_YUV_CONVERSION_JPEG:
+        return &SDL_YUV_JPEG;
+    case SDL_YUV_CONVERSION_BT709:
+        return &SDL_YUV_BT709;
+    case SDL_YUV_CONVERSION_BT709_FULL:
+        return &SDL_YUV_BT709_FULL;
+    default:
+        return &SDL_YUV_BT601;
+    }
+}
+
+/* Where the samples of a YUV image live in memory */
+typedef struct
+{
+    Uint8 *y, *u, *v;
+    int y_pitch, uv_pitch;
+    int y_step;         /* bytes between luma samples */
+    int uv_step;        /* bytes between chroma samples */
+    int uv_rows;        /* luma rows sharing each chroma row */
+} SDL_YUVPlanes;
+
+static int
+GetYUVPlanes(int width, int height, Uint32 format, const void *pixels, int pitch, SDL_YUVPlanes *planes)
+{
+    Uint8 *base = (Uint8 *) pixels;
+
+    SDL_zerop(planes);
+
+    switch (format) {
+    case SDL_PIXELFORMAT_YV12:
+    case SDL_PIXELFORMAT_IYUV:
+        planes->y = base;
+        planes->y_pitch = pitch;
+        planes->y_step = 1;
+        planes->uv_pitch = (pitch + 1) / 2;
+        planes->uv_step = 1;
+        planes->uv_rows = 2;
+        if (format == SDL_PIXELFORMAT_YV12) {
+            planes->v = base + pitch * height;
+            planes->u = planes->v + planes->uv_pitch * ((height + 1) / 2);
+        } else {
+            planes->u = base + pitch * height;
+            planes->v = planes->u + planes->uv_pitch * ((height + 1) / 2);
+        }
+        break;
+    case SDL_PIXELFORMAT_NV12:
+    case SDL_PIXELFORMAT_NV21:
+        planes->y = base;
+        planes->y_pitch = pitch;
+        planes->y_step = 1;
+        planes->uv_pitch = pitch;
+        planes->uv_step = 2;
+        planes->uv_rows = 2;
+        if (format == SDL_PIXELFORMAT_NV12) {
+            planes->u = base + pitch * height;
+            planes->v = planes->u + 1;
+        } else {
+            planes->v = base + pitch * height;
+            planes->u = planes->v + 1;
+        }
+        break;
+    case SDL_PIXELFORMAT_YUY2:
+    case SDL_PIXELFORMAT_UYVY:
+    case SDL_PIXELFORMAT_YVYU:
+        planes->y_pitch = pitch;
+        planes->y_step = 2;
+        planes->uv_pitch = pitch;
+        planes->uv_step = 4;
+        planes->uv_rows = 1;
+        if (format == SDL_PIXELFORMAT_YUY2) {
+            planes->y = base;
+            planes->u = base + 1;
+            planes->v = base + 3;
+        } else if (format == SDL_PIXELFORMAT_UYVY) {
+            planes->u = base;
+            planes->y = base + 1;
+            planes->v = base + 2;
+        } else {
+            planes->y = base;
+            planes->v = base + 1;
+            planes->u = base + 3;
+        }
+        break;
+    default:
+        return SDL_SetError("Unsupported YUV format: %s", SDL_GetPixelFormatName(format));
+    }
+    return 0;
+}
+
+/* Position of each channel in a 32-bit format with 8-bit channels */
+typedef struct
+{
+    int r_shift, g_shift, b_shift, a_shift;
+    Uint32 a_mask;
+} SDL_RGBLayout;
+
+static SDL_bool
+IsByteChannel(Uint32 mask, int *shift)
+{
+    int i;
+
+    for (i = 0; i < 32; i += 8) {
+        if (mask == ((Uint32) 0xFF << i)) {
+            *shift = i;
+            return SDL_TRUE;
+        }
+    }
+    return SDL_FALSE;
+}
+
+/* Returns SDL_FALSE for formats that have to go through ARGB8888 first */
+static SDL_bool
+GetRGBLayout(Uint32 format, SDL_RGBLayout *layout)
+{
+    int bpp;
+    Uint32 Rmask, Gmask, Bmask, Amask;
+
+    if (!SDL_PixelFormatEnumToMasks(format, &bpp, &Rmask, &Gmask, &Bmask, &Amask) ||
+        SDL_BYTESPERPIXEL(format) != 4) {
+        return SDL_FALSE;
+    }
+    if (!IsByteChannel(Rmask, &layout->r_shift) ||
+        !IsByteChannel(Gmask, &layout->g_shift) ||
+        !IsByteChannel(Bmask, &layout->b_shift)) {
+        return SDL_FALSE;
+    }
+    if (Amask) {
+        if (!IsByteChannel(Amask, &layout->a_shift)) {
+            return SDL_FALSE;
+        }
+    } else {
+        /* The unused byte */
+        layout->a_shift = 48 - layout->r_shift - layout->g_shift - layout->b_shift;
+    }
+    layout->a_mask = Amask;
+    return SDL_TRUE;
+}
+
+static SDL_INLINE Uint32
+Clamp255(int value)
+{
+    if (value < 0) {
+        return 0;
+    }
+    if (value > 255) {
+        return 255;
+    }
+    return (Uint32) value;
+}
+
+static void
+YUVRowToRGB(const SDL_YUVCoefficients *c, const SDL_RGBLayout *layout,
+            const Uint8 *y, const Uint8 *u, const Uint8 *v,
+            int y_step, int uv_step, Uint32 *dst, int x, int width)
+{
+    for (; x < width; ++x) {
+        const int Y = (int) (((Uint32) y[x * y_step] * 257 * c->y_gain) >> 16) + c->bias;
+        const int U = u[(x / 2) * uv_step] - 128;
+        const int V = v[(x / 2) * uv_step] - 128;
+
+        dst[x] = (Clamp255((Y + c->r_v * V) >> YUV_DECODE_BITS) << layout->r_shift) |
+                 (Clamp255((Y - (c->g_u * U + c->g_v * V)) >> YUV_DECODE_BITS) << layout->g_shift) |
+                 (Clamp255((Y + c->b_u * U) >> YUV_DECODE_BITS) << layout->b_shift) |
+                 layout->a_mask;
+    }
+}
+
+#ifdef __SSE2__
+typedef struct
+{
+    __m128i y_gain, bias, uv_offset;
+    __m128i r_v, g_u, g_v, b_u;
+    __m128i low_words, low_bytes, alpha;
+    int order[4];       /* the channel stored in each byte of a pixel */
+} SDL_YUVConstantsSSE2;
+
+static void
+InitYUVConstantsSSE2(const SDL_YUVCoefficients *c, const SDL_RGBLayout *layout, SDL_YUVConstantsSSE2 *k)
+{
+    k->y_gain = _mm_set1_epi16((short) c->y_gain);
+    k->bias = _mm_set1_epi16(c->bias);
+    k->uv_offset = _mm_set1_epi16(128);
+    k->r_v = _mm_set1_epi16(c->r_v);
+    k->g_u = _mm_set1_epi16(c->g_u);
+    k->g_v = _mm_set1_epi16(c->g_v);
+    k->b_u = _mm_set1_epi16(c->b_u);
+    k->low_words = _mm_set1_epi32(0x0000FFFF);
+    k->low_bytes = _mm_set1_epi16(0x00FF);
+    k->alpha = _mm_set1_epi8(layout->a_mask ? (char) 0xFF : 0);
+    k->order[layout->r_shift / 8] = 0;
+    k->order[layout->g_shift / 8] = 1;
+    k->order[layout->b_shift / 8] = 2;
+    k->order[layout->a_shift / 8] = 3;
+}
+
+/* Converts 8 pixels, given as 16-bit Y and horizontally doubled U and V.
+   This is the same arithmetic as YUVRowToRGB(), the saturating adds only
+   clip values that would be clamped to 255 anyway. */
+static SDL_INLINE void
+YUV8ToRGB_SSE2(const SDL_YUVConstantsSSE2 *k, __m128i y, __m128i u, __m128i v, Uint32 *dst)
+{
+    __m128i channels[4], lo, hi;
+
+    y = _mm_add_epi16(_mm_mulhi_epu16(_mm_or_si128(y, _mm_slli_epi16(y, 8)), k->y_gain), k->bias);
+    u = _mm_sub_epi16(u, k->uv_offset);
+    v = _mm_sub_epi16(v, k->uv_offset);
+
+    channels[0] = _mm_srai_epi16(_mm_adds_epi16(y, _mm_mullo_epi16(v, k->r_v)), YUV_DECODE_BITS);
+    channels[1] = _mm_srai_epi16(_mm_subs_epi16(y, _mm_add_epi16(_mm_mullo_epi16(u, k->g_u),
+                                                                 _mm_mullo_epi16(v, k->g_v))), YUV_DECODE_BITS);
+    channels[2] = _mm_srai_epi16(_mm_adds_epi16(y, _mm_mullo_epi16(u, k->b_u)), YUV_DECODE_BITS);
+    channels[0] = _mm_packus_epi16(channels[0], channels[0]);
+    channels[1] = _mm_packus_epi16(channels[1], channels[1]);
+    channels[2] = _mm_packus_epi16(channels[2], channels[2]);
+    channels[3] = k->alpha;
+
+    lo = _mm_unpacklo_epi8(channels[k->order[0]], channels[k->order[1]]);
+    hi = _mm_unpacklo_epi8(channels[k->order[2]], channels[k->order[3]]);
+    _mm_storeu_si128((__m128i *) dst, _mm_unpacklo_epi16(lo, hi));
+    _mm_storeu_si128((__m128i *) (dst + 4), _mm_unpackhi_epi16(lo, hi));
+}
+
+/* Splits 16-bit interleaved chroma c0 c1 c0 c1 ... into doubled c0 and c1 */
+static SDL_INLINE void
+SplitChromaSSE2(const SDL_YUVConstantsSSE2 *k, __m128i c, __m128i *first, __m128i *second)
+{
+    const __m128i c0 = _mm_and_si128(c, k->low_words);
+    const __m128i c1 = _mm_srli_epi32(c, 16);
+    *first = _mm_or_si128(c0, _mm_slli_epi32(c0, 16));
+    *second = _mm_or_si128(c1, _mm_slli_epi32(c1, 16));
+}
+
+/* Converts as much of a row as possible with SSE2, returns the number of
+   pixels done */
+static int
+YUVRowToRGB_SSE2(const SDL_YUVConstantsSSE2 *k,
+                 const Uint8 *y, const Uint8 *u, const Uint8 *v,
+                 int y_step, int uv_step, Uint32 *dst, int width)
+{
+    const __m128i zero = _mm_setzero_si128();
+    __m128i Y, U, V, C;
+    int x = 0;
+
+    if (uv_step == 1) {
+        /* Planar, 16 pixels at a time to load 8 bytes of each chroma plane */
+        for (; x + 16 <= width; x += 16) {
+            Y = _mm_loadu_si128((const __m128i *) (y + x));
+            U = _mm_unpacklo_epi8(_mm_loadl_epi64((const __m128i *) (u + x / 2)), zero);
+            V = _mm_unpacklo_epi8(_mm_loadl_epi64((const __m128i *) (v + x / 2)), zero);
+            YUV8ToRGB_SSE2(k, _mm_unpacklo_epi8(Y, zero), _mm_unpacklo_epi16(U, U),
+                           _mm_unpacklo_epi16(V, V), dst + x);
+            YUV8ToRGB_SSE2(k, _mm_unpackhi_epi8(Y, zero), _mm_unpackhi_epi16(U, U),
+                           _mm_unpackhi_epi16(V, V), dst + x + 8);
+        }
+    } else if (uv_step == 2) {
+        /* Interleaved chroma plane */
+        const Uint8 *uv = (u < v) ? u : v;
+        for (; x + 8 <= width; x += 8) {
+            Y = _mm_unpacklo_epi8(_mm_loadl_epi64((const __m128i *) (y + x)), zero);
+            C = _mm_unpacklo_epi8(_mm_loadl_epi64((const __m128i *) (uv + x)), zero);
+            if (u < v) {
+                SplitChromaSSE2(k, C, &U, &V);
+            } else {
+                SplitChromaSSE2(k, C, &V, &U);
+            }
+            YUV8ToRGB_SSE2(k, Y, U, V, dst + x);
+        }
+    } else {
+        /* Packed 4:2:2, luma in either the even or the odd bytes */
+        const Uint8 *p = (y < u) ? y : u;
+        for (; x + 8 <= width; x += 8) {
+            const __m128i data = _mm_loadu_si128((const __m128i *) (p + x * 2));
+            if (y == p) {
+                Y = _mm_and_si128(data, k->low_bytes);
+                C = _mm_srli_epi16(data, 8);
+            } else {
+                Y = _mm_srli_epi16(data, 8);
+                C = _mm_and_si128(data, k->low_bytes);
+            }
+            if (u < v) {
+                SplitChromaSSE2(k, C, &U, &V);
+            } else {
+                SplitChromaSSE2(k, C, &V, &U);
+            }
+            YUV8ToRGB_SSE2(k, Y, U, V, dst + x);
+        }
+    }
+    return x;
+}
+#endif /* __SSE2__ */
+
+/* Doubles a row of 32-bit pixels horizontally */
+static void
+DoubleRow(const Uint32 *src, Uint32 *dst, int width)
+{
+    int x = 0;
+
+#ifdef __SSE2__
+    if (SDL_HasSSE2()) {
+        for (; x + 4 <= width; x += 4) {
+            const __m128i pixels = _mm_loadu_si128((const __m128i *) (src + x));
+            _mm_storeu_si128((__m128i *) (dst + x * 2), _mm_unpacklo_epi32(pixels, pixels));
+            _mm_storeu_si128((__m128i *) (dst + x * 2 + 4), _mm_unpackhi_epi32(pixels, pixels));
+        }
+    }
+#endif
+    for (; x < width; ++x) {
+        dst[x * 2] = dst[x * 2 + 1] = src[x];
+    }
+}
+
+/* Converts YUV to a 32-bit format with 8-bit channels, at twice the size if
+   a row buffer for the doubling is passed in */
+static void
+ConvertYUVToRGB(int width, int height, const SDL_YUVPlanes *planes,
+                const SDL_YUVCoefficients *c, const SDL_RGBLayout *layout,
+                Uint8 *dst, int dst_pitch, Uint32 *row2x)
+{
+    int j, x;
+#ifdef __SSE2__
+    SDL_YUVConstantsSSE2 k;
+    const SDL_bool use_sse2 = SDL_HasSSE2();
+
+    if (use_sse2) {
+        InitYUVConstantsSSE2(c, layout, &k);
+    }
+#endif
+
+    for (j = 0; j < height; ++j) {
+        const Uint8 *y = planes->y + j * planes->y_pitch;
+        const Uint8 *u = planes->u + (j / planes->uv_rows) * planes->uv_pitch;
+        const Uint8 *v = planes->v + (j / planes->uv_rows) * planes->uv_pitch;
+        Uint32 *row = row2x ? row2x : (Uint32 *) dst;
+
+        x = 0;
+#ifdef __SSE2__
+        if (use_sse2) {
+            x = YUVRowToRGB_SSE2(&k, y, u, v, planes->y_step, planes->uv_step, row, width);
+        }
+#endif
+        YUVRowToRGB(c, layout, y, u, v, planes->y_step, planes->uv_step, row, x, width);
+
+        if (row2x) {
+            DoubleRow(row2x, (Uint32 *) dst, width);
+            SDL_memcpy(dst + dst_pitch, dst, width * 2 * sizeof (Uint32));
+            dst += dst_pitch * 2;
+        } else {
+            dst += dst_pitch;
+        }
+    }
+}
+
+/* Converts a 32-bit format with 8-bit channels to YUV, averaging the colour
+   of each pixel pair or 2x2 block for its chroma */
+static void
+ConvertRGBToYUV(int width, int height, const Uint8 *src, int src_pitch,
+                const SDL_RGBLayout *layout, const SDL_YUVCoefficients *c,
+                const SDL_YUVPlanes *planes)
+{
+    int i, j, k;
+
+    for (j = 0; j < height; j += planes->uv_rows) {
+        const Uint32 *rows[2];
+        const int nrows = planes->uv_rows;
+        Uint8 *u = planes->u + (j / nrows) * planes->uv_pitch;
+        Uint8 *v = planes->v + (j / nrows) * planes->uv_pitch;
+
+        rows[0] = (const Uint32 *) (src + j * src_pitch);
+        rows[1] = (j + 1 < height) ? (const Uint32 *) (src + (j + 1) * src_pitch) : rows[0];
+
+        for (k = 0; k < nrows && j + k < height; ++k) {
+            Uint8 *y = planes->y + (j + k) * planes->y_pitch;
+            for (i = 0; i < width; ++i) {
+                const Uint32 pixel = rows[k][i];
+                const int R = (pixel >> layout->r_shift) & 0xFF;
+                const int G = (pixel >> layout->g_shift) & 0xFF;
+                const int B = (pixel >> layout->b_shift) & 0xFF;
+                y[i * planes->y_step] = (Uint8) (((c->y_r * R + c->y_g * G + c->y_b * B + YUV_ROUND) >> YUV_BITS) + c->y_offset);
+            }
+        }
+
+        for (i = 0; i < width; i += 2) {
+            const int i1 = (i + 1 < width) ? i + 1 : i;
+            int R = 0, G = 0, B = 0, shift = YUV_BITS + 1;
+
+            for (k = 0; k < nrows; ++k) {
+                const Uint32 p0 = rows[k][i], p1 = rows[k][i1];
+                R += ((p0 >> layout->r_shift) & 0xFF) + ((p1 >> layout->r_shift) & 0xFF);
+                G += ((p0 >> layout->g_shift) & 0xFF) + ((p1 >> layout->g_shift) & 0xFF);
+                B += ((p0 >> layout->b_shift) & 0xFF) + ((p1 >> layout->b_shift) & 0xFF);
+            }
+            if (nrows == 2) {
+                ++shift;
+            }
+            u[(i / 2) * planes->uv_step] = (Uint8) Clamp255(((c->u_r * R + c->u_g * G + c->u_b * B + (1 << (shift - 1))) >> shift) + 128);
+            v[(i / 2) * planes->uv_step] = (Uint8) Clamp255(((c->v_r * R + c->v_g * G + c->v_b * B + (1 << (shift - 1))) >> shift) + 128);
+        }
+    }
+}
+
+int
+SDL_ConvertPixels_YUV_to_RGB(int width, int height,
+                             Uint32 src_format, const void *src, int src_pitch,
+                             Uint32 dst_format, void *dst, int dst_pitch)
+{
+    const SDL_YUVCoefficients *c = GetYUVCoefficients(width, height);
+    SDL_YUVPlanes planes;
+    SDL_RGBLayout layout;
+    void *tmp;
+    int tmp_pitch, retval;
+
+    if (GetYUVPlanes(width, height, src_format, src, src_pitch, &planes) < 0) {
+        return -1;
+    }
+
+    if (GetRGBLayout(dst_format, &layout)) {
+        ConvertYUVToRGB(width, height, &planes, c, &layout, (Uint8 *) dst, dst_pitch, NULL);
+        return 0;
+    }
+
+    /* Any other format goes through ARGB8888 */
+    tmp_pitch = width * 4;
+    tmp = SDL_malloc(tmp_pitch * height);
+    if (!tmp) {
+        return SDL_OutOfMemory();
+    }
+    GetRGBLayout(SDL_PIXELFORMAT_ARGB8888, &layout);
+    ConvertYUVToRGB(width, height, &planes, c, &layout, (Uint8 *) tmp, tmp_pitch, NULL);
+    retval = SDL_ConvertPixels(width, height, SDL_PIXELFORMAT_ARGB8888, tmp, tmp_pitch,
+                               dst_format, dst, dst_pitch);
+    SDL_free(tmp);
+    return retval;
+}
+
+/* Whether YUV converts to this format without going through ARGB8888 */
+SDL_bool
+SDL_IsYUVDirectFormat(Uint32 format)
+{
+    SDL_RGBLayout layout;
+    return GetRGBLayout(format, &layout);
+}
+
+int
+SDL_ConvertPixels_YUV_to_RGB2X(int width, int height,
+                               Uint32 src_format, const void *src, int src_pitch,
+                               Uint32 dst_format, void *dst, int dst_pitch)
+{
+    const SDL_YUVCoefficients *c = GetYUVCoefficients(width, height);
+    SDL_YUVPlanes planes;
+    SDL_RGBLayout layout;
+    Uint32 *row;
+
+    if (GetYUVPlanes(width, height, src_format, src, src_pitch, &planes) < 0) {
+        return -1;
+    }
+    if (!GetRGBLayout(dst_format, &layout)) {
+        return SDL_SetError("Unsupported 2x YUV destination format: %s", SDL_GetPixelFormatName(dst_format));
+    }
+
+    row = (Uint32 *) SDL_malloc(width * sizeof (Uint32));
+    if (!row) {
+        return SDL_OutOfMemory();
+    }
+    ConvertYUVToRGB(width, height, &planes, c, &layout, (Uint8 *) dst, dst_pitch, row);
+    SDL_free(row);
+    return 0;
+}
+
+int
+SDL_ConvertPixels_RGB_to_YUV(int width, int height,
+                             Uint32 src_format, const void *src, int src_pitch,
+                             Uint32 dst_format, void *dst, int dst_pitch)
+{
+    const SDL_YUVCoefficients *c = GetYUVCoefficients(width, height);
+    SDL_YUVPlanes planes;
+    SDL_RGBLayout layout;
+    void *tmp;
+    int tmp_pitch;
+
+    if (GetYUVPlanes(width, height, dst_format, dst, dst_pitch, &planes) < 0) {
+        return -1;
+    }
+
+    if (GetRGBLayout(src_format, &layout)) {
+        ConvertRGBToYUV(width, height, (const Uint8 *) src, src_pitch, &layout, c, &planes);
+        return 0;
+    }
+
+    /* Any other format goes through ARGB8888 */
+    tmp_pitch = width * 4;
+    tmp = SDL_malloc(tmp_pitch * height);
+    if (!tmp) {
+        return SDL_OutOfMemory();
+    }
+    if (SDL_ConvertPixels(width, height, src_format, src, src_pitch,
+                          SDL_PIXELFORMAT_ARGB8888, tmp, tmp_pitch) < 0) {
+        SDL_free(tmp);
+        return -1;
+    }
+    GetRGBLayout(SDL_PIXELFORMAT_ARGB8888, &layout);
+    ConvertRGBToYUV(width, height, (const Uint8 *) tmp, tmp_pitch, &layout, c, &planes);
+    SDL_free(tmp);
+    return 0;
+}
+
+/* Copies every step'th byte of a row, for one plane of samples */
+static void
+CopySamples(const Uint8 *src, int src_step, Uint8 *dst, int dst_step, int count)
+{
+    int i;
+
+    if (src_step == 1 && dst_step == 1) {
+        SDL_memcpy(dst, src, count);
+        return;
+    }
+    for (i = 0; i < count; ++i) {
+        *dst = *src;
+        src += src_step;
+        dst += dst_step;
+    }
+}
+
+/* Moves the samples between two layouts with the same chroma subsampling,
+   which loses nothing */
+static void
+CopyYUVPlanes(int width, int height, const SDL_YUVPlanes *src, const SDL_YUVPlanes *dst)
+{
+    const int uv_width = (width + 1) / 2;
+    const int uv_height = (height + src->uv_rows - 1) / src->uv_rows;
+    int j;
+
+    for (j = 0; j < height; ++j) {
+        CopySamples(src->y + j * src->y_pitch, src->y_step,
+                    dst->y + j * dst->y_pitch, dst->y_step, width);
+    }
+    for (j = 0; j < uv_height; ++j) {
+        CopySamples(src->u + j * src->uv_pitch, src->uv_step,
+                    dst->u + j * dst->uv_pitch, dst->uv_step, uv_width);
+        CopySamples(src->v + j * src->uv_pitch, src->uv_step,
+                    dst->v + j * dst->uv_pitch, dst->uv_step, uv_width);
+    }
+}
+
+int
+SDL_ConvertPixels_YUV_to_YUV(int width, int height,
+                             Uint32 src_format, const void *src, int src_pitch,
+                             Uint32 dst_format, void *dst, int dst_pitch)
+{
+    const SDL_YUVCoefficients *c = GetYUVCoefficients(width, height);
+    SDL_YUVPlanes src_planes, dst_planes;
+    SDL_RGBLayout layout;
+    void *tmp;
+    int tmp_pitch;
+
+    if (GetYUVPlanes(width, height, src_format, src, src_pitch, &src_planes) < 0 ||
+        GetYUVPlanes(width, height, dst_format, dst, dst_pitch, &dst_planes) < 0) {
+        return -1;
+    }
+
+    if (src_planes.uv_rows == dst_planes.uv_rows) {
+        CopyYUVPlanes(width, height, &src_planes, &dst_planes);
+        return 0;
+    }
+
+    /* Packed and planar formats subsample chroma differently, so go through
+       ARGB8888, the conversion matrix is the same both ways */
+    tmp_pitch = width * 4;
+    tmp = SDL_malloc(tmp_pitch * height);
+    if (!tmp) {
+        return SDL_OutOfMemory();
+    }
+    GetRGBLayout(SDL_PIXELFORMAT_ARGB8888, &layout);
+    ConvertYUVToRGB(width, height, &src_planes, c, &layout, (Uint8 *) tmp, tmp_pitch, NULL);
+    ConvertRGBToYUV(width, height, (const Uint8 *) tmp, tmp_pitch, &layout, c, &dst_planes);
+    SDL_free(tmp);
+    return 0;
+}
+
+/* vi: set ts=4 sw=4 expandtab: */
@@ -23,22 +23,110 @@
 #if SDL_VIDEO_DRIVER_DUMMY
 
 #include "../SDL_sysvideo.h"
+#include "SDL_hints.h"
+#include "SDL_log.h"
+#include "SDL_timer.h"
 #include "SDL_nullframebuffer_c.h"
 
 
 #define DUMMY_SURFACE   "_SDL_DummySurface"
 
+/* The window surface, and how often it has been presented */
+typedef struct
+{
+    SDL_Surface *surface;
+    Uint32 presents;
+    Uint64 pixels;
+    Uint64 last_present;
+    double min_interval;
+    double max_interval;
+    double sum_interval;
+    double sum2_interval;
+} DUMMY_Framebuffer;
+
+/* Frames are written to the output as a header and tightly packed rows */
+#define DUMMY_FRAME_MAGIC   0x464C4453  /* "SDLF" */
+
+static SDL_bool output_checked;
+static SDL_RWops *output;
+static Uint64 output_start;
+static Uint32 frame_number;
+
+static Uint64
+DUMMY_GetNanoseconds(Uint64 ticks)
+{
+    const Uint64 frequency = SDL_GetPerformanceFrequency();
+
+    return (ticks / frequency) * 1000000000 + ((ticks % frequency) * 1000000000) / frequency;
+}
+
+static int
+DUMMY_WriteFrame(SDL_Window * window, SDL_Surface * surface, Uint64 now)
+{
+    const size_t length = (size_t) surface->w * surface->format->BytesPerPixel;
+    const Uint8 *row = (const Uint8 *) surface->pixels;
+    SDL_bool ok;
+    int y;
+
+    if (!output_checked) {
+        const char *file = SDL_GetHint(SDL_HINT_VIDEO_DUMMY_OUTPUT);
+
+        output_checked = SDL_TRUE;
+        if (file && *file) {
+            output = SDL_RWFromFile(file, "wb");
+            if (!output) {
+                return -1;
+            }
+            output_start = now;
+        }
+    }
+    if (!output) {
+        return 0;
+    }
+
+    ok = SDL_WriteLE32(output, DUMMY_FRAME_MAGIC) &&
+         SDL_WriteLE32(output, SDL_GetWindowID(window)) &&
+         SDL_WriteLE32(output, (Uint32) surface->w) &&
+         SDL_WriteLE32(output, (Uint32) surface->h) &&
+         SDL_WriteLE32(output, surface->format->format) &&
+         SDL_WriteLE32(output, frame_number) &&
+         SDL_WriteLE64(output, DUMMY_GetNanoseconds(now - output_start));
+    if (ok && surface->pitch == (int) length) {
+        ok = (SDL_RWwrite(output, row, length, surface->h) == (size_t) surface->h);
+    } else {
+        for (y = 0; ok && y < surface->h; ++y, row += surface->pitch) {
+            ok = (SDL_RWwrite(output, row, length, 1) == 1);
+        }
+    }
+    if (!ok) {
+        /* The reader has probably gone away, stop sending it frames */
+        SDL_RWclose(output);
+        output = NULL;
+        return SDL_SetError("Couldn't write frame to %s", SDL_GetHint(SDL_HINT_VIDEO_DUMMY_OUTPUT));
+    }
+    return 0;
+}
+
 int SDL_DUMMY_CreateWindowFramebuffer(_THIS, SDL_Window * window, Uint32 * format, void ** pixels, int *pitch)
 {
+    DUMMY_Framebuffer *framebuffer;
     SDL_Surface *surface;
     const Uint32 surface_format = SDL_PIXELFORMAT_RGB888;
     int w, h;
     int bpp;
     Uint32 Rmask, Gmask, Bmask, Amask;
 
-    /* Free the old framebuffer surface */
-    surface = (SDL_Surface *) SDL_GetWindowData(window, DUMMY_SURFACE);
-    SDL_FreeSurface(surface);
+    /* Keep the statistics over size changes, but free the old surface */
+    framebuffer = (DUMMY_Framebuffer *) SDL_GetWindowData(window, DUMMY_SURFACE);
+    if (!framebuffer) {
+        framebuffer = (DUMMY_Framebuffer *) SDL_calloc(1, sizeof(*framebuffer));
+        if (!framebuffer) {
+            return SDL_OutOfMemory();
+        }
+        SDL_SetWindowData(window, DUMMY_SURFACE, framebuffer);
+    }
+    SDL_FreeSurface(framebuffer->surface);
+    framebuffer->surface = NULL;
 
     /* Create a new one */
     SDL_PixelFormatEnumToMasks(surface_format, &bpp, &Rmask, &Gmask, &Bmask, &Amask);
@@ -49,7 +137,7 @@ int SDL_DUMMY_CreateWindowFramebuffer(_THIS, SDL_Window * window, Uint32 * forma
     }
 
     /* Save the info and return! */
-    SDL_SetWindowData(window, DUMMY_SURFACE, surface);
+    framebuffer->surface = surface;
     *format = surface_format;
     *pixels = surface->pixels;
     *pitch = surface->pitch;
@@ -58,30 +146,82 @@ int SDL_DUMMY_CreateWindowFramebuffer(_THIS, SDL_Window * window, Uint32 * forma
 
 int SDL_DUMMY_UpdateWindowFramebuffer(_THIS, SDL_Window * window, const SDL_Rect * rects, int numrects)
 {
-    static int frame_number;
+    DUMMY_Framebuffer *framebuffer;
     SDL_Surface *surface;
+    Uint64 now;
+    int i;
 
-    surface = (SDL_Surface *) SDL_GetWindowData(window, DUMMY_SURFACE);
-    if (!surface) {
+    framebuffer = (DUMMY_Framebuffer *) SDL_GetWindowData(window, DUMMY_SURFACE);
+    if (!framebuffer || !framebuffer->surface) {
         return SDL_SetError("Couldn't find dummy surface for window");
     }
+    surface = framebuffer->surface;
+
+    /* Count the frame and the time since the last one */
+    now = SDL_GetPerformanceCounter();
+    if (framebuffer->presents > 0) {
+        const double interval = (double) (now - framebuffer->last_present) * 1000.0 /
+                                (double) SDL_GetPerformanceFrequency();
+
+        if (framebuffer->presents == 1 || interval < framebuffer->min_interval) {
+            framebuffer->min_interval = interval;
+        }
+        if (interval > framebuffer->max_interval) {
+            framebuffer->max_interval = interval;
+        }
+        framebuffer->sum_interval += interval;
+        framebuffer->sum2_interval += interval * interval;
+    }
+    ++framebuffer->presents;
+    framebuffer->last_present = now;
+    for (i = 0; i < numrects; ++i) {
+        framebuffer->pixels += (Uint64) rects[i].w * rects[i].h;
+    }
+    ++frame_number;
 
     /* Send the data to the display */
     if (SDL_getenv("SDL_VIDEO_DUMMY_SAVE_FRAMES")) {
         char file[128];
         SDL_snprintf(file, sizeof(file), "SDL_window%d-%8.8d.bmp",
-                     SDL_GetWindowID(window), ++frame_number);
+                     SDL_GetWindowID(window), frame_number);
         SDL_SaveBMP(surface, file);
     }
-    return 0;
+    return DUMMY_WriteFrame(window, surface, now);
 }
 
 void SDL_DUMMY_DestroyWindowFramebuffer(_THIS, SDL_Window * window)
 {
-    SDL_Surface *surface;
+    DUMMY_Framebuffer *framebuffer;
 
-    surface = (SDL_Surface *) SDL_SetWindowData(window, DUMMY_SURFACE, NULL);
-    SDL_FreeSurface(surface);
+    framebuffer = (DUMMY_Framebuffer *) SDL_SetWindowData(window, DUMMY_SURFACE, NULL);
+    if (!framebuffer) {
+        return;
+    }
+
+    if (framebuffer->presents > 1) {
+        const double intervals = (double) (framebuffer->presents - 1);
+        const double mean = framebuffer->sum_interval / intervals;
+        const double variance = framebuffer->sum2_interval / intervals - mean * mean;
+
+        SDL_LogInfo(SDL_LOG_CATEGORY_VIDEO,
+                    "Window %d: %u frames, %.1f pixels per frame, frame time %.3f ms average, %.3f min, %.3f max, %.3f deviation",
+                    SDL_GetWindowID(window), framebuffer->presents,
+                    (double) framebuffer->pixels / framebuffer->presents,
+                    mean, framebuffer->min_interval, framebuffer->max_interval,
+                    variance > 0.0 ? SDL_sqrt(variance) : 0.0);
+    }
+    SDL_FreeSurface(framebuffer->surface);
+    SDL_free(framebuffer);
+}
+
+void SDL_DUMMY_QuitFramebuffer(_THIS)
+{
+    if (output) {
+        SDL_RWclose(output);
+        output = NULL;
+    }
+    output_checked = SDL_FALSE;
+    frame_number = 0;
 }
 
 #endif /* SDL_VIDEO_DRIVER_DUMMY */
@@ -41,6 +41,7 @@
 #include "SDL_mouse.h"
 #include "../SDL_sysvideo.h"
 #include "../SDL_pixels_c.h"
+#include "../SDL_shape_internals.h"
 #include "../../events/SDL_events_c.h"
 
 #include "SDL_nullvideo.h"
@@ -53,6 +54,20 @@
 static int DUMMY_VideoInit(_THIS);
 static int DUMMY_SetDisplayMode(_THIS, SDL_VideoDisplay * display, SDL_DisplayMode * mode);
 static void DUMMY_VideoQuit(_THIS);
+static void DUMMY_DestroyWindow(_THIS, SDL_Window * window);
+static SDL_WindowShaper *DUMMY_CreateShaper(SDL_Window * window);
+static int DUMMY_SetWindowShape(SDL_WindowShaper * shaper, SDL_Surface * shape, SDL_WindowShapeMode * shape_mode);
+static int DUMMY_UpdateWindowShape(SDL_WindowShaper * shaper, SDL_Surface * shape, const SDL_Rect * rect);
+static int DUMMY_ResizeWindowShape(SDL_Window * window);
+
+/* Shaped windows keep the opaque pixels of their shape as a region and a
+   tree of rectangles, like the drivers for window systems taking those. */
+typedef struct
+{
+    int w, h;
+    SDL_Region region;
+    SDL_ShapeTree *tree;
+} DUMMY_ShapeData;
 
 /* DUMMY driver bootstrap functions */
 
@@ -91,9 +106,14 @@ DUMMY_CreateDevice(int devindex)
     device->VideoQuit = DUMMY_VideoQuit;
     device->SetDisplayMode = DUMMY_SetDisplayMode;
     device->PumpEvents = DUMMY_PumpEvents;
+    device->DestroyWindow = DUMMY_DestroyWindow;
     device->CreateWindowFramebuffer = SDL_DUMMY_CreateWindowFramebuffer;
     device->UpdateWindowFramebuffer = SDL_DUMMY_UpdateWindowFramebuffer;
     device->DestroyWindowFramebuffer = SDL_DUMMY_DestroyWindowFramebuffer;
+    device->shape_driver.CreateShaper = DUMMY_CreateShaper;
+    device->shape_driver.SetWindowShape = DUMMY_SetWindowShape;
+    device->shape_driver.UpdateWindowShape = DUMMY_UpdateWindowShape;
+    device->shape_driver.ResizeWindowShape = DUMMY_ResizeWindowShape;
 
     device->free = DUMMY_DeleteDevice;
 
@@ -137,6 +157,84 @@ DUMMY_SetDisplayMode(_THIS, SDL_VideoDisplay * display, SDL_DisplayMode * mode)
 void
 DUMMY_VideoQuit(_THIS)
 {
+    SDL_DUMMY_QuitFramebuffer(_this);
+}
+
+static void
+DUMMY_DestroyWindow(_THIS, SDL_Window * window)
+{
+    if (window->shaper) {
+        DUMMY_ResizeWindowShape(window);
+        SDL_free(window->shaper->driverdata);
+        SDL_free(window->shaper);
+        window->shaper = NULL;
+    }
+}
+
+static SDL_WindowShaper *
+DUMMY_CreateShaper(SDL_Window * window)
+{
+    SDL_WindowShaper *shaper;
+    DUMMY_ShapeData *data;
+
+    shaper = (SDL_WindowShaper *) SDL_calloc(1, sizeof(*shaper));
+    data = (DUMMY_ShapeData *) SDL_calloc(1, sizeof(*data));
+    if (!shaper || !data) {
+        SDL_free(shaper);
+        SDL_free(data);
+        SDL_OutOfMemory();
+        return NULL;
+    }
+    shaper->window = window;
+    shaper->mode.mode = ShapeModeDefault;
+    shaper->mode.parameters.binarizationCutoff = 1;
+    shaper->driverdata = data;
+    return shaper;
+}
+
+static int
+DUMMY_SetWindowShape(SDL_WindowShaper * shaper, SDL_Surface * shape, SDL_WindowShapeMode * shape_mode)
+{
+    if (shape->format->Amask == 0 && SDL_SHAPEMODEALPHA(shaper->mode.mode)) {
+        return SDL_INVALID_SHAPE_ARGUMENT;
+    }
+    return DUMMY_UpdateWindowShape(shaper, shape, NULL);
+}
+
+static int
+DUMMY_UpdateWindowShape(SDL_WindowShaper * shaper, SDL_Surface * shape, const SDL_Rect * rect)
+{
+    DUMMY_ShapeData *data = (DUMMY_ShapeData *) shaper->driverdata;
+
+    if (shape->w != shaper->window->w || shape->h != shaper->window->h) {
+        return SDL_INVALID_SHAPE_ARGUMENT;
+    }
+    if (shape->w != data->w || shape->h != data->h) {
+        rect = NULL;
+    }
+    if (SDL_CalculateShapeRegion(shaper->mode, shape, rect, &data->region) < 0 ||
+        SDL_UpdateShapeTree(&data->tree, &data->region, shape->w, shape->h, rect) < 0) {
+        DUMMY_ResizeWindowShape(shaper->window);
+        return -1;
+    }
+    data->w = shape->w;
+    data->h = shape->h;
+    shaper->region = &data->region;
+    return 0;
+}
+
+static int
+DUMMY_ResizeWindowShape(SDL_Window * window)
+{
+    DUMMY_ShapeData *data = (DUMMY_ShapeData *) window->shaper->driverdata;
+
+    if (data->tree) {
+        SDL_FreeShapeTree(&data->tree);
+    }
+    SDL_FreeRegion(&data->region);
+    data->w = data->h = 0;
+    window->shaper->region = NULL;
+    return 0;
 }
 
 #endif /* SDL_VIDEO_DRIVER_DUMMY */
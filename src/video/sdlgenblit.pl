@@ -38,6 +38,10 @@ my @dst_formats = (
     "RGB888",
     "BGR888",
     "ARGB8888",
+    "RGBA8888",
+    "ABGR8888",
+    "BGRA8888",
+    "RGB565",
 );
 
 my %format_size = (
@@ -47,6 +51,7 @@ my %format_size = (
     "RGBA8888" => 4,
     "ABGR8888" => 4,
     "BGRA8888" => 4,
+    "RGB565" => 2,
 );
 
 my %format_type = (
@@ -56,6 +61,7 @@ my %format_type = (
     "RGBA8888" => "Uint32",
     "ABGR8888" => "Uint32",
     "BGRA8888" => "Uint32",
+    "RGB565" => "Uint16",
 );
 
 my %get_rgba_string_ignore_alpha = (
@@ -65,6 +71,7 @@ my %get_rgba_string_ignore_alpha = (
     "RGBA8888" => "_R = (Uint8)(_pixel >> 24); _G = (Uint8)(_pixel >> 16); _B = (Uint8)(_pixel >> 8);",
     "ABGR8888" => "_B = (Uint8)(_pixel >> 16); _G = (Uint8)(_pixel >> 8); _R = (Uint8)_pixel;",
     "BGRA8888" => "_B = (Uint8)(_pixel >> 24); _G = (Uint8)(_pixel >> 16); _R = (Uint8)(_pixel >> 8);",
+    "RGB565" => "_R = SDL_expand_byte[3][(_pixel >> 11) & 0x1F]; _G = SDL_expand_byte[2][(_pixel >> 5) & 0x3F]; _B = SDL_expand_byte[3][_pixel & 0x1F];",
 );
 
 my %get_rgba_string = (
@@ -74,6 +81,7 @@ my %get_rgba_string = (
     "RGBA8888" => $get_rgba_string_ignore_alpha{"RGBA8888"} . " _A = (Uint8)_pixel;",
     "ABGR8888" => $get_rgba_string_ignore_alpha{"ABGR8888"} . " _A = (Uint8)(_pixel >> 24);",
     "BGRA8888" => $get_rgba_string_ignore_alpha{"BGRA8888"} . " _A = (Uint8)_pixel;",
+    "RGB565" => $get_rgba_string_ignore_alpha{"RGB565"} . " _A = 0xFF;",
 );
 
 my %set_rgba_string = (
@@ -83,6 +91,24 @@ my %set_rgba_string = (
     "RGBA8888" => "_pixel = ((Uint32)_R << 24) | ((Uint32)_G << 16) | ((Uint32)_B << 8) | _A;",
     "ABGR8888" => "_pixel = ((Uint32)_A << 24) | ((Uint32)_B << 16) | ((Uint32)_G << 8) | _R;",
     "BGRA8888" => "_pixel = ((Uint32)_B << 24) | ((Uint32)_G << 16) | ((Uint32)_R << 8) | _A;",
+    "RGB565" => "_pixel = ((Uint32)(_R >> 3) << 11) | ((Uint32)(_G >> 2) << 5) | (_B >> 3);",
+);
+
+# Where each channel lives in the pixel, for the SIMD blitters: R, G, B, A
+# (-1 means the format has no such channel)
+my %format_shifts = (
+    "RGB888" => [ 16, 8, 0, -1 ],
+    "BGR888" => [ 0, 8, 16, -1 ],
+    "ARGB8888" => [ 16, 8, 0, 24 ],
+    "RGBA8888" => [ 24, 16, 8, 0 ],
+    "ABGR8888" => [ 0, 8, 16, 24 ],
+    "BGRA8888" => [ 8, 16, 24, 0 ],
+    "RGB565" => [ 11, 5, 0, -1 ],
+);
+
+# Channel sizes in bits, for formats that don't use 8 bits everywhere
+my %format_bits = (
+    "RGB565" => [ 5, 6, 5, 0 ],
 );
 
 sub open_file {
@@ -147,6 +173,7 @@ sub output_copyfuncname
     my $modulate = shift;
     my $blend = shift;
     my $scale = shift;
+    my $simd = shift;
     my $args = shift;
     my $suffix = shift;
 
@@ -160,6 +187,9 @@ sub output_copyfuncname
     if ( $scale ) {
         print FILE "_Scale";
     }
+    if ( $simd ) {
+        print FILE "_$simd";
+    }
     if ( $args ) {
         print FILE "(SDL_BlitInfo *info)";
     }
@@ -179,7 +209,7 @@ sub get_rgba
         $string = $get_rgba_string{$format};
     }
 
-    $string =~ s/_/$prefix/g;
+    $string =~ s/_(R|G|B|A|pixel)\b/$prefix$1/g;
     if ( $prefix ne "" ) {
         print FILE <<__EOF__;
             ${prefix}pixel = *$prefix;
@@ -199,7 +229,7 @@ sub set_rgba
     my $prefix = shift;
     my $format = shift;
     my $string = $set_rgba_string{$format};
-    $string =~ s/_/$prefix/g;
+    $string =~ s/_(R|G|B|A|pixel)\b/$prefix$1/g;
     print FILE <<__EOF__;
             $string
             *dst = ${prefix}pixel;
@@ -307,7 +337,7 @@ sub output_copyfunc
     my $dst_has_alpha = ($dst =~ /A/) ? 1 : 0;
     my $ignore_dst_alpha = !$dst_has_alpha && !$blend;
 
-    output_copyfuncname("static void", $src, $dst, $modulate, $blend, $scale, 1, "\n");
+    output_copyfuncname("static void", $src, $dst, $modulate, $blend, $scale, "", 1, "\n");
     print FILE <<__EOF__;
 {
 __EOF__
@@ -426,6 +456,390 @@ __EOF__
 __EOF__
 }
 
+sub has_simd_variant
+{
+    my $src = shift;
+    my $dst = shift;
+    my $modulate = shift;
+    my $blend = shift;
+
+    # A scaled copy between identical formats has no per-pixel math to speed up
+    return !( $src eq $dst && !$modulate && !$blend );
+}
+
+sub get_format_bits
+{
+    my $format = shift;
+
+    if ( exists $format_bits{$format} ) {
+        return @{$format_bits{$format}};
+    }
+    return ( 8, 8, 8, 8 );
+}
+
+sub get_rgba_sse2
+{
+    my $prefix = shift;
+    my $format = shift;
+    my $ignore_alpha = shift;
+    my @shifts = @{$format_shifts{$format}};
+    my @bits = get_format_bits($format);
+    my @channels = ( "R", "G", "B", "A" );
+
+    for (my $i = 0; $i < 4; ++$i) {
+        my $channel = $channels[$i];
+        my $shift = $shifts[$i];
+        if ( $bits[$i] < 8 && $shift >= 0 ) {
+            my $mask = sprintf("0x%02X", (1 << $bits[$i]) - 1);
+            print FILE <<__EOF__;
+            v${prefix}${channel} = SDL_Blit_ExpandBits_SSE2(_mm_and_si128(_mm_srli_epi32(v${prefix}pixel, $shift), _mm_set1_epi32($mask)), $bits[$i]);
+__EOF__
+            next;
+        }
+        if ( $channel eq "A" ) {
+            if ( $ignore_alpha ) {
+                next;
+            }
+            if ( $shift < 0 ) {
+                print FILE <<__EOF__;
+            v${prefix}A = mm_ff;
+__EOF__
+                next;
+            }
+        }
+        if ( $shift == 24 ) {
+            print FILE <<__EOF__;
+            v${prefix}${channel} = _mm_srli_epi32(v${prefix}pixel, 24);
+__EOF__
+        } elsif ( $shift == 0 ) {
+            print FILE <<__EOF__;
+            v${prefix}${channel} = _mm_and_si128(v${prefix}pixel, mm_ff);
+__EOF__
+        } else {
+            print FILE <<__EOF__;
+            v${prefix}${channel} = _mm_and_si128(_mm_srli_epi32(v${prefix}pixel, $shift), mm_ff);
+__EOF__
+        }
+    }
+}
+
+sub set_rgba_sse2
+{
+    my $prefix = shift;
+    my $format = shift;
+    my @shifts = @{$format_shifts{$format}};
+    my @bits = get_format_bits($format);
+    my @channels = ( "R", "G", "B", "A" );
+    my $string = "";
+
+    for (my $i = 0; $i < 4; ++$i) {
+        my $channel = $channels[$i];
+        my $shift = $shifts[$i];
+        my $value = "v${prefix}${channel}";
+        if ( $shift < 0 ) {
+            next;
+        }
+        if ( $bits[$i] < 8 ) {
+            $value = "_mm_srli_epi32($value, " . (8 - $bits[$i]) . ")";
+        }
+        if ( $shift > 0 ) {
+            $value = "_mm_slli_epi32($value, $shift)";
+        }
+        if ( $string eq "" ) {
+            $string = $value;
+        } else {
+            $string = "_mm_or_si128($string, $value)";
+        }
+    }
+    print FILE <<__EOF__;
+            v${prefix}pixel = $string;
+__EOF__
+    if ( $format_size{$format} == 2 ) {
+        print FILE <<__EOF__;
+            _mm_storel_epi64((__m128i *)dst, SDL_Blit_Pack16_SSE2(v${prefix}pixel));
+__EOF__
+    } else {
+        print FILE <<__EOF__;
+            _mm_storeu_si128((__m128i *)dst, v${prefix}pixel);
+__EOF__
+    }
+}
+
+sub load_pixels_sse2
+{
+    my $format = shift;
+    my $pointer = shift;
+
+    if ( $format_size{$format} == 2 ) {
+        return "_mm_unpacklo_epi16(_mm_loadl_epi64((const __m128i *)$pointer), _mm_setzero_si128())";
+    }
+    return "_mm_loadu_si128((const __m128i *)$pointer)";
+}
+
+sub output_copycore_sse2
+{
+    my $src = shift;
+    my $dst = shift;
+    my $modulate = shift;
+    my $blend = shift;
+    my $s = "";
+    my $d = "";
+
+    my $dst_has_alpha = ($dst =~ /A/) ? 1 : 0;
+    my $ignore_dst_alpha = !$dst_has_alpha && !$blend;
+
+    if ( $blend ) {
+        get_rgba_sse2("src", $src, $ignore_dst_alpha);
+        get_rgba_sse2("dst", $dst, !$dst_has_alpha);
+        $s = "src";
+        $d = "dst";
+    } else {
+        get_rgba_sse2("", $src, $ignore_dst_alpha);
+    }
+
+    if ( $modulate ) {
+        print FILE <<__EOF__;
+            if (flags & SDL_COPY_MODULATE_COLOR) {
+                v${s}R = SDL_Blit_MulDiv255_SSE2(v${s}R, mm_modulateR);
+                v${s}G = SDL_Blit_MulDiv255_SSE2(v${s}G, mm_modulateG);
+                v${s}B = SDL_Blit_MulDiv255_SSE2(v${s}B, mm_modulateB);
+            }
+__EOF__
+        if (not $ignore_dst_alpha) {
+            print FILE <<__EOF__;
+            if (flags & SDL_COPY_MODULATE_ALPHA) {
+                v${s}A = SDL_Blit_MulDiv255_SSE2(v${s}A, mm_modulateA);
+            }
+__EOF__
+        }
+    }
+    if ( $blend ) {
+        print FILE <<__EOF__;
+            if (flags & (SDL_COPY_BLEND|SDL_COPY_ADD)) {
+                /* An alpha of 255 leaves the color as it is, no need to test */
+                v${s}R = SDL_Blit_MulDiv255_SSE2(v${s}R, v${s}A);
+                v${s}G = SDL_Blit_MulDiv255_SSE2(v${s}G, v${s}A);
+                v${s}B = SDL_Blit_MulDiv255_SSE2(v${s}B, v${s}A);
+            }
+            switch (flags & (SDL_COPY_BLEND|SDL_COPY_ADD|SDL_COPY_MOD)) {
+            case SDL_COPY_BLEND:
+                vinvA = _mm_sub_epi32(mm_ff, v${s}A);
+                v${d}R = _mm_add_epi32(v${s}R, SDL_Blit_MulDiv255_SSE2(vinvA, v${d}R));
+                v${d}G = _mm_add_epi32(v${s}G, SDL_Blit_MulDiv255_SSE2(vinvA, v${d}G));
+                v${d}B = _mm_add_epi32(v${s}B, SDL_Blit_MulDiv255_SSE2(vinvA, v${d}B));
+__EOF__
+
+        if ( $dst_has_alpha ) {
+            print FILE <<__EOF__;
+                v${d}A = _mm_add_epi32(v${s}A, SDL_Blit_MulDiv255_SSE2(vinvA, v${d}A));
+__EOF__
+        }
+
+        print FILE <<__EOF__;
+                break;
+            case SDL_COPY_ADD:
+                v${d}R = _mm_min_epi16(_mm_add_epi32(v${s}R, v${d}R), mm_ff);
+                v${d}G = _mm_min_epi16(_mm_add_epi32(v${s}G, v${d}G), mm_ff);
+                v${d}B = _mm_min_epi16(_mm_add_epi32(v${s}B, v${d}B), mm_ff);
+                break;
+            case SDL_COPY_MOD:
+                v${d}R = SDL_Blit_MulDiv255_SSE2(v${s}R, v${d}R);
+                v${d}G = SDL_Blit_MulDiv255_SSE2(v${s}G, v${d}G);
+                v${d}B = SDL_Blit_MulDiv255_SSE2(v${s}B, v${d}B);
+                break;
+            }
+__EOF__
+    }
+    if ( $blend ) {
+        set_rgba_sse2("dst", $dst);
+    } else {
+        set_rgba_sse2("", $dst);
+    }
+}
+
+sub output_copyfunc_sse2
+{
+    my $src = shift;
+    my $dst = shift;
+    my $modulate = shift;
+    my $blend = shift;
+    my $scale = shift;
+
+    my $dst_has_alpha = ($dst =~ /A/) ? 1 : 0;
+    my $ignore_dst_alpha = !$dst_has_alpha && !$blend;
+
+    print FILE <<__EOF__;
+#ifdef __SSE2__
+__EOF__
+    output_copyfuncname("static void", $src, $dst, $modulate, $blend, $scale, "SSE2", 1, "\n");
+    print FILE <<__EOF__;
+{
+    const __m128i mm_ff = _mm_set1_epi32(0xFF);
+__EOF__
+    if ( $modulate || $blend ) {
+        print FILE <<__EOF__;
+    const int flags = info->flags;
+__EOF__
+    }
+    if ( $modulate ) {
+        print FILE <<__EOF__;
+    const Uint32 modulateR = info->r;
+    const Uint32 modulateG = info->g;
+    const Uint32 modulateB = info->b;
+    const __m128i mm_modulateR = _mm_set1_epi32(modulateR);
+    const __m128i mm_modulateG = _mm_set1_epi32(modulateG);
+    const __m128i mm_modulateB = _mm_set1_epi32(modulateB);
+__EOF__
+        if (!$ignore_dst_alpha) {
+            print FILE <<__EOF__;
+    const Uint32 modulateA = info->a;
+    const __m128i mm_modulateA = _mm_set1_epi32(modulateA);
+__EOF__
+        }
+    }
+    if ( $blend ) {
+        print FILE <<__EOF__;
+    Uint32 srcpixel;
+    Uint32 srcR, srcG, srcB, srcA;
+    Uint32 dstpixel;
+    __m128i vsrcpixel;
+    __m128i vsrcR, vsrcG, vsrcB, vsrcA;
+    __m128i vdstpixel;
+    __m128i vinvA;
+__EOF__
+        if ($dst_has_alpha) {
+            print FILE <<__EOF__;
+    Uint32 dstR, dstG, dstB, dstA;
+    __m128i vdstR, vdstG, vdstB, vdstA;
+__EOF__
+        } else {
+            print FILE <<__EOF__;
+    Uint32 dstR, dstG, dstB;
+    __m128i vdstR, vdstG, vdstB;
+__EOF__
+        }
+    } else {
+        print FILE <<__EOF__;
+    Uint32 pixel;
+    __m128i vpixel;
+__EOF__
+        if (!$ignore_dst_alpha) {
+            print FILE <<__EOF__;
+    Uint32 R, G, B, A;
+    __m128i vR, vG, vB, vA;
+__EOF__
+        } else {
+            print FILE <<__EOF__;
+    Uint32 R, G, B;
+    __m128i vR, vG, vB;
+__EOF__
+        }
+    }
+    my $vsrc = $blend ? "vsrcpixel" : "vpixel";
+    my $vdst = load_pixels_sse2($dst, "dst");
+    if ( $scale ) {
+        print FILE <<__EOF__;
+    $format_type{$src} srcbuf[4];
+    int srcy, srcx;
+    int posy, posx;
+    int incy, incx;
+    int i;
+
+    srcy = 0;
+    posy = 0;
+    incy = (info->src_h << 16) / info->dst_h;
+    incx = (info->src_w << 16) / info->dst_w;
+
+    while (info->dst_h--) {
+        $format_type{$src} *src = 0;
+        $format_type{$dst} *dst = ($format_type{$dst} *)info->dst;
+        int n = info->dst_w;
+        srcx = -1;
+        posx = 0x10000L;
+        while (posy >= 0x10000L) {
+            ++srcy;
+            posy -= 0x10000L;
+        }
+        for (; n >= 4; n -= 4) {
+            for (i = 0; i < 4; ++i) {
+                if (posx >= 0x10000L) {
+                    while (posx >= 0x10000L) {
+                        ++srcx;
+                        posx -= 0x10000L;
+                    }
+                    src = ($format_type{$src} *)(info->src + (srcy * info->src_pitch) + (srcx * $format_size{$src}));
+                }
+                srcbuf[i] = *src;
+                posx += incx;
+            }
+            $vsrc = _mm_loadu_si128((const __m128i *)srcbuf);
+__EOF__
+        if ( $blend ) {
+            print FILE <<__EOF__;
+            vdstpixel = $vdst;
+__EOF__
+        }
+        output_copycore_sse2($src, $dst, $modulate, $blend);
+        print FILE <<__EOF__;
+            dst += 4;
+        }
+        while (n--) {
+            if (posx >= 0x10000L) {
+                while (posx >= 0x10000L) {
+                    ++srcx;
+                    posx -= 0x10000L;
+                }
+                src = ($format_type{$src} *)(info->src + (srcy * info->src_pitch) + (srcx * $format_size{$src}));
+            }
+__EOF__
+        output_copycore($src, $dst, $modulate, $blend);
+        print FILE <<__EOF__;
+            posx += incx;
+            ++dst;
+        }
+        posy += incy;
+        info->dst += info->dst_pitch;
+    }
+__EOF__
+    } else {
+        print FILE <<__EOF__;
+
+    while (info->dst_h--) {
+        $format_type{$src} *src = ($format_type{$src} *)info->src;
+        $format_type{$dst} *dst = ($format_type{$dst} *)info->dst;
+        int n = info->dst_w;
+        for (; n >= 4; n -= 4) {
+            $vsrc = _mm_loadu_si128((const __m128i *)src);
+__EOF__
+        if ( $blend ) {
+            print FILE <<__EOF__;
+            vdstpixel = $vdst;
+__EOF__
+        }
+        output_copycore_sse2($src, $dst, $modulate, $blend);
+        print FILE <<__EOF__;
+            src += 4;
+            dst += 4;
+        }
+        while (n--) {
+__EOF__
+        output_copycore($src, $dst, $modulate, $blend);
+        print FILE <<__EOF__;
+            ++src;
+            ++dst;
+        }
+        info->src += info->src_pitch;
+        info->dst += info->dst_pitch;
+    }
+__EOF__
+    }
+    print FILE <<__EOF__;
+}
+#endif /* __SSE2__ */
+
+__EOF__
+}
+
 sub output_copyfunc_h
 {
 }
@@ -437,6 +851,33 @@ sub output_copyinc
 #include "SDL_blit.h"
 #include "SDL_blit_auto.h"
 
+#ifdef __SSE2__
+/* (a * b) / 255 in each 32-bit lane, exact for a and b from 0 to 255 */
+static SDL_INLINE __m128i SDL_Blit_MulDiv255_SSE2(const __m128i a, const __m128i b)
+{
+    const __m128i x = _mm_mullo_epi16(a, b);
+    return _mm_srli_epi32(_mm_add_epi32(_mm_add_epi32(x, _mm_set1_epi32(1)), _mm_srli_epi32(x, 8)), 8);
+}
+
+/* v * 255 / (2^bits - 1), like SDL_expand_byte[8 - bits][v] */
+static SDL_INLINE __m128i SDL_Blit_ExpandBits_SSE2(const __m128i v, const int bits)
+{
+    const int max = (1 << bits) - 1;
+    const __m128i q = _mm_set1_epi32(255 / max);
+    const __m128i r = _mm_set1_epi32(255 % max);
+    const __m128i recip = _mm_set1_epi32((0x10000 + max - 1) / max);
+    return _mm_add_epi32(_mm_mullo_epi16(v, q), _mm_mulhi_epu16(_mm_mullo_epi16(v, r), recip));
+}
+
+/* Narrows 4 16-bit pixels held in 32-bit lanes, for _mm_storel_epi64() */
+static SDL_INLINE __m128i SDL_Blit_Pack16_SSE2(const __m128i v)
+{
+    /* sign extend first, so the saturating pack leaves the bits alone */
+    const __m128i x = _mm_srai_epi32(_mm_slli_epi32(v, 16), 16);
+    return _mm_packs_epi32(x, x);
+}
+#endif
+
 __EOF__
 }
 
@@ -453,7 +894,6 @@ __EOF__
                 for (my $blend = 0; $blend <= 1; ++$blend) {
                     for (my $scale = 0; $scale <= 1; ++$scale) {
                         if ( $modulate || $blend || $scale ) {
-                            print FILE "    { SDL_PIXELFORMAT_$src, SDL_PIXELFORMAT_$dst, ";
                             my $flags = "";
                             my $flag = "";
                             if ( $modulate ) {
@@ -483,8 +923,14 @@ __EOF__
                             if ( $flags eq "" ) {
                                 $flags = "0";
                             }
-                            print FILE "($flags), SDL_CPU_ANY,";
-                            output_copyfuncname("", $src_formats[$i], $dst_formats[$j], $modulate, $blend, $scale, 0, " },\n");
+                            if ( has_simd_variant($src, $dst, $modulate, $blend) ) {
+                                print FILE "#ifdef __SSE2__\n";
+                                print FILE "    { SDL_PIXELFORMAT_$src, SDL_PIXELFORMAT_$dst, ($flags), SDL_CPU_SSE2,";
+                                output_copyfuncname("", $src, $dst, $modulate, $blend, $scale, "SSE2", 0, " },\n");
+                                print FILE "#endif\n";
+                            }
+                            print FILE "    { SDL_PIXELFORMAT_$src, SDL_PIXELFORMAT_$dst, ($flags), SDL_CPU_ANY,";
+                            output_copyfuncname("", $src, $dst, $modulate, $blend, $scale, "", 0, " },\n");
                         }
                     }
                 }
@@ -508,6 +954,9 @@ sub output_copyfunc_c
             for (my $scale = 0; $scale <= 1; ++$scale) {
                 if ( $modulate || $blend || $scale ) {
                     output_copyfunc($src, $dst, $modulate, $blend, $scale);
+                    if ( has_simd_variant($src, $dst, $modulate, $blend) ) {
+                        output_copyfunc_sse2($src, $dst, $modulate, $blend, $scale);
+                    }
                 }
             }
         }
@@ -969,6 +969,161 @@ int audio_openCloseAudioDeviceConnected()
 
 
 
+/* Fill (count) mono Sint16 frames with (value). */
+static void
+_audio_fillFrames(Sint16 *frames, int count, Sint16 value)
+{
+   int i;
+   for (i = 0; i < count; i++) {
+      frames[i] = value;
+   }
+}
+
+/* Check that frames [start, end) of the disk driver's output all equal (value). */
+static void
+_audio_checkFrames(const Sint16 *frames, int start, int end, Sint16 value)
+{
+   int i;
+   for (i = start; i < end; i++) {
+      if (frames[i] != value) {
+         break;
+      }
+   }
+   SDLTest_AssertCheck(i == end, "Validate frames %d to %d; expected: %d, got: %d at frame %d", start, end - 1, (int) value, (int) frames[i], i);
+}
+
+/**
+ * \brief Queues scheduled audio on the disk driver and checks where it lands in the output file.
+ *
+ * \sa https://wiki.libsdl.org/SDL_QueueAudioAtFrame
+ * \sa https://wiki.libsdl.org/SDL_GetQueuedAudioFramePosition
+ */
+int audio_queueAudioAtFrame()
+{
+   const char *filename = "sdlaudio.raw";
+   SDL_AudioSpec desired, obtained;
+   SDL_AudioDeviceID id;
+   Sint16 *frames;
+   SDL_RWops *rw;
+   Uint32 start;
+   size_t got;
+   int result;
+
+   frames = (Sint16 *) SDL_malloc(4096 * sizeof (Sint16));
+   SDLTest_AssertCheck(frames != NULL, "Validate frame buffer allocation");
+   if (frames == NULL) return TEST_ABORTED;
+
+   /* Switch the (initialized) audio subsystem over to the disk writer */
+   result = SDL_AudioInit("disk");
+   SDLTest_AssertPass("Call to SDL_AudioInit('disk')");
+   if (result != 0) {
+      SDLTest_Log("Disk audio driver not available, skipping");
+      SDL_free(frames);
+      SDL_AudioInit(NULL);
+      return TEST_SKIPPED;
+   }
+
+   SDL_zero(desired);
+   desired.freq = 22050;
+   desired.format = AUDIO_S16SYS;
+   desired.channels = 1;
+   desired.samples = 512;
+   desired.callback = NULL;
+
+   id = SDL_OpenAudioDevice(filename, 0, &desired, &obtained, 0);
+   SDLTest_AssertPass("Call to SDL_OpenAudioDevice('%s',...)", filename);
+   SDLTest_AssertCheck(id > 1, "Validate device ID; expected: >1, got: %i", id);
+   if (id <= 1) {
+      SDL_free(frames);
+      SDL_AudioInit(NULL);
+      return TEST_ABORTED;
+   }
+
+   /* Queue while paused, so everything is in place before the first frame plays. */
+   _audio_fillFrames(frames, 1000, 100);
+   result = SDL_QueueAudio(id, frames, 1000 * sizeof (Sint16));
+   SDLTest_AssertCheck(result == 0, "Validate SDL_QueueAudio result; expected: 0, got: %d", result);
+
+   /* Reached at frame 1000, 500 frames late: all 300 frames are skipped. */
+   _audio_fillFrames(frames, 300, 200);
+   result = SDL_QueueAudioAtFrame(id, frames, 300 * sizeof (Sint16), 500);
+   SDLTest_AssertCheck(result == 0, "Validate SDL_QueueAudioAtFrame result; expected: 0, got: %d", result);
+
+   /* Reached early at frame 1000: silence until 1500, then 200 frames. */
+   _audio_fillFrames(frames, 200, 300);
+   result = SDL_QueueAudioAtFrame(id, frames, 200 * sizeof (Sint16), 1500);
+   SDLTest_AssertCheck(result == 0, "Validate SDL_QueueAudioAtFrame result; expected: 0, got: %d", result);
+
+   /* Reached at 1700: silence until 1800, then 400 frames. */
+   _audio_fillFrames(frames, 400, 400);
+   result = SDL_QueueAudioAtFrame(id, frames, 400 * sizeof (Sint16), 1800);
+   SDLTest_AssertCheck(result == 0, "Validate SDL_QueueAudioAtFrame result; expected: 0, got: %d", result);
+
+   /* Reached at 2200, 100 frames late: starts mid-buffer and plays 100 frames. */
+   _audio_fillFrames(frames, 200, 500);
+   result = SDL_QueueAudioAtFrame(id, frames, 200 * sizeof (Sint16), 2100);
+   SDLTest_AssertCheck(result == 0, "Validate SDL_QueueAudioAtFrame result; expected: 0, got: %d", result);
+
+   /* Partial sample frames are rejected */
+   result = SDL_QueueAudioAtFrame(id, frames, 3, 4000);
+   SDLTest_AssertCheck(result == -1, "Validate SDL_QueueAudioAtFrame result for a partial frame; expected: -1, got: %d", result);
+
+   SDL_PauseAudioDevice(id, 0);
+   SDLTest_AssertPass("Call to SDL_PauseAudioDevice(id, 0)");
+
+   start = SDL_GetTicks();
+   while ((SDL_GetQueuedAudioFramePosition(id, NULL) < 3072) && !SDL_TICKS_PASSED(SDL_GetTicks(), start + 5000)) {
+      SDL_Delay(10);
+   }
+   SDLTest_AssertCheck(SDL_GetQueuedAudioFramePosition(id, NULL) >= 3072, "Validate queue position advanced to at least 3072 frames");
+
+   SDL_CloseAudioDevice(id);
+   SDLTest_AssertPass("Call to SDL_CloseAudioDevice()");
+
+   rw = SDL_RWFromFile(filename, "rb");
+   SDLTest_AssertCheck(rw != NULL, "Validate disk audio output file was written");
+   if (rw != NULL) {
+      const Sint64 size = SDL_RWsize(rw);
+      Sint16 *output = (Sint16 *) SDL_malloc((size_t) size);
+      int count = (int) (size / sizeof (Sint16));
+      int first = 0;
+
+      SDLTest_AssertCheck(output != NULL, "Validate output buffer allocation");
+      if (output != NULL) {
+         got = SDL_RWread(rw, output, sizeof (Sint16), count);
+         SDLTest_AssertCheck(got == (size_t) count, "Validate disk audio output read; expected: %d frames, got: %d", count, (int) got);
+
+         /* The device writes whole buffers of silence while it is paused,
+            before the queue starts; skip those. */
+         while ((first < count) && (output[first] == 0)) {
+            first++;
+         }
+         SDLTest_AssertCheck((first % obtained.samples) == 0, "Validate queue output starts on a buffer boundary; got frame %d", first);
+         SDLTest_AssertCheck(count - first >= 3072, "Validate disk audio output length; expected: >=3072 frames, got: %d", count - first);
+         if (count - first >= 3072) {
+            _audio_checkFrames(output + first, 0, 1000, 100);
+            _audio_checkFrames(output + first, 1000, 1500, 0);
+            _audio_checkFrames(output + first, 1500, 1700, 300);
+            _audio_checkFrames(output + first, 1700, 1800, 0);
+            _audio_checkFrames(output + first, 1800, 2200, 400);
+            _audio_checkFrames(output + first, 2200, 2300, 500);
+            _audio_checkFrames(output + first, 2300, 3072, 0);
+         }
+         SDL_free(output);
+      }
+      SDL_RWclose(rw);
+   }
+
+   SDL_free(frames);
+
+   /* Back to the default audio driver */
+   result = SDL_AudioInit(NULL);
+   SDLTest_AssertPass("Call to SDL_AudioInit(NULL)");
+
+   return TEST_COMPLETED;
+}
+
+
 /* ================= Test Case References ================== */
 
 /* Audio test cases */
@@ -1022,11 +1177,14 @@ static const SDLTest_TestCaseReference audioTest14 =
 static const SDLTest_TestCaseReference audioTest15 =
         { (SDLTest_TestCaseFp)audio_pauseUnpauseAudio, "audio_pauseUnpauseAudio", "Pause and Unpause audio for various audio specs while testing callback.", TEST_ENABLED };
 
+static const SDLTest_TestCaseReference audioTest16 =
+        { (SDLTest_TestCaseFp)audio_queueAudioAtFrame, "audio_queueAudioAtFrame", "Queue scheduled audio on the disk driver and check frame-exact placement.", TEST_ENABLED };
+
 /* Sequence of Audio test cases */
 static const SDLTest_TestCaseReference *audioTests[] =  {
     &audioTest1, &audioTest2, &audioTest3, &audioTest4, &audioTest5, &audioTest6,
     &audioTest7, &audioTest8, &audioTest9, &audioTest10, &audioTest11,
-    &audioTest12, &audioTest13, &audioTest14, &audioTest15, NULL
+    &audioTest12, &audioTest13, &audioTest14, &audioTest15, &audioTest16, NULL
 };
 
 /* Audio test suite (global) */
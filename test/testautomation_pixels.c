@@ -500,6 +500,251 @@ pixels_calcGammaRamp(void *arg)
   return TEST_COMPLETED;
 }
 
+/* Nearest palette entry by exhaustive search, as documented for SDL_MapRGBA */
+static Uint32
+_nearestColor(const SDL_Palette *palette, Uint8 r, Uint8 g, Uint8 b, Uint8 a)
+{
+  unsigned int smallest = ~0u;
+  Uint32 pixel = 0;
+  int i;
+
+  for (i = 0; i < palette->ncolors; i++) {
+    const int rd = palette->colors[i].r - r;
+    const int gd = palette->colors[i].g - g;
+    const int bd = palette->colors[i].b - b;
+    const int ad = palette->colors[i].a - a;
+    const unsigned int distance = rd * rd + gd * gd + bd * bd + ad * ad;
+    if (distance < smallest) {
+      pixel = i;
+      if (distance == 0) {
+        break;
+      }
+      smallest = distance;
+    }
+  }
+  return pixel;
+}
+
+/* Maps the colors of a grid with (data) and with a palette of its own */
+static int SDLCALL
+_mapColors(void *data)
+{
+  SDL_PixelFormat *shared = (SDL_PixelFormat *) data;
+  SDL_PixelFormat *format;
+  SDL_Palette *palette;
+  Uint8 r, g, b;
+  int i, mismatches = 0;
+
+  format = SDL_AllocFormat(SDL_PIXELFORMAT_INDEX8);
+  palette = SDL_AllocPalette(256);
+  if (format == NULL || palette == NULL) {
+    SDL_FreeFormat(format);
+    SDL_FreePalette(palette);
+    return -1;
+  }
+  for (i = 0; i < 256; i++) {
+    palette->colors[i].r = (Uint8) (i * 37);
+    palette->colors[i].g = (Uint8) (i * 101);
+    palette->colors[i].b = (Uint8) (i * 59);
+  }
+  SDL_SetPaletteColors(palette, palette->colors, 0, 256);
+  SDL_SetPixelFormatPalette(format, palette);
+
+  for (i = 0; i < 4 * 4096; i++) {
+    r = (Uint8) (((i >> 8) & 0xF) * 17);
+    g = (Uint8) (((i >> 4) & 0xF) * 17);
+    b = (Uint8) ((i & 0xF) * 17);
+    if (SDL_MapRGB(shared, r, g, b) != _nearestColor(shared->palette, r, g, b, 255)) {
+      mismatches++;
+    }
+    if (SDL_MapRGB(format, r, g, b) != _nearestColor(palette, r, g, b, 255)) {
+      mismatches++;
+    }
+  }
+
+  SDL_FreePalette(palette);
+  SDL_FreeFormat(format);
+  return mismatches;
+}
+
+/**
+ * @brief Call to SDL_MapRGB and SDL_MapRGBA with a palette
+ *
+ * @sa http://wiki.libsdl.org/moin.fcg/SDL_MapRGBA
+ */
+int
+pixels_mapRGBPalette(void *arg)
+{
+  SDL_PixelFormat *format;
+  SDL_Palette *palette;
+  SDL_Color colors[256];
+  SDL_Thread *threads[4];
+  Uint32 expected, result;
+  Uint8 r, g, b;
+  int variation;
+  int i, status, mismatches;
+
+  format = SDL_AllocFormat(SDL_PIXELFORMAT_INDEX8);
+  SDLTest_AssertPass("Call to SDL_AllocFormat(SDL_PIXELFORMAT_INDEX8)");
+  palette = SDL_AllocPalette(256);
+  SDLTest_AssertPass("Call to SDL_AllocPalette(256)");
+  SDLTest_AssertCheck(format != NULL && palette != NULL, "Verify format and palette are not NULL");
+  if (format == NULL || palette == NULL) {
+    SDL_FreeFormat(format);
+    SDL_FreePalette(palette);
+    return TEST_ABORTED;
+  }
+  SDL_SetPixelFormatPalette(format, palette);
+
+  for (variation = 0; variation < 4; variation++) {
+    for (i = 0; i < 256; i++) {
+      colors[i].r = SDLTest_RandomUint8();
+      colors[i].g = SDLTest_RandomUint8();
+      colors[i].b = SDLTest_RandomUint8();
+      colors[i].a = 255;
+      switch (variation) {
+        /* Few distinct colors, repeated */
+        case 1:
+          if (i >= 20) colors[i] = colors[i % 20];
+          break;
+        /* Coarse colors with many ties */
+        case 2:
+          colors[i].r &= 0xC0;
+          colors[i].g &= 0xC0;
+          colors[i].b &= 0x80;
+          break;
+        /* Varying alpha */
+        case 3:
+          colors[i].a = SDLTest_RandomUint8();
+          break;
+      }
+    }
+    SDL_SetPaletteColors(palette, colors, 0, 256);
+    SDLTest_AssertPass("Call to SDL_SetPaletteColors() (variation %d)", variation);
+
+    /* Map every color twice, the second lookup can use cached results */
+    mismatches = 0;
+    for (i = 0; i < 2 * 4096; i++) {
+      r = (Uint8) (((i >> 8) & 0xF) * 17);
+      g = (Uint8) (((i >> 4) & 0xF) * 17);
+      b = (Uint8) ((i & 0xF) * 17);
+      expected = _nearestColor(palette, r, g, b, 255);
+      result = SDL_MapRGB(format, r, g, b);
+      if (result != expected) {
+        mismatches++;
+      }
+    }
+    SDLTest_AssertCheck(mismatches == 0, "Verify SDL_MapRGB results; expected: 0 mismatches, got: %d", mismatches);
+
+    /* Changed colors are picked up */
+    colors[0].r ^= 0xFF;
+    colors[0].g ^= 0xFF;
+    SDL_SetPaletteColors(palette, colors, 0, 1);
+    mismatches = 0;
+    for (i = 0; i < 2 * 4096; i++) {
+      r = (Uint8) (((i >> 8) & 0xF) * 17);
+      g = (Uint8) (((i >> 4) & 0xF) * 17);
+      b = (Uint8) ((i & 0xF) * 17);
+      expected = _nearestColor(palette, r, g, b, 128);
+      result = SDL_MapRGBA(format, r, g, b, 128);
+      if (result != expected) {
+        mismatches++;
+      }
+    }
+    SDLTest_AssertCheck(mismatches == 0, "Verify SDL_MapRGBA results after SDL_SetPaletteColors; expected: 0 mismatches, got: %d", mismatches);
+  }
+
+  /* Colors can be looked up from several threads, in one palette or their own */
+  for (i = 0; i < 256; i++) {
+    colors[i].a = 255;
+  }
+  SDL_SetPaletteColors(palette, colors, 0, 256);
+  for (i = 0; i < SDL_arraysize(threads); i++) {
+    threads[i] = SDL_CreateThread(_mapColors, "MapColors", format);
+    SDLTest_AssertCheck(threads[i] != NULL, "Verify thread %d was created", i);
+  }
+  mismatches = 0;
+  for (i = 0; i < SDL_arraysize(threads); i++) {
+    if (threads[i] != NULL) {
+      SDL_WaitThread(threads[i], &status);
+      mismatches += status;
+    }
+  }
+  SDLTest_AssertCheck(mismatches == 0, "Verify concurrent SDL_MapRGB results; expected: 0 mismatches, got: %d", mismatches);
+
+  SDL_FreePalette(palette);
+  SDL_FreeFormat(format);
+  SDLTest_AssertPass("Call to SDL_FreeFormat()");
+
+  return TEST_COMPLETED;
+}
+
+static int SDLCALL
+_allocFreeFormats(void *data)
+{
+  int i, failures = 0;
+
+  for (i = 0; i < 10000; i++) {
+    const Uint32 format = _RGBPixelFormats[(i + (int) (size_t) data) % _numRGBPixelFormats];
+    SDL_PixelFormat *result = SDL_AllocFormat(format);
+    if (result == NULL || result->format != format) {
+      failures++;
+    }
+    SDL_FreeFormat(result);
+  }
+  return failures;
+}
+
+/**
+ * @brief Sharing of formats returned by SDL_AllocFormat
+ *
+ * @sa http://wiki.libsdl.org/moin.fcg/SDL_AllocFormat
+ */
+int
+pixels_allocFormatShared(void *arg)
+{
+  SDL_PixelFormat *first, *second;
+  SDL_Thread *threads[4];
+  Uint32 format;
+  int i, status, failures;
+
+  /* RGB formats are shared */
+  for (i = 0; i < _numRGBPixelFormats; i++) {
+    format = _RGBPixelFormats[i];
+    first = SDL_AllocFormat(format);
+    second = SDL_AllocFormat(format);
+    SDLTest_AssertPass("Call to SDL_AllocFormat(%s) twice", _RGBPixelFormatsVerbose[i]);
+    SDLTest_AssertCheck(first != NULL && second != NULL, "Verify results are not NULL");
+    if (first == NULL || second == NULL) {
+      continue;
+    }
+    if (SDL_ISPIXELFORMAT_INDEXED(format)) {
+      SDLTest_AssertCheck(first != second, "Verify indexed formats are not shared");
+    } else {
+      SDLTest_AssertCheck(first == second, "Verify RGB formats are shared");
+    }
+    SDL_FreeFormat(second);
+    SDLTest_AssertCheck(first->format == format, "Verify value of result.format after freeing the other reference; expected: %u, got %u", format, first->format);
+    SDL_FreeFormat(first);
+  }
+
+  /* Formats can be allocated and freed from several threads at once */
+  for (i = 0; i < SDL_arraysize(threads); i++) {
+    threads[i] = SDL_CreateThread(_allocFreeFormats, "AllocFreeFormats", (void *) (size_t) (i * 3));
+    SDLTest_AssertCheck(threads[i] != NULL, "Verify thread %d was created", i);
+  }
+  failures = 0;
+  for (i = 0; i < SDL_arraysize(threads); i++) {
+    if (threads[i] != NULL) {
+      SDL_WaitThread(threads[i], &status);
+      failures += status;
+    }
+  }
+  SDLTest_AssertCheck(failures == 0, "Verify concurrent SDL_AllocFormat calls; expected: 0 failures, got: %d", failures);
+
+  return TEST_COMPLETED;
+}
+
 /* ================= Test References ================== */
 
 /* Pixels test cases */
@@ -515,9 +760,15 @@ static const SDLTest_TestCaseReference pixelsTest3 =
 static const SDLTest_TestCaseReference pixelsTest4 =
         { (SDLTest_TestCaseFp)pixels_getPixelFormatName, "pixels_getPixelFormatName", "Call to SDL_GetPixelFormatName", TEST_ENABLED };
 
+static const SDLTest_TestCaseReference pixelsTest5 =
+        { (SDLTest_TestCaseFp)pixels_mapRGBPalette, "pixels_mapRGBPalette", "Call to SDL_MapRGB and SDL_MapRGBA with a palette", TEST_ENABLED };
+
+static const SDLTest_TestCaseReference pixelsTest6 =
+        { (SDLTest_TestCaseFp)pixels_allocFormatShared, "pixels_allocFormatShared", "Sharing of formats from SDL_AllocFormat", TEST_ENABLED };
+
 /* Sequence of Pixels test cases */
 static const SDLTest_TestCaseReference *pixelsTests[] =  {
-    &pixelsTest1, &pixelsTest2, &pixelsTest3, &pixelsTest4, NULL
+    &pixelsTest1, &pixelsTest2, &pixelsTest3, &pixelsTest4, &pixelsTest5, &pixelsTest6, NULL
 };
 
 /* Pixels test suite (global) */
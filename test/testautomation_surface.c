@@ -588,6 +588,944 @@ surface_testBlitBlendLoop(void *arg) {
 
 }
 
+/**
+ * @brief Tests bilinear and box filtered stretching.
+ */
+int
+surface_testSoftStretchLinear(void *arg)
+{
+    static const Uint32 src_pixels[4 * 2] = {
+        0xFF000000, 0xFF808080, 0xFF000000, 0xFF808080,
+        0xFF404040, 0xFFC0C0C0, 0xFF404040, 0xFFC0C0C0
+    };
+    SDL_Surface *src, *dst, *other;
+    Uint32 *pixels;
+    int ret;
+
+    src = SDL_CreateRGBSurfaceWithFormatFrom((void *) src_pixels, 4, 2, 32, 4 * 4, SDL_PIXELFORMAT_ARGB8888);
+    dst = SDL_CreateRGBSurfaceWithFormat(0, 8, 2, 32, SDL_PIXELFORMAT_ARGB8888);
+    SDLTest_AssertCheck(src != NULL && dst != NULL, "Verify surfaces are not NULL");
+    if (src == NULL || dst == NULL) {
+        return TEST_ABORTED;
+    }
+    pixels = (Uint32 *) dst->pixels;
+
+    /* Doubling the width samples halfway between pixel centers */
+    ret = SDL_SoftStretchLinear(src, NULL, dst, NULL);
+    SDLTest_AssertPass("Call to SDL_SoftStretchLinear() to 8x2");
+    SDLTest_AssertCheck(ret == 0, "Verify result from SDL_SoftStretchLinear, expected: 0, got: %i", ret);
+    SDLTest_AssertCheck(pixels[0] == 0xFF000000, "Verify first pixel, expected: 0xFF000000, got: 0x%.8x", pixels[0]);
+    SDLTest_AssertCheck(pixels[1] == 0xFF202020, "Verify second pixel, expected: 0xFF202020, got: 0x%.8x", pixels[1]);
+    SDLTest_AssertCheck(pixels[2] == 0xFF606060, "Verify third pixel, expected: 0xFF606060, got: 0x%.8x", pixels[2]);
+    SDLTest_AssertCheck(pixels[7] == 0xFF808080, "Verify last pixel, expected: 0xFF808080, got: 0x%.8x", pixels[7]);
+    SDL_FreeSurface(dst);
+
+    /* Halving both dimensions averages each 2x2 block */
+    dst = SDL_CreateRGBSurfaceWithFormat(0, 2, 1, 32, SDL_PIXELFORMAT_ARGB8888);
+    SDLTest_AssertCheck(dst != NULL, "Verify destination surface is not NULL");
+    if (dst == NULL) {
+        SDL_FreeSurface(src);
+        return TEST_ABORTED;
+    }
+    pixels = (Uint32 *) dst->pixels;
+    ret = SDL_SoftStretchLinear(src, NULL, dst, NULL);
+    SDLTest_AssertPass("Call to SDL_SoftStretchLinear() to 2x1");
+    SDLTest_AssertCheck(ret == 0, "Verify result from SDL_SoftStretchLinear, expected: 0, got: %i", ret);
+    SDLTest_AssertCheck(pixels[0] == 0xFF606060, "Verify first pixel, expected: 0xFF606060, got: 0x%.8x", pixels[0]);
+    SDLTest_AssertCheck(pixels[1] == 0xFF606060, "Verify second pixel, expected: 0xFF606060, got: 0x%.8x", pixels[1]);
+
+    /* Different formats are rejected */
+    other = SDL_CreateRGBSurfaceWithFormat(0, 2, 1, 32, SDL_PIXELFORMAT_ABGR8888);
+    SDLTest_AssertCheck(other != NULL, "Verify other surface is not NULL");
+    if (other != NULL) {
+        ret = SDL_SoftStretchLinear(src, NULL, other, NULL);
+        SDLTest_AssertCheck(ret == -1, "Verify result from SDL_SoftStretchLinear with mismatched formats, expected: -1, got: %i", ret);
+        SDL_FreeSurface(other);
+    }
+
+    SDL_FreeSurface(dst);
+    SDL_FreeSurface(src);
+
+    return TEST_COMPLETED;
+}
+
+/**
+ * @brief Tests conversion between YUV and RGB formats.
+ */
+int
+surface_testYUVConversion(void *arg)
+{
+    static const Uint32 yuv_formats[] = {
+        SDL_PIXELFORMAT_YV12, SDL_PIXELFORMAT_IYUV, SDL_PIXELFORMAT_NV12, SDL_PIXELFORMAT_NV21,
+        SDL_PIXELFORMAT_YUY2, SDL_PIXELFORMAT_UYVY, SDL_PIXELFORMAT_YVYU
+    };
+    static const Uint32 rgb_formats[] = {
+        SDL_PIXELFORMAT_ARGB8888, SDL_PIXELFORMAT_RGBA8888, SDL_PIXELFORMAT_RGB24
+    };
+    const int w = 34, h = 6;
+    Uint32 rgb[34 * 6], result[34 * 6];
+    Uint8 yuv[34 * 6 * 2], tmp[34 * 6 * 4], copy[34 * 6 * 2];
+    int i, j, k, c, ret, max_error;
+
+    /* Each 2x2 block has one color, so no detail is lost to the chroma subsampling */
+    for (i = 0; i < w * h; ++i) {
+        const int x = (i % w) / 2, y = (i / w) / 2;
+        rgb[i] = 0xFF000000 | ((x * 15) << 16) | ((y * 80) << 8) | ((x * y * 5) & 0xFF);
+    }
+    rgb[0] = rgb[1] = rgb[w] = rgb[w + 1] = 0xFFFFFFFF;
+
+    for (i = 0; i < SDL_arraysize(yuv_formats); ++i) {
+        const int packed = (yuv_formats[i] == SDL_PIXELFORMAT_YUY2 ||
+                            yuv_formats[i] == SDL_PIXELFORMAT_UYVY ||
+                            yuv_formats[i] == SDL_PIXELFORMAT_YVYU);
+        const int pitch = packed ? w * 2 : w;
+
+        SDL_SetYUVConversionMode(SDL_YUV_CONVERSION_BT601);
+        ret = SDL_ConvertPixels(w, h, SDL_PIXELFORMAT_ARGB8888, rgb, w * 4, yuv_formats[i], yuv, pitch);
+        SDLTest_AssertPass("Call to SDL_ConvertPixels() to %s", SDL_GetPixelFormatName(yuv_formats[i]));
+        SDLTest_AssertCheck(ret == 0, "Verify result from SDL_ConvertPixels, expected: 0, got: %i", ret);
+        if (yuv_formats[i] == SDL_PIXELFORMAT_IYUV) {
+            SDLTest_AssertCheck(yuv[0] == 235 && yuv[w * h] == 128 && yuv[w * h + (w / 2) * (h / 2)] == 128,
+                                "Verify white is limited range, expected: 235/128/128, got: %d/%d/%d",
+                                yuv[0], yuv[w * h], yuv[w * h + (w / 2) * (h / 2)]);
+        }
+
+        for (j = 0; j < SDL_arraysize(rgb_formats); ++j) {
+            const int bpp = SDL_BYTESPERPIXEL(rgb_formats[j]);
+
+            ret = SDL_ConvertPixels(w, h, yuv_formats[i], yuv, pitch, rgb_formats[j], tmp, w * bpp);
+            SDLTest_AssertCheck(ret == 0, "Verify result from SDL_ConvertPixels to %s, expected: 0, got: %i", SDL_GetPixelFormatName(rgb_formats[j]), ret);
+            ret = SDL_ConvertPixels(w, h, rgb_formats[j], tmp, w * bpp, SDL_PIXELFORMAT_ARGB8888, result, w * 4);
+            SDLTest_AssertCheck(ret == 0, "Verify result from SDL_ConvertPixels back to ARGB8888, expected: 0, got: %i", ret);
+
+            max_error = 0;
+            for (k = 0; k < w * h; ++k) {
+                for (c = 0; c < 32; c += 8) {
+                    max_error = SDL_max(max_error, SDL_abs((int) ((rgb[k] >> c) & 0xFF) - (int) ((result[k] >> c) & 0xFF)));
+                }
+            }
+            SDLTest_AssertCheck(max_error <= 2, "Verify %s -> %s round trip, expected error <= 2, got: %d",
+                                SDL_GetPixelFormatName(yuv_formats[i]), SDL_GetPixelFormatName(rgb_formats[j]), max_error);
+        }
+    }
+
+    /* Formats with the same chroma subsampling only reorder the samples,
+       the last three formats are packed and the others planar */
+    for (i = 0; i < SDL_arraysize(yuv_formats); ++i) {
+        const int packed_i = (i >= 4);
+        const int pitch_i = packed_i ? w * 2 : w;
+        const int size = packed_i ? w * h * 2 : w * h + 2 * (w / 2) * (h / 2);
+
+        for (k = 0; k < size; ++k) {
+            yuv[k] = SDLTest_RandomUint8();
+        }
+        for (j = 0; j < SDL_arraysize(yuv_formats); ++j) {
+            const int packed_j = (j >= 4);
+            const int pitch_j = packed_j ? w * 2 : w;
+
+            if (packed_i != packed_j) {
+                continue;
+            }
+            SDL_memset(copy, 0, sizeof (copy));
+            ret = SDL_ConvertPixels(w, h, yuv_formats[i], yuv, pitch_i, yuv_formats[j], tmp, pitch_j);
+            SDLTest_AssertCheck(ret == 0, "Verify result from SDL_ConvertPixels to %s, expected: 0, got: %i", SDL_GetPixelFormatName(yuv_formats[j]), ret);
+            if (yuv_formats[i] == SDL_PIXELFORMAT_YV12 && yuv_formats[j] == SDL_PIXELFORMAT_NV12) {
+                SDLTest_AssertCheck(tmp[w * h] == yuv[w * h + (w / 2) * (h / 2)] && tmp[w * h + 1] == yuv[w * h],
+                                    "Verify YV12 -> NV12 moves U and V into place");
+            }
+            ret = SDL_ConvertPixels(w, h, yuv_formats[j], tmp, pitch_j, yuv_formats[i], copy, pitch_i);
+            SDLTest_AssertCheck(ret == 0, "Verify result from SDL_ConvertPixels back to %s, expected: 0, got: %i", SDL_GetPixelFormatName(yuv_formats[i]), ret);
+            SDLTest_AssertCheck(SDL_memcmp(yuv, copy, size) == 0, "Verify %s -> %s round trip is lossless",
+                                SDL_GetPixelFormatName(yuv_formats[i]), SDL_GetPixelFormatName(yuv_formats[j]));
+        }
+    }
+
+    /* Full range keeps white at 255 */
+    SDL_SetYUVConversionMode(SDL_YUV_CONVERSION_JPEG);
+    ret = SDL_ConvertPixels(w, h, SDL_PIXELFORMAT_ARGB8888, rgb, w * 4, SDL_PIXELFORMAT_NV12, yuv, w);
+    SDLTest_AssertCheck(ret == 0, "Verify result from SDL_ConvertPixels to NV12, expected: 0, got: %i", ret);
+    SDLTest_AssertCheck(yuv[0] == 255, "Verify white is full range, expected: 255, got: %d", yuv[0]);
+
+    SDL_SetYUVConversionMode(SDL_YUV_CONVERSION_AUTOMATIC);
+    SDLTest_AssertCheck(SDL_GetYUVConversionModeForResolution(640, 480) == SDL_YUV_CONVERSION_BT601, "Verify SD content uses BT.601");
+    SDLTest_AssertCheck(SDL_GetYUVConversionModeForResolution(1920, 1080) == SDL_YUV_CONVERSION_BT709, "Verify HD content uses BT.709");
+    SDL_SetYUVConversionMode(SDL_YUV_CONVERSION_BT601);
+
+    return TEST_COMPLETED;
+}
+
+/**
+ * @brief Tests aligned surfaces and the surface pixel pool.
+ */
+int
+surface_testAlignedPool(void *arg)
+{
+    SDL_Surface *surface, *other;
+    void *pixels;
+    int x, y;
+
+    surface = SDL_CreateRGBSurfaceWithFormat(SDL_SIMD_ALIGNED, 33, 7, 0, SDL_PIXELFORMAT_RGB24);
+    SDLTest_AssertPass("Call to SDL_CreateRGBSurfaceWithFormat() with SDL_SIMD_ALIGNED");
+    SDLTest_AssertCheck(surface != NULL, "Verify aligned surface is not NULL");
+    if (surface == NULL) {
+        return TEST_ABORTED;
+    }
+    SDLTest_AssertCheck((surface->flags & SDL_SIMD_ALIGNED) != 0, "Verify surface has SDL_SIMD_ALIGNED");
+    SDLTest_AssertCheck(((uintptr_t) surface->pixels & 63) == 0, "Verify pixels are 64 byte aligned");
+    SDLTest_AssertCheck(surface->pitch == 128, "Verify pitch, expected: 128, got: %i", surface->pitch);
+    for (y = 0; y < surface->h; ++y) {
+        for (x = 0; x < surface->pitch; ++x) {
+            if (((Uint8 *) surface->pixels)[y * surface->pitch + x] != 0) {
+                break;
+            }
+        }
+        if (x < surface->pitch) {
+            break;
+        }
+    }
+    SDLTest_AssertCheck(y == surface->h, "Verify pixels are cleared");
+
+    /* Freed pixels come back for a surface of a similar size */
+    SDL_SetHint(SDL_HINT_SURFACE_POOL_SIZE, "1048576");
+    other = SDL_CreateRGBSurfaceWithFormat(0, 100, 100, 0, SDL_PIXELFORMAT_ARGB8888);
+    SDLTest_AssertCheck(other != NULL, "Verify pooled surface is not NULL");
+    if (other != NULL) {
+        SDLTest_AssertCheck((other->flags & SDL_SIMD_ALIGNED) == 0,
+                            "Verify pooled surface with pitch %i doesn't have SDL_SIMD_ALIGNED", other->pitch);
+        SDL_memset(other->pixels, 0xFF, other->pitch * other->h);
+        pixels = other->pixels;
+        SDL_FreeSurface(other);
+
+        other = SDL_CreateRGBSurfaceWithFormat(0, 99, 100, 0, SDL_PIXELFORMAT_ARGB8888);
+        SDLTest_AssertCheck(other != NULL, "Verify second pooled surface is not NULL");
+        if (other != NULL) {
+            SDLTest_AssertCheck(other->pixels == pixels, "Verify pixels were reused");
+            SDLTest_AssertCheck(((Uint32 *) other->pixels)[0] == 0, "Verify reused pixels are cleared");
+            SDL_FreeSurface(other);
+        }
+    }
+    other = SDL_CreateRGBSurfaceWithFormat(0, 64, 10, 0, SDL_PIXELFORMAT_ARGB8888);
+    SDLTest_AssertCheck(other != NULL, "Verify pooled surface is not NULL");
+    if (other != NULL) {
+        SDLTest_AssertCheck((other->flags & SDL_SIMD_ALIGNED) != 0,
+                            "Verify pooled surface with pitch %i has SDL_SIMD_ALIGNED", other->pitch);
+        SDLTest_AssertCheck(((uintptr_t) other->pixels & 63) == 0, "Verify pooled pixels are 64 byte aligned");
+        SDL_FreeSurface(other);
+    }
+    SDL_SetHint(SDL_HINT_SURFACE_POOL_SIZE, "0");
+
+    SDL_FreeSurface(surface);
+
+    return TEST_COMPLETED;
+}
+
+/**
+ * @brief Tests that blits follow palette changes between blit mappings.
+ */
+int
+surface_testBlitMapPalette(void *arg)
+{
+    const SDL_Color colors[2][3] = {
+        { { 255, 0, 0, 255 }, { 0, 255, 0, 255 }, { 0, 0, 255, 255 } },
+        { { 0, 0, 255, 255 }, { 255, 0, 0, 255 }, { 0, 255, 0, 255 } }
+    };
+    SDL_Surface *src, *rgb, *indexed;
+    SDL_Palette *palette;
+    Uint32 pixel;
+    int i;
+
+    src = SDL_CreateRGBSurfaceWithFormat(0, 3, 1, 0, SDL_PIXELFORMAT_INDEX8);
+    rgb = SDL_CreateRGBSurfaceWithFormat(0, 3, 1, 0, SDL_PIXELFORMAT_ARGB8888);
+    indexed = SDL_CreateRGBSurfaceWithFormat(0, 3, 1, 0, SDL_PIXELFORMAT_INDEX8);
+    SDLTest_AssertCheck(src != NULL && rgb != NULL && indexed != NULL, "Verify surfaces are not NULL");
+    if (src == NULL || rgb == NULL || indexed == NULL) {
+        SDL_FreeSurface(src);
+        SDL_FreeSurface(rgb);
+        SDL_FreeSurface(indexed);
+        return TEST_ABORTED;
+    }
+    for (i = 0; i < 3; ++i) {
+        ((Uint8 *) src->pixels)[i] = (Uint8) i;
+    }
+    SDL_SetPaletteColors(src->format->palette, colors[0], 0, 3);
+    SDL_SetPaletteColors(indexed->format->palette, colors[1], 0, 3);
+
+    /* Switching destinations reuses the mappings */
+    for (i = 0; i < 3; ++i) {
+        SDL_BlitSurface(src, NULL, rgb, NULL);
+        SDL_BlitSurface(src, NULL, indexed, NULL);
+    }
+    pixel = ((Uint32 *) rgb->pixels)[0];
+    SDLTest_AssertCheck(pixel == 0xFFFF0000, "Verify palette to RGB blit, expected: 0xFFFF0000, got: 0x%.8x", pixel);
+    pixel = ((Uint8 *) indexed->pixels)[0];
+    SDLTest_AssertCheck(pixel == 1, "Verify palette to palette blit, expected: 1, got: %d", (int) pixel);
+
+    /* New colors give new mappings */
+    SDL_SetPaletteColors(src->format->palette, colors[1], 0, 3);
+    SDL_BlitSurface(src, NULL, rgb, NULL);
+    SDL_BlitSurface(src, NULL, indexed, NULL);
+    pixel = ((Uint32 *) rgb->pixels)[0];
+    SDLTest_AssertCheck(pixel == 0xFF0000FF, "Verify blit after SDL_SetPaletteColors, expected: 0xFF0000FF, got: 0x%.8x", pixel);
+    pixel = ((Uint8 *) indexed->pixels)[0];
+    SDLTest_AssertCheck(pixel == 0, "Verify palette to palette blit after SDL_SetPaletteColors, expected: 0, got: %d", (int) pixel);
+
+    /* So do new palettes, even at the address of a freed one */
+    for (i = 0; i < 8; ++i) {
+        palette = SDL_AllocPalette(256);
+        SDL_SetPaletteColors(palette, colors[i & 1], 0, 3);
+        SDL_SetSurfacePalette(src, palette);
+        SDL_FreePalette(palette);
+        SDL_BlitSurface(src, NULL, rgb, NULL);
+        pixel = ((Uint32 *) rgb->pixels)[0];
+        SDLTest_AssertCheck(pixel == ((i & 1) ? 0xFF0000FF : 0xFFFF0000),
+                            "Verify blit with new palette %d, got: 0x%.8x", i, pixel);
+    }
+
+    SDL_FreeSurface(src);
+    SDL_FreeSurface(rgb);
+    SDL_FreeSurface(indexed);
+
+    return TEST_COMPLETED;
+}
+
+/**
+ * @brief Tests loading bitmaps straight into other pixel formats.
+ */
+int
+surface_testLoadBitmapWithFormat(void *arg)
+{
+    const Uint32 saved[] = { SDL_PIXELFORMAT_ARGB8888, SDL_PIXELFORMAT_BGR24, SDL_PIXELFORMAT_INDEX8 };
+    const Uint32 loaded[] = { SDL_PIXELFORMAT_ABGR8888, SDL_PIXELFORMAT_RGB565, SDL_PIXELFORMAT_RGB888 };
+    const char *sampleFilename = "testLoadBitmapWithFormat.bmp";
+    Uint8 *buffer;
+    SDL_Surface *face, *saveme, *expected, *rface;
+    SDL_RWops *rw;
+    int i, j, ret, size;
+
+    face = SDLTest_ImageFace();
+    SDLTest_AssertCheck(face != NULL, "Verify face surface is not NULL");
+    if (face == NULL) return TEST_ABORTED;
+
+    size = 4096 + face->w * face->h * 4;
+    buffer = (Uint8 *)SDL_malloc(size);
+    SDLTest_AssertCheck(buffer != NULL, "Verify buffer is not NULL");
+    if (buffer == NULL) {
+        SDL_FreeSurface(face);
+        return TEST_ABORTED;
+    }
+
+    for (i = 0; i < SDL_arraysize(saved); i++) {
+        saveme = SDL_ConvertSurfaceFormat(face, saved[i], 0);
+        SDLTest_AssertCheck(saveme != NULL, "Verify conversion to %s", SDL_GetPixelFormatName(saved[i]));
+        if (saveme == NULL) continue;
+        unlink(sampleFilename);
+        ret = SDL_SaveBMP(saveme, sampleFilename);
+        SDLTest_AssertCheck(ret == 0, "Verify result from SDL_SaveBMP, expected: 0, got: %i", ret);
+        rw = SDL_RWFromMem(buffer, size);
+        ret = SDL_SaveBMP_RW(saveme, rw, 0);
+        SDLTest_AssertCheck(ret == 0, "Verify result from SDL_SaveBMP_RW, expected: 0, got: %i", ret);
+        SDL_RWclose(rw);
+        SDL_FreeSurface(saveme);
+
+        for (j = 0; j < SDL_arraysize(loaded); j++) {
+            saveme = SDL_LoadBMP(sampleFilename);
+            expected = saveme ? SDL_ConvertSurfaceFormat(saveme, loaded[j], 0) : NULL;
+            SDL_FreeSurface(saveme);
+            SDLTest_AssertCheck(expected != NULL, "Verify SDL_LoadBMP and SDL_ConvertSurfaceFormat result is not NULL");
+            if (expected == NULL) continue;
+
+            /* From a file */
+            rface = SDL_LoadBMPWithFormat(sampleFilename, loaded[j]);
+            SDLTest_AssertPass("Call to SDL_LoadBMPWithFormat(%s), saved as %s", SDL_GetPixelFormatName(loaded[j]), SDL_GetPixelFormatName(saved[i]));
+            SDLTest_AssertCheck(rface != NULL && rface->format->format == loaded[j], "Verify format of loaded surface");
+            if (rface != NULL) {
+                ret = SDLTest_CompareSurfaces(rface, expected, 0);
+                SDLTest_AssertCheck(ret == 0, "Validate result from SDLTest_CompareSurfaces, expected: 0, got: %i", ret);
+                SDL_FreeSurface(rface);
+            }
+
+            /* From memory */
+            rface = SDL_LoadBMPWithFormat_RW(SDL_RWFromConstMem(buffer, size), 1, loaded[j]);
+            SDLTest_AssertPass("Call to SDL_LoadBMPWithFormat_RW(%s), saved as %s", SDL_GetPixelFormatName(loaded[j]), SDL_GetPixelFormatName(saved[i]));
+            SDLTest_AssertCheck(rface != NULL && rface->format->format == loaded[j], "Verify format of loaded surface");
+            if (rface != NULL) {
+                ret = SDLTest_CompareSurfaces(rface, expected, 0);
+                SDLTest_AssertCheck(ret == 0, "Validate result from SDLTest_CompareSurfaces, expected: 0, got: %i", ret);
+                SDL_FreeSurface(rface);
+            }
+            SDL_FreeSurface(expected);
+        }
+    }
+
+    /* Truncated pixel data fails */
+    rface = SDL_LoadBMPWithFormat_RW(SDL_RWFromConstMem(buffer, 200), 1, SDL_PIXELFORMAT_ARGB8888);
+    SDLTest_AssertCheck(rface == NULL, "Verify truncated bitmap is not loaded");
+    SDL_FreeSurface(rface);
+
+    unlink(sampleFilename);
+    SDL_free(buffer);
+    SDL_FreeSurface(face);
+
+    return TEST_COMPLETED;
+}
+
+/* Creates a surface on a buffer with (pad) bytes of slack after each row */
+static SDL_Surface *
+_createPaddedSurface(Uint32 format, int w, int h, int pad, Uint8 **buffer)
+{
+    const int pitch = w * SDL_BYTESPERPIXEL(format) + pad;
+    SDL_Surface *surface;
+
+    *buffer = (Uint8 *) SDL_malloc(pitch * h);
+    if (*buffer == NULL) {
+        return NULL;
+    }
+    surface = SDL_CreateRGBSurfaceWithFormatFrom(*buffer, w, h, SDL_BITSPERPIXEL(format), pitch, format);
+    if (surface == NULL) {
+        SDL_free(*buffer);
+        *buffer = NULL;
+    }
+    return surface;
+}
+
+/**
+ * @brief Tests that the SSE2 alpha blitters match the portable C ones byte for byte.
+ */
+int
+surface_testSIMDAlphaBlit(void *arg)
+{
+    const struct {
+        Uint32 srcformat;
+        Uint32 dstformat;
+        int alpha;  /* -1 for per-pixel alpha */
+    } cases[] = {
+        { SDL_PIXELFORMAT_ARGB8888, SDL_PIXELFORMAT_ARGB8888, -1 },
+        { SDL_PIXELFORMAT_ARGB8888, SDL_PIXELFORMAT_RGB888, -1 },
+        { SDL_PIXELFORMAT_RGB565, SDL_PIXELFORMAT_RGB565, 128 },
+        { SDL_PIXELFORMAT_RGB565, SDL_PIXELFORMAT_RGB565, 77 },
+        { SDL_PIXELFORMAT_RGB555, SDL_PIXELFORMAT_RGB555, 128 },
+        { SDL_PIXELFORMAT_RGB555, SDL_PIXELFORMAT_RGB555, 201 },
+        { SDL_PIXELFORMAT_RGB888, SDL_PIXELFORMAT_RGB888, 128 },
+        { SDL_PIXELFORMAT_RGB888, SDL_PIXELFORMAT_RGB888, 33 }
+    };
+    const int widths[] = { 1, 3, 7, 13, 33, 67 };
+    const int h = 5;
+    const char *hint = SDL_GetHint(SDL_HINT_BLIT_SIMD);
+    int i, j, k, ret;
+
+    for (i = 0; i < SDL_arraysize(cases); ++i) {
+        for (j = 0; j < SDL_arraysize(widths); ++j) {
+            const int w = widths[j];
+            const int pad = 1 + (j * 5) % 11;
+            Uint8 *srcbuf, *simdbuf, *scalarbuf;
+            SDL_Surface *src, *simd, *scalar;
+            SDL_Rect dstrect;
+
+            src = _createPaddedSurface(cases[i].srcformat, w, h, pad, &srcbuf);
+            simd = _createPaddedSurface(cases[i].dstformat, w + 2, h, pad + 3, &simdbuf);
+            scalar = _createPaddedSurface(cases[i].dstformat, w + 2, h, pad + 3, &scalarbuf);
+            SDLTest_AssertCheck(src != NULL && simd != NULL && scalar != NULL, "Verify surfaces are not NULL");
+            if (src == NULL || simd == NULL || scalar == NULL) {
+                SDL_FreeSurface(src);
+                SDL_FreeSurface(simd);
+                SDL_FreeSurface(scalar);
+                SDL_free(srcbuf);
+                SDL_free(simdbuf);
+                SDL_free(scalarbuf);
+                return TEST_ABORTED;
+            }
+            for (k = 0; k < src->pitch * h; ++k) {
+                srcbuf[k] = SDLTest_RandomUint8();
+            }
+            for (k = 0; k < simd->pitch * h; ++k) {
+                simdbuf[k] = scalarbuf[k] = SDLTest_RandomUint8();
+            }
+            SDL_SetSurfaceBlendMode(src, SDL_BLENDMODE_BLEND);
+            if (cases[i].alpha >= 0) {
+                SDL_SetSurfaceAlphaMod(src, (Uint8) cases[i].alpha);
+            }
+
+            /* Start one pixel in, so the rows are not aligned either */
+            dstrect.x = 1;
+            dstrect.y = 0;
+            dstrect.w = w;
+            dstrect.h = h;
+            SDL_SetHint(SDL_HINT_BLIT_SIMD, "1");
+            ret = SDL_BlitSurface(src, NULL, simd, &dstrect);
+            SDLTest_AssertCheck(ret == 0, "Validate result from SDL_BlitSurface, expected: 0, got: %i", ret);
+            SDL_SetHint(SDL_HINT_BLIT_SIMD, "0");
+            dstrect.w = w;
+            dstrect.h = h;
+            ret = SDL_BlitSurface(src, NULL, scalar, &dstrect);
+            SDLTest_AssertCheck(ret == 0, "Validate result from SDL_BlitSurface, expected: 0, got: %i", ret);
+
+            ret = SDL_memcmp(simdbuf, scalarbuf, simd->pitch * h);
+            SDLTest_AssertCheck(ret == 0, "Verify %s to %s blit, alpha %d, width %d matches with and without SSE2",
+                                SDL_GetPixelFormatName(cases[i].srcformat), SDL_GetPixelFormatName(cases[i].dstformat),
+                                cases[i].alpha, w);
+
+            SDL_FreeSurface(src);
+            SDL_FreeSurface(simd);
+            SDL_FreeSurface(scalar);
+            SDL_free(srcbuf);
+            SDL_free(simdbuf);
+            SDL_free(scalarbuf);
+        }
+    }
+    SDL_SetHint(SDL_HINT_BLIT_SIMD, hint);
+
+    return TEST_COMPLETED;
+}
+
+static SDL_bool _slowBlitLogged;
+static SDL_LogOutputFunction _defaultLogOutput;
+static void *_defaultLogUserdata;
+
+static void SDLCALL
+_slowBlitLogOutput(void *userdata, int category, SDL_LogPriority priority, const char *message)
+{
+    if (category == SDL_LOG_CATEGORY_VIDEO && SDL_strstr(message, "slow blit")) {
+        _slowBlitLogged = SDL_TRUE;
+        return;
+    }
+    _defaultLogOutput(_defaultLogUserdata, category, priority, message);
+}
+
+/* Blends src onto dst with color modulation, returns whether the slow blitter was picked */
+static SDL_bool
+_blitModulated(SDL_Surface *src, SDL_Surface *dst)
+{
+    int ret;
+
+    _slowBlitLogged = SDL_FALSE;
+    SDL_SetSurfaceBlendMode(src, SDL_BLENDMODE_BLEND);
+    SDL_SetSurfaceColorMod(src, 128, 255, 255);
+    ret = SDL_BlitSurface(src, NULL, dst, NULL);
+    SDLTest_AssertCheck(ret == 0, "Validate result from SDL_BlitSurface, expected: 0, got: %i", ret);
+    return _slowBlitLogged;
+}
+
+/**
+ * @brief Tests that blits falling back to the generic blitter are logged.
+ */
+int
+surface_testSlowBlitLog(void *arg)
+{
+    const struct {
+        Uint32 srcformat;
+        Uint32 dstformat;
+        SDL_bool slow;
+    } cases[] = {
+        { SDL_PIXELFORMAT_ARGB8888, SDL_PIXELFORMAT_ARGB8888, SDL_FALSE },
+        { SDL_PIXELFORMAT_ARGB8888, SDL_PIXELFORMAT_ABGR8888, SDL_FALSE },
+        { SDL_PIXELFORMAT_ARGB8888, SDL_PIXELFORMAT_RGB565, SDL_FALSE },
+        { SDL_PIXELFORMAT_RGB565, SDL_PIXELFORMAT_ARGB8888, SDL_TRUE }
+    };
+    SDL_Surface *src[2], *dst[2];
+    SDL_LogPriority priority = SDL_LogGetPriority(SDL_LOG_CATEGORY_VIDEO);
+    int i, j, ret;
+
+    SDL_LogGetOutputFunction(&_defaultLogOutput, &_defaultLogUserdata);
+    SDL_LogSetOutputFunction(_slowBlitLogOutput, NULL);
+    SDL_LogSetPriority(SDL_LOG_CATEGORY_VIDEO, SDL_LOG_PRIORITY_DEBUG);
+
+    for (i = 0; i < SDL_arraysize(cases); ++i) {
+        /* The second pair reuses the blitter the first one picked */
+        for (j = 0; j < 2; ++j) {
+            src[j] = SDL_CreateRGBSurfaceWithFormat(0, 8, 8, 0, cases[i].srcformat);
+            dst[j] = SDL_CreateRGBSurfaceWithFormat(0, 8, 8, 0, cases[i].dstformat);
+            SDLTest_AssertCheck(src[j] != NULL && dst[j] != NULL, "Verify surfaces are not NULL");
+        }
+        if (src[0] && dst[0] && src[1] && dst[1]) {
+            for (j = 0; j < 2; ++j) {
+                SDLTest_AssertCheck(_blitModulated(src[j], dst[j]) == cases[i].slow,
+                                    "Verify %s to %s blit %s the slow blitter%s",
+                                    SDL_GetPixelFormatName(cases[i].srcformat), SDL_GetPixelFormatName(cases[i].dstformat),
+                                    cases[i].slow ? "uses" : "doesn't use", j ? " again" : "");
+            }
+
+            /* A plain copy never needs it */
+            _slowBlitLogged = SDL_FALSE;
+            SDL_SetSurfaceBlendMode(src[0], SDL_BLENDMODE_NONE);
+            SDL_SetSurfaceColorMod(src[0], 255, 255, 255);
+            ret = SDL_BlitSurface(src[0], NULL, dst[0], NULL);
+            SDLTest_AssertCheck(ret == 0, "Validate result from SDL_BlitSurface, expected: 0, got: %i", ret);
+            SDLTest_AssertCheck(!_slowBlitLogged, "Verify a copy doesn't use the slow blitter");
+        }
+        for (j = 0; j < 2; ++j) {
+            SDL_FreeSurface(src[j]);
+            SDL_FreeSurface(dst[j]);
+        }
+    }
+
+    SDL_LogSetPriority(SDL_LOG_CATEGORY_VIDEO, priority);
+    SDL_LogSetOutputFunction(_defaultLogOutput, _defaultLogUserdata);
+    return TEST_COMPLETED;
+}
+
+/* Fills a surface with random pixels, a third of them (key) if it isn't -1 */
+static void
+_fillRandomPixels(SDL_Surface *surface, Sint64 key)
+{
+    int x, y;
+
+    for (y = 0; y < surface->h; ++y) {
+        for (x = 0; x < surface->w; ++x) {
+            Uint32 pixel;
+            if (key >= 0 && SDLTest_RandomIntegerInRange(0, 2) == 0) {
+                pixel = (Uint32) key;
+            } else {
+                Uint8 a = SDLTest_RandomUint8();
+                if (a < 64) {
+                    a = 0;
+                } else if (a > 192) {
+                    a = 255;
+                }
+                pixel = SDL_MapRGBA(surface->format, SDLTest_RandomUint8(), SDLTest_RandomUint8(), SDLTest_RandomUint8(), a);
+            }
+            switch (surface->format->BytesPerPixel) {
+            case 2:
+                ((Uint16 *) ((Uint8 *) surface->pixels + y * surface->pitch))[x] = (Uint16) pixel;
+                break;
+            default:
+                ((Uint32 *) ((Uint8 *) surface->pixels + y * surface->pitch))[x] = pixel;
+                break;
+            }
+        }
+    }
+}
+
+/* Blits (src) onto (dst) whole, clipped on every side, and from a sub-rectangle */
+static void
+_blitRLEPattern(SDL_Surface *src, SDL_Surface *dst)
+{
+    SDL_Rect srcrect, dstrect;
+
+    dstrect.x = 3;
+    dstrect.y = 2;
+    SDL_BlitSurface(src, NULL, dst, &dstrect);
+    dstrect.x = -7;
+    dstrect.y = -5;
+    SDL_BlitSurface(src, NULL, dst, &dstrect);
+    dstrect.x = dst->w - src->w / 2;
+    dstrect.y = dst->h - src->h / 3;
+    SDL_BlitSurface(src, NULL, dst, &dstrect);
+    srcrect.x = 5;
+    srcrect.y = 3;
+    srcrect.w = src->w - 11;
+    srcrect.h = src->h - 4;
+    dstrect.x = 1;
+    dstrect.y = 9;
+    SDL_BlitSurface(src, &srcrect, dst, &dstrect);
+}
+
+/**
+ * @brief Tests that RLE encoding and blitting give the same results with and without SSE2.
+ */
+int
+surface_testSIMDRLEBlit(void *arg)
+{
+    const struct {
+        Uint32 srcformat;
+        Uint32 dstformat;
+        SDL_bool colorkey;
+        int alpha;  /* -1 for per-pixel alpha */
+    } cases[] = {
+        { SDL_PIXELFORMAT_RGB888, SDL_PIXELFORMAT_RGB888, SDL_TRUE, 255 },
+        { SDL_PIXELFORMAT_RGB888, SDL_PIXELFORMAT_RGB888, SDL_TRUE, 77 },
+        { SDL_PIXELFORMAT_RGB565, SDL_PIXELFORMAT_RGB565, SDL_TRUE, 255 },
+        { SDL_PIXELFORMAT_ARGB8888, SDL_PIXELFORMAT_ARGB8888, SDL_FALSE, -1 },
+        { SDL_PIXELFORMAT_ARGB8888, SDL_PIXELFORMAT_RGB888, SDL_FALSE, -1 },
+        { SDL_PIXELFORMAT_ARGB8888, SDL_PIXELFORMAT_RGB565, SDL_FALSE, -1 }
+    };
+    const char *hint = SDL_GetHint(SDL_HINT_BLIT_SIMD);
+    int i, j, ret;
+
+    for (i = 0; i < SDL_arraysize(cases); ++i) {
+        const int w = 37, h = 23;
+        SDL_Surface *original, *src[2], *dst[2];
+        Uint32 key = 0;
+
+        original = SDL_CreateRGBSurfaceWithFormat(0, w, h, 0, cases[i].srcformat);
+        SDLTest_AssertCheck(original != NULL, "Verify source surface is not NULL");
+        if (original == NULL) {
+            return TEST_ABORTED;
+        }
+        if (cases[i].colorkey) {
+            key = SDL_MapRGB(original->format, 0xFF, 0x00, 0xFF);
+        }
+        _fillRandomPixels(original, cases[i].colorkey ? (Sint64) key : -1);
+
+        for (j = 0; j < 2; ++j) {
+            SDL_SetHint(SDL_HINT_BLIT_SIMD, j ? "0" : "1");
+            src[j] = SDL_ConvertSurfaceFormat(original, cases[i].srcformat, 0);
+            dst[j] = SDL_CreateRGBSurfaceWithFormat(0, 64, 48, 0, cases[i].dstformat);
+            SDLTest_AssertCheck(src[j] != NULL && dst[j] != NULL, "Verify surfaces are not NULL");
+            if (src[j] == NULL || dst[j] == NULL) {
+                return TEST_ABORTED;
+            }
+            SDL_FillRect(dst[j], NULL, SDL_MapRGB(dst[j]->format, 0x20, 0x40, 0x60));
+            if (cases[i].colorkey) {
+                SDL_SetColorKey(src[j], SDL_TRUE, key);
+            }
+            if (cases[i].alpha >= 0) {
+                SDL_SetSurfaceAlphaMod(src[j], (Uint8) cases[i].alpha);
+            }
+            SDL_SetSurfaceBlendMode(src[j], (cases[i].alpha == 255) ? SDL_BLENDMODE_NONE : SDL_BLENDMODE_BLEND);
+            SDL_SetSurfaceRLE(src[j], 1);
+
+            _blitRLEPattern(src[j], dst[j]);
+            SDLTest_AssertCheck((src[j]->flags & SDL_RLEACCEL) != 0, "Verify surface is RLE encoded");
+
+            /* Locking decodes the surface, blitting again encodes it again */
+            ret = SDL_LockSurface(src[j]);
+            SDLTest_AssertCheck(ret == 0, "Validate result from SDL_LockSurface, expected: 0, got: %i", ret);
+            SDL_UnlockSurface(src[j]);
+            if (cases[i].colorkey) {
+                ret = SDLTest_CompareSurfaces(src[j], original, 0);
+                SDLTest_AssertCheck(ret == 0, "Verify %s colorkey surface survives RLE encoding, got: %i",
+                                    SDL_GetPixelFormatName(cases[i].srcformat), ret);
+            }
+            _blitRLEPattern(src[j], dst[j]);
+        }
+
+        /* The encoded surfaces don't keep their pixels, decode them to compare */
+        SDL_LockSurface(src[0]);
+        SDL_LockSurface(src[1]);
+        ret = 0;
+        for (j = 0; j < h && ret == 0; ++j) {
+            ret = SDL_memcmp((Uint8 *) src[0]->pixels + j * src[0]->pitch,
+                             (Uint8 *) src[1]->pixels + j * src[1]->pitch,
+                             w * src[0]->format->BytesPerPixel);
+        }
+        SDLTest_AssertCheck(ret == 0, "Verify %s to %s decoded surfaces match with and without SSE2",
+                            SDL_GetPixelFormatName(cases[i].srcformat), SDL_GetPixelFormatName(cases[i].dstformat));
+        SDL_UnlockSurface(src[1]);
+        SDL_UnlockSurface(src[0]);
+        ret = SDLTest_CompareSurfaces(dst[0], dst[1], 0);
+        SDLTest_AssertCheck(ret == 0, "Verify %s to %s RLE blits, alpha %d, match with and without SSE2",
+                            SDL_GetPixelFormatName(cases[i].srcformat), SDL_GetPixelFormatName(cases[i].dstformat),
+                            cases[i].alpha);
+
+        for (j = 0; j < 2; ++j) {
+            SDL_FreeSurface(src[j]);
+            SDL_FreeSurface(dst[j]);
+        }
+        SDL_FreeSurface(original);
+    }
+    SDL_SetHint(SDL_HINT_BLIT_SIMD, hint);
+
+    return TEST_COMPLETED;
+}
+
+/**
+ * @brief Tests RLE surfaces encoded in the background.
+ */
+int
+surface_testLazyRLE(void *arg)
+{
+    const char *hint = SDL_GetHint(SDL_HINT_RLE_LAZY_ENCODE);
+    SDL_Surface *src[4], *dst[4], *expected;
+    Uint32 key;
+    int i, j, ret;
+
+    expected = SDL_CreateRGBSurfaceWithFormat(0, 256, 256, 0, SDL_PIXELFORMAT_RGB888);
+    SDLTest_AssertCheck(expected != NULL, "Verify surface is not NULL");
+    if (expected == NULL) {
+        return TEST_ABORTED;
+    }
+    key = SDL_MapRGB(expected->format, 0xFF, 0x00, 0xFF);
+
+    SDL_SetHint(SDL_HINT_RLE_LAZY_ENCODE, "1");
+    for (i = 0; i < SDL_arraysize(src); ++i) {
+        src[i] = SDL_CreateRGBSurfaceWithFormat(0, 256, 256, 0, SDL_PIXELFORMAT_RGB888);
+        dst[i] = SDL_CreateRGBSurfaceWithFormat(0, 256, 256, 0, SDL_PIXELFORMAT_RGB888);
+        SDLTest_AssertCheck(src[i] != NULL && dst[i] != NULL, "Verify surfaces are not NULL");
+        if (src[i] == NULL || dst[i] == NULL) {
+            return TEST_ABORTED;
+        }
+        _fillRandomPixels(src[i], key);
+        SDL_SetColorKey(src[i], SDL_TRUE, key);
+        SDL_SetSurfaceRLE(src[i], 1);
+    }
+
+    /* Queue them all, then take one back before it's encoded, likely */
+    for (i = 0; i < SDL_arraysize(src); ++i) {
+        SDL_BlitSurface(src[i], NULL, dst[i], NULL);
+    }
+    ret = SDL_LockSurface(src[2]);
+    SDLTest_AssertCheck(ret == 0, "Validate result from SDL_LockSurface, expected: 0, got: %i", ret);
+    SDL_UnlockSurface(src[2]);
+
+    /* Whenever the encodings are installed, the blits stay the same */
+    for (j = 0; j < 20; ++j) {
+        for (i = 0; i < SDL_arraysize(src); ++i) {
+            SDL_FillRect(expected, NULL, 0);
+            SDL_SetSurfaceRLE(src[i], 0);
+            SDL_BlitSurface(src[i], NULL, expected, NULL);
+            SDL_SetSurfaceRLE(src[i], 1);
+
+            SDL_FillRect(dst[i], NULL, 0);
+            SDL_BlitSurface(src[i], NULL, dst[i], NULL);
+            ret = SDLTest_CompareSurfaces(dst[i], expected, 0);
+            if (ret != 0) {
+                break;
+            }
+        }
+        if (ret != 0) {
+            break;
+        }
+        SDL_Delay(1);
+    }
+    SDLTest_AssertCheck(ret == 0, "Verify blits of lazily encoded surfaces, got: %i", ret);
+
+    for (i = 0; i < SDL_arraysize(src); ++i) {
+        SDL_FreeSurface(src[i]);
+        SDL_FreeSurface(dst[i]);
+    }
+    SDL_FreeSurface(expected);
+    SDL_SetHint(SDL_HINT_RLE_LAZY_ENCODE, hint);
+
+    return TEST_COMPLETED;
+}
+
+/**
+ * @brief Tests writing to RLE surfaces that are encoded in the background.
+ */
+int
+surface_testLazyRLEWrite(void *arg)
+{
+    const char *hint = SDL_GetHint(SDL_HINT_RLE_LAZY_ENCODE);
+    SDL_Surface *src, *dst, *solid;
+    SDL_Rect rect;
+    Uint32 key, red, blue, pixel;
+    int i, ret;
+
+    src = SDL_CreateRGBSurfaceWithFormat(0, 256, 256, 0, SDL_PIXELFORMAT_RGB888);
+    dst = SDL_CreateRGBSurfaceWithFormat(0, 256, 256, 0, SDL_PIXELFORMAT_RGB888);
+    solid = SDL_CreateRGBSurfaceWithFormat(0, 16, 16, 0, SDL_PIXELFORMAT_RGB888);
+    SDLTest_AssertCheck(src != NULL && dst != NULL && solid != NULL, "Verify surfaces are not NULL");
+    if (src == NULL || dst == NULL || solid == NULL) {
+        return TEST_ABORTED;
+    }
+    key = SDL_MapRGB(src->format, 0xFF, 0x00, 0xFF);
+    red = SDL_MapRGB(src->format, 0xFF, 0x00, 0x00);
+    blue = SDL_MapRGB(src->format, 0x00, 0x00, 0xFF);
+    SDL_FillRect(solid, NULL, blue);
+
+    SDL_SetHint(SDL_HINT_RLE_LAZY_ENCODE, "1");
+    _fillRandomPixels(src, key);
+    SDL_SetColorKey(src, SDL_TRUE, key);
+    SDL_SetSurfaceRLE(src, 1);
+
+    /* The first blit starts encoding it, an unlocked fill then needs the
+       lock like it does for any RLE surface instead of being lost */
+    SDL_BlitSurface(src, NULL, dst, NULL);
+    rect.x = 32;
+    rect.y = 32;
+    rect.w = 64;
+    rect.h = 64;
+    ret = SDL_FillRect(src, &rect, red);
+    SDLTest_AssertCheck(ret == -1, "Verify unlocked fill of an RLE surface fails, expected: -1, got: %i", ret);
+
+    ret = SDL_LockSurface(src);
+    SDLTest_AssertCheck(ret == 0, "Validate result from SDL_LockSurface, expected: 0, got: %i", ret);
+    ret = SDL_FillRect(src, &rect, red);
+    SDLTest_AssertCheck(ret == 0, "Verify locked fill of an RLE surface, expected: 0, got: %i", ret);
+    SDL_UnlockSurface(src);
+
+    /* Blitting into it locks it */
+    rect.x = 160;
+    rect.y = 160;
+    ret = SDL_BlitSurface(solid, NULL, src, &rect);
+    SDLTest_AssertCheck(ret == 0, "Verify blit into an RLE surface, expected: 0, got: %i", ret);
+
+    /* Whenever the encoding is installed, both writes are there */
+    for (i = 0; i < 20; ++i) {
+        SDL_FillRect(dst, NULL, 0);
+        SDL_BlitSurface(src, NULL, dst, NULL);
+        pixel = ((Uint32 *) ((Uint8 *) dst->pixels + 64 * dst->pitch))[64];
+        if (pixel != red) {
+            break;
+        }
+        pixel = ((Uint32 *) ((Uint8 *) dst->pixels + 168 * dst->pitch))[168];
+        if (pixel != blue) {
+            break;
+        }
+        SDL_Delay(1);
+    }
+    SDLTest_AssertCheck(i == 20, "Verify writes to a lazily encoded surface are kept, got 0x%.8x after %d blits", pixel, i);
+
+    SDL_FreeSurface(src);
+    SDL_FreeSurface(dst);
+    SDL_FreeSurface(solid);
+    SDL_SetHint(SDL_HINT_RLE_LAZY_ENCODE, hint);
+
+    return TEST_COMPLETED;
+}
+
+/**
+ * @brief Tests that blits split across threads match single threaded ones.
+ */
+int
+surface_testBlitThreads(void *arg)
+{
+    const char *hint = SDL_GetHint(SDL_HINT_BLIT_THREADS);
+    SDL_Surface *src, *dst, *expected;
+    SDL_Rect srcrect, dstrect;
+    int ret;
+
+    /* large enough to be split into four bands */
+    src = SDL_CreateRGBSurfaceWithFormat(0, 1024, 1024, 0, SDL_PIXELFORMAT_ARGB8888);
+    dst = SDL_CreateRGBSurfaceWithFormat(0, 1024, 1024, 0, SDL_PIXELFORMAT_RGB565);
+    expected = SDL_CreateRGBSurfaceWithFormat(0, 1024, 1024, 0, SDL_PIXELFORMAT_RGB565);
+    SDLTest_AssertCheck(src != NULL && dst != NULL && expected != NULL, "Verify surfaces are not NULL");
+    if (src == NULL || dst == NULL || expected == NULL) {
+        return TEST_ABORTED;
+    }
+    _fillRandomPixels(src, -1);
+    SDL_SetSurfaceBlendMode(src, SDL_BLENDMODE_NONE);
+
+    SDL_SetHint(SDL_HINT_BLIT_THREADS, "1");
+    SDL_BlitSurface(src, NULL, expected, NULL);
+    SDL_SetHint(SDL_HINT_BLIT_THREADS, "4");
+    SDL_BlitSurface(src, NULL, dst, NULL);
+    ret = SDLTest_CompareSurfaces(dst, expected, 0);
+    SDLTest_AssertCheck(ret == 0, "Verify threaded conversion, got: %i", ret);
+
+    /* Moving a surface's pixels down depends on the rows being copied
+       bottom up, so this has to stay on one thread */
+    SDL_FreeSurface(expected);
+    expected = SDL_ConvertSurface(src, src->format, 0);
+    SDLTest_AssertCheck(expected != NULL, "Verify surface is not NULL");
+    if (expected == NULL) {
+        return TEST_ABORTED;
+    }
+    SDL_SetSurfaceBlendMode(expected, SDL_BLENDMODE_NONE);
+    srcrect.x = 0;
+    srcrect.y = 0;
+    srcrect.w = 1024;
+    srcrect.h = 1000;
+
+    SDL_SetHint(SDL_HINT_BLIT_THREADS, "1");
+    dstrect.x = 0;
+    dstrect.y = 24;
+    SDL_BlitSurface(expected, &srcrect, expected, &dstrect);
+    SDL_SetHint(SDL_HINT_BLIT_THREADS, "4");
+    dstrect.x = 0;
+    dstrect.y = 24;
+    SDL_BlitSurface(src, &srcrect, src, &dstrect);
+    ret = SDLTest_CompareSurfaces(src, expected, 0);
+    SDLTest_AssertCheck(ret == 0, "Verify overlapping blit within a surface, got: %i", ret);
+
+    SDL_FreeSurface(src);
+    SDL_FreeSurface(dst);
+    SDL_FreeSurface(expected);
+    SDL_SetHint(SDL_HINT_BLIT_THREADS, hint);
+
+    return TEST_COMPLETED;
+}
+
 /* ================= Test References ================== */
 
 /* Surface test cases */
@@ -630,11 +1568,46 @@ static const SDLTest_TestCaseReference surfaceTest11 =
 static const SDLTest_TestCaseReference surfaceTest12 =
         { (SDLTest_TestCaseFp)surface_testBlitBlendMod, "surface_testBlitBlendMod", "Tests blitting routines with mod blending mode.", TEST_ENABLED};
 
+static const SDLTest_TestCaseReference surfaceTest13 =
+        { (SDLTest_TestCaseFp)surface_testSoftStretchLinear, "surface_testSoftStretchLinear", "Tests bilinear and box filtered stretching.", TEST_ENABLED};
+
+static const SDLTest_TestCaseReference surfaceTest14 =
+        { (SDLTest_TestCaseFp)surface_testYUVConversion, "surface_testYUVConversion", "Tests conversion between YUV and RGB formats.", TEST_ENABLED};
+
+static const SDLTest_TestCaseReference surfaceTest15 =
+        { (SDLTest_TestCaseFp)surface_testAlignedPool, "surface_testAlignedPool", "Tests aligned surfaces and the surface pixel pool.", TEST_ENABLED};
+
+static const SDLTest_TestCaseReference surfaceTest16 =
+        { (SDLTest_TestCaseFp)surface_testBlitMapPalette, "surface_testBlitMapPalette", "Tests that blits follow palette changes between blit mappings.", TEST_ENABLED};
+
+static const SDLTest_TestCaseReference surfaceTest17 =
+        { (SDLTest_TestCaseFp)surface_testLoadBitmapWithFormat, "surface_testLoadBitmapWithFormat", "Tests loading bitmaps into other pixel formats.", TEST_ENABLED};
+
+static const SDLTest_TestCaseReference surfaceTest18 =
+        { (SDLTest_TestCaseFp)surface_testSIMDAlphaBlit, "surface_testSIMDAlphaBlit", "Tests that the SSE2 alpha blitters match the C ones.", TEST_ENABLED};
+
+static const SDLTest_TestCaseReference surfaceTest19 =
+        { (SDLTest_TestCaseFp)surface_testSlowBlitLog, "surface_testSlowBlitLog", "Tests that blits falling back to the generic blitter are logged.", TEST_ENABLED};
+
+static const SDLTest_TestCaseReference surfaceTest20 =
+        { (SDLTest_TestCaseFp)surface_testSIMDRLEBlit, "surface_testSIMDRLEBlit", "Tests that SSE2 RLE encoding and blits match the C ones.", TEST_ENABLED};
+
+static const SDLTest_TestCaseReference surfaceTest21 =
+        { (SDLTest_TestCaseFp)surface_testLazyRLE, "surface_testLazyRLE", "Tests RLE surfaces encoded in the background.", TEST_ENABLED};
+
+static const SDLTest_TestCaseReference surfaceTest22 =
+        { (SDLTest_TestCaseFp)surface_testBlitThreads, "surface_testBlitThreads", "Tests that blits split across threads match single threaded ones.", TEST_ENABLED};
+
+static const SDLTest_TestCaseReference surfaceTest23 =
+        { (SDLTest_TestCaseFp)surface_testLazyRLEWrite, "surface_testLazyRLEWrite", "Tests writing to RLE surfaces that are encoded in the background.", TEST_ENABLED};
+
 /* Sequence of Surface test cases */
 static const SDLTest_TestCaseReference *surfaceTests[] =  {
     &surfaceTest1, &surfaceTest2, &surfaceTest3, &surfaceTest4, &surfaceTest5,
     &surfaceTest6, &surfaceTest7, &surfaceTest8, &surfaceTest9, &surfaceTest10,
-    &surfaceTest11, &surfaceTest12, NULL
+    &surfaceTest11, &surfaceTest12, &surfaceTest13, &surfaceTest14, &surfaceTest15,
+    &surfaceTest16, &surfaceTest17, &surfaceTest18, &surfaceTest19, &surfaceTest20,
+    &surfaceTest21, &surfaceTest22, &surfaceTest23, NULL
 };
 
 /* Surface test suite (global) */
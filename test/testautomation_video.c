@@ -17,6 +17,7 @@
 
 #include "SDL.h"
 #include "SDL_test.h"
+#include "SDL_shape.h"
 
 /* Private helpers */
 
@@ -1720,6 +1721,607 @@ video_getSetWindowData(void *arg)
   return returnValue;
 }
 
+/**
+ * @brief Tests window surface updates with and without damage tracking
+ *
+ * @sa http://wiki.libsdl.org/SDL_UpdateWindowSurface
+ * @sa http://wiki.libsdl.org/SDL_UpdateWindowSurfaceRects
+ */
+int
+video_updateWindowSurfaceDamage(void *arg)
+{
+  const char* title = "video_updateWindowSurfaceDamage Test Window";
+  SDL_Window* window;
+  SDL_Surface* surface;
+  SDL_Surface* sprite;
+  SDL_Rect rects[3];
+  int tracked, result;
+
+  for (tracked = 0; tracked < 2; tracked++) {
+    SDL_SetHint(SDL_HINT_WINDOW_SURFACE_DAMAGE, tracked ? "1" : "0");
+    SDLTest_AssertPass("Call to SDL_SetHint(SDL_HINT_WINDOW_SURFACE_DAMAGE, %d)", tracked);
+
+    window = _createVideoSuiteTestWindow(title);
+    if (window == NULL) break;
+
+    surface = SDL_GetWindowSurface(window);
+    SDLTest_AssertPass("Call to SDL_GetWindowSurface()");
+    if (surface == NULL) {
+      _destroyVideoSuiteTestWindow(window);
+      continue;
+    }
+    SDLTest_AssertCheck(((surface->flags & SDL_TRACKDAMAGE) != 0) == tracked,
+      "Verify SDL_TRACKDAMAGE flag; expected: %d, got: %d", tracked, (surface->flags & SDL_TRACKDAMAGE) != 0);
+
+    /* The first update presents the whole surface */
+    result = SDL_UpdateWindowSurface(window);
+    SDLTest_AssertPass("Call to SDL_UpdateWindowSurface()");
+    SDLTest_AssertCheck(result == 0, "Verify result value; expected: 0, got: %d", result);
+
+    /* Nothing drawn */
+    result = SDL_UpdateWindowSurface(window);
+    SDLTest_AssertPass("Call to SDL_UpdateWindowSurface() without drawing");
+    SDLTest_AssertCheck(result == 0, "Verify result value; expected: 0, got: %d", result);
+
+    /* Fill and blit into opposite corners */
+    rects[0].x = 0;
+    rects[0].y = 0;
+    rects[0].w = 16;
+    rects[0].h = 16;
+    result = SDL_FillRect(surface, &rects[0], SDL_MapRGB(surface->format, 255, 0, 0));
+    SDLTest_AssertCheck(result == 0, "Verify SDL_FillRect result value; expected: 0, got: %d", result);
+    sprite = SDL_CreateRGBSurfaceWithFormat(0, 16, 16, 0, SDL_PIXELFORMAT_ARGB8888);
+    SDLTest_AssertCheck(sprite != NULL, "Verify sprite surface is not NULL");
+    if (sprite != NULL) {
+      rects[1].x = surface->w - 8;
+      rects[1].y = surface->h - 8;
+      result = SDL_BlitSurface(sprite, NULL, surface, &rects[1]);
+      SDLTest_AssertCheck(result == 0, "Verify SDL_BlitSurface result value; expected: 0, got: %d", result);
+      SDL_FreeSurface(sprite);
+    }
+    result = SDL_UpdateWindowSurface(window);
+    SDLTest_AssertPass("Call to SDL_UpdateWindowSurface() after drawing");
+    SDLTest_AssertCheck(result == 0, "Verify result value; expected: 0, got: %d", result);
+
+    /* Overlapping rects, and rects partly or entirely outside the window */
+    rects[0].x = -10;
+    rects[0].y = -10;
+    rects[0].w = 40;
+    rects[0].h = 40;
+    rects[1].x = 20;
+    rects[1].y = 20;
+    rects[1].w = 40;
+    rects[1].h = 40;
+    rects[2].x = surface->w + 10;
+    rects[2].y = 0;
+    rects[2].w = 10;
+    rects[2].h = 10;
+    result = SDL_UpdateWindowSurfaceRects(window, rects, 3);
+    SDLTest_AssertPass("Call to SDL_UpdateWindowSurfaceRects()");
+    SDLTest_AssertCheck(result == 0, "Verify result value; expected: 0, got: %d", result);
+
+    result = SDL_UpdateWindowSurfaceRects(window, &rects[2], 1);
+    SDLTest_AssertPass("Call to SDL_UpdateWindowSurfaceRects() outside the window");
+    SDLTest_AssertCheck(result == 0, "Verify result value; expected: 0, got: %d", result);
+
+    result = SDL_UpdateWindowSurfaceRects(window, NULL, 1);
+    SDLTest_AssertPass("Call to SDL_UpdateWindowSurfaceRects(rects=NULL)");
+    SDLTest_AssertCheck(result == -1, "Verify result value; expected: -1, got: %d", result);
+    _checkInvalidParameterError();
+
+    _destroyVideoSuiteTestWindow(window);
+  }
+
+  SDL_SetHint(SDL_HINT_WINDOW_SURFACE_DAMAGE, NULL);
+  return TEST_COMPLETED;
+}
+
+typedef struct {
+  int count;
+  SDL_Window *window;
+  SDL_Surface *surface;
+  SDL_Rect bounds;
+  Uint64 timestamp;
+} _presentCallbackData;
+
+static void SDLCALL
+_presentCallback(void *userdata, SDL_Window *window, SDL_Surface *surface,
+                 const SDL_Rect *rects, int numrects, Uint64 timestamp)
+{
+  _presentCallbackData *data = (_presentCallbackData *)userdata;
+  int i;
+
+  data->count++;
+  data->window = window;
+  data->surface = surface;
+  data->timestamp = timestamp;
+  SDL_zero(data->bounds);
+  for (i = 0; i < numrects; i++) {
+    SDL_UnionRect(&data->bounds, &rects[i], &data->bounds);
+  }
+}
+
+/**
+ * @brief Tests the functionality of the SDL_SetWindowPresentCallback function
+ */
+int
+video_setWindowPresentCallback(void *arg)
+{
+  const char* title = "video_setWindowPresentCallback Test Window";
+  _presentCallbackData data;
+  SDL_Window* window;
+  SDL_Surface* surface;
+  SDL_Rect rect;
+  Uint64 before;
+  int result;
+
+  SDL_zero(data);
+
+  /* Invalid window */
+  result = SDL_SetWindowPresentCallback(NULL, _presentCallback, &data);
+  SDLTest_AssertPass("Call to SDL_SetWindowPresentCallback(window=NULL)");
+  SDLTest_AssertCheck(result == -1, "Verify result value; expected: -1, got: %d", result);
+  _checkInvalidWindowError();
+
+  window = _createVideoSuiteTestWindow(title);
+  if (window == NULL) return TEST_ABORTED;
+
+  result = SDL_SetWindowPresentCallback(window, _presentCallback, &data);
+  SDLTest_AssertPass("Call to SDL_SetWindowPresentCallback()");
+  SDLTest_AssertCheck(result == 0, "Verify result value; expected: 0, got: %d", result);
+
+  surface = SDL_GetWindowSurface(window);
+  SDLTest_AssertPass("Call to SDL_GetWindowSurface()");
+  if (surface != NULL) {
+    /* The whole surface */
+    before = SDL_GetPerformanceCounter();
+    result = SDL_UpdateWindowSurface(window);
+    SDLTest_AssertPass("Call to SDL_UpdateWindowSurface()");
+    SDLTest_AssertCheck(result == 0, "Verify result value; expected: 0, got: %d", result);
+    SDLTest_AssertCheck(data.count == 1, "Verify callback count; expected: 1, got: %d", data.count);
+    SDLTest_AssertCheck(data.window == window, "Verify callback window");
+    SDLTest_AssertCheck(data.surface == surface, "Verify callback surface");
+    SDLTest_AssertCheck(data.timestamp >= before, "Verify callback timestamp is not before the update");
+    SDLTest_AssertCheck(data.bounds.x == 0 && data.bounds.y == 0 && data.bounds.w == surface->w && data.bounds.h == surface->h,
+      "Verify callback rects cover the surface; got: %d,%d %dx%d", data.bounds.x, data.bounds.y, data.bounds.w, data.bounds.h);
+
+    /* A rect partly outside the window is clipped */
+    rect.x = surface->w - 10;
+    rect.y = 5;
+    rect.w = 20;
+    rect.h = 10;
+    result = SDL_UpdateWindowSurfaceRects(window, &rect, 1);
+    SDLTest_AssertPass("Call to SDL_UpdateWindowSurfaceRects()");
+    SDLTest_AssertCheck(result == 0, "Verify result value; expected: 0, got: %d", result);
+    SDLTest_AssertCheck(data.count == 2, "Verify callback count; expected: 2, got: %d", data.count);
+    SDLTest_AssertCheck(data.bounds.x == surface->w - 10 && data.bounds.y == 5 && data.bounds.w == 10 && data.bounds.h == 10,
+      "Verify callback rects; expected: %d,5 10x10, got: %d,%d %dx%d", surface->w - 10,
+      data.bounds.x, data.bounds.y, data.bounds.w, data.bounds.h);
+
+    /* Nothing to present */
+    rect.x = surface->w;
+    result = SDL_UpdateWindowSurfaceRects(window, &rect, 1);
+    SDLTest_AssertPass("Call to SDL_UpdateWindowSurfaceRects() outside the window");
+    SDLTest_AssertCheck(result == 0, "Verify result value; expected: 0, got: %d", result);
+    SDLTest_AssertCheck(data.count == 2, "Verify callback count; expected: 2, got: %d", data.count);
+
+    /* Removed callback */
+    result = SDL_SetWindowPresentCallback(window, NULL, NULL);
+    SDLTest_AssertPass("Call to SDL_SetWindowPresentCallback(callback=NULL)");
+    SDLTest_AssertCheck(result == 0, "Verify result value; expected: 0, got: %d", result);
+    result = SDL_UpdateWindowSurface(window);
+    SDLTest_AssertPass("Call to SDL_UpdateWindowSurface()");
+    SDLTest_AssertCheck(result == 0, "Verify result value; expected: 0, got: %d", result);
+    SDLTest_AssertCheck(data.count == 2, "Verify callback count; expected: 2, got: %d", data.count);
+  }
+
+  _destroyVideoSuiteTestWindow(window);
+
+  return TEST_COMPLETED;
+}
+
+typedef struct {
+  int w, h;
+  Uint8 *covered;
+  int numrects;
+  int outside;
+  SDL_Rect first;
+} _presentCoverageData;
+
+static void SDLCALL
+_presentCoverageCallback(void *userdata, SDL_Window *window, SDL_Surface *surface,
+                         const SDL_Rect *rects, int numrects, Uint64 timestamp)
+{
+  _presentCoverageData *data = (_presentCoverageData *)userdata;
+  int i, x, y;
+
+  data->numrects = numrects;
+  if (numrects > 0) {
+    data->first = rects[0];
+  }
+  for (i = 0; i < numrects; i++) {
+    if (rects[i].x < 0 || rects[i].y < 0 || rects[i].w <= 0 || rects[i].h <= 0 ||
+        rects[i].x + rects[i].w > data->w || rects[i].y + rects[i].h > data->h) {
+      data->outside++;
+      continue;
+    }
+    for (y = rects[i].y; y < rects[i].y + rects[i].h; y++) {
+      for (x = rects[i].x; x < rects[i].x + rects[i].w; x++) {
+        data->covered[y * data->w + x]++;
+      }
+    }
+  }
+}
+
+/**
+ * @brief Tests SDL_UpdateWindowSurfaceRects with many overlapping rects
+ */
+int
+video_updateWindowSurfaceManyRects(void *arg)
+{
+  const char* title = "video_updateWindowSurfaceManyRects Test Window";
+  _presentCoverageData data;
+  SDL_Window* window;
+  SDL_Surface* surface;
+  SDL_Rect *rects, clipped, bounds;
+  Uint8 *wanted;
+  int numrects, i, y, result, missing = 0, twice = 0;
+
+  window = _createVideoSuiteTestWindow(title);
+  if (window == NULL) return TEST_ABORTED;
+
+  surface = SDL_GetWindowSurface(window);
+  SDLTest_AssertPass("Call to SDL_GetWindowSurface()");
+  SDLTest_AssertCheck(surface != NULL, "Verify surface is not NULL");
+  if (surface == NULL) {
+    _destroyVideoSuiteTestWindow(window);
+    return TEST_ABORTED;
+  }
+
+  SDL_zero(data);
+  data.w = surface->w;
+  data.h = surface->h;
+  data.covered = (Uint8 *)SDL_calloc(data.w * data.h, 1);
+  wanted = (Uint8 *)SDL_calloc(data.w * data.h, 1);
+  numrects = SDLTest_RandomIntegerInRange(500, 2000);
+  rects = (SDL_Rect *)SDL_malloc(numrects * sizeof(*rects));
+  SDLTest_AssertCheck(data.covered != NULL && wanted != NULL && rects != NULL, "Verify allocations");
+  if (data.covered == NULL || wanted == NULL || rects == NULL) {
+    SDL_free(data.covered);
+    SDL_free(wanted);
+    SDL_free(rects);
+    _destroyVideoSuiteTestWindow(window);
+    return TEST_ABORTED;
+  }
+
+  /* Small rects clustered in a few places, some crossing the window edges */
+  bounds.x = 0;
+  bounds.y = 0;
+  bounds.w = data.w;
+  bounds.h = data.h;
+  for (i = 0; i < numrects; i++) {
+    const int cluster = i % 4;
+    rects[i].w = SDLTest_RandomIntegerInRange(1, 40);
+    rects[i].h = SDLTest_RandomIntegerInRange(1, 40);
+    rects[i].x = (cluster & 1) ? data.w - SDLTest_RandomIntegerInRange(-20, 100) : SDLTest_RandomIntegerInRange(-20, 100);
+    rects[i].y = (cluster & 2) ? data.h - SDLTest_RandomIntegerInRange(-20, 100) : SDLTest_RandomIntegerInRange(-20, 100);
+    if (SDL_IntersectRect(&rects[i], &bounds, &clipped)) {
+      for (y = clipped.y; y < clipped.y + clipped.h; y++) {
+        SDL_memset(&wanted[y * data.w + clipped.x], 1, clipped.w);
+      }
+    }
+  }
+
+  SDL_SetWindowPresentCallback(window, _presentCoverageCallback, &data);
+  result = SDL_UpdateWindowSurfaceRects(window, rects, numrects);
+  SDLTest_AssertPass("Call to SDL_UpdateWindowSurfaceRects() with %d rects", numrects);
+  SDLTest_AssertCheck(result == 0, "Verify result value; expected: 0, got: %d", result);
+  SDLTest_AssertCheck(data.numrects > 0 && data.numrects <= 16, "Verify presented rect count; expected: 1-16, got: %d", data.numrects);
+  SDLTest_AssertCheck(data.outside == 0, "Verify presented rects are inside the window; got %d outside", data.outside);
+
+  for (i = 0; i < data.w * data.h; i++) {
+    if (wanted[i] && !data.covered[i]) {
+      missing++;
+    }
+    if (data.covered[i] > 1) {
+      twice++;
+    }
+  }
+  SDLTest_AssertCheck(missing == 0, "Verify every updated pixel is presented; %d missing", missing);
+  SDLTest_AssertCheck(twice == 0, "Verify no pixel is presented twice; %d presented twice", twice);
+
+  SDL_free(data.covered);
+  SDL_free(wanted);
+  SDL_free(rects);
+  _destroyVideoSuiteTestWindow(window);
+
+  return TEST_COMPLETED;
+}
+
+/**
+ * @brief Tests SDL_UpdateWindowSurfaceRects with empty, disjoint and adjoining rects
+ */
+int
+video_updateWindowSurfaceFewRects(void *arg)
+{
+  const char* title = "video_updateWindowSurfaceFewRects Test Window";
+  const struct {
+    const char *name;
+    int numrects;
+    SDL_Rect rects[3];
+    int presented;      /* rects presented, -1 for no present */
+    SDL_Rect first;
+  } cases[] = {
+    { "no rects", 0, { { 0, 0, 0, 0 } }, -1, { 0, 0, 0, 0 } },
+    { "empty and outside rects", 2, { { 10, 10, 0, 20 }, { -50, 10, 40, 20 } }, -1, { 0, 0, 0, 0 } },
+    { "disjoint rects", 2, { { 100, 50, 30, 10 }, { 10, 10, 20, 20 } }, 2, { 10, 10, 20, 20 } },
+    { "the same rect twice", 2, { { 10, 10, 40, 10 }, { 10, 10, 40, 10 } }, 1, { 10, 10, 40, 10 } },
+    { "stacked rects", 3, { { 10, 20, 40, 15 }, { 10, 10, 40, 10 }, { 10, 30, 40, 10 } }, 1, { 10, 10, 40, 30 } },
+    { "rects crossing the edge", 2, { { -10, -10, 30, 30 }, { 20, -10, 10, 30 } }, 1, { 0, 0, 30, 20 } }
+  };
+  _presentCoverageData data;
+  SDL_Window* window;
+  SDL_Surface* surface;
+  SDL_Rect clipped, bounds;
+  Uint8 *wanted;
+  int c, i, y, result, mismatches;
+
+  window = _createVideoSuiteTestWindow(title);
+  if (window == NULL) return TEST_ABORTED;
+
+  surface = SDL_GetWindowSurface(window);
+  SDLTest_AssertPass("Call to SDL_GetWindowSurface()");
+  SDLTest_AssertCheck(surface != NULL, "Verify surface is not NULL");
+  if (surface == NULL) {
+    _destroyVideoSuiteTestWindow(window);
+    return TEST_ABORTED;
+  }
+
+  SDL_zero(data);
+  data.w = surface->w;
+  data.h = surface->h;
+  data.covered = (Uint8 *)SDL_malloc(data.w * data.h);
+  wanted = (Uint8 *)SDL_malloc(data.w * data.h);
+  SDLTest_AssertCheck(data.covered != NULL && wanted != NULL, "Verify allocations");
+  if (data.covered == NULL || wanted == NULL) {
+    SDL_free(data.covered);
+    SDL_free(wanted);
+    _destroyVideoSuiteTestWindow(window);
+    return TEST_ABORTED;
+  }
+  bounds.x = 0;
+  bounds.y = 0;
+  bounds.w = data.w;
+  bounds.h = data.h;
+
+  /* Present anything already waiting before counting */
+  SDL_UpdateWindowSurface(window);
+  SDL_SetWindowPresentCallback(window, _presentCoverageCallback, &data);
+
+  for (c = 0; c < SDL_arraysize(cases); c++) {
+    SDL_memset(data.covered, 0, data.w * data.h);
+    SDL_memset(wanted, 0, data.w * data.h);
+    for (i = 0; i < cases[c].numrects; i++) {
+      if (SDL_IntersectRect(&cases[c].rects[i], &bounds, &clipped)) {
+        for (y = clipped.y; y < clipped.y + clipped.h; y++) {
+          SDL_memset(&wanted[y * data.w + clipped.x], 1, clipped.w);
+        }
+      }
+    }
+    data.numrects = -1;
+    data.outside = 0;
+
+    result = SDL_UpdateWindowSurfaceRects(window, cases[c].rects, cases[c].numrects);
+    SDLTest_AssertPass("Call to SDL_UpdateWindowSurfaceRects() with %s", cases[c].name);
+    SDLTest_AssertCheck(result == 0, "Verify result value; expected: 0, got: %d", result);
+    SDLTest_AssertCheck(data.numrects == cases[c].presented, "Verify presented rect count; expected: %d, got: %d", cases[c].presented, data.numrects);
+    SDLTest_AssertCheck(data.outside == 0, "Verify presented rects are inside the window; got %d outside", data.outside);
+    if (cases[c].presented > 0) {
+      SDLTest_AssertCheck(SDL_RectEquals(&data.first, &cases[c].first),
+        "Verify first presented rect; expected: %d,%d %dx%d, got: %d,%d %dx%d",
+        cases[c].first.x, cases[c].first.y, cases[c].first.w, cases[c].first.h,
+        data.first.x, data.first.y, data.first.w, data.first.h);
+    }
+    mismatches = 0;
+    for (i = 0; i < data.w * data.h; i++) {
+      if (data.covered[i] != wanted[i]) {
+        mismatches++;
+      }
+    }
+    SDLTest_AssertCheck(mismatches == 0, "Verify exactly the updated pixels are presented once; %d mismatches", mismatches);
+  }
+
+  SDL_free(data.covered);
+  SDL_free(wanted);
+  _destroyVideoSuiteTestWindow(window);
+
+  return TEST_COMPLETED;
+}
+
+/**
+ * @brief Tests setting the shape of a shaped window, then updating parts of it
+ */
+int
+video_setUpdateWindowShape(void *arg)
+{
+  const int w = 64, h = 48;
+  SDL_Window* window;
+  SDL_Surface* shape;
+  SDL_WindowShapeMode mode, result_mode;
+  SDL_Rect rect;
+  int result, i;
+
+  window = SDL_CreateShapedWindow("video_setUpdateWindowShape Test Window", 0, 0, w, h, 0);
+  SDLTest_AssertPass("Call to SDL_CreateShapedWindow()");
+  if (window == NULL) {
+    SDLTest_Log("Shaped windows are not supported: %s", SDL_GetError());
+    return TEST_SKIPPED;
+  }
+  shape = SDL_CreateRGBSurfaceWithFormat(0, w, h, 0, SDL_PIXELFORMAT_ARGB8888);
+  SDLTest_AssertCheck(shape != NULL, "Verify shape surface is not NULL");
+  if (shape == NULL) {
+    SDL_DestroyWindow(window);
+    return TEST_ABORTED;
+  }
+
+  /* No shape to update yet */
+  result = SDL_UpdateWindowShape(window, shape, NULL);
+  SDLTest_AssertPass("Call to SDL_UpdateWindowShape() before setting a shape");
+  SDLTest_AssertCheck(result == SDL_WINDOW_LACKS_SHAPE, "Verify result value; expected: %d, got: %d", SDL_WINDOW_LACKS_SHAPE, result);
+
+  /* An opaque square in a transparent window */
+  SDL_FillRect(shape, NULL, SDL_MapRGBA(shape->format, 0, 0, 0, 0));
+  rect.x = w / 4;
+  rect.y = h / 4;
+  rect.w = w / 2;
+  rect.h = h / 2;
+  SDL_FillRect(shape, &rect, SDL_MapRGBA(shape->format, 0xFF, 0xFF, 0xFF, 0xFF));
+  mode.mode = ShapeModeBinarizeAlpha;
+  mode.parameters.binarizationCutoff = 128;
+  result = SDL_SetWindowShape(window, shape, &mode);
+  SDLTest_AssertPass("Call to SDL_SetWindowShape()");
+  SDLTest_AssertCheck(result == 0, "Verify result value; expected: 0, got: %d", result);
+
+  /* Parts of the shape changing, some reaching outside it */
+  for (i = 0; i < 20; i++) {
+    rect.x = SDLTest_RandomIntegerInRange(-8, w);
+    rect.y = SDLTest_RandomIntegerInRange(-8, h);
+    rect.w = SDLTest_RandomIntegerInRange(1, w / 2);
+    rect.h = SDLTest_RandomIntegerInRange(1, h / 2);
+    SDL_FillRect(shape, &rect, SDL_MapRGBA(shape->format, 0xFF, 0xFF, 0xFF, SDLTest_RandomUint8()));
+    result = SDL_UpdateWindowShape(window, shape, &rect);
+    SDLTest_AssertCheck(result == 0, "Verify SDL_UpdateWindowShape() result for %d,%d %dx%d; expected: 0, got: %d", rect.x, rect.y, rect.w, rect.h, result);
+  }
+  result = SDL_UpdateWindowShape(window, shape, NULL);
+  SDLTest_AssertPass("Call to SDL_UpdateWindowShape() with the whole shape");
+  SDLTest_AssertCheck(result == 0, "Verify result value; expected: 0, got: %d", result);
+
+  /* The mode the shape was set with is kept */
+  result = SDL_GetShapedWindowMode(window, &result_mode);
+  SDLTest_AssertPass("Call to SDL_GetShapedWindowMode()");
+  SDLTest_AssertCheck(result == 0, "Verify result value; expected: 0, got: %d", result);
+  SDLTest_AssertCheck(result_mode.mode == ShapeModeBinarizeAlpha && result_mode.parameters.binarizationCutoff == 128,
+    "Verify shape mode; expected: %d with cutoff 128, got: %d with cutoff %d", ShapeModeBinarizeAlpha,
+    result_mode.mode, result_mode.parameters.binarizationCutoff);
+
+  /* Negative cases */
+  result = SDL_UpdateWindowShape(NULL, shape, NULL);
+  SDLTest_AssertPass("Call to SDL_UpdateWindowShape() with NULL window");
+  SDLTest_AssertCheck(result == SDL_NONSHAPEABLE_WINDOW, "Verify result value; expected: %d, got: %d", SDL_NONSHAPEABLE_WINDOW, result);
+  result = SDL_UpdateWindowShape(window, NULL, NULL);
+  SDLTest_AssertPass("Call to SDL_UpdateWindowShape() with NULL shape");
+  SDLTest_AssertCheck(result == SDL_INVALID_SHAPE_ARGUMENT, "Verify result value; expected: %d, got: %d", SDL_INVALID_SHAPE_ARGUMENT, result);
+
+  SDL_FreeSurface(shape);
+  SDL_DestroyWindow(window);
+
+  return TEST_COMPLETED;
+}
+
+/**
+ * @brief Tests that presenting a shaped window leaves out what the shape hides
+ */
+int
+video_presentShapedWindow(void *arg)
+{
+  const int w = 64, h = 48;
+  const struct {
+    const char *name;
+    SDL_Rect rect;
+    Uint8 alpha;
+  } updates[] = {
+    { "a hole in the square", { 24, 18, 8, 8 }, 0x00 },
+    { "a strip crossing the edge", { -8, 40, 40, 16 }, 0xFF },
+    { "the hole filled again", { 24, 18, 8, 8 }, 0xFF }
+  };
+  _presentCoverageData data;
+  SDL_Window* window;
+  SDL_Surface* shape;
+  SDL_Surface* surface;
+  SDL_WindowShapeMode mode;
+  SDL_Rect rect, full;
+  Uint32 pixel;
+  int u, x, y, shown, result, mismatches;
+
+  window = SDL_CreateShapedWindow("video_presentShapedWindow Test Window", 0, 0, w, h, 0);
+  SDLTest_AssertPass("Call to SDL_CreateShapedWindow()");
+  if (window == NULL) {
+    SDLTest_Log("Shaped windows are not supported: %s", SDL_GetError());
+    return TEST_SKIPPED;
+  }
+  shape = SDL_CreateRGBSurfaceWithFormat(0, w, h, 0, SDL_PIXELFORMAT_ARGB8888);
+  SDLTest_AssertCheck(shape != NULL, "Verify shape surface is not NULL");
+  surface = SDL_GetWindowSurface(window);
+  SDLTest_AssertPass("Call to SDL_GetWindowSurface()");
+  SDLTest_AssertCheck(surface != NULL, "Verify surface is not NULL");
+  SDL_zero(data);
+  data.w = w;
+  data.h = h;
+  data.covered = (Uint8 *)SDL_malloc(w * h);
+  SDLTest_AssertCheck(data.covered != NULL, "Verify allocations");
+  if (shape == NULL || surface == NULL || data.covered == NULL) {
+    SDL_FreeSurface(shape);
+    SDL_free(data.covered);
+    SDL_DestroyWindow(window);
+    return TEST_ABORTED;
+  }
+
+  /* An opaque square in a transparent window */
+  SDL_FillRect(shape, NULL, SDL_MapRGBA(shape->format, 0, 0, 0, 0));
+  rect.x = w / 4;
+  rect.y = h / 4;
+  rect.w = w / 2;
+  rect.h = h / 2;
+  SDL_FillRect(shape, &rect, SDL_MapRGBA(shape->format, 0xFF, 0xFF, 0xFF, 0xFF));
+  mode.mode = ShapeModeBinarizeAlpha;
+  mode.parameters.binarizationCutoff = 128;
+  result = SDL_SetWindowShape(window, shape, &mode);
+  SDLTest_AssertPass("Call to SDL_SetWindowShape()");
+  SDLTest_AssertCheck(result == 0, "Verify result value; expected: 0, got: %d", result);
+
+  full.x = 0;
+  full.y = 0;
+  full.w = w;
+  full.h = h;
+  SDL_SetWindowPresentCallback(window, _presentCoverageCallback, &data);
+  for (u = -1; u < (int)SDL_arraysize(updates); u++) {
+    if (u >= 0) {
+      SDL_FillRect(shape, &updates[u].rect, SDL_MapRGBA(shape->format, 0xFF, 0xFF, 0xFF, updates[u].alpha));
+      result = SDL_UpdateWindowShape(window, shape, &updates[u].rect);
+      SDLTest_AssertPass("Call to SDL_UpdateWindowShape() with %s", updates[u].name);
+      SDLTest_AssertCheck(result == 0, "Verify result value; expected: 0, got: %d", result);
+    }
+
+    SDL_memset(data.covered, 0, w * h);
+    data.numrects = -1;
+    data.outside = 0;
+    result = SDL_UpdateWindowSurfaceRects(window, &full, 1);
+    SDLTest_AssertPass("Call to SDL_UpdateWindowSurfaceRects() with the whole window");
+    SDLTest_AssertCheck(result == 0, "Verify result value; expected: 0, got: %d", result);
+    SDLTest_AssertCheck(data.numrects > 0, "Verify something is presented; got %d rects", data.numrects);
+    SDLTest_AssertCheck(data.outside == 0, "Verify presented rects are inside the window; got %d outside", data.outside);
+
+    /* Exactly the pixels the shape shows are presented, each once */
+    mismatches = 0;
+    for (y = 0; y < h; y++) {
+      for (x = 0; x < w; x++) {
+        pixel = ((Uint32 *)((Uint8 *)shape->pixels + y * shape->pitch))[x];
+        shown = ((pixel >> 24) >= 128) ? 1 : 0;
+        if (data.covered[y * w + x] != shown) {
+          mismatches++;
+        }
+      }
+    }
+    SDLTest_AssertCheck(mismatches == 0, "Verify exactly the opaque pixels are presented once; %d mismatches", mismatches);
+  }
+
+  SDL_free(data.covered);
+  SDL_FreeSurface(shape);
+  SDL_DestroyWindow(window);
+
+  return TEST_COMPLETED;
+}
+
 
 /* ================= Test References ================== */
 
@@ -1793,13 +2395,32 @@ static const SDLTest_TestCaseReference videoTest22 =
 static const SDLTest_TestCaseReference videoTest23 =
         { (SDLTest_TestCaseFp)video_getSetWindowData, "video_getSetWindowData",  "Checks SDL_SetWindowData and SDL_GetWindowData positive and negative cases", TEST_ENABLED };
 
+static const SDLTest_TestCaseReference videoTest24 =
+        { (SDLTest_TestCaseFp)video_updateWindowSurfaceDamage, "video_updateWindowSurfaceDamage",  "Checks SDL_UpdateWindowSurface and SDL_UpdateWindowSurfaceRects with and without damage tracking", TEST_ENABLED };
+
+static const SDLTest_TestCaseReference videoTest25 =
+        { (SDLTest_TestCaseFp)video_setWindowPresentCallback, "video_setWindowPresentCallback",  "Checks the callback set with SDL_SetWindowPresentCallback", TEST_ENABLED };
+
+static const SDLTest_TestCaseReference videoTest26 =
+        { (SDLTest_TestCaseFp)video_updateWindowSurfaceManyRects, "video_updateWindowSurfaceManyRects",  "Checks SDL_UpdateWindowSurfaceRects presents many overlapping rects once each", TEST_ENABLED };
+
+static const SDLTest_TestCaseReference videoTest27 =
+        { (SDLTest_TestCaseFp)video_setUpdateWindowShape, "video_setUpdateWindowShape",  "Checks SDL_SetWindowShape and SDL_UpdateWindowShape", TEST_ENABLED };
+
+static const SDLTest_TestCaseReference videoTest28 =
+        { (SDLTest_TestCaseFp)video_updateWindowSurfaceFewRects, "video_updateWindowSurfaceFewRects",  "Checks SDL_UpdateWindowSurfaceRects with empty, disjoint and adjoining rects", TEST_ENABLED };
+
+static const SDLTest_TestCaseReference videoTest29 =
+        { (SDLTest_TestCaseFp)video_presentShapedWindow, "video_presentShapedWindow",  "Checks presenting a shaped window leaves out what the shape hides", TEST_ENABLED };
+
 /* Sequence of Video test cases */
 static const SDLTest_TestCaseReference *videoTests[] =  {
     &videoTest1, &videoTest2, &videoTest3, &videoTest4, &videoTest5, &videoTest6,
     &videoTest7, &videoTest8, &videoTest9, &videoTest10, &videoTest11, &videoTest12,
     &videoTest13, &videoTest14, &videoTest15, &videoTest16, &videoTest17,
     &videoTest18, &videoTest19, &videoTest20, &videoTest21, &videoTest22,
-    &videoTest23, NULL
+    &videoTest23, &videoTest24, &videoTest25, &videoTest26, &videoTest27,
+    &videoTest28, &videoTest29, NULL
 };
 
 /* Video test suite (global) */
@@ -0,0 +1,114 @@
+/*
+  Copyright (C) 1997-2017 Sam Lantinga <slouken@libsdl.org>
+
+  This software is provided 'as-is', without any express or implied
+  warranty.  In no event will the authors be held liable for any damages
+  arising from the use of this software.
+
+  Permission is granted to anyone to use this software for any purpose,
+  including commercial applications, and to alter it and redistribute it
+  freely.
+*/
+
+/* Runs one of the benchmarks below, or lists them without arguments:
+     testbench <benchmark> [arguments...]
+ */
+
+#include "testbench.h"
+
+static const BenchReference benchmarks[] = {
+    { "streambatch", "[num_streams] [iterations] [max_threads]",
+      "SDL_AudioStreamPutBatch() over increasing thread counts", Bench_StreamBatch },
+    { "audio", "[--csv] [--ms milliseconds_per_case]",
+      "Audio format conversion, resampling and mixing", Bench_Audio },
+    { "convert", "[width height] [iterations]",
+      "SDL_ConvertPixels() between the 24 and 32-bit RGB formats", Bench_Convert },
+    { "blitthreads", "[iterations] [max_threads]",
+      "Large blits and conversions over increasing SDL_HINT_BLIT_THREADS", Bench_BlitThreads },
+    { "yuv", "[iterations]",
+      "YUV to RGB conversion of 1080p frames and YUV textures", Bench_YUV },
+    { "fill", "[iterations]",
+      "SDL_FillRect() and SDL_FillRects() at several sizes", Bench_Fill },
+    { "rle", "[iterations]",
+      "Encoding and blitting RLE accelerated sprites", Bench_RLE },
+    { "surface", "[iterations]",
+      "Temporary surfaces with the pixel pool, and aligned blits", Bench_Surface },
+    { "blitmap", "[iterations]",
+      "Blitting atlas tiles to several destinations in turn", Bench_BlitMap },
+    { "palette", "[iterations]",
+      "Mapping true color pixels to a 256 color palette", Bench_Palette },
+    { "format", "[iterations]",
+      "SDL_AllocFormat() and surface creation on several threads", Bench_Format },
+    { "bmp", "[--iterations N] [file.bmp...]",
+      "Loading BMP files straight into another pixel format", Bench_BMP },
+    { "damage", "[iterations]",
+      "Presenting small changes to a window surface", Bench_Damage },
+    { "headless", "[--frames N] [--windows 1-4] [--output file]",
+      "Drawing several windows with the dummy driver, without a display", Bench_Headless },
+    { "region", "[rects] [iterations]",
+      "Clipping and combining large batches of rects", Bench_Region },
+    { "shape", "[width height] [frames]",
+      "Animating the shape of a large shaped window", Bench_Shape },
+};
+
+int
+BenchIterations(int argc, char **argv, int default_iterations)
+{
+    if (argc > 1) {
+        return SDL_max(SDL_atoi(argv[1]), 0);
+    }
+    return default_iterations;
+}
+
+double
+BenchMilliseconds(Uint64 ticks)
+{
+    return ((double) ticks * 1000.0) / (double) SDL_GetPerformanceFrequency();
+}
+
+double
+BenchElapsed(Uint64 start, int iterations)
+{
+    return BenchMilliseconds(SDL_GetPerformanceCounter() - start) / iterations;
+}
+
+static void
+ListBenchmarks(const char *program)
+{
+    int i;
+
+    SDL_Log("USAGE: %s <benchmark> [arguments...]\n", program);
+    for (i = 0; i < SDL_arraysize(benchmarks); ++i) {
+        SDL_Log("  %-12s %s\n", benchmarks[i].name, benchmarks[i].description);
+    }
+}
+
+int
+main(int argc, char **argv)
+{
+    const BenchReference *bench = NULL;
+    int result;
+    int i;
+
+    /* Enable standard application logging */
+    SDL_LogSetPriority(SDL_LOG_CATEGORY_APPLICATION, SDL_LOG_PRIORITY_INFO);
+
+    for (i = 0; argc > 1 && i < SDL_arraysize(benchmarks); ++i) {
+        if (SDL_strcasecmp(argv[1], benchmarks[i].name) == 0) {
+            bench = &benchmarks[i];
+        }
+    }
+    if (!bench) {
+        ListBenchmarks(argv[0]);
+        return 1;
+    }
+
+    result = bench->run(argc - 1, argv + 1);
+    if (result == 1) {
+        SDL_Log("USAGE: %s %s %s\n", argv[0], bench->name, bench->usage);
+    }
+    SDL_Quit();
+    return result;
+}
+
+/* vi: set ts=4 sw=4 expandtab: */
@@ -0,0 +1,69 @@
+/*
+  Copyright (C) 1997-2017 Sam Lantinga <slouken@libsdl.org>
+
+  This software is provided 'as-is', without any express or implied
+  warranty.  In no event will the authors be held liable for any damages
+  arising from the use of this software.
+
+  Permission is granted to anyone to use this software for any purpose,
+  including commercial applications, and to alter it and redistribute it
+  freely.
+*/
+
+/* Benchmarks run by testbench, see testbench.c */
+
+#ifndef _testbench_h
+#define _testbench_h
+
+#include "SDL.h"
+
+/* Runs a benchmark, argv[0] being its name. Returns 0 when done, 1 when
+   the arguments are wrong, so the driver shows the usage, or another
+   non-zero value when the benchmark failed. */
+typedef int (*BenchFunc)(int argc, char **argv);
+
+typedef struct BenchReference
+{
+    const char *name;
+    const char *usage;
+    const char *description;
+    BenchFunc run;
+} BenchReference;
+
+/* Returns the iteration count given as the first argument, or
+   default_iterations without one; 0 if the count isn't positive. */
+extern int BenchIterations(int argc, char **argv, int default_iterations);
+
+/* Converts performance counter ticks to milliseconds */
+extern double BenchMilliseconds(Uint64 ticks);
+
+/* Milliseconds per iteration since start, a performance counter value */
+extern double BenchElapsed(Uint64 start, int iterations);
+
+/* testbench_audio.c */
+extern int Bench_StreamBatch(int argc, char **argv);
+extern int Bench_Audio(int argc, char **argv);
+
+/* testbench_pixels.c */
+extern int Bench_Convert(int argc, char **argv);
+extern int Bench_YUV(int argc, char **argv);
+extern int Bench_Palette(int argc, char **argv);
+extern int Bench_Format(int argc, char **argv);
+
+/* testbench_surface.c */
+extern int Bench_BlitThreads(int argc, char **argv);
+extern int Bench_Fill(int argc, char **argv);
+extern int Bench_RLE(int argc, char **argv);
+extern int Bench_Surface(int argc, char **argv);
+extern int Bench_BlitMap(int argc, char **argv);
+extern int Bench_BMP(int argc, char **argv);
+
+/* testbench_video.c */
+extern int Bench_Damage(int argc, char **argv);
+extern int Bench_Headless(int argc, char **argv);
+extern int Bench_Region(int argc, char **argv);
+extern int Bench_Shape(int argc, char **argv);
+
+#endif /* _testbench_h */
+
+/* vi: set ts=4 sw=4 expandtab: */
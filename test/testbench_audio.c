@@ -0,0 +1,423 @@
+/*
+  Copyright (C) 1997-2017 Sam Lantinga <slouken@libsdl.org>
+
+  This software is provided 'as-is', without any express or implied
+  warranty.  In no event will the authors be held liable for any damages
+  arising from the use of this software.
+
+  Permission is granted to anyone to use this software for any purpose,
+  including commercial applications, and to alter it and redistribute it
+  freely.
+*/
+
+/* Audio benchmarks run by testbench */
+
+#include <stdio.h>
+
+#include "testbench.h"
+
+/* Measures how SDL_AudioStreamPutBatch() scales with the number of threads.
+   Every stream gets the same 10ms chunk of 44.1kHz stereo Sint16 audio,
+   resampled to 48kHz float, like a server mixing many voices would. */
+
+#define BATCH_SRC_RATE 44100
+#define BATCH_DST_RATE 48000
+#define BATCH_FRAMES (BATCH_SRC_RATE / 100)
+
+int
+Bench_StreamBatch(int argc, char **argv)
+{
+    const Uint32 chunklen = BATCH_FRAMES * 2 * sizeof (Sint16);
+    int num_streams = 256;
+    int iterations = 100;
+    int max_threads = SDL_GetCPUCount();
+    SDL_AudioStream **streams;
+    const void **bufs;
+    Uint32 *lens;
+    Sint16 *chunk;
+    Uint8 *drain;
+    int threads, i, j;
+
+    if (argc > 1) {
+        num_streams = SDL_atoi(argv[1]);
+    }
+    if (argc > 2) {
+        iterations = SDL_atoi(argv[2]);
+    }
+    if (argc > 3) {
+        max_threads = SDL_atoi(argv[3]);
+    }
+    if ((num_streams <= 0) || (iterations <= 0) || (max_threads <= 0)) {
+        return 1;
+    }
+
+    streams = (SDL_AudioStream **) SDL_calloc(num_streams, sizeof (SDL_AudioStream *));
+    bufs = (const void **) SDL_calloc(num_streams, sizeof (void *));
+    lens = (Uint32 *) SDL_calloc(num_streams, sizeof (Uint32));
+    chunk = (Sint16 *) SDL_malloc(chunklen);
+    drain = (Uint8 *) SDL_malloc(chunklen * 4);
+    if (!streams || !bufs || !lens || !chunk || !drain) {
+        SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "Out of memory!\n");
+        return 2;
+    }
+
+    for (i = 0; i < BATCH_FRAMES * 2; i++) {
+        chunk[i] = (Sint16) ((i * 37) & 0x7FFF);
+    }
+
+    for (i = 0; i < num_streams; i++) {
+        streams[i] = SDL_NewAudioStream(AUDIO_S16SYS, 2, BATCH_SRC_RATE, AUDIO_F32SYS, 2, BATCH_DST_RATE);
+        if (!streams[i]) {
+            SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "SDL_NewAudioStream failed: %s\n", SDL_GetError());
+            return 3;
+        }
+        bufs[i] = chunk;
+        lens[i] = chunklen;
+    }
+
+    SDL_Log("%d streams, %d iterations of %d frames\n", num_streams, iterations, BATCH_FRAMES);
+
+    for (threads = 1; ; threads = SDL_min(threads * 2, max_threads)) {
+        char hint[16];
+        Uint64 start;
+
+        SDL_snprintf(hint, sizeof (hint), "%d", threads);
+        SDL_SetHint(SDL_HINT_AUDIO_STREAM_BATCH_THREADS, hint);
+
+        start = SDL_GetPerformanceCounter();
+        for (i = 0; i < iterations; i++) {
+            if (SDL_AudioStreamPutBatch(streams, bufs, lens, num_streams) < 0) {
+                SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "SDL_AudioStreamPutBatch failed: %s\n", SDL_GetError());
+                return 4;
+            }
+            for (j = 0; j < num_streams; j++) {
+                while (SDL_AudioStreamGet(streams[j], drain, chunklen * 4) > 0) {
+                    /* throw the converted data away. */
+                }
+            }
+        }
+
+        SDL_Log("%2d threads: %8.3f ms per batch\n", threads, BenchElapsed(start, iterations));
+
+        if (threads == max_threads) {
+            break;
+        }
+    }
+
+    for (i = 0; i < num_streams; i++) {
+        SDL_FreeAudioStream(streams[i]);
+    }
+    SDL_free(drain);
+    SDL_free(chunk);
+    SDL_free(lens);
+    SDL_free(bufs);
+    SDL_free(streams);
+    return 0;
+}
+
+/* Throughput benchmark for SDL_ConvertAudio(), SDL_AudioStream and
+   SDL_MixAudioFormat().
+
+   Sweeps every sample format pair, the supported channel layouts and a set
+   of common rate pairs, and reports MB/s (of source data) and ns per
+   sample frame for each case. Use --csv to get one machine-readable line
+   per case on stdout for regression tracking.
+
+   The "path" column names the converter implementation SDL picks on this
+   CPU, and for SDL_AudioStream resampling, the SDL_HINT_AUDIO_RESAMPLING_MODE
+   setting in effect (libsamplerate is only used for modes other than
+   "default", and only if SDL was built with it). */
+
+#define BENCH_FRAMES 4096
+
+static SDL_bool csv = SDL_FALSE;
+static double min_seconds = 0.05;
+static const char *simd_path = "scalar";
+
+static const struct
+{
+    SDL_AudioFormat format;
+    const char *name;
+} formats[] = {
+    { AUDIO_U8, "U8" },
+    { AUDIO_S8, "S8" },
+    { AUDIO_U16LSB, "U16LSB" },
+    { AUDIO_S16LSB, "S16LSB" },
+    { AUDIO_U16MSB, "U16MSB" },
+    { AUDIO_S16MSB, "S16MSB" },
+    { AUDIO_S32LSB, "S32LSB" },
+    { AUDIO_S32MSB, "S32MSB" },
+    { AUDIO_F32LSB, "F32LSB" },
+    { AUDIO_F32MSB, "F32MSB" }
+};
+
+static const Uint8 channel_layouts[] = { 1, 2, 4, 6 };
+
+static const struct
+{
+    int src;
+    int dst;
+} rates[] = {
+    { 22050, 44100 },
+    { 44100, 48000 },
+    { 48000, 44100 },
+    { 44100, 22050 },
+    { 48000, 96000 },
+    { 96000, 48000 }
+};
+
+static const char *
+FormatName(const SDL_AudioFormat format)
+{
+    int i;
+    for (i = 0; i < SDL_arraysize(formats); i++) {
+        if (formats[i].format == format) {
+            return formats[i].name;
+        }
+    }
+    return "???";
+}
+
+static int
+FrameSize(const SDL_AudioFormat format, const Uint8 channels)
+{
+    return (SDL_AUDIO_BITSIZE(format) / 8) * channels;
+}
+
+/* Fill with a low-amplitude ramp; the benchmarks don't care what it sounds like. */
+static void
+FillSource(Uint8 *buf, const int len)
+{
+    int i;
+    for (i = 0; i < len; i++) {
+        buf[i] = (Uint8) ((i * 7) & 0x3F);
+    }
+}
+
+static void
+Report(const char *bench, const SDL_AudioFormat src_format, const Uint8 src_channels, const int src_rate,
+       const SDL_AudioFormat dst_format, const Uint8 dst_channels, const int dst_rate,
+       const char *path, const Uint64 frames, const Uint64 bytes, const Uint64 ticks)
+{
+    const double seconds = (double) ticks / (double) SDL_GetPerformanceFrequency();
+    const double mbps = (seconds > 0.0) ? ((double) bytes / (1024.0 * 1024.0)) / seconds : 0.0;
+    const double nsframe = (frames > 0) ? (seconds * 1000000000.0) / (double) frames : 0.0;
+
+    if (csv) {
+        printf("%s,%s,%d,%d,%s,%d,%d,%s,%.2f,%.3f\n", bench,
+                FormatName(src_format), (int) src_channels, src_rate,
+                FormatName(dst_format), (int) dst_channels, dst_rate,
+                path, mbps, nsframe);
+    } else {
+        SDL_Log("%-7s %6s/%d/%-5d -> %6s/%d/%-5d %-16s %10.2f MB/s %9.3f ns/frame\n", bench,
+                FormatName(src_format), (int) src_channels, src_rate,
+                FormatName(dst_format), (int) dst_channels, dst_rate,
+                path, mbps, nsframe);
+    }
+}
+
+static void
+BenchConvert(const SDL_AudioFormat src_format, const Uint8 src_channels, const int src_rate,
+             const SDL_AudioFormat dst_format, const Uint8 dst_channels, const int dst_rate)
+{
+    const int srclen = BENCH_FRAMES * FrameSize(src_format, src_channels);
+    const Uint64 limit = (Uint64) (min_seconds * SDL_GetPerformanceFrequency());
+    Uint64 ticks = 0, frames = 0, bytes = 0;
+    Uint8 *src;
+    SDL_AudioCVT cvt;
+    int rc;
+
+    rc = SDL_BuildAudioCVT(&cvt, src_format, src_channels, src_rate, dst_format, dst_channels, dst_rate);
+    if (rc < 0) {
+        return;  /* not a supported conversion; nothing to measure. */
+    } else if (rc == 0) {
+        return;  /* no conversion needed. */
+    }
+
+    src = (Uint8 *) SDL_malloc(srclen);
+    cvt.buf = (Uint8 *) SDL_malloc(srclen * cvt.len_mult);
+    if (!src || !cvt.buf) {
+        SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "Out of memory!\n");
+        SDL_free(cvt.buf);
+        SDL_free(src);
+        return;
+    }
+    FillSource(src, srclen);
+
+    /* SDL_ConvertAudio() works in-place, so only the conversion itself is timed. */
+    while (ticks < limit) {
+        Uint64 start;
+        SDL_memcpy(cvt.buf, src, srclen);
+        cvt.len = srclen;
+        start = SDL_GetPerformanceCounter();
+        SDL_ConvertAudio(&cvt);
+        ticks += SDL_GetPerformanceCounter() - start;
+        frames += BENCH_FRAMES;
+        bytes += srclen;
+    }
+
+    Report("convert", src_format, src_channels, src_rate, dst_format, dst_channels, dst_rate,
+           simd_path, frames, bytes, ticks);
+
+    SDL_free(cvt.buf);
+    SDL_free(src);
+}
+
+static void
+BenchStream(const SDL_AudioFormat src_format, const Uint8 src_channels, const int src_rate,
+            const SDL_AudioFormat dst_format, const Uint8 dst_channels, const int dst_rate,
+            const char *path)
+{
+    const int srclen = BENCH_FRAMES * FrameSize(src_format, src_channels);
+    const int drainlen = BENCH_FRAMES * 8 * FrameSize(dst_format, dst_channels);
+    const Uint64 limit = (Uint64) (min_seconds * SDL_GetPerformanceFrequency());
+    Uint64 ticks = 0, frames = 0, bytes = 0;
+    SDL_AudioStream *stream;
+    Uint8 *src, *drain;
+
+    stream = SDL_NewAudioStream(src_format, src_channels, src_rate, dst_format, dst_channels, dst_rate);
+    if (!stream) {
+        return;
+    }
+
+    src = (Uint8 *) SDL_malloc(srclen);
+    drain = (Uint8 *) SDL_malloc(drainlen);
+    if (!src || !drain) {
+        SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "Out of memory!\n");
+        SDL_free(drain);
+        SDL_free(src);
+        SDL_FreeAudioStream(stream);
+        return;
+    }
+    FillSource(src, srclen);
+
+    while (ticks < limit) {
+        const Uint64 start = SDL_GetPerformanceCounter();
+        SDL_AudioStreamPut(stream, src, srclen);
+        while (SDL_AudioStreamGet(stream, drain, drainlen) > 0) {
+            /* throw the converted data away. */
+        }
+        ticks += SDL_GetPerformanceCounter() - start;
+        frames += BENCH_FRAMES;
+        bytes += srclen;
+    }
+
+    Report("stream", src_format, src_channels, src_rate, dst_format, dst_channels, dst_rate,
+           path, frames, bytes, ticks);
+
+    SDL_free(drain);
+    SDL_free(src);
+    SDL_FreeAudioStream(stream);
+}
+
+static void
+BenchMix(const SDL_AudioFormat format)
+{
+    const int len = BENCH_FRAMES * FrameSize(format, 2);
+    const Uint64 limit = (Uint64) (min_seconds * SDL_GetPerformanceFrequency());
+    Uint64 ticks = 0, frames = 0, bytes = 0;
+    Uint8 *src, *dst;
+
+    src = (Uint8 *) SDL_malloc(len);
+    dst = (Uint8 *) SDL_malloc(len);
+    if (!src || !dst) {
+        SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "Out of memory!\n");
+        SDL_free(dst);
+        SDL_free(src);
+        return;
+    }
+    FillSource(src, len);
+    FillSource(dst, len);
+
+    while (ticks < limit) {
+        const Uint64 start = SDL_GetPerformanceCounter();
+        SDL_MixAudioFormat(dst, src, format, len, SDL_MIX_MAXVOLUME / 2);
+        ticks += SDL_GetPerformanceCounter() - start;
+        frames += BENCH_FRAMES;
+        bytes += len;
+    }
+
+    Report("mix", format, 2, 48000, format, 2, 48000, "scalar", frames, bytes, ticks);
+
+    SDL_free(dst);
+    SDL_free(src);
+}
+
+int
+Bench_Audio(int argc, char **argv)
+{
+    const char *resampling_modes[] = { "default", "fast", "medium", "best" };
+    int i, j, k;
+
+    for (i = 1; i < argc; i++) {
+        if (SDL_strcmp(argv[i], "--csv") == 0) {
+            csv = SDL_TRUE;
+        } else if ((SDL_strcmp(argv[i], "--ms") == 0) && (i + 1 < argc)) {
+            min_seconds = SDL_atoi(argv[++i]) / 1000.0;
+        } else {
+            return 1;
+        }
+    }
+
+    /* This mirrors how SDL_audiotypecvt.c picks its converters. */
+    if (SDL_HasSSE2()) {
+        simd_path = "sse2";
+    }
+
+    if (csv) {
+        printf("bench,src_format,src_channels,src_rate,dst_format,dst_channels,dst_rate,path,mb_per_sec,ns_per_frame\n");
+    }
+
+    /* every format pair, stereo, no resampling. */
+    for (i = 0; i < SDL_arraysize(formats); i++) {
+        for (j = 0; j < SDL_arraysize(formats); j++) {
+            BenchConvert(formats[i].format, 2, 48000, formats[j].format, 2, 48000);
+        }
+    }
+
+    /* channel layouts, in the two most common formats. */
+    for (i = 0; i < SDL_arraysize(channel_layouts); i++) {
+        for (j = 0; j < SDL_arraysize(channel_layouts); j++) {
+            if (i != j) {
+                BenchConvert(AUDIO_F32SYS, channel_layouts[i], 48000, AUDIO_F32SYS, channel_layouts[j], 48000);
+                BenchConvert(AUDIO_S16SYS, channel_layouts[i], 48000, AUDIO_S16SYS, channel_layouts[j], 48000);
+            }
+        }
+    }
+
+    /* rate pairs, through both SDL_AudioCVT and SDL_AudioStream. */
+    for (i = 0; i < SDL_arraysize(rates); i++) {
+        BenchConvert(AUDIO_S16SYS, 2, rates[i].src, AUDIO_S16SYS, 2, rates[i].dst);
+        BenchConvert(AUDIO_F32SYS, 2, rates[i].src, AUDIO_F32SYS, 2, rates[i].dst);
+        BenchConvert(AUDIO_S16SYS, 2, rates[i].src, AUDIO_F32SYS, 6, rates[i].dst);
+    }
+
+    /* SDL_AudioStream only picks up libsamplerate when the audio subsystem
+       is initialized, so run the stream sweep once per resampling mode. */
+    for (k = 0; k < SDL_arraysize(resampling_modes); k++) {
+        char path[32];
+
+        SDL_SetHint(SDL_HINT_AUDIO_RESAMPLING_MODE, resampling_modes[k]);
+        if (SDL_AudioInit("dummy") < 0) {
+            SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "Couldn't initialize dummy audio driver: %s\n", SDL_GetError());
+            return 2;
+        }
+
+        SDL_snprintf(path, sizeof (path), "%s+%s", simd_path, resampling_modes[k]);
+        for (i = 0; i < SDL_arraysize(rates); i++) {
+            BenchStream(AUDIO_S16SYS, 2, rates[i].src, AUDIO_S16SYS, 2, rates[i].dst, path);
+            BenchStream(AUDIO_F32SYS, 2, rates[i].src, AUDIO_F32SYS, 2, rates[i].dst, path);
+            BenchStream(AUDIO_S16SYS, 2, rates[i].src, AUDIO_F32SYS, 6, rates[i].dst, path);
+        }
+
+        SDL_AudioQuit();
+    }
+
+    for (i = 0; i < SDL_arraysize(formats); i++) {
+        BenchMix(formats[i].format);
+    }
+
+    return 0;
+}
+
+/* vi: set ts=4 sw=4 expandtab: */
@@ -0,0 +1,425 @@
+/*
+  Copyright (C) 1997-2017 Sam Lantinga <slouken@libsdl.org>
+
+  This software is provided 'as-is', without any express or implied
+  warranty.  In no event will the authors be held liable for any damages
+  arising from the use of this software.
+
+  Permission is granted to anyone to use this software for any purpose,
+  including commercial applications, and to alter it and redistribute it
+  freely.
+*/
+
+/* Pixel format benchmarks run by testbench */
+
+#include "testbench.h"
+
+/* Measures SDL_ConvertPixels() throughput between the 24 and 32-bit RGB
+   formats, in megapixels per second. */
+
+static const Uint32 convert_formats[] = {
+    SDL_PIXELFORMAT_RGB24,
+    SDL_PIXELFORMAT_BGR24,
+    SDL_PIXELFORMAT_RGB888,
+    SDL_PIXELFORMAT_BGR888,
+    SDL_PIXELFORMAT_ARGB8888,
+    SDL_PIXELFORMAT_RGBA8888,
+    SDL_PIXELFORMAT_ABGR8888,
+    SDL_PIXELFORMAT_BGRA8888,
+};
+
+int
+Bench_Convert(int argc, char **argv)
+{
+    int width = 1920;
+    int height = 1080;
+    int iterations = 20;
+    Uint8 *src, *dst;
+    int i, j, k;
+
+    if (argc > 2) {
+        width = SDL_atoi(argv[1]);
+        height = SDL_atoi(argv[2]);
+    }
+    if (argc > 3) {
+        iterations = SDL_atoi(argv[3]);
+    }
+    if ((width <= 0) || (height <= 0) || (iterations <= 0)) {
+        return 1;
+    }
+
+    src = (Uint8 *) SDL_malloc(width * height * 4);
+    dst = (Uint8 *) SDL_malloc(width * height * 4);
+    if (!src || !dst) {
+        SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "Out of memory!\n");
+        return 2;
+    }
+    for (i = 0; i < width * height * 4; i++) {
+        src[i] = (Uint8) (i * 37);
+    }
+
+    SDL_Log("%dx%d, %d iterations\n", width, height, iterations);
+
+    for (i = 0; i < SDL_arraysize(convert_formats); i++) {
+        for (j = 0; j < SDL_arraysize(convert_formats); j++) {
+            const int src_pitch = width * SDL_BYTESPERPIXEL(convert_formats[i]);
+            const int dst_pitch = width * SDL_BYTESPERPIXEL(convert_formats[j]);
+            Uint64 start;
+
+            if (i == j) {
+                continue;
+            }
+
+            start = SDL_GetPerformanceCounter();
+            for (k = 0; k < iterations; k++) {
+                if (SDL_ConvertPixels(width, height, convert_formats[i], src, src_pitch,
+                                      convert_formats[j], dst, dst_pitch) < 0) {
+                    SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "SDL_ConvertPixels failed: %s\n", SDL_GetError());
+                    return 3;
+                }
+            }
+
+            SDL_Log("%-24s -> %-24s %8.1f Mpixels/s\n",
+                    SDL_GetPixelFormatName(convert_formats[i]),
+                    SDL_GetPixelFormatName(convert_formats[j]),
+                    ((double) width * height) / (BenchElapsed(start, iterations) * 1000.0));
+        }
+    }
+
+    SDL_free(dst);
+    SDL_free(src);
+    return 0;
+}
+
+/* Measures YUV to RGB conversion of 1080p video frames, both with
+   SDL_ConvertPixels() and through a YUV texture on the software renderer,
+   at 1x and 2x. */
+
+static const Uint32 yuv_formats[] = {
+    SDL_PIXELFORMAT_YV12,
+    SDL_PIXELFORMAT_IYUV,
+    SDL_PIXELFORMAT_NV12,
+    SDL_PIXELFORMAT_NV21,
+    SDL_PIXELFORMAT_YUY2,
+    SDL_PIXELFORMAT_UYVY,
+    SDL_PIXELFORMAT_YVYU,
+};
+
+static int
+GetYUVPitch(Uint32 format, int width)
+{
+    switch (format) {
+    case SDL_PIXELFORMAT_YUY2:
+    case SDL_PIXELFORMAT_UYVY:
+    case SDL_PIXELFORMAT_YVYU:
+        return width * 2;
+    default:
+        return width;
+    }
+}
+
+/* Time one frame update of a YUV texture copied to the whole target */
+static double
+TimeYUVTexture(SDL_Renderer *renderer, Uint32 format, int width, int height,
+            const Uint8 *frame, int iterations)
+{
+    SDL_Texture *texture;
+    Uint64 start;
+    int i;
+
+    texture = SDL_CreateTexture(renderer, format, SDL_TEXTUREACCESS_STREAMING, width, height);
+    if (!texture) {
+        return -1.0;
+    }
+    start = SDL_GetPerformanceCounter();
+    for (i = 0; i < iterations; ++i) {
+        SDL_UpdateTexture(texture, NULL, frame, GetYUVPitch(format, width));
+        SDL_RenderCopy(renderer, texture, NULL, NULL);
+    }
+    SDL_DestroyTexture(texture);
+    return BenchElapsed(start, iterations);
+}
+
+int
+Bench_YUV(int argc, char **argv)
+{
+    const int width = 1920;
+    const int height = 1080;
+    int iterations = 20;
+    SDL_Surface *target1x, *target2x;
+    SDL_Renderer *renderer1x, *renderer2x;
+    Uint8 *frame, *pixels;
+    int i, j;
+
+    iterations = BenchIterations(argc, argv, iterations);
+    if (!iterations) {
+        return 1;
+    }
+
+    frame = (Uint8 *) SDL_malloc(width * height * 2);
+    pixels = (Uint8 *) SDL_malloc(width * height * 4);
+    target1x = SDL_CreateRGBSurfaceWithFormat(0, width, height, 32, SDL_PIXELFORMAT_RGB888);
+    target2x = SDL_CreateRGBSurfaceWithFormat(0, width * 2, height * 2, 32, SDL_PIXELFORMAT_RGB888);
+    if (!frame || !pixels || !target1x || !target2x) {
+        SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "Couldn't allocate frames: %s\n", SDL_GetError());
+        return 2;
+    }
+    renderer1x = SDL_CreateSoftwareRenderer(target1x);
+    renderer2x = SDL_CreateSoftwareRenderer(target2x);
+    if (!renderer1x || !renderer2x) {
+        SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "Couldn't create renderers: %s\n", SDL_GetError());
+        return 2;
+    }
+    for (i = 0; i < width * height * 2; ++i) {
+        frame[i] = (Uint8) (i * 37);
+    }
+
+    SDL_Log("%dx%d frames, %d iterations\n", width, height, iterations);
+
+    for (i = 0; i < SDL_arraysize(yuv_formats); ++i) {
+        double convert, texture1x, texture2x;
+        Uint64 start = SDL_GetPerformanceCounter();
+
+        for (j = 0; j < iterations; ++j) {
+            SDL_ConvertPixels(width, height, yuv_formats[i], frame, GetYUVPitch(yuv_formats[i], width),
+                              SDL_PIXELFORMAT_ARGB8888, pixels, width * 4);
+        }
+        convert = BenchElapsed(start, iterations);
+        texture1x = TimeYUVTexture(renderer1x, yuv_formats[i], width, height, frame, iterations);
+        texture2x = TimeYUVTexture(renderer2x, yuv_formats[i], width, height, frame, iterations);
+
+        SDL_Log("%-22s convert %7.2f ms, texture 1x %7.2f ms, texture 2x %7.2f ms\n",
+                SDL_GetPixelFormatName(yuv_formats[i]), convert, texture1x, texture2x);
+    }
+
+    SDL_DestroyRenderer(renderer2x);
+    SDL_DestroyRenderer(renderer1x);
+    SDL_FreeSurface(target2x);
+    SDL_FreeSurface(target1x);
+    SDL_free(pixels);
+    SDL_free(frame);
+    return 0;
+}
+
+/* Measures mapping true color pixels to the nearest palette entry, with
+   SDL_MapRGB() and by converting a whole image to an 8-bit surface. */
+
+/* A 6x7x6 color cube, like many fixed palettes */
+static void
+FillCubePalette(SDL_Palette * palette, int seed)
+{
+    SDL_Color colors[256];
+    int i;
+
+    for (i = 0; i < 256; ++i) {
+        const int n = (i + seed) % 252;
+        colors[i].r = (Uint8) ((n / 42) * 255 / 5);
+        colors[i].g = (Uint8) (((n / 6) % 7) * 255 / 6);
+        colors[i].b = (Uint8) ((n % 6) * 255 / 5);
+        colors[i].a = 255;
+    }
+    SDL_SetPaletteColors(palette, colors, 0, 256);
+}
+
+/* A smooth gradient with some noise, like a photo */
+static SDL_Surface *
+CreatePhotoImage(int w, int h)
+{
+    SDL_Surface *image = SDL_CreateRGBSurfaceWithFormat(0, w, h, 0, SDL_PIXELFORMAT_ARGB8888);
+    Uint32 noise = 1;
+    int x, y;
+
+    if (!image) {
+        return NULL;
+    }
+    for (y = 0; y < h; ++y) {
+        Uint32 *row = (Uint32 *) ((Uint8 *) image->pixels + y * image->pitch);
+        for (x = 0; x < w; ++x) {
+            noise = noise * 1103515245 + 12345;
+            row[x] = SDL_MapRGB(image->format,
+                                (Uint8) (x * 255 / w),
+                                (Uint8) (y * 255 / h),
+                                (Uint8) (128 + ((noise >> 16) & 63)));
+        }
+    }
+    return image;
+}
+
+int
+Bench_Palette(int argc, char **argv)
+{
+    SDL_PixelFormat *format;
+    SDL_Palette *palette;
+    SDL_Surface *image;
+    int iterations = 10;
+    Uint32 sum = 0;
+    Uint64 start;
+    double mapped, warm, cold;
+    int i, x, y;
+
+    iterations = BenchIterations(argc, argv, iterations);
+    if (!iterations) {
+        return 1;
+    }
+
+    format = SDL_AllocFormat(SDL_PIXELFORMAT_INDEX8);
+    palette = SDL_AllocPalette(256);
+    image = CreatePhotoImage(640, 480);
+    if (!format || !palette || !image) {
+        SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "Couldn't create image: %s\n", SDL_GetError());
+        return 2;
+    }
+    FillCubePalette(palette, 0);
+    SDL_SetPixelFormatPalette(format, palette);
+
+    /* Every pixel through SDL_MapRGB() */
+    start = SDL_GetPerformanceCounter();
+    for (i = 0; i < iterations; ++i) {
+        for (y = 0; y < image->h; ++y) {
+            const Uint32 *row = (const Uint32 *) ((Uint8 *) image->pixels + y * image->pitch);
+            for (x = 0; x < image->w; ++x) {
+                sum += SDL_MapRGB(format, (Uint8) (row[x] >> 16), (Uint8) (row[x] >> 8), (Uint8) row[x]);
+            }
+        }
+    }
+    mapped = BenchElapsed(start, iterations);
+
+    /* Converting with the same palette each time */
+    start = SDL_GetPerformanceCounter();
+    for (i = 0; i < iterations; ++i) {
+        SDL_Surface *converted = SDL_ConvertSurface(image, format, 0);
+        if (!converted) {
+            SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "Couldn't convert image: %s\n", SDL_GetError());
+            return 2;
+        }
+        sum += ((Uint8 *) converted->pixels)[i];
+        SDL_FreeSurface(converted);
+    }
+    warm = BenchElapsed(start, iterations);
+
+    /* Converting with a changed palette each time */
+    start = SDL_GetPerformanceCounter();
+    for (i = 0; i < iterations; ++i) {
+        SDL_Surface *converted;
+
+        FillCubePalette(palette, i + 1);
+        converted = SDL_ConvertSurface(image, format, 0);
+        if (!converted) {
+            SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "Couldn't convert image: %s\n", SDL_GetError());
+            return 2;
+        }
+        sum += ((Uint8 *) converted->pixels)[i];
+        SDL_FreeSurface(converted);
+    }
+    cold = BenchElapsed(start, iterations);
+
+    SDL_Log("640x480 to 256 colors: SDL_MapRGB %8.4f ms, convert %8.4f ms, convert with new palette %8.4f ms (%u)\n",
+            mapped, warm, cold, (unsigned int) sum);
+
+    SDL_FreeSurface(image);
+    SDL_FreePalette(palette);
+    SDL_FreeFormat(format);
+    return 0;
+}
+
+/* Measures looking up pixel formats with SDL_AllocFormat(), and creating
+   small surfaces of many formats from several threads at once. */
+
+#define FORMAT_THREADS 4
+
+static const Uint32 pixel_formats[] = {
+    SDL_PIXELFORMAT_RGB332,
+    SDL_PIXELFORMAT_RGB444,
+    SDL_PIXELFORMAT_RGB555,
+    SDL_PIXELFORMAT_BGR555,
+    SDL_PIXELFORMAT_ARGB4444,
+    SDL_PIXELFORMAT_RGBA4444,
+    SDL_PIXELFORMAT_ABGR4444,
+    SDL_PIXELFORMAT_BGRA4444,
+    SDL_PIXELFORMAT_ARGB1555,
+    SDL_PIXELFORMAT_RGBA5551,
+    SDL_PIXELFORMAT_ABGR1555,
+    SDL_PIXELFORMAT_BGRA5551,
+    SDL_PIXELFORMAT_RGB565,
+    SDL_PIXELFORMAT_BGR565,
+    SDL_PIXELFORMAT_RGB24,
+    SDL_PIXELFORMAT_BGR24,
+    SDL_PIXELFORMAT_RGB888,
+    SDL_PIXELFORMAT_RGBX8888,
+    SDL_PIXELFORMAT_BGR888,
+    SDL_PIXELFORMAT_BGRX8888,
+    SDL_PIXELFORMAT_ARGB8888,
+    SDL_PIXELFORMAT_RGBA8888,
+    SDL_PIXELFORMAT_ABGR8888,
+    SDL_PIXELFORMAT_BGRA8888,
+    SDL_PIXELFORMAT_ARGB2101010,
+};
+
+static int format_iterations = 100000;
+static SDL_atomic_t format_failures;
+
+static int SDLCALL
+CreateSurfaces(void *data)
+{
+    const int offset = (int) (size_t) data;
+    int i;
+
+    for (i = 0; i < format_iterations / 10; ++i) {
+        const Uint32 pixel_format = pixel_formats[(i + offset) % SDL_arraysize(pixel_formats)];
+        SDL_Surface *surface = SDL_CreateRGBSurfaceWithFormat(0, 4, 4, 0, pixel_format);
+
+        if (!surface || surface->format->format != pixel_format) {
+            SDL_AtomicIncRef(&format_failures);
+        }
+        SDL_FreeSurface(surface);
+    }
+    return 0;
+}
+
+int
+Bench_Format(int argc, char **argv)
+{
+    SDL_PixelFormat *held[SDL_arraysize(pixel_formats)];
+    SDL_Thread *threads[FORMAT_THREADS];
+    Uint64 start;
+    double lookup, created;
+    int i, j;
+
+    format_iterations = BenchIterations(argc, argv, format_iterations);
+    if (!format_iterations) {
+        return 1;
+    }
+
+    /* Keep every format alive, like the surfaces of a running program */
+    for (i = 0; i < SDL_arraysize(pixel_formats); ++i) {
+        held[i] = SDL_AllocFormat(pixel_formats[i]);
+    }
+
+    start = SDL_GetPerformanceCounter();
+    for (i = 0; i < format_iterations; ++i) {
+        for (j = 0; j < SDL_arraysize(pixel_formats); ++j) {
+            SDL_FreeFormat(SDL_AllocFormat(pixel_formats[j]));
+        }
+    }
+    lookup = BenchElapsed(start, format_iterations * (int) SDL_arraysize(pixel_formats)) * 1000000.0;
+
+    start = SDL_GetPerformanceCounter();
+    for (i = 0; i < FORMAT_THREADS; ++i) {
+        threads[i] = SDL_CreateThread(CreateSurfaces, "CreateSurfaces", (void *) (size_t) (i * 7));
+    }
+    for (i = 0; i < FORMAT_THREADS; ++i) {
+        SDL_WaitThread(threads[i], NULL);
+    }
+    created = BenchElapsed(start, FORMAT_THREADS * (format_iterations / 10)) * 1000000.0;
+
+    SDL_Log("SDL_AllocFormat/SDL_FreeFormat: %8.2f ns, 4x4 surface on %d threads: %8.2f ns, %d failures\n",
+            lookup, FORMAT_THREADS, created, SDL_AtomicGet(&format_failures));
+
+    for (i = 0; i < SDL_arraysize(pixel_formats); ++i) {
+        SDL_FreeFormat(held[i]);
+    }
+    SDL_Quit();
+    return SDL_AtomicGet(&format_failures) ? 2 : 0;
+}
+
+/* vi: set ts=4 sw=4 expandtab: */
@@ -0,0 +1,699 @@
+/*
+  Copyright (C) 1997-2017 Sam Lantinga <slouken@libsdl.org>
+
+  This software is provided 'as-is', without any express or implied
+  warranty.  In no event will the authors be held liable for any damages
+  arising from the use of this software.
+
+  Permission is granted to anyone to use this software for any purpose,
+  including commercial applications, and to alter it and redistribute it
+  freely.
+*/
+
+/* Surface and blit benchmarks run by testbench */
+
+#include <stdio.h>
+
+#include "testbench.h"
+
+/* Measures how large blits and pixel conversions scale with the number of
+   threads allowed by SDL_HINT_BLIT_THREADS, at 1080p, 4K and 8K. */
+
+static const struct
+{
+    const char *name;
+    int w, h;
+} blit_sizes[] = {
+    { "1080p", 1920, 1080 },
+    { "4K", 3840, 2160 },
+    { "8K", 7680, 4320 },
+};
+
+int
+Bench_BlitThreads(int argc, char **argv)
+{
+    int iterations = 10;
+    int max_threads = SDL_GetCPUCount();
+    int i, j, threads;
+
+    if (argc > 1) {
+        iterations = SDL_atoi(argv[1]);
+    }
+    if (argc > 2) {
+        max_threads = SDL_atoi(argv[2]);
+    }
+    if ((iterations <= 0) || (max_threads <= 0)) {
+        return 1;
+    }
+
+    for (i = 0; i < SDL_arraysize(blit_sizes); i++) {
+        SDL_Surface *src = SDL_CreateRGBSurfaceWithFormat(0, blit_sizes[i].w, blit_sizes[i].h, 0, SDL_PIXELFORMAT_ARGB8888);
+        SDL_Surface *dst = SDL_CreateRGBSurfaceWithFormat(0, blit_sizes[i].w, blit_sizes[i].h, 0, SDL_PIXELFORMAT_RGB888);
+        Uint8 *pixels = (Uint8 *) SDL_malloc(blit_sizes[i].w * blit_sizes[i].h * 4);
+
+        if (!src || !dst || !pixels) {
+            SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "Couldn't create %s surfaces: %s\n", blit_sizes[i].name, SDL_GetError());
+            return 2;
+        }
+        for (j = 0; j < src->pitch * src->h; j++) {
+            ((Uint8 *) src->pixels)[j] = (Uint8) (j * 37);
+        }
+        SDL_SetSurfaceBlendMode(src, SDL_BLENDMODE_BLEND);
+
+        for (threads = 1; ; threads = SDL_min(threads * 2, max_threads)) {
+            char hint[16];
+            Uint64 start;
+            double convert, blend;
+
+            SDL_snprintf(hint, sizeof (hint), "%d", threads);
+            SDL_SetHint(SDL_HINT_BLIT_THREADS, hint);
+
+            start = SDL_GetPerformanceCounter();
+            for (j = 0; j < iterations; j++) {
+                SDL_ConvertPixels(blit_sizes[i].w, blit_sizes[i].h,
+                                  SDL_PIXELFORMAT_ARGB8888, src->pixels, src->pitch,
+                                  SDL_PIXELFORMAT_ABGR8888, pixels, blit_sizes[i].w * 4);
+            }
+            convert = BenchElapsed(start, iterations);
+
+            start = SDL_GetPerformanceCounter();
+            for (j = 0; j < iterations; j++) {
+                SDL_BlitSurface(src, NULL, dst, NULL);
+            }
+            blend = BenchElapsed(start, iterations);
+
+            SDL_Log("%-5s %2d threads: convert %8.3f ms, blend %8.3f ms\n",
+                    blit_sizes[i].name, threads, convert, blend);
+
+            if (threads == max_threads) {
+                break;
+            }
+        }
+
+        SDL_free(pixels);
+        SDL_FreeSurface(dst);
+        SDL_FreeSurface(src);
+    }
+
+    return 0;
+}
+
+/* Measures SDL_FillRect() on surfaces from 64x64 up to 4K in each pixel
+   size, and SDL_FillRects() on a grid of 16x16 tiles against filling the
+   tiles one at a time. */
+
+static const struct
+{
+    const char *name;
+    int w, h;
+} fill_sizes[] = {
+    { "64x64", 64, 64 },
+    { "256x256", 256, 256 },
+    { "1080p", 1920, 1080 },
+    { "4K", 3840, 2160 },
+};
+
+static const Uint32 fill_formats[] = {
+    SDL_PIXELFORMAT_INDEX8,
+    SDL_PIXELFORMAT_RGB565,
+    SDL_PIXELFORMAT_RGB24,
+    SDL_PIXELFORMAT_ARGB8888,
+};
+
+#define FILL_TILE_SIZE   16
+
+int
+Bench_Fill(int argc, char **argv)
+{
+    int iterations = 20;
+    int i, j, k, n;
+
+    iterations = BenchIterations(argc, argv, iterations);
+    if (!iterations) {
+        return 1;
+    }
+
+    for (i = 0; i < SDL_arraysize(fill_sizes); ++i) {
+        const int w = fill_sizes[i].w, h = fill_sizes[i].h;
+        const int count = ((w + FILL_TILE_SIZE - 1) / FILL_TILE_SIZE) * ((h + FILL_TILE_SIZE - 1) / FILL_TILE_SIZE);
+        SDL_Rect *tiles = (SDL_Rect *) SDL_malloc(count * sizeof (SDL_Rect));
+        int x, y;
+
+        if (!tiles) {
+            SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "Out of memory!\n");
+            return 2;
+        }
+        n = 0;
+        for (y = 0; y < h; y += FILL_TILE_SIZE) {
+            for (x = 0; x < w; x += FILL_TILE_SIZE) {
+                tiles[n].x = x;
+                tiles[n].y = y;
+                tiles[n].w = FILL_TILE_SIZE;
+                tiles[n].h = FILL_TILE_SIZE;
+                ++n;
+            }
+        }
+
+        for (j = 0; j < SDL_arraysize(fill_formats); ++j) {
+            SDL_Surface *surface = SDL_CreateRGBSurfaceWithFormat(0, w, h, 0, fill_formats[j]);
+            double fill, fill_rects, fill_tiles;
+            Uint64 start;
+
+            if (!surface) {
+                SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "Couldn't create surface: %s\n", SDL_GetError());
+                return 2;
+            }
+
+            /* Touch the pixels once so page faults aren't counted */
+            SDL_FillRect(surface, NULL, 0);
+
+            start = SDL_GetPerformanceCounter();
+            for (k = 0; k < iterations; ++k) {
+                SDL_FillRect(surface, NULL, k);
+            }
+            fill = BenchElapsed(start, iterations);
+
+            start = SDL_GetPerformanceCounter();
+            for (k = 0; k < iterations; ++k) {
+                SDL_FillRects(surface, tiles, count, k);
+            }
+            fill_rects = BenchElapsed(start, iterations);
+
+            start = SDL_GetPerformanceCounter();
+            for (k = 0; k < iterations; ++k) {
+                for (n = 0; n < count; ++n) {
+                    SDL_FillRect(surface, &tiles[n], k);
+                }
+            }
+            fill_tiles = BenchElapsed(start, iterations);
+
+            SDL_Log("%-8s %-24s fill %8.3f ms (%6.2f GB/s), tiles: %8.3f ms together, %8.3f ms one at a time\n",
+                    fill_sizes[i].name, SDL_GetPixelFormatName(fill_formats[j]), fill,
+                    ((double) surface->pitch * h) / (fill * 1000000.0),
+                    fill_rects, fill_tiles);
+
+            SDL_FreeSurface(surface);
+        }
+        SDL_free(tiles);
+    }
+
+    return 0;
+}
+
+/* Measures the first blit (which RLE encodes the surface) and the following
+   blits of colorkeyed and alpha sprites with SDL_RLEACCEL, at several sizes. */
+
+static const int rle_sizes[] = { 64, 256, 1024 };
+
+static const struct
+{
+    const char *name;
+    Uint32 src_format;
+    Uint32 dst_format;
+    SDL_bool colorkey;
+} rle_cases[] = {
+    { "colorkey 8888", SDL_PIXELFORMAT_RGB888, SDL_PIXELFORMAT_RGB888, SDL_TRUE },
+    { "colorkey 565", SDL_PIXELFORMAT_RGB565, SDL_PIXELFORMAT_RGB565, SDL_TRUE },
+    { "colorkey 8", SDL_PIXELFORMAT_INDEX8, SDL_PIXELFORMAT_INDEX8, SDL_TRUE },
+    { "alpha -> 8888", SDL_PIXELFORMAT_ARGB8888, SDL_PIXELFORMAT_RGB888, SDL_FALSE },
+    { "alpha -> 565", SDL_PIXELFORMAT_ARGB8888, SDL_PIXELFORMAT_RGB565, SDL_FALSE },
+};
+
+/* A disc that fades out over the outer half of its radius, like a glow,
+   on a transparent background. Colorkeyed sprites use black for the
+   transparent pixels and make the rest opaque. */
+static SDL_Surface *
+CreateRLESprite(int size, Uint32 format, SDL_bool colorkey)
+{
+    SDL_Surface *sprite = SDL_CreateRGBSurfaceWithFormat(0, size, size, 0, format);
+    const int r = size / 2;
+    int x, y;
+
+    if (!sprite) {
+        return NULL;
+    }
+    if (sprite->format->palette) {
+        SDL_Color colors[256];
+        for (x = 0; x < 256; ++x) {
+            colors[x].r = (Uint8) ((x >> 5) * 255 / 7);
+            colors[x].g = (Uint8) (((x >> 2) & 7) * 255 / 7);
+            colors[x].b = (Uint8) ((x & 3) * 255 / 3);
+            colors[x].a = 255;
+        }
+        SDL_SetPaletteColors(sprite->format->palette, colors, 0, 256);
+    }
+
+    for (y = 0; y < size; ++y) {
+        Uint8 *row = (Uint8 *) sprite->pixels + y * sprite->pitch;
+        for (x = 0; x < size; ++x) {
+            const int dx = x - r, dy = y - r;
+            const int d2 = dx * dx + dy * dy;
+            Uint8 a;
+            Uint32 pixel;
+
+            if (d2 >= r * r) {
+                a = 0;
+            } else if (colorkey || d2 < r * r / 4) {
+                a = 255;
+            } else {
+                /* fade out over the outer half of the radius */
+                a = (Uint8) (1 + 254 * (r * r - d2) / (r * r * 3 / 4));
+            }
+            if (colorkey && !a) {
+                pixel = SDL_MapRGB(sprite->format, 0, 0, 0);
+            } else {
+                pixel = SDL_MapRGBA(sprite->format, (Uint8) (x * 255 / size), (Uint8) (y * 255 / size), 0x80, a);
+            }
+            switch (sprite->format->BytesPerPixel) {
+            case 1:
+                row[x] = (Uint8) pixel;
+                break;
+            case 2:
+                ((Uint16 *) row)[x] = (Uint16) pixel;
+                break;
+            case 4:
+                ((Uint32 *) row)[x] = pixel;
+                break;
+            }
+        }
+    }
+
+    if (colorkey) {
+        SDL_SetColorKey(sprite, SDL_TRUE, SDL_MapRGB(sprite->format, 0, 0, 0));
+    }
+    return sprite;
+}
+
+int
+Bench_RLE(int argc, char **argv)
+{
+    int iterations = 100;
+    int i, j, k;
+
+    iterations = BenchIterations(argc, argv, iterations);
+    if (!iterations) {
+        return 1;
+    }
+
+    for (i = 0; i < SDL_arraysize(rle_cases); ++i) {
+        for (j = 0; j < SDL_arraysize(rle_sizes); ++j) {
+            const int size = rle_sizes[j];
+            SDL_Surface *dst = SDL_CreateRGBSurfaceWithFormat(0, size, size, 0, rle_cases[i].dst_format);
+            SDL_Surface *sprite = CreateRLESprite(size, rle_cases[i].src_format, rle_cases[i].colorkey);
+            double first, plain, rle;
+            Uint64 start;
+
+            if (!dst || !sprite) {
+                SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "Couldn't create surfaces: %s\n", SDL_GetError());
+                return 2;
+            }
+            if (SDL_ISPIXELFORMAT_INDEXED(rle_cases[i].dst_format)) {
+                SDL_SetSurfacePalette(dst, sprite->format->palette);
+            }
+
+            start = SDL_GetPerformanceCounter();
+            for (k = 0; k < iterations; ++k) {
+                SDL_BlitSurface(sprite, NULL, dst, NULL);
+            }
+            plain = BenchElapsed(start, iterations);
+
+            SDL_SetSurfaceRLE(sprite, 1);
+            start = SDL_GetPerformanceCounter();
+            SDL_BlitSurface(sprite, NULL, dst, NULL);
+            first = BenchElapsed(start, 1);
+
+            start = SDL_GetPerformanceCounter();
+            for (k = 0; k < iterations; ++k) {
+                SDL_BlitSurface(sprite, NULL, dst, NULL);
+            }
+            rle = BenchElapsed(start, iterations);
+
+            SDL_Log("%-14s %4dx%-4d  without RLE %8.4f ms, first RLE blit %8.4f ms, RLE %8.4f ms\n",
+                    rle_cases[i].name, size, size, plain, first, rle);
+
+            SDL_FreeSurface(sprite);
+            SDL_FreeSurface(dst);
+        }
+    }
+
+    return 0;
+}
+
+/* Measures creating and freeing temporary surfaces with and without
+   SDL_HINT_SURFACE_POOL_SIZE, and blits between surfaces with and without
+   SDL_SIMD_ALIGNED rows. */
+
+static const struct
+{
+    int w, h;
+} churn_sizes[] = {
+    { 64, 64 },
+    { 256, 256 },
+    { 640, 480 },
+    { 1920, 1080 },
+};
+
+static const struct
+{
+    const char *name;
+    Uint32 src_format;
+    Uint32 dst_format;
+    SDL_BlendMode blend;
+} aligned_blits[] = {
+    { "copy", SDL_PIXELFORMAT_ARGB8888, SDL_PIXELFORMAT_ARGB8888, SDL_BLENDMODE_NONE },
+    { "convert", SDL_PIXELFORMAT_ARGB8888, SDL_PIXELFORMAT_ABGR8888, SDL_BLENDMODE_NONE },
+    { "blend", SDL_PIXELFORMAT_ARGB8888, SDL_PIXELFORMAT_RGB888, SDL_BLENDMODE_BLEND },
+    { "blend 565", SDL_PIXELFORMAT_ARGB8888, SDL_PIXELFORMAT_RGB565, SDL_BLENDMODE_BLEND },
+};
+
+/* Create a surface per frame, draw into it and throw it away */
+static double
+Churn(int w, int h, int iterations)
+{
+    Uint64 start = SDL_GetPerformanceCounter();
+    int i;
+
+    for (i = 0; i < iterations; ++i) {
+        SDL_Surface *surface = SDL_CreateRGBSurfaceWithFormat(0, w, h, 0, SDL_PIXELFORMAT_ARGB8888);
+        if (!surface) {
+            SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "Couldn't create surface: %s\n", SDL_GetError());
+            return 0.0;
+        }
+        SDL_FillRect(surface, NULL, i);
+        SDL_FreeSurface(surface);
+    }
+    return BenchElapsed(start, iterations);
+}
+
+static double
+AlignedBlit(int i, Uint32 flags, int iterations)
+{
+    /* 1000 pixels don't make a multiple of 64 bytes at any depth */
+    SDL_Surface *src = SDL_CreateRGBSurfaceWithFormat(flags, 1000, 1000, 0, aligned_blits[i].src_format);
+    SDL_Surface *dst = SDL_CreateRGBSurfaceWithFormat(flags, 1000, 1000, 0, aligned_blits[i].dst_format);
+    double elapsed = 0.0;
+    Uint64 start;
+    int j;
+
+    if (src && dst) {
+        for (j = 0; j < src->pitch * src->h; ++j) {
+            ((Uint8 *) src->pixels)[j] = (Uint8) (j * 37);
+        }
+        SDL_SetSurfaceBlendMode(src, aligned_blits[i].blend);
+        SDL_BlitSurface(src, NULL, dst, NULL);
+
+        start = SDL_GetPerformanceCounter();
+        for (j = 0; j < iterations; ++j) {
+            SDL_BlitSurface(src, NULL, dst, NULL);
+        }
+        elapsed = BenchElapsed(start, iterations);
+    } else {
+        SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "Couldn't create surfaces: %s\n", SDL_GetError());
+    }
+    SDL_FreeSurface(src);
+    SDL_FreeSurface(dst);
+    return elapsed;
+}
+
+int
+Bench_Surface(int argc, char **argv)
+{
+    int iterations = 100;
+    int i;
+
+    iterations = BenchIterations(argc, argv, iterations);
+    if (!iterations) {
+        return 1;
+    }
+
+    for (i = 0; i < SDL_arraysize(churn_sizes); ++i) {
+        double plain, pooled;
+
+        SDL_SetHint(SDL_HINT_SURFACE_POOL_SIZE, "0");
+        plain = Churn(churn_sizes[i].w, churn_sizes[i].h, iterations);
+        SDL_SetHint(SDL_HINT_SURFACE_POOL_SIZE, "67108864");
+        pooled = Churn(churn_sizes[i].w, churn_sizes[i].h, iterations);
+
+        SDL_Log("create/fill/free %4dx%-4d: %8.4f ms, pooled %8.4f ms\n",
+                churn_sizes[i].w, churn_sizes[i].h, plain, pooled);
+    }
+    SDL_SetHint(SDL_HINT_SURFACE_POOL_SIZE, "0");
+
+    for (i = 0; i < SDL_arraysize(aligned_blits); ++i) {
+        const double unaligned = AlignedBlit(i, 0, iterations);
+        const double aligned = AlignedBlit(i, SDL_SIMD_ALIGNED, iterations);
+
+        SDL_Log("%-9s 1000x1000: %8.4f ms, aligned %8.4f ms\n",
+                aligned_blits[i].name, unaligned, aligned);
+    }
+
+    return 0;
+}
+
+/* Measures blitting small tiles from one atlas to several destinations in
+   turn, which remaps the atlas for every blit. Set the video log category
+   to debug priority to see the blit map cache statistics at exit. */
+
+#define ATLAS_TILE_SIZE   32
+
+static const Uint32 atlas_formats[] = {
+    SDL_PIXELFORMAT_INDEX8,
+    SDL_PIXELFORMAT_ARGB8888,
+};
+
+static const Uint32 target_formats[] = {
+    SDL_PIXELFORMAT_INDEX8,
+    SDL_PIXELFORMAT_ARGB8888,
+    SDL_PIXELFORMAT_RGB565,
+    SDL_PIXELFORMAT_INDEX8,
+};
+
+static void
+FillAtlasPalette(SDL_Palette * palette, int seed)
+{
+    SDL_Color colors[256];
+    int i;
+
+    for (i = 0; i < 256; ++i) {
+        colors[i].r = (Uint8) (i * seed);
+        colors[i].g = (Uint8) (i * 7 + seed);
+        colors[i].b = (Uint8) (255 - i);
+        colors[i].a = 255;
+    }
+    SDL_SetPaletteColors(palette, colors, 0, 256);
+}
+
+int
+Bench_BlitMap(int argc, char **argv)
+{
+    SDL_Surface *targets[SDL_arraysize(target_formats)];
+    int iterations = 1000;
+    int i, j;
+
+    iterations = BenchIterations(argc, argv, iterations);
+    if (!iterations) {
+        return 1;
+    }
+
+    for (i = 0; i < SDL_arraysize(target_formats); ++i) {
+        targets[i] = SDL_CreateRGBSurfaceWithFormat(0, 256, 256, 0, target_formats[i]);
+        if (!targets[i]) {
+            SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "Couldn't create target: %s\n", SDL_GetError());
+            return 2;
+        }
+        if (targets[i]->format->palette) {
+            FillAtlasPalette(targets[i]->format->palette, i + 3);
+        }
+    }
+
+    for (i = 0; i < SDL_arraysize(atlas_formats); ++i) {
+        SDL_Surface *atlas = SDL_CreateRGBSurfaceWithFormat(0, 512, 512, 0, atlas_formats[i]);
+        Uint64 start;
+        double same, rotating;
+
+        if (!atlas) {
+            SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "Couldn't create atlas: %s\n", SDL_GetError());
+            return 2;
+        }
+        if (atlas->format->palette) {
+            FillAtlasPalette(atlas->format->palette, 1);
+        }
+        for (j = 0; j < atlas->pitch * atlas->h; ++j) {
+            ((Uint8 *) atlas->pixels)[j] = (Uint8) (j * 13);
+        }
+        SDL_SetColorKey(atlas, SDL_TRUE, 0);
+        SDL_SetSurfaceBlendMode(atlas, SDL_BLENDMODE_NONE);
+
+        /* Every blit to the same target */
+        start = SDL_GetPerformanceCounter();
+        for (j = 0; j < iterations; ++j) {
+            SDL_Rect src = { (j % 16) * ATLAS_TILE_SIZE, ((j / 16) % 16) * ATLAS_TILE_SIZE, ATLAS_TILE_SIZE, ATLAS_TILE_SIZE };
+            SDL_Rect dst = { (j % 8) * ATLAS_TILE_SIZE, 0, 0, 0 };
+            SDL_BlitSurface(atlas, &src, targets[1], &dst);
+        }
+        same = BenchElapsed(start, iterations) * 1000.0;
+
+        /* Each blit to the next target */
+        start = SDL_GetPerformanceCounter();
+        for (j = 0; j < iterations; ++j) {
+            SDL_Rect src = { (j % 16) * ATLAS_TILE_SIZE, ((j / 16) % 16) * ATLAS_TILE_SIZE, ATLAS_TILE_SIZE, ATLAS_TILE_SIZE };
+            SDL_Rect dst = { (j % 8) * ATLAS_TILE_SIZE, 0, 0, 0 };
+            SDL_BlitSurface(atlas, &src, targets[j % SDL_arraysize(targets)], &dst);
+        }
+        rotating = BenchElapsed(start, iterations) * 1000.0;
+
+        SDL_Log("%-8s atlas: %8.2f us per tile to one target, %8.2f us per tile over %d targets\n",
+                SDL_GetPixelFormatName(atlas_formats[i]) + 16, same, rotating,
+                (int) SDL_arraysize(targets));
+
+        SDL_FreeSurface(atlas);
+    }
+
+    for (i = 0; i < SDL_arraysize(targets); ++i) {
+        SDL_FreeSurface(targets[i]);
+    }
+    return 0;
+}
+
+/* Measures loading BMP files into ARGB8888 surfaces with SDL_LoadBMP() and
+   SDL_ConvertSurfaceFormat(), against SDL_LoadBMPWithFormat(), from files
+   and from memory. Without arguments it writes and loads a few large test
+   images, otherwise it loads the given files. */
+
+#define BMP_TARGET_FORMAT   SDL_PIXELFORMAT_ARGB8888
+
+static const Uint32 generated_formats[] = {
+    SDL_PIXELFORMAT_INDEX8,
+    SDL_PIXELFORMAT_BGR24,
+    SDL_PIXELFORMAT_ARGB8888,
+};
+
+static SDL_bool
+WriteBMPImage(const char *file, Uint32 format)
+{
+    SDL_Surface *image = SDL_CreateRGBSurfaceWithFormat(0, 4096, 2048, 0, format);
+    int x, y, status;
+
+    if (!image) {
+        return SDL_FALSE;
+    }
+    if (image->format->palette) {
+        SDL_Color colors[256];
+        for (x = 0; x < 256; ++x) {
+            colors[x].r = (Uint8) x;
+            colors[x].g = (Uint8) (x * 3);
+            colors[x].b = (Uint8) (255 - x);
+            colors[x].a = 255;
+        }
+        SDL_SetPaletteColors(image->format->palette, colors, 0, 256);
+    }
+    for (y = 0; y < image->h; ++y) {
+        Uint8 *row = (Uint8 *) image->pixels + y * image->pitch;
+        for (x = 0; x < image->w * image->format->BytesPerPixel; ++x) {
+            row[x] = (Uint8) (x + y * 7);
+        }
+    }
+    status = SDL_SaveBMP(image, file);
+    SDL_FreeSurface(image);
+    return (status == 0);
+}
+
+static SDL_bool
+LoadBMPImage(const char *file, int iterations)
+{
+    SDL_RWops *rw;
+    Uint8 *data;
+    Sint64 size;
+    Uint64 start;
+    double converted, direct, converted_mem, direct_mem;
+    int i;
+
+    rw = SDL_RWFromFile(file, "rb");
+    if (!rw) {
+        return SDL_FALSE;
+    }
+    size = SDL_RWsize(rw);
+    data = (Uint8 *) SDL_malloc((size_t) size);
+    if (!data || SDL_RWread(rw, data, 1, (size_t) size) != (size_t) size) {
+        SDL_RWclose(rw);
+        SDL_free(data);
+        return SDL_FALSE;
+    }
+    SDL_RWclose(rw);
+
+    start = SDL_GetPerformanceCounter();
+    for (i = 0; i < iterations; ++i) {
+        SDL_Surface *image = SDL_LoadBMP(file);
+        SDL_Surface *surface = image ? SDL_ConvertSurfaceFormat(image, BMP_TARGET_FORMAT, 0) : NULL;
+        SDL_FreeSurface(image);
+        if (!surface) {
+            SDL_free(data);
+            return SDL_FALSE;
+        }
+        SDL_FreeSurface(surface);
+    }
+    converted = BenchElapsed(start, iterations);
+
+    start = SDL_GetPerformanceCounter();
+    for (i = 0; i < iterations; ++i) {
+        SDL_FreeSurface(SDL_LoadBMPWithFormat(file, BMP_TARGET_FORMAT));
+    }
+    direct = BenchElapsed(start, iterations);
+
+    start = SDL_GetPerformanceCounter();
+    for (i = 0; i < iterations; ++i) {
+        SDL_Surface *image = SDL_LoadBMP_RW(SDL_RWFromConstMem(data, (int) size), 1);
+        SDL_FreeSurface(SDL_ConvertSurfaceFormat(image, BMP_TARGET_FORMAT, 0));
+        SDL_FreeSurface(image);
+    }
+    converted_mem = BenchElapsed(start, iterations);
+
+    start = SDL_GetPerformanceCounter();
+    for (i = 0; i < iterations; ++i) {
+        SDL_FreeSurface(SDL_LoadBMPWithFormat_RW(SDL_RWFromConstMem(data, (int) size), 1, BMP_TARGET_FORMAT));
+    }
+    direct_mem = BenchElapsed(start, iterations);
+
+    SDL_Log("%s: file %8.3f ms, direct %8.3f ms; memory %8.3f ms, direct %8.3f ms\n",
+            file, converted, direct, converted_mem, direct_mem);
+    SDL_free(data);
+    return SDL_TRUE;
+}
+
+int
+Bench_BMP(int argc, char **argv)
+{
+    int iterations = 10;
+    int i;
+
+    if (argc > 1 && SDL_strcmp(argv[1], "--iterations") == 0 && argc > 2) {
+        iterations = SDL_atoi(argv[2]);
+        argc -= 2;
+        argv += 2;
+    }
+    if (iterations <= 0) {
+        return 1;
+    }
+
+    if (argc > 1) {
+        for (i = 1; i < argc; ++i) {
+            if (!LoadBMPImage(argv[i], iterations)) {
+                SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "Couldn't load %s: %s\n", argv[i], SDL_GetError());
+            }
+        }
+    } else {
+        for (i = 0; i < SDL_arraysize(generated_formats); ++i) {
+            char file[64];
+
+            SDL_snprintf(file, sizeof(file), "testbench-bmp-%d.bmp", i);
+            if (!WriteBMPImage(file, generated_formats[i]) || !LoadBMPImage(file, iterations)) {
+                SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "Couldn't write or load %s: %s\n", file, SDL_GetError());
+            }
+            remove(file);
+        }
+    }
+
+    return 0;
+}
+
+/* vi: set ts=4 sw=4 expandtab: */
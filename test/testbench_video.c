@@ -0,0 +1,547 @@
+/*
+  Copyright (C) 1997-2017 Sam Lantinga <slouken@libsdl.org>
+
+  This software is provided 'as-is', without any express or implied
+  warranty.  In no event will the authors be held liable for any damages
+  arising from the use of this software.
+
+  Permission is granted to anyone to use this software for any purpose,
+  including commercial applications, and to alter it and redistribute it
+  freely.
+*/
+
+/* Window benchmarks run by testbench */
+
+#include "testbench.h"
+#include "SDL_shape.h"
+
+/* Measures presenting a window surface where only two small squares in
+   opposite corners change each frame: updating the whole window, passing
+   the two rects, and with SDL_HINT_WINDOW_SURFACE_DAMAGE. Set
+   SDL_FRAMEBUFFER_ACCELERATION=1 to measure the texture fallback. */
+
+#define DAMAGE_WIDTH    1280
+#define DAMAGE_HEIGHT   720
+#define DAMAGE_SQUARE_SIZE     32
+
+enum
+{
+    PRESENT_FULL,
+    PRESENT_RECTS,
+    PRESENT_DAMAGE
+};
+
+static const char *present_names[] = {
+    "SDL_UpdateWindowSurface",
+    "SDL_UpdateWindowSurfaceRects",
+    "damage tracking",
+};
+
+static double
+RunDamage(int mode, int iterations)
+{
+    SDL_Window *window;
+    SDL_Surface *surface;
+    SDL_Rect rects[2];
+    double elapsed = 0.0;
+    Uint64 start;
+    int i;
+
+    SDL_SetHint(SDL_HINT_WINDOW_SURFACE_DAMAGE, (mode == PRESENT_DAMAGE) ? "1" : "0");
+    window = SDL_CreateWindow("testbench", SDL_WINDOWPOS_UNDEFINED, SDL_WINDOWPOS_UNDEFINED,
+                              DAMAGE_WIDTH, DAMAGE_HEIGHT, 0);
+    surface = window ? SDL_GetWindowSurface(window) : NULL;
+    if (!surface) {
+        SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "Couldn't create window surface: %s\n", SDL_GetError());
+        if (window) {
+            SDL_DestroyWindow(window);
+        }
+        return 0.0;
+    }
+    SDL_FillRect(surface, NULL, 0);
+    SDL_UpdateWindowSurface(window);
+
+    rects[0].x = 0;
+    rects[0].y = 0;
+    rects[1].x = surface->w - DAMAGE_SQUARE_SIZE;
+    rects[1].y = surface->h - DAMAGE_SQUARE_SIZE;
+    rects[0].w = rects[1].w = DAMAGE_SQUARE_SIZE;
+    rects[0].h = rects[1].h = DAMAGE_SQUARE_SIZE;
+
+    start = SDL_GetPerformanceCounter();
+    for (i = 0; i < iterations; ++i) {
+        const Uint32 color = SDL_MapRGB(surface->format, (Uint8) i, (Uint8) (i * 3), 255);
+
+        SDL_PumpEvents();
+        SDL_FillRects(surface, rects, 2, color);
+        if (mode == PRESENT_RECTS) {
+            SDL_UpdateWindowSurfaceRects(window, rects, 2);
+        } else {
+            SDL_UpdateWindowSurface(window);
+        }
+    }
+    elapsed = BenchElapsed(start, iterations);
+
+    SDL_DestroyWindow(window);
+    return elapsed;
+}
+
+int
+Bench_Damage(int argc, char **argv)
+{
+    int iterations = 500;
+    int i;
+
+    iterations = BenchIterations(argc, argv, iterations);
+    if (!iterations) {
+        return 1;
+    }
+
+    if (SDL_Init(SDL_INIT_VIDEO) < 0) {
+        SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "Couldn't initialize SDL: %s\n", SDL_GetError());
+        return 2;
+    }
+
+    SDL_Log("Video driver: %s, %dx%d window, two %dx%d squares per frame\n",
+            SDL_GetCurrentVideoDriver(), DAMAGE_WIDTH, DAMAGE_HEIGHT, DAMAGE_SQUARE_SIZE, DAMAGE_SQUARE_SIZE);
+    for (i = 0; i < SDL_arraysize(present_names); ++i) {
+        SDL_Log("%-28s: %8.4f ms per frame\n", present_names[i], RunDamage(i, iterations));
+    }
+
+    return 0;
+}
+
+/* Measures drawing several windows with the software renderer and the dummy
+   video driver, so it runs without a display. Every presented frame is seen
+   through SDL_SetWindowPresentCallback(), and can be written to a file or a
+   pipe with --output, in the layout described for SDL_HINT_VIDEO_DUMMY_OUTPUT. */
+
+#define HEADLESS_WINDOWS 4
+#define HEADLESS_SPRITES 64
+
+typedef struct
+{
+    SDL_Window *window;
+    SDL_Renderer *renderer;
+    int presents;
+    Uint64 pixels;
+    Uint64 first;
+    Uint64 last;
+    Uint64 min_interval;
+    Uint64 max_interval;
+} HeadlessWindow;
+
+static void SDLCALL
+Presented(void *userdata, SDL_Window * window, SDL_Surface * surface,
+          const SDL_Rect * rects, int numrects, Uint64 timestamp)
+{
+    HeadlessWindow *headless = (HeadlessWindow *) userdata;
+    int i;
+
+    if (headless->presents == 0) {
+        headless->first = timestamp;
+    } else {
+        const Uint64 interval = timestamp - headless->last;
+        if (headless->presents == 1 || interval < headless->min_interval) {
+            headless->min_interval = interval;
+        }
+        if (interval > headless->max_interval) {
+            headless->max_interval = interval;
+        }
+    }
+    headless->last = timestamp;
+    ++headless->presents;
+    for (i = 0; i < numrects; ++i) {
+        headless->pixels += (Uint64) rects[i].w * rects[i].h;
+    }
+}
+
+static void
+DrawHeadless(SDL_Renderer * renderer, int frame, int seed)
+{
+    SDL_Rect rect;
+    int w, h, i;
+
+    SDL_GetRendererOutputSize(renderer, &w, &h);
+    SDL_SetRenderDrawColor(renderer, 0x20, 0x20, 0x40, 0xFF);
+    SDL_RenderClear(renderer);
+
+    rect.w = 32;
+    rect.h = 32;
+    for (i = 0; i < HEADLESS_SPRITES; ++i) {
+        rect.x = (i * 37 + seed * 11 + frame * (1 + i % 5)) % (w - rect.w);
+        rect.y = (i * 53 + seed * 7 + frame * (1 + i % 3)) % (h - rect.h);
+        SDL_SetRenderDrawColor(renderer, (Uint8) (i * 4), (Uint8) (255 - i * 4), (Uint8) (seed * 64), 0x80);
+        SDL_RenderFillRect(renderer, &rect);
+    }
+    SDL_RenderPresent(renderer);
+}
+
+int
+Bench_Headless(int argc, char **argv)
+{
+    HeadlessWindow windows[HEADLESS_WINDOWS];
+    int num_windows = 2;
+    int frames = 600;
+    Uint64 start;
+    double elapsed;
+    SDL_Event event;
+    int i, j;
+
+    /* Enable the driver's report */
+    SDL_LogSetPriority(SDL_LOG_CATEGORY_VIDEO, SDL_LOG_PRIORITY_INFO);
+
+    for (i = 1; i < argc; i += 2) {
+        if (i + 1 >= argc) {
+            frames = 0;
+        } else if (SDL_strcmp(argv[i], "--frames") == 0) {
+            frames = SDL_atoi(argv[i + 1]);
+        } else if (SDL_strcmp(argv[i], "--windows") == 0) {
+            num_windows = SDL_atoi(argv[i + 1]);
+        } else if (SDL_strcmp(argv[i], "--output") == 0) {
+            SDL_SetHint(SDL_HINT_VIDEO_DUMMY_OUTPUT, argv[i + 1]);
+        } else {
+            frames = 0;
+        }
+    }
+    if (frames <= 0 || num_windows <= 0 || num_windows > HEADLESS_WINDOWS) {
+        return 1;
+    }
+
+    SDL_setenv("SDL_VIDEODRIVER", "dummy", 1);
+    if (SDL_Init(SDL_INIT_VIDEO) < 0) {
+        SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "Couldn't initialize SDL: %s\n", SDL_GetError());
+        return 2;
+    }
+
+    SDL_zero(windows);
+    for (i = 0; i < num_windows; ++i) {
+        char title[32];
+
+        SDL_snprintf(title, sizeof(title), "testbench %d", i);
+        windows[i].window = SDL_CreateWindow(title, 0, 0, 640, 480, 0);
+        if (windows[i].window) {
+            windows[i].renderer = SDL_CreateRenderer(windows[i].window, -1, SDL_RENDERER_SOFTWARE);
+        }
+        if (!windows[i].renderer) {
+            SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "Couldn't create window: %s\n", SDL_GetError());
+            SDL_Quit();
+            return 2;
+        }
+        SDL_SetRenderDrawBlendMode(windows[i].renderer, SDL_BLENDMODE_BLEND);
+        SDL_SetWindowPresentCallback(windows[i].window, Presented, &windows[i]);
+    }
+
+    start = SDL_GetPerformanceCounter();
+    for (j = 0; j < frames; ++j) {
+        while (SDL_PollEvent(&event)) {
+        }
+        for (i = 0; i < num_windows; ++i) {
+            DrawHeadless(windows[i].renderer, j, i);
+        }
+    }
+    elapsed = BenchMilliseconds(SDL_GetPerformanceCounter() - start);
+
+    SDL_Log("%d frames in %d windows: %.3f ms per frame, %.1f frames per second\n",
+            frames, num_windows, elapsed / frames, frames * 1000.0 / elapsed);
+    for (i = 0; i < num_windows; ++i) {
+        const HeadlessWindow *headless = &windows[i];
+
+        if (headless->presents > 1) {
+            SDL_Log("Window %u: %d presents, %.0f pixels each, %.3f ms apart (%.3f min, %.3f max)\n",
+                    SDL_GetWindowID(headless->window), headless->presents,
+                    (double) headless->pixels / headless->presents,
+                    BenchMilliseconds(headless->last - headless->first) / (headless->presents - 1),
+                    BenchMilliseconds(headless->min_interval), BenchMilliseconds(headless->max_interval));
+        }
+        SDL_DestroyRenderer(headless->renderer);
+        SDL_DestroyWindow(headless->window);
+    }
+
+    return 0;
+}
+
+/* Measures clipping and combining large batches of rects: filling them on a
+   surface where most are clipped away, filling them with blending through
+   the software renderer, and presenting them as window surface updates with
+   the dummy video driver, where overlapping rects are presented once. */
+
+#define REGION_WIDTH    800
+#define REGION_HEIGHT    600
+
+static int presented_rects;
+static Uint64 presented_pixels;
+
+static void SDLCALL
+RegionPresented(void *userdata, SDL_Window * window, SDL_Surface * surface,
+          const SDL_Rect * rects, int numrects, Uint64 timestamp)
+{
+    int i;
+
+    presented_rects += numrects;
+    for (i = 0; i < numrects; ++i) {
+        presented_pixels += (Uint64) rects[i].w * rects[i].h;
+    }
+}
+
+/* Small rects scattered over an area three times the size of the window,
+   so most of them are outside it */
+static void
+ScatterRects(SDL_Rect * rects, int count, int size)
+{
+    Uint32 seed = 1;
+    int i;
+
+    for (i = 0; i < count; ++i) {
+        seed = seed * 1103515245 + 12345;
+        rects[i].x = (int) ((seed >> 8) % (REGION_WIDTH * 3)) - REGION_WIDTH;
+        seed = seed * 1103515245 + 12345;
+        rects[i].y = (int) ((seed >> 8) % (REGION_HEIGHT * 3)) - REGION_HEIGHT;
+        rects[i].w = 1 + (int) ((seed >> 4) % size);
+        rects[i].h = 1 + (int) ((seed >> 12) % size);
+    }
+}
+
+/* Rects clustered around a few moving objects, like sprites redrawn over
+   each other */
+static void
+ClusterRects(SDL_Rect * rects, int count, int frame)
+{
+    Uint32 seed = 7 + frame;
+    int i;
+
+    for (i = 0; i < count; ++i) {
+        const int cluster = i % 8;
+        seed = seed * 1103515245 + 12345;
+        rects[i].x = (cluster * 97 + frame * 3) % (REGION_WIDTH - 100) + (int) ((seed >> 8) % 64);
+        rects[i].y = (cluster * 61 + frame * 2) % (REGION_HEIGHT - 100) + (int) ((seed >> 16) % 64);
+        rects[i].w = 8 + (int) ((seed >> 4) % 24);
+        rects[i].h = 8 + (int) ((seed >> 12) % 24);
+    }
+}
+
+int
+Bench_Region(int argc, char **argv)
+{
+    SDL_Window *window;
+    SDL_Renderer *renderer;
+    SDL_Surface *surface;
+    SDL_Rect *rects;
+    Uint64 requested_pixels = 0, start;
+    double filled, blended, updated;
+    int count = 10000;
+    int iterations = 100;
+    int i, j;
+
+    if (argc > 1) {
+        count = SDL_atoi(argv[1]);
+    }
+    if (argc > 2) {
+        iterations = SDL_atoi(argv[2]);
+    }
+    if (count <= 0 || iterations <= 0) {
+        return 1;
+    }
+
+    SDL_setenv("SDL_VIDEODRIVER", "dummy", 1);
+    if (SDL_Init(SDL_INIT_VIDEO) < 0) {
+        SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "Couldn't initialize SDL: %s\n", SDL_GetError());
+        return 2;
+    }
+    rects = (SDL_Rect *) SDL_malloc(count * sizeof(*rects));
+    surface = SDL_CreateRGBSurfaceWithFormat(0, REGION_WIDTH, REGION_HEIGHT, 0, SDL_PIXELFORMAT_ARGB8888);
+    if (!rects || !surface) {
+        SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "Couldn't create surface: %s\n", SDL_GetError());
+        SDL_Quit();
+        return 2;
+    }
+
+    /* Filling, where clipping decides which few rects are drawn */
+    ScatterRects(rects, count, 8);
+    start = SDL_GetPerformanceCounter();
+    for (i = 0; i < iterations; ++i) {
+        SDL_FillRects(surface, rects, count, (Uint32) i);
+    }
+    filled = BenchElapsed(start, iterations * count) * 1000000.0;
+
+    /* Blending through the software renderer */
+    renderer = SDL_CreateSoftwareRenderer(surface);
+    if (!renderer) {
+        SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "Couldn't create renderer: %s\n", SDL_GetError());
+        SDL_Quit();
+        return 2;
+    }
+    SDL_SetRenderDrawBlendMode(renderer, SDL_BLENDMODE_BLEND);
+    SDL_SetRenderDrawColor(renderer, 0xFF, 0x80, 0x40, 0x80);
+    start = SDL_GetPerformanceCounter();
+    for (i = 0; i < iterations; ++i) {
+        SDL_RenderFillRects(renderer, rects, count);
+    }
+    blended = BenchElapsed(start, iterations * count) * 1000000.0;
+    SDL_DestroyRenderer(renderer);
+    SDL_FreeSurface(surface);
+
+    /* Presenting overlapping rects */
+    window = SDL_CreateWindow("testbench", 0, 0, REGION_WIDTH, REGION_HEIGHT, 0);
+    if (!window || !SDL_GetWindowSurface(window)) {
+        SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "Couldn't create window: %s\n", SDL_GetError());
+        SDL_Quit();
+        return 2;
+    }
+    SDL_SetWindowPresentCallback(window, RegionPresented, NULL);
+    start = SDL_GetPerformanceCounter();
+    for (i = 0; i < iterations; ++i) {
+        ClusterRects(rects, count, i);
+        for (j = 0; j < count; ++j) {
+            requested_pixels += (Uint64) rects[j].w * rects[j].h;
+        }
+        SDL_UpdateWindowSurfaceRects(window, rects, count);
+    }
+    updated = BenchElapsed(start, iterations * count) * 1000000.0;
+
+    SDL_Log("%d rects: fill %6.2f ns, blend %6.2f ns, update %6.2f ns per rect\n",
+            count, filled, blended, updated);
+    SDL_Log("Updates presented %.1f rects and %.0f%% of the requested pixels\n",
+            (double) presented_rects / iterations,
+            requested_pixels ? (double) presented_pixels * 100.0 / (double) requested_pixels : 0.0);
+
+    SDL_DestroyWindow(window);
+    SDL_free(rects);
+    return 0;
+}
+
+/* Measures animating the shape of a large shaped window, where a sprite
+   moves over a still disc: setting the whole shape every frame, and updating
+   only the part of it the sprite moved over. Runs with the video driver in
+   SDL_VIDEODRIVER, or the dummy driver when that isn't set. */
+
+#define SHAPE_SPRITE_SIZE 48
+
+/* A disc fading out at its edge over a transparent background */
+static void
+DrawShapeBackground(SDL_Surface * surface)
+{
+    const int cx = surface->w / 2, cy = surface->h / 2;
+    const int radius = SDL_min(cx, cy) - 1;
+    int x, y;
+
+    for (y = 0; y < surface->h; ++y) {
+        Uint32 *row = (Uint32 *) ((Uint8 *) surface->pixels + y * surface->pitch);
+        for (x = 0; x < surface->w; ++x) {
+            const int dx = x - cx, dy = y - cy;
+            const int d2 = dx * dx + dy * dy;
+            int alpha = 0;
+
+            if (d2 < radius * radius) {
+                alpha = 255 - (255 * d2) / (radius * radius);
+            }
+            row[x] = SDL_MapRGBA(surface->format, 0x40, 0x80, 0xC0, (Uint8) alpha);
+        }
+    }
+}
+
+/* A square ring moving around the window */
+static void
+MoveShapeSprite(SDL_Surface * shape, SDL_Surface * background, int frame, SDL_Rect * sprite, SDL_Rect * changed)
+{
+    SDL_Rect hole;
+
+    SDL_BlitSurface(background, sprite, shape, sprite);
+    *changed = *sprite;
+
+    sprite->x = (frame * 7) % (shape->w - SHAPE_SPRITE_SIZE);
+    sprite->y = (frame * 5) % (shape->h - SHAPE_SPRITE_SIZE);
+    hole.x = sprite->x + SHAPE_SPRITE_SIZE / 4;
+    hole.y = sprite->y + SHAPE_SPRITE_SIZE / 4;
+    hole.w = hole.h = SHAPE_SPRITE_SIZE / 2;
+    SDL_FillRect(shape, sprite, SDL_MapRGBA(shape->format, 0xFF, 0xFF, 0xFF, 0xFF));
+    SDL_FillRect(shape, &hole, SDL_MapRGBA(shape->format, 0, 0, 0, 0));
+    SDL_UnionRect(changed, sprite, changed);
+}
+
+int
+Bench_Shape(int argc, char **argv)
+{
+    SDL_Window *window;
+    SDL_Surface *shape, *background;
+    SDL_WindowShapeMode mode;
+    SDL_Rect sprite, changed;
+    SDL_Event event;
+    Uint64 start;
+    double full, partial;
+    int w = 1024, h = 768, frames = 200;
+    int i;
+
+    if (argc > 2) {
+        w = SDL_atoi(argv[1]);
+        h = SDL_atoi(argv[2]);
+    }
+    if (argc > 3) {
+        frames = SDL_atoi(argv[3]);
+    }
+    if (w <= SHAPE_SPRITE_SIZE || h <= SHAPE_SPRITE_SIZE || frames <= 0) {
+        return 1;
+    }
+
+    if (!SDL_getenv("SDL_VIDEODRIVER")) {
+        SDL_setenv("SDL_VIDEODRIVER", "dummy", 1);
+    }
+    if (SDL_Init(SDL_INIT_VIDEO) < 0) {
+        SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "Couldn't initialize SDL: %s\n", SDL_GetError());
+        return 2;
+    }
+    window = SDL_CreateShapedWindow("testbench", 0, 0, w, h, 0);
+    shape = SDL_CreateRGBSurfaceWithFormat(0, w, h, 0, SDL_PIXELFORMAT_ARGB8888);
+    background = SDL_CreateRGBSurfaceWithFormat(0, w, h, 0, SDL_PIXELFORMAT_ARGB8888);
+    if (!window || !shape || !background) {
+        SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "Couldn't create shaped window: %s\n", SDL_GetError());
+        SDL_Quit();
+        return 2;
+    }
+    DrawShapeBackground(background);
+    SDL_SetSurfaceBlendMode(background, SDL_BLENDMODE_NONE);
+    SDL_BlitSurface(background, NULL, shape, NULL);
+
+    mode.mode = ShapeModeBinarizeAlpha;
+    mode.parameters.binarizationCutoff = 128;
+    sprite.x = sprite.y = 0;
+    sprite.w = sprite.h = SHAPE_SPRITE_SIZE;
+
+    /* Setting the whole shape every frame */
+    start = SDL_GetPerformanceCounter();
+    for (i = 0; i < frames; ++i) {
+        while (SDL_PollEvent(&event)) {
+        }
+        MoveShapeSprite(shape, background, i, &sprite, &changed);
+        if (SDL_SetWindowShape(window, shape, &mode) != 0) {
+            SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "Couldn't set window shape: %s\n", SDL_GetError());
+            SDL_Quit();
+            return 2;
+        }
+    }
+    full = BenchElapsed(start, frames);
+
+    /* Updating only what the sprite moved over */
+    start = SDL_GetPerformanceCounter();
+    for (i = 0; i < frames; ++i) {
+        while (SDL_PollEvent(&event)) {
+        }
+        MoveShapeSprite(shape, background, i, &sprite, &changed);
+        if (SDL_UpdateWindowShape(window, shape, &changed) != 0) {
+            SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "Couldn't update window shape: %s\n", SDL_GetError());
+            SDL_Quit();
+            return 2;
+        }
+    }
+    partial = BenchElapsed(start, frames);
+
+    SDL_Log("%dx%d shape with the %s driver: set %.3f ms, update %.3f ms per frame\n",
+            w, h, SDL_GetCurrentVideoDriver(), full, partial);
+
+    SDL_FreeSurface(background);
+    SDL_FreeSurface(shape);
+    SDL_DestroyWindow(window);
+    return 0;
+}
+
+/* vi: set ts=4 sw=4 expandtab: */
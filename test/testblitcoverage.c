@@ -0,0 +1,114 @@
+/*
+  Copyright (C) 1997-2017 Sam Lantinga <slouken@libsdl.org>
+
+  This software is provided 'as-is', without any express or implied
+  warranty.  In no event will the authors be held liable for any damages
+  arising from the use of this software.
+
+  Permission is granted to anyone to use this software for any purpose,
+  including commercial applications, and to alter it and redistribute it
+  freely.
+*/
+
+/* Reports which combinations of common pixel formats and blit flags still
+   end up on the generic SDL_Blit_Slow() path. */
+
+#include "SDL.h"
+
+static const Uint32 formats[] = {
+    SDL_PIXELFORMAT_RGB565,
+    SDL_PIXELFORMAT_RGB888,
+    SDL_PIXELFORMAT_BGR888,
+    SDL_PIXELFORMAT_ARGB8888,
+    SDL_PIXELFORMAT_RGBA8888,
+    SDL_PIXELFORMAT_ABGR8888,
+    SDL_PIXELFORMAT_BGRA8888,
+};
+
+static const SDL_BlendMode blendmodes[] = {
+    SDL_BLENDMODE_NONE,
+    SDL_BLENDMODE_BLEND,
+    SDL_BLENDMODE_ADD,
+    SDL_BLENDMODE_MOD,
+};
+
+static const char *blendnames[] = { "none", "blend", "add", "mod" };
+
+static SDL_bool slow_blit;
+static SDL_LogOutputFunction default_output;
+static void *default_userdata;
+
+static void SDLCALL
+LogOutput(void *userdata, int category, SDL_LogPriority priority, const char *message)
+{
+    if (category == SDL_LOG_CATEGORY_VIDEO && SDL_strstr(message, "slow blit")) {
+        slow_blit = SDL_TRUE;
+        return;
+    }
+    default_output(default_userdata, category, priority, message);
+}
+
+int
+main(int argc, char **argv)
+{
+    const int total = SDL_arraysize(formats) * SDL_arraysize(formats) * SDL_arraysize(blendmodes) * 4 * 2;
+    int slow = 0;
+    int i, j, b, m, scaled;
+
+    SDL_LogSetPriority(SDL_LOG_CATEGORY_APPLICATION, SDL_LOG_PRIORITY_INFO);
+    SDL_LogSetPriority(SDL_LOG_CATEGORY_VIDEO, SDL_LOG_PRIORITY_DEBUG);
+    SDL_LogGetOutputFunction(&default_output, &default_userdata);
+    SDL_LogSetOutputFunction(LogOutput, NULL);
+
+    for (i = 0; i < SDL_arraysize(formats); i++) {
+        for (j = 0; j < SDL_arraysize(formats); j++) {
+            SDL_Surface *src = SDL_CreateRGBSurfaceWithFormat(0, 32, 32, 0, formats[i]);
+            SDL_Surface *dst = SDL_CreateRGBSurfaceWithFormat(0, 64, 64, 0, formats[j]);
+            if (!src || !dst) {
+                SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "Couldn't create surfaces: %s\n", SDL_GetError());
+                return 1;
+            }
+
+            for (b = 0; b < SDL_arraysize(blendmodes); b++) {
+                /* bit 0 is color modulation, bit 1 alpha modulation */
+                for (m = 0; m < 4; m++) {
+                    for (scaled = 0; scaled < 2; scaled++) {
+                        SDL_Rect dstrect = { 0, 0, 32, 32 };
+
+                        SDL_SetSurfaceBlendMode(src, blendmodes[b]);
+                        SDL_SetSurfaceColorMod(src, (m & 1) ? 128 : 255, 255, 255);
+                        SDL_SetSurfaceAlphaMod(src, (m & 2) ? 128 : 255);
+
+                        slow_blit = SDL_FALSE;
+                        if (scaled) {
+                            dstrect.w = dstrect.h = 64;
+                            SDL_BlitScaled(src, NULL, dst, &dstrect);
+                        } else {
+                            SDL_BlitSurface(src, NULL, dst, &dstrect);
+                        }
+
+                        if (slow_blit) {
+                            SDL_Log("%-24s -> %-24s blend %-5s%s%s%s\n",
+                                    SDL_GetPixelFormatName(formats[i]),
+                                    SDL_GetPixelFormatName(formats[j]),
+                                    blendnames[b],
+                                    (m & 1) ? ", color mod" : "",
+                                    (m & 2) ? ", alpha mod" : "",
+                                    scaled ? ", scaled" : "");
+                            ++slow;
+                        }
+                    }
+                }
+            }
+            SDL_FreeSurface(dst);
+            SDL_FreeSurface(src);
+        }
+    }
+
+    SDL_Log("%d of %d combinations use the slow blitter\n", slow, total);
+
+    SDL_Quit();
+    return 0;
+}
+
+/* vi: set ts=4 sw=4 expandtab: */